@@ -1,7 +1,7 @@
 #include <Arduino.h>
 
 // Palette 1: Warm sunset tones (from your first image)
-const uint32_t PALETTE_SUNSET[] = {
+constexpr uint32_t PALETTE_SUNSET[] = {
   0x1a2f3f, // Dark blue
   0x2d4a5a, // Medium dark blue
   0x5a6b7a, // Blue-gray
@@ -14,7 +14,7 @@ const uint32_t PALETTE_SUNSET[] = {
 const int PALETTE_SUNSET_SIZE = 8;
 
 // Palette 2: Yellow/Brown tones (from your second image)
-const uint32_t PALETTE_YELLOW_BROWN[] = {
+constexpr uint32_t PALETTE_YELLOW_BROWN[] = {
   0xf5d428, // Bright yellow
   0xc89050, // Light brown
   0x8b5a28, // Medium brown
@@ -27,7 +27,7 @@ const uint32_t PALETTE_YELLOW_BROWN[] = {
 const int PALETTE_YELLOW_BROWN_SIZE = 8;
 
 // Palette 3: Grayscale/Blue tones (from your third image)
-const uint32_t PALETTE_GRAYSCALE[] = {
+constexpr uint32_t PALETTE_GRAYSCALE[] = {
   0x000000, // Black
   0x282838, // Very dark blue-gray
   0x404858, // Dark blue-gray
@@ -41,7 +41,7 @@ const int PALETTE_GRAYSCALE_SIZE = 8;
 
 
 // Palette 4: Retro Gaming (Game Boy inspired)
-const uint32_t PALETTE_GAMEBOY[] = {
+constexpr uint32_t PALETTE_GAMEBOY[] = {
   0x0f380f, // Dark green
   0x306230, // Medium dark green
   0x8bac0f, // Light green
@@ -50,7 +50,7 @@ const uint32_t PALETTE_GAMEBOY[] = {
 const int PALETTE_GAMEBOY_SIZE = 4;
 
 // Palette 5: Cyberpunk Neon
-const uint32_t PALETTE_CYBERPUNK[] = {
+constexpr uint32_t PALETTE_CYBERPUNK[] = {
   0x0a0a1a, // Very dark blue
   0x1a1a3a, // Dark blue
   0xff006e, // Hot pink
@@ -63,7 +63,7 @@ const uint32_t PALETTE_CYBERPUNK[] = {
 const int PALETTE_CYBERPUNK_SIZE = 8;
 
 // Palette 6: Autumn Forest
-const uint32_t PALETTE_AUTUMN[] = {
+constexpr uint32_t PALETTE_AUTUMN[] = {
   0x2d1b00, // Dark brown
   0x5a3a1a, // Brown
   0x8b4513, // Saddle brown
@@ -76,7 +76,7 @@ const uint32_t PALETTE_AUTUMN[] = {
 const int PALETTE_AUTUMN_SIZE = 8;
 
 // Palette 7: Ocean Deep
-const uint32_t PALETTE_OCEAN[] = {
+constexpr uint32_t PALETTE_OCEAN[] = {
   0x001219, // Very dark blue
   0x005f73, // Dark cyan
   0x0a9396, // Teal
@@ -89,7 +89,7 @@ const uint32_t PALETTE_OCEAN[] = {
 const int PALETTE_OCEAN_SIZE = 8;
 
 // Palette 8: Desert Sand
-const uint32_t PALETTE_DESERT[] = {
+constexpr uint32_t PALETTE_DESERT[] = {
   0x3d2817, // Dark brown
   0x6b4423, // Brown
   0x8b6f47, // Light brown
@@ -102,7 +102,7 @@ const uint32_t PALETTE_DESERT[] = {
 const int PALETTE_DESERT_SIZE = 8;
 
 // Palette 9: Cherry Blossom
-const uint32_t PALETTE_SAKURA[] = {
+constexpr uint32_t PALETTE_SAKURA[] = {
   0x2d132c, // Dark purple
   0x801336, // Dark red
   0xc72c41, // Red
@@ -115,7 +115,7 @@ const uint32_t PALETTE_SAKURA[] = {
 const int PALETTE_SAKURA_SIZE = 8;
 
 // Palette 10: Mint Ice Cream
-const uint32_t PALETTE_MINT[] = {
+constexpr uint32_t PALETTE_MINT[] = {
   0x0d3b66, // Dark blue
   0x1a5490, // Blue
   0x2ec4b6, // Turquoise
@@ -128,7 +128,7 @@ const uint32_t PALETTE_MINT[] = {
 const int PALETTE_MINT_SIZE = 8;
 
 // Palette 11: Fire and Ash
-const uint32_t PALETTE_FIRE[] = {
+constexpr uint32_t PALETTE_FIRE[] = {
   0x0c0a09, // Almost black
   0x1c1614, // Very dark gray
   0x3d2b1f, // Dark brown
@@ -141,7 +141,7 @@ const uint32_t PALETTE_FIRE[] = {
 const int PALETTE_FIRE_SIZE = 8;
 
 // Palette 12: Arctic Ice
-const uint32_t PALETTE_ARCTIC[] = {
+constexpr uint32_t PALETTE_ARCTIC[] = {
   0x03045e, // Navy blue
   0x023e8a, // Dark blue
   0x0077b6, // Blue
@@ -154,7 +154,7 @@ const uint32_t PALETTE_ARCTIC[] = {
 const int PALETTE_ARCTIC_SIZE = 8;
 
 // Palette 13: Vintage Sepia
-const uint32_t PALETTE_SEPIA[] = {
+constexpr uint32_t PALETTE_SEPIA[] = {
   0x1a1110, // Very dark brown
   0x3d2817, // Dark brown
   0x5c4033, // Brown
@@ -167,7 +167,7 @@ const uint32_t PALETTE_SEPIA[] = {
 const int PALETTE_SEPIA_SIZE = 8;
 
 // Palette 14: Neon Night
-const uint32_t PALETTE_NEON[] = {
+constexpr uint32_t PALETTE_NEON[] = {
   0x000000, // Black
   0x1a1a2e, // Very dark blue
   0x16213e, // Dark blue
@@ -180,14 +180,14 @@ const uint32_t PALETTE_NEON[] = {
 const int PALETTE_NEON_SIZE = 8;
 
 // Palette 15: Black & White (2 colors)
-const uint32_t PALETTE_BW[] = {
+constexpr uint32_t PALETTE_BW[] = {
   0x000000, // Black
   0xffffff  // White
 };
 const int PALETTE_BW_SIZE = 2;
 
 // Palette 16: 4 Colors (CGA inspired)
-const uint32_t PALETTE_4COLOR[] = {
+constexpr uint32_t PALETTE_4COLOR[] = {
   0x000000, // Black
   0x00aaaa, // Cyan
   0xaa00aa, // Magenta
@@ -196,7 +196,7 @@ const uint32_t PALETTE_4COLOR[] = {
 const int PALETTE_4COLOR_SIZE = 4;
 
 // Palette 17: 16 Colors (VGA inspired)
-const uint32_t PALETTE_16COLOR[] = {
+constexpr uint32_t PALETTE_16COLOR[] = {
   0x000000, // Black
   0x0000aa, // Blue
   0x00aa00, // Green
@@ -217,7 +217,7 @@ const uint32_t PALETTE_16COLOR[] = {
 const int PALETTE_16COLOR_SIZE = 16;
 
 
-const uint32_t PALETTE_FRESTA[] = {
+constexpr uint32_t PALETTE_FRESTA[] = {
   0x0a1f2e, // Darkest Blue (from top left edge)
   0x1a4d6f, // Deep Blue
   0x5fb8b8, // Turquoise/Cyan
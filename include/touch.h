@@ -5,7 +5,9 @@
  * Capacitive touchscreen libraries
  * TouchLib: https://github.com/mmMicky/TouchLib.git
  ******************************************************************************/
+#include <atomic>
 #include "utilities.h"
+#include "i2c_bus.h"
 #define TOUCH_MODULES_CST_MUTUAL
 // Please fill below values from Arduino_GFX Example - TouchCalibration
 bool touch_swap_xy = false;
@@ -16,7 +18,17 @@ int16_t touch_map_y2 = -1;
 
 int16_t touch_max_x = 0, touch_max_y = 0;
 int16_t touch_raw_x = 0, touch_raw_y = 0;
-int16_t touch_last_x = 0, touch_last_y = 0;
+
+// Last mapped point, x in the high half and y in the low half: the bus task writes it
+// while LVGL reads it, and one word keeps a reader from pairing x and y of two reports
+std::atomic<uint32_t> touch_last_point(0);
+
+// Interrupt-driven reads: the INT line queues a read on the I2C bus task, which also
+// polls while a finger is down (the controller only reports changes)
+#define TOUCH_HELD_POLL_MS 20
+volatile bool touch_cached_pressed = false;
+static volatile bool touch_irq_ready = false;
+static volatile bool touch_read_queued = false;
 
 
 #include <Wire.h>
@@ -76,20 +88,29 @@ void touch_init(int16_t w, int16_t h, uint8_t r)
 
 bool touch_has_signal()
 {
-    // TODO: implement TOUCH_INT
-    return true;
+    return touch_irq_ready;
 }
 
 void translate_touch_raw()
 {
+    int16_t x, y;
     if (touch_swap_xy) {
-        touch_last_x = map(touch_raw_y, touch_map_x1, touch_map_x2, 0, touch_max_x);
-        touch_last_y = map(touch_raw_x, touch_map_y1, touch_map_y2, 0, touch_max_y);
+        x = map(touch_raw_y, touch_map_x1, touch_map_x2, 0, touch_max_x);
+        y = map(touch_raw_x, touch_map_y1, touch_map_y2, 0, touch_max_y);
     } else {
-        touch_last_x = map(touch_raw_x, touch_map_x1, touch_map_x2, 0, touch_max_x);
-        touch_last_y = map(touch_raw_y, touch_map_y1, touch_map_y2, 0, touch_max_y);
+        x = map(touch_raw_x, touch_map_x1, touch_map_x2, 0, touch_max_x);
+        y = map(touch_raw_y, touch_map_y1, touch_map_y2, 0, touch_max_y);
     }
-    // Serial.printf("touch_raw_x: %d, touch_raw_y: %d, touch_last_x: %d, touch_last_y: %d\n", touch_raw_x, touch_raw_y, touch_last_x, touch_last_y);
+    touch_last_point.store(((uint32_t)(uint16_t)x << 16) | (uint16_t)y);
+    // Serial.printf("touch_raw_x: %d, touch_raw_y: %d, x: %d, y: %d\n", touch_raw_x, touch_raw_y, x, y);
+}
+
+// Both coordinates of the last point, from the same report
+void touch_last_xy(int16_t &x, int16_t &y)
+{
+    uint32_t point = touch_last_point.load();
+    x = (int16_t)(point >> 16);
+    y = (int16_t)(point & 0xFFFF);
 }
 
 bool touch_touched()
@@ -99,9 +120,6 @@ bool touch_touched()
         touch_raw_x = t.x;
         touch_raw_y = t.y;
 
-        touch_last_x = touch_raw_x;
-        touch_last_y = touch_raw_y;
-
         translate_touch_raw();
         return true;
     }
@@ -112,3 +130,33 @@ bool touch_released()
 {
     return false;
 }
+
+// Runs on the I2C bus task
+void touch_read_job(void *ctx)
+{
+    touch_read_queued = false;
+    bool pressed = touch_touched();
+    touch_cached_pressed = pressed;
+    i2cBusSetPoll(touch_read_job, ctx, pressed ? TOUCH_HELD_POLL_MS : 0);
+}
+
+void IRAM_ATTR touch_irq_handler()
+{
+    if (!touch_read_queued)
+    {
+        // Marked before queueing, the job may run on the other core before this returns
+        touch_read_queued = true;
+        if (!i2cBusSubmitFromISR(touch_read_job, NULL, I2C_PRIORITY_HIGH))
+        {
+            touch_read_queued = false;
+        }
+    }
+}
+
+// Call once the I2C bus task is running; touch_touched() must not be called directly after
+void touch_begin_irq()
+{
+    pinMode(BOARD_TOUCH_IRQ, INPUT_PULLUP);
+    attachInterrupt(BOARD_TOUCH_IRQ, touch_irq_handler, FALLING);
+    touch_irq_ready = true;
+}
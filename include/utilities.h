@@ -37,6 +37,7 @@
 
 #define BOARD_SENSOR_IRQ    21
 #define BOARD_TOUCH_RST     13
+#define BOARD_TOUCH_IRQ     BOARD_SENSOR_IRQ    // Touch INT shares the sensor interrupt line
 
 #define BOARD_TFT_WIDTH     222
 #define BOARD_TFT_HEIHT     480
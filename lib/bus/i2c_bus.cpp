@@ -0,0 +1,274 @@
+#include "i2c_bus.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+struct I2cJob
+{
+    I2cJobFn fn;
+    void *ctx;
+    uint32_t queuedMicros;
+};
+
+static const int I2C_QUEUE_DEPTH = 8;
+
+static QueueHandle_t queues[I2C_PRIORITY_COUNT] = {};
+static SemaphoreHandle_t busMutex = nullptr;
+static TaskHandle_t busTask = nullptr;
+
+static portMUX_TYPE busLock = portMUX_INITIALIZER_UNLOCKED;
+static I2cBusStats stats = {};
+static I2cJobFn pollFn = nullptr;
+static void *pollCtx = nullptr;
+static uint32_t pollPeriodMs = 0;
+static uint32_t lockStartMicros = 0;
+
+static void addBusy(uint32_t start)
+{
+    uint32_t elapsed = micros() - start;
+    portENTER_CRITICAL(&busLock);
+    stats.busyMicros += elapsed;
+    portEXIT_CRITICAL(&busLock);
+}
+
+static void runJob(I2cJobFn fn, void *ctx)
+{
+    xSemaphoreTake(busMutex, portMAX_DELAY);
+    uint32_t start = micros();
+    fn(ctx);
+    addBusy(start);
+    xSemaphoreGive(busMutex);
+}
+
+// Highest priority first; one job per call so a new high priority job never waits
+// behind a backlog of low priority ones
+static bool takeNextJob(I2cJob &job, int &priority)
+{
+    for (int p = 0; p < I2C_PRIORITY_COUNT; p++)
+    {
+        if (xQueueReceive(queues[p], &job, 0) == pdTRUE)
+        {
+            priority = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void busTaskLoop(void *param)
+{
+    (void)param;
+    uint32_t lastPoll = millis();
+
+    for (;;)
+    {
+        portENTER_CRITICAL(&busLock);
+        I2cJobFn fn = pollFn;
+        void *ctx = pollCtx;
+        uint32_t period = pollPeriodMs;
+        portEXIT_CRITICAL(&busLock);
+
+        TickType_t wait = portMAX_DELAY;
+        if (fn && period)
+        {
+            uint32_t since = millis() - lastPoll;
+            wait = since >= period ? 0 : pdMS_TO_TICKS(period - since);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        if (fn && period && millis() - lastPoll >= period)
+        {
+            lastPoll = millis();
+            runJob(fn, ctx);
+            portENTER_CRITICAL(&busLock);
+            stats.polls++;
+            portEXIT_CRITICAL(&busLock);
+        }
+
+        I2cJob job;
+        int priority;
+        while (takeNextJob(job, priority))
+        {
+            uint32_t waited = micros() - job.queuedMicros;
+            runJob(job.fn, job.ctx);
+
+            portENTER_CRITICAL(&busLock);
+            stats.jobs[priority]++;
+            stats.queueMicros += waited;
+            if (waited > stats.maxQueueMicros)
+            {
+                stats.maxQueueMicros = waited;
+            }
+            portEXIT_CRITICAL(&busLock);
+        }
+    }
+}
+
+bool i2cBusBegin()
+{
+    if (busTask)
+    {
+        return true;
+    }
+
+    busMutex = xSemaphoreCreateMutex();
+    if (!busMutex)
+    {
+        return false;
+    }
+    for (int p = 0; p < I2C_PRIORITY_COUNT; p++)
+    {
+        queues[p] = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(I2cJob));
+        if (!queues[p])
+        {
+            return false;
+        }
+    }
+
+    stats.startMillis = millis();
+
+    // Core 0, above the loop task: jobs are short and mostly wait on the I2C peripheral
+    if (xTaskCreatePinnedToCore(busTaskLoop, "i2c_bus", 4096, nullptr,
+                                uxTaskPriorityGet(nullptr) + 1, &busTask, 0) != pdPASS)
+    {
+        busTask = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool i2cBusSubmit(I2cJobFn fn, void *ctx, I2cPriority priority)
+{
+    if (!busTask || priority < 0 || priority >= I2C_PRIORITY_COUNT)
+    {
+        return false;
+    }
+
+    I2cJob job = {fn, ctx, (uint32_t)micros()};
+    if (xQueueSend(queues[priority], &job, 0) != pdTRUE)
+    {
+        portENTER_CRITICAL(&busLock);
+        stats.dropped++;
+        portEXIT_CRITICAL(&busLock);
+        return false;
+    }
+    xTaskNotifyGive(busTask);
+    return true;
+}
+
+bool IRAM_ATTR i2cBusSubmitFromISR(I2cJobFn fn, void *ctx, I2cPriority priority)
+{
+    if (!busTask || priority < 0 || priority >= I2C_PRIORITY_COUNT)
+    {
+        return false;
+    }
+
+    BaseType_t woken = pdFALSE;
+    I2cJob job = {fn, ctx, (uint32_t)micros()};
+    if (xQueueSendFromISR(queues[priority], &job, &woken) != pdTRUE)
+    {
+        portENTER_CRITICAL_ISR(&busLock);
+        stats.dropped++;
+        portEXIT_CRITICAL_ISR(&busLock);
+        return false;
+    }
+    vTaskNotifyGiveFromISR(busTask, &woken);
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+    return true;
+}
+
+bool i2cBusCall(I2cJobFn fn, void *ctx, uint32_t timeoutMs)
+{
+    if (!busMutex)
+    {
+        fn(ctx);
+        return true;
+    }
+
+    uint32_t start = micros();
+    if (xSemaphoreTake(busMutex, pdMS_TO_TICKS(timeoutMs)) != pdTRUE)
+    {
+        return false;
+    }
+    uint32_t acquired = micros();
+    fn(ctx);
+    addBusy(acquired);
+    xSemaphoreGive(busMutex);
+
+    portENTER_CRITICAL(&busLock);
+    stats.calls++;
+    stats.lockWaitMicros += acquired - start;
+    portEXIT_CRITICAL(&busLock);
+    return true;
+}
+
+void i2cBusSetPoll(I2cJobFn fn, void *ctx, uint32_t periodMs)
+{
+    portENTER_CRITICAL(&busLock);
+    pollFn = periodMs ? fn : nullptr;
+    pollCtx = ctx;
+    pollPeriodMs = periodMs;
+    portEXIT_CRITICAL(&busLock);
+
+    if (busTask && xTaskGetCurrentTaskHandle() != busTask)
+    {
+        xTaskNotifyGive(busTask); // Recompute its wait
+    }
+}
+
+void i2cBusLock()
+{
+    if (!busMutex)
+    {
+        return;
+    }
+
+    uint32_t start = micros();
+    xSemaphoreTake(busMutex, portMAX_DELAY);
+    lockStartMicros = micros();
+
+    portENTER_CRITICAL(&busLock);
+    stats.lockWaitMicros += lockStartMicros - start;
+    portEXIT_CRITICAL(&busLock);
+}
+
+void i2cBusUnlock()
+{
+    if (!busMutex)
+    {
+        return;
+    }
+
+    addBusy(lockStartMicros);
+    xSemaphoreGive(busMutex);
+}
+
+I2cBusStats i2cBusGetStats()
+{
+    I2cBusStats copy;
+
+    portENTER_CRITICAL(&busLock);
+    copy = stats;
+    portEXIT_CRITICAL(&busLock);
+    return copy;
+}
+
+void i2cBusLogStats()
+{
+    I2cBusStats s = i2cBusGetStats();
+    uint64_t upMicros = (uint64_t)(millis() - s.startMillis) * 1000;
+    uint32_t busyX1000 = upMicros ? (uint32_t)(s.busyMicros * 1000 / upMicros) : 0;
+    uint32_t queued = s.jobs[I2C_PRIORITY_HIGH] + s.jobs[I2C_PRIORITY_NORMAL] + s.jobs[I2C_PRIORITY_LOW];
+
+    Serial.printf("[i2c] jobs=%lu/%lu/%lu polls=%lu calls=%lu dropped=%lu busy=%lums (%lu.%lu%%) queue avg=%luus max=%luus lock wait=%luus\n",
+                  (unsigned long)s.jobs[I2C_PRIORITY_HIGH], (unsigned long)s.jobs[I2C_PRIORITY_NORMAL],
+                  (unsigned long)s.jobs[I2C_PRIORITY_LOW], (unsigned long)s.polls, (unsigned long)s.calls,
+                  (unsigned long)s.dropped, (unsigned long)(s.busyMicros / 1000),
+                  (unsigned long)(busyX1000 / 10), (unsigned long)(busyX1000 % 10),
+                  (unsigned long)(queued ? s.queueMicros / queued : 0), (unsigned long)s.maxQueueMicros,
+                  (unsigned long)s.lockWaitMicros);
+}
@@ -0,0 +1,98 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Shared I2C bus arbiter
+//
+// The PMU, the touch controller and the camera SCCB all sit on BOARD_I2C_SDA/SCL. Once
+// the arbiter is started, every Wire transaction runs as a job on one bus task pinned to
+// core 0, taken from per-priority queues highest first, so the loop task (preview,
+// capture, LVGL) never waits on the bus for telemetry or touch. Code that must talk to
+// the bus itself (the camera driver's SCCB writes) brackets it with i2cBusLock/Unlock.
+//
+// A single periodic poll job can be installed for devices that have to be read while
+// their interrupt line is quiet (a touch controller while a finger is down).
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum I2cPriority
+{
+    I2C_PRIORITY_HIGH = 0, // Input and anything the capture path waits for
+    I2C_PRIORITY_NORMAL,
+    I2C_PRIORITY_LOW, // Telemetry refreshes
+    I2C_PRIORITY_COUNT
+};
+
+typedef void (*I2cJobFn)(void *ctx);
+
+struct I2cBusStats
+{
+    uint32_t jobs[I2C_PRIORITY_COUNT]; // Jobs run, per priority
+    uint32_t polls;                    // Poll job runs
+    uint32_t calls;                    // i2cBusCall jobs run on their caller
+    uint32_t dropped;                  // Submissions refused because a queue was full
+    uint64_t busyMicros;               // Time the bus was held (jobs and external locks)
+    uint32_t queueMicros;              // Time jobs waited in a queue, summed
+    uint32_t maxQueueMicros;           // Longest single queue wait
+    uint32_t lockWaitMicros;           // Time i2cBusLock callers waited for the bus
+    uint32_t startMillis;              // When the arbiter started (for the busy ratio)
+};
+
+/**
+ * Start the bus task (call once, after every device on the bus has been initialized)
+ *
+ * @return false if the task or its queues could not be created
+ */
+bool i2cBusBegin();
+
+/**
+ * Queue a job without waiting for it
+ *
+ * @param fn Job body, runs on the bus task with the bus held
+ * @param ctx Job context (must stay valid until the job has run)
+ * @param priority Queue to use
+ * @return false if the arbiter is not running or the queue is full
+ */
+bool i2cBusSubmit(I2cJobFn fn, void *ctx, I2cPriority priority);
+
+/**
+ * Same as i2cBusSubmit, for interrupt handlers
+ */
+bool i2cBusSubmitFromISR(I2cJobFn fn, void *ctx, I2cPriority priority);
+
+/**
+ * Run a job on the calling task as soon as the bus is free, skipping the queues
+ *
+ * For the few transactions a caller cannot continue without (switching flash power).
+ * Waits at most for the job currently on the bus. Must not be called from a job.
+ *
+ * @param fn Job body
+ * @param ctx Job context
+ * @param timeoutMs Longest wait for the bus
+ * @return false if the bus did not come free within timeoutMs (fn was not run)
+ */
+bool i2cBusCall(I2cJobFn fn, void *ctx, uint32_t timeoutMs);
+
+/**
+ * Install (or with periodMs 0, remove) the periodic poll job; it runs at high priority
+ */
+void i2cBusSetPoll(I2cJobFn fn, void *ctx, uint32_t periodMs);
+
+/**
+ * Hold the bus for direct access by a driver outside the arbiter
+ */
+void i2cBusLock();
+void i2cBusUnlock();
+
+/**
+ * Copy of the counters
+ */
+I2cBusStats i2cBusGetStats();
+
+/**
+ * Print the counters to Serial
+ */
+void i2cBusLogStats();
+
+#endif // I2C_BUS_H
@@ -0,0 +1,27 @@
+#include "camera_zoom.h"
+
+int applySensorZoom(sensor_t *sensor, int zoomFactor)
+{
+    if (!sensor || sensor->id.PID != OV3660_PID || zoomFactor <= 1)
+    {
+        return 1;
+    }
+
+    const resolution_info_t &output = resolution[sensor->status.framesize];
+    SensorWindow window;
+    if (!sensorZoomWindow(OV3660_SENSOR_GEOMETRY, zoomFactor, output.width, output.height, window))
+    {
+        return 1;
+    }
+
+    if (sensor->set_res_raw(sensor, window.startX, window.startY, window.endX, window.endY,
+                            window.offsetX, window.offsetY, window.totalX, window.totalY,
+                            window.outputX, window.outputY, window.scale, window.binning) != 0)
+    {
+        // Registers may be half written; go back to the driver's mode
+        sensor->set_framesize(sensor, sensor->status.framesize);
+        return 1;
+    }
+
+    return zoomFactor;
+}
@@ -0,0 +1,20 @@
+#ifndef CAMERA_ZOOM_H
+#define CAMERA_ZOOM_H
+
+#include <esp_camera.h>
+#include "sensor_zoom.h"
+
+/**
+ * Program the sensor readout window for a zoom factor at the current frame size
+ *
+ * Only the OV3660 is supported. If the window cannot be set the driver's own mode for
+ * the current frame size is restored. Call from a point where the sensor may be written
+ * (no other SCCB traffic in flight).
+ *
+ * @param sensor Camera sensor
+ * @param zoomFactor Magnification wanted (1 leaves the sensor untouched)
+ * @return Magnification the sensor now applies (1 = none, crop in software)
+ */
+int applySensorZoom(sensor_t *sensor, int zoomFactor);
+
+#endif // CAMERA_ZOOM_H
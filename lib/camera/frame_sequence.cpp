@@ -0,0 +1,50 @@
+#include "frame_sequence.h"
+#include <string.h>
+
+void frameSequenceInitHeader(FrameSequenceHeader &header, uint16_t sensorPid)
+{
+    memset(&header, 0, sizeof(header));
+    header.magic = FRAME_SEQUENCE_MAGIC;
+    header.version = FRAME_SEQUENCE_VERSION;
+    header.headerBytes = sizeof(FrameSequenceHeader);
+    header.recordBytes = sizeof(FrameSequenceRecord);
+    header.sensorPid = sensorPid;
+}
+
+bool frameSequenceHeaderValid(const FrameSequenceHeader &header)
+{
+    // Later versions may only grow the structures
+    return header.magic == FRAME_SEQUENCE_MAGIC && header.version >= 1 &&
+           header.headerBytes >= sizeof(FrameSequenceHeader) && header.recordBytes >= sizeof(FrameSequenceRecord);
+}
+
+void frameSequenceFillRecord(FrameSequenceRecord &record, const camera_fb_t *frame, const sensor_t *sensor,
+                             int zoomLevel, int sensorZoom)
+{
+    memset(&record, 0, sizeof(record));
+    record.timestampMicros = (uint32_t)(frame->timestamp.tv_sec * 1000000ULL + frame->timestamp.tv_usec);
+    record.pixelBytes = frame->len;
+    record.width = frame->width;
+    record.height = frame->height;
+    record.pixelFormat = frame->format;
+    record.zoomLevel = zoomLevel;
+    record.sensorZoom = sensorZoom;
+
+    if (sensor)
+    {
+        record.framesize = sensor->status.framesize;
+        record.aec = sensor->status.aec;
+        record.aec2 = sensor->status.aec2;
+        record.agc = sensor->status.agc;
+        record.agcGain = sensor->status.agc_gain;
+        record.aecValue = sensor->status.aec_value;
+        record.hmirror = sensor->status.hmirror;
+        record.vflip = sensor->status.vflip;
+    }
+}
+
+bool frameSequenceRecordValid(const FrameSequenceRecord &record)
+{
+    return record.pixelFormat == PIXFORMAT_RGB565 && record.width > 0 && record.height > 0 &&
+           record.pixelBytes == (uint32_t)record.width * record.height * 2;
+}
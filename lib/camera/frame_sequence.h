@@ -0,0 +1,89 @@
+#ifndef FRAME_SEQUENCE_H
+#define FRAME_SEQUENCE_H
+
+#include <esp_camera.h>
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Raw frame sequence files
+//
+// A recording of consecutive camera frames exactly as the driver delivered them, for
+// replaying field footage through the filters on the host:
+//
+//   FrameSequenceHeader
+//   FrameSequenceRecord, pixelBytes of frame data      (once per frame)
+//
+// Pixels are the driver's RGB565 (byte-swapped) rows without padding. Every field is
+// little-endian, the byte order of both the ESP32-S3 and the hosts we replay on. The
+// header's frame count is written when the recording ends; a reader that finds 0 (the
+// recording was cut short) can still read records until the end of the file.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const uint32_t FRAME_SEQUENCE_MAGIC = 0x51455346; // "FSEQ"
+const uint16_t FRAME_SEQUENCE_VERSION = 1;
+
+struct FrameSequenceHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes; // sizeof(FrameSequenceHeader), for readers of later versions
+    uint16_t recordBytes; // sizeof(FrameSequenceRecord)
+    uint16_t sensorPid;
+    uint32_t frameCount;  // 0 until the recording is finished
+    uint32_t reserved[4];
+};
+
+struct FrameSequenceRecord
+{
+    uint32_t timestampMicros; // Driver timestamp of the frame
+    uint32_t pixelBytes;      // Frame data following this record
+    uint16_t width;
+    uint16_t height;
+    uint8_t pixelFormat; // pixformat_t
+    uint8_t framesize;   // framesize_t the sensor was set to
+    uint8_t zoomLevel;   // UI zoom level
+    uint8_t sensorZoom;  // Part of the zoom the readout window applied (1 = none)
+    uint8_t aec;         // Sensor settings the frame was exposed with
+    uint8_t aec2;
+    uint8_t agc;
+    uint8_t agcGain;
+    uint16_t aecValue;
+    uint8_t hmirror;
+    uint8_t vflip;
+    uint32_t reserved[2];
+};
+
+static_assert(sizeof(FrameSequenceHeader) == 32, "FrameSequenceHeader layout changed");
+static_assert(sizeof(FrameSequenceRecord) == 32, "FrameSequenceRecord layout changed");
+
+/**
+ * Header for a new recording (frame count 0)
+ *
+ * @param header Header to fill
+ * @param sensorPid Product ID of the sensor recorded from
+ */
+void frameSequenceInitHeader(FrameSequenceHeader &header, uint16_t sensorPid);
+
+/**
+ * @return Whether a header read from a file is one this code understands
+ */
+bool frameSequenceHeaderValid(const FrameSequenceHeader &header);
+
+/**
+ * Record describing a frame and the sensor settings it was taken with
+ *
+ * @param record Record to fill
+ * @param frame Frame as delivered by the driver
+ * @param sensor Camera sensor (nullptr leaves the settings zero)
+ * @param zoomLevel UI zoom level
+ * @param sensorZoom Magnification applied by the readout window
+ */
+void frameSequenceFillRecord(FrameSequenceRecord &record, const camera_fb_t *frame, const sensor_t *sensor,
+                             int zoomLevel, int sensorZoom);
+
+/**
+ * @return Whether a record read from a file describes a complete RGB565 frame
+ */
+bool frameSequenceRecordValid(const FrameSequenceRecord &record);
+
+#endif // FRAME_SEQUENCE_H
@@ -0,0 +1,227 @@
+#include "sensor_queue.h"
+#include "camera_zoom.h"
+#include <Arduino.h>
+
+struct SensorSlot
+{
+    bool pending;
+    int value;
+};
+
+static portMUX_TYPE queueLock = portMUX_INITIALIZER_UNLOCKED;
+static SensorSlot slots[SENSOR_CMD_COUNT] = {};
+static int requestedZoom = 1; // Last zoom posted, restored after a frame size change
+static int windowZoom = 1;    // Zoom the readout window registers hold
+static int sensorZoom = 1;    // Zoom of the frames delivered now (windowZoom once settled)
+static bool zoomSettling = false; // Window rewritten; the next frame may mix old and new
+static SensorQueueStats stats = {};
+
+void sensorQueuePost(SensorCommand command, int value)
+{
+    if (command < 0 || command >= SENSOR_CMD_COUNT)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&queueLock);
+    if (slots[command].pending)
+    {
+        stats.coalesced++;
+    }
+    slots[command].pending = true;
+    slots[command].value = value;
+    if (command == SENSOR_CMD_ZOOM)
+    {
+        requestedZoom = value;
+    }
+    stats.posted++;
+    portEXIT_CRITICAL(&queueLock);
+}
+
+bool sensorQueuePending()
+{
+    bool pending = false;
+
+    portENTER_CRITICAL(&queueLock);
+    for (int i = 0; i < SENSOR_CMD_COUNT && !pending; i++)
+    {
+        pending = slots[i].pending;
+    }
+    portEXIT_CRITICAL(&queueLock);
+    return pending;
+}
+
+// Count one driver write call and its outcome
+static void countWrite(int result)
+{
+    stats.transactions++;
+    if (result != 0)
+    {
+        stats.failures++;
+    }
+}
+
+static void applyZoom(sensor_t *sensor, int factor)
+{
+    if (sensor->id.PID != OV3660_PID)
+    {
+        return;
+    }
+
+    int previous = windowZoom;
+    if (factor > 1)
+    {
+        windowZoom = applySensorZoom(sensor, factor);
+        countWrite(windowZoom == factor ? 0 : -1);
+    }
+    else
+    {
+        windowZoom = 1;
+    }
+
+    if (windowZoom == 1 && previous > 1)
+    {
+        // Back to the driver's own (binned, full field of view) mode
+        countWrite(sensor->set_framesize(sensor, sensor->status.framesize));
+    }
+
+    // Frames keep the old zoom until one read out entirely with the new window arrives
+    if (windowZoom != previous)
+    {
+        zoomSettling = true;
+    }
+}
+
+static void applyCommand(sensor_t *sensor, SensorCommand command, int value)
+{
+    switch (command)
+    {
+    case SENSOR_CMD_AEC2:
+        countWrite(sensor->set_aec2(sensor, value ? 1 : 0));
+        if (value)
+        {
+            // Same companions camera_init enables with AEC2
+            countWrite(sensor->set_dcw(sensor, 1));
+            countWrite(sensor->set_bpc(sensor, 1));
+            countWrite(sensor->set_wpc(sensor, 1));
+        }
+        break;
+    case SENSOR_CMD_GAIN_CTRL:
+        countWrite(sensor->set_gain_ctrl(sensor, value ? 1 : 0));
+        break;
+    case SENSOR_CMD_AGC_GAIN:
+        countWrite(sensor->set_agc_gain(sensor, value));
+        break;
+    case SENSOR_CMD_EXPOSURE_CTRL:
+        countWrite(sensor->set_exposure_ctrl(sensor, value ? 1 : 0));
+        break;
+    case SENSOR_CMD_AEC_VALUE:
+        countWrite(sensor->set_aec_value(sensor, value));
+        break;
+    case SENSOR_CMD_ZOOM:
+        applyZoom(sensor, value);
+        break;
+    default:
+        break;
+    }
+}
+
+int sensorQueueApply(sensor_t *sensor)
+{
+    if (!sensor)
+    {
+        return 0;
+    }
+
+    // Take the batch under the lock; the SCCB writes themselves run outside it
+    SensorSlot batch[SENSOR_CMD_COUNT];
+    bool any = false;
+    portENTER_CRITICAL(&queueLock);
+    for (int i = 0; i < SENSOR_CMD_COUNT; i++)
+    {
+        batch[i] = slots[i];
+        slots[i].pending = false;
+        any = any || batch[i].pending;
+    }
+    portEXIT_CRITICAL(&queueLock);
+
+    if (!any)
+    {
+        return 0;
+    }
+
+    uint32_t start = micros();
+    int applied = 0;
+    for (int i = 0; i < SENSOR_CMD_COUNT; i++)
+    {
+        if (batch[i].pending)
+        {
+            applyCommand(sensor, (SensorCommand)i, batch[i].value);
+            applied++;
+        }
+    }
+    uint32_t elapsed = micros() - start;
+
+    stats.batches++;
+    stats.applied += applied;
+    stats.stallMicros += elapsed;
+    if (elapsed > stats.maxStallMicros)
+    {
+        stats.maxStallMicros = elapsed;
+    }
+    return applied;
+}
+
+bool sensorQueueFrameFetched()
+{
+    if (!zoomSettling)
+    {
+        return true;
+    }
+
+    // The writes may have straddled this frame's start, so only the next one is sure to
+    // be read out with the new window
+    zoomSettling = false;
+    sensorZoom = windowZoom;
+    return false;
+}
+
+int sensorQueueZoomFactor()
+{
+    return sensorZoom;
+}
+
+void sensorQueueFrameSizeChanged()
+{
+    windowZoom = 1;
+    sensorZoom = 1;
+    zoomSettling = false;
+
+    portENTER_CRITICAL(&queueLock);
+    if (requestedZoom > 1)
+    {
+        slots[SENSOR_CMD_ZOOM].pending = true;
+        slots[SENSOR_CMD_ZOOM].value = requestedZoom;
+    }
+    portEXIT_CRITICAL(&queueLock);
+}
+
+SensorQueueStats sensorQueueGetStats()
+{
+    SensorQueueStats copy;
+
+    portENTER_CRITICAL(&queueLock);
+    copy = stats;
+    portEXIT_CRITICAL(&queueLock);
+    return copy;
+}
+
+void sensorQueueLogStats()
+{
+    SensorQueueStats s = sensorQueueGetStats();
+    Serial.printf("[sensor] posted=%lu coalesced=%lu applied=%lu batches=%lu sccb=%lu failed=%lu stall=%luus max=%luus\n",
+                  (unsigned long)s.posted, (unsigned long)s.coalesced,
+                  (unsigned long)s.applied, (unsigned long)s.batches,
+                  (unsigned long)s.transactions, (unsigned long)s.failures,
+                  (unsigned long)s.stallMicros, (unsigned long)s.maxStallMicros);
+}
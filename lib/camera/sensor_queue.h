@@ -0,0 +1,102 @@
+#ifndef SENSOR_QUEUE_H
+#define SENSOR_QUEUE_H
+
+#include <esp_camera.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sensor command queue
+//
+// UI code posts sensor settings here instead of writing them itself. Each setting has
+// one slot, so posting again before the value reached the sensor simply replaces it
+// (dragging a slider costs one register write per frame, not one per event). The
+// preview applies the pending slots at a frame boundary while it holds the only frame
+// buffer, so DMA is idle, the stream never stops and no frame is dropped.
+//
+// Slots are applied in enum order, which keeps the auto/manual switches ahead of the
+// manual values they enable.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum SensorCommand
+{
+    SENSOR_CMD_AEC2 = 0,      // Night mode AEC (also enables DCW/BPC/WPC when turned on)
+    SENSOR_CMD_GAIN_CTRL,     // Auto gain on/off
+    SENSOR_CMD_AGC_GAIN,      // Manual gain
+    SENSOR_CMD_EXPOSURE_CTRL, // Auto exposure on/off
+    SENSOR_CMD_AEC_VALUE,     // Manual exposure
+    SENSOR_CMD_ZOOM,          // Readout window magnification (see camera_zoom.h)
+    SENSOR_CMD_COUNT
+};
+
+struct SensorQueueStats
+{
+    uint32_t posted;         // Commands posted
+    uint32_t coalesced;      // Posts that replaced a value not applied yet
+    uint32_t batches;        // Frame boundaries that had something to apply
+    uint32_t applied;        // Commands applied
+    uint32_t transactions;   // Sensor driver write calls (each one or more SCCB writes)
+    uint32_t failures;       // Driver calls that reported an error
+    uint32_t stallMicros;    // Total time a frame was held while applying
+    uint32_t maxStallMicros; // Longest single batch
+};
+
+/**
+ * Queue a sensor setting; the latest value posted before the next frame boundary wins
+ *
+ * Safe to call from any task.
+ *
+ * @param command Setting to change
+ * @param value New value (switches: 0 or 1; zoom: magnification)
+ */
+void sensorQueuePost(SensorCommand command, int value);
+
+/**
+ * @return true if any setting is waiting for a frame boundary
+ */
+bool sensorQueuePending();
+
+/**
+ * Write every pending setting to the sensor
+ *
+ * Call from the capture path while holding a frame buffer (between esp_camera_fb_get and
+ * esp_camera_fb_return), so the driver has nowhere to put pixels and no DMA is running.
+ *
+ * @param sensor Camera sensor
+ * @return Number of settings applied
+ */
+int sensorQueueApply(sensor_t *sensor);
+
+/**
+ * Tell the queue a frame was fetched from the driver
+ *
+ * A zoom change rewrites the readout window while the sensor keeps streaming, so the
+ * first frame fetched after it may have been read out with the old window or a mix of
+ * both. That frame should be dropped; sensorQueueZoomFactor reports the new zoom from
+ * the frame after it.
+ *
+ * @return false if this frame was read out while the window changed (drop it)
+ */
+bool sensorQueueFrameFetched();
+
+/**
+ * @return Magnification the sensor readout window applied to the frames delivered now
+ */
+int sensorQueueZoomFactor();
+
+/**
+ * Tell the queue the frame size was set directly, which resets the readout window
+ *
+ * The last zoom posted is queued again so the next frame boundary restores it.
+ */
+void sensorQueueFrameSizeChanged();
+
+/**
+ * Copy of the counters
+ */
+SensorQueueStats sensorQueueGetStats();
+
+/**
+ * Print the counters to Serial
+ */
+void sensorQueueLogStats();
+
+#endif // SENSOR_QUEUE_H
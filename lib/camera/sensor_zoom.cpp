@@ -0,0 +1,64 @@
+#include "sensor_zoom.h"
+
+int zoomLevelFactor(int zoomLevel)
+{
+    if (zoomLevel <= 0 || zoomLevel >= SENSOR_ZOOM_LEVELS)
+    {
+        return 1;
+    }
+    return 1 << zoomLevel;
+}
+
+bool sensorZoomWindow(const SensorGeometry &geometry, int zoomFactor, int outputWidth, int outputHeight, SensorWindow &window)
+{
+    if (zoomFactor < 2 || outputWidth <= 0 || outputHeight <= 0)
+    {
+        return false;
+    }
+
+    // Even sizes and offsets keep the Bayer phase of the window unchanged
+    int width = (geometry.arrayWidth / zoomFactor) & ~1;
+    int height = (geometry.arrayHeight / zoomFactor) & ~1;
+    if (width < outputWidth || height < outputHeight)
+    {
+        return false;
+    }
+
+    int x = ((geometry.arrayWidth - width) / 2) & ~1;
+    int y = ((geometry.arrayHeight - height) / 2) & ~1;
+
+    // Readout includes the ISP margin on both sides, like the full-frame mode
+    window.startX = x;
+    window.startY = y;
+    window.endX = x + width + 2 * geometry.offsetX - 1;
+    window.endY = y + height + 2 * geometry.offsetY - 1;
+    window.offsetX = geometry.offsetX;
+    window.offsetY = geometry.offsetY;
+
+    // Keep the full-frame vertical blanking on top of the shorter window
+    int verticalBlank = geometry.totalY - (geometry.arrayHeight + 2 * geometry.offsetY);
+    window.totalX = geometry.totalX;
+    window.totalY = (window.endY - window.startY + 1) + verticalBlank;
+
+    window.outputX = outputWidth;
+    window.outputY = outputHeight;
+    window.scale = true;
+    window.binning = false;
+    return true;
+}
+
+ZoomCrop softwareZoomCrop(int frameWidth, int frameHeight, int zoomFactor)
+{
+    ZoomCrop crop;
+
+    if (zoomFactor < 1)
+    {
+        zoomFactor = 1;
+    }
+
+    crop.width = frameWidth / zoomFactor;
+    crop.height = frameHeight / zoomFactor;
+    crop.x = (frameWidth - crop.width) / 2;
+    crop.y = (frameHeight - crop.height) / 2;
+    return crop;
+}
@@ -0,0 +1,94 @@
+#ifndef SENSOR_ZOOM_H
+#define SENSOR_ZOOM_H
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Digital zoom geometry
+//
+// Turns the UI zoom levels into either a sensor readout window (so the sensor's own
+// scaler delivers the cropped region at full output resolution) or, when the sensor
+// cannot be reprogrammed, the software crop of the delivered frame. Plain integer math
+// with no camera driver dependency, so it can be checked on the host.
+//
+// A zoomed window is the centered 1/factor of the 1x field of view, so sensor and
+// software zoom frame the same scene.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const int SENSOR_ZOOM_LEVELS = 3; // 1x, 2x, 4x
+
+// Readout timing of a sensor's full-frame mode, all in sensor pixels and lines
+struct SensorGeometry
+{
+    int arrayWidth;  // Active array the 1x view is taken from
+    int arrayHeight;
+    int offsetX;     // ISP crop inside the readout window (X/Y_OFFSET)
+    int offsetY;
+    int totalX;      // Full-frame line length (HTS)
+    int totalY;      // Full-frame length (VTS)
+};
+
+// OV3660 4:3 full-array mode (esp32-camera ratio table)
+const SensorGeometry OV3660_SENSOR_GEOMETRY = {2048, 1536, 16, 6, 2300, 1564};
+
+// Arguments of sensor_t::set_res_raw
+struct SensorWindow
+{
+    int startX;
+    int startY;
+    int endX;
+    int endY;
+    int offsetX;
+    int offsetY;
+    int totalX;
+    int totalY;
+    int outputX;
+    int outputY;
+    bool scale;
+    bool binning;
+};
+
+// Crop of a delivered frame, in frame pixels
+struct ZoomCrop
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * Magnification of a UI zoom level
+ *
+ * @param zoomLevel 0 = 1x, 1 = 2x, 2 = 4x (anything else is treated as 1x)
+ * @return 1, 2 or 4
+ */
+int zoomLevelFactor(int zoomLevel);
+
+/**
+ * Sensor readout window for a zoom factor
+ *
+ * The window is read without binning and scaled by the ISP to the output size. The
+ * line length is kept at the full-frame value so exposure timing does not change, and
+ * the frame length shrinks with the window so the frame rate does not drop.
+ *
+ * @param geometry Sensor full-frame timing
+ * @param zoomFactor Magnification, 2 or more (1x uses the driver's own frame size mode)
+ * @param outputWidth Delivered frame width
+ * @param outputHeight Delivered frame height
+ * @param window Filled with the set_res_raw arguments
+ * @return false if the window would be smaller than the output (nothing to gain)
+ */
+bool sensorZoomWindow(const SensorGeometry &geometry, int zoomFactor, int outputWidth, int outputHeight, SensorWindow &window);
+
+/**
+ * Centered software crop of a delivered frame
+ *
+ * @param frameWidth Frame width
+ * @param frameHeight Frame height
+ * @param zoomFactor Magnification still to apply in software (1 = whole frame)
+ * @return Crop rectangle inside the frame
+ */
+ZoomCrop softwareZoomCrop(int frameWidth, int frameHeight, int zoomFactor);
+
+#endif // SENSOR_ZOOM_H
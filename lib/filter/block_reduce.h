@@ -0,0 +1,113 @@
+#ifndef BLOCK_REDUCE_H
+#define BLOCK_REDUCE_H
+
+#include <Arduino.h>
+#include "pixel_simd.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Summed-row block reduction
+//
+// Shared by the block filters (pixelate, CRT). For each row of blocks the RGB565 fields
+// of every column are summed over the block's rows into one small integer line
+// (3 x width uint16_t), so the frame is read exactly once and no full-frame buffer is
+// needed. Block sums are then divided with a reciprocal multiply, the block color is
+// written into the first row with paired 32-bit stores, and that row is copied to the
+// rest of the block row. All sums are taken before anything is written, so the frame
+// is updated in place.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Exact floor(value / count) by reciprocal multiply
+struct BlockDivisor
+{
+    int count;
+    uint32_t multiplier; // ceil(2^24 / count), 0 when count is too large for the shortcut
+
+    void set(int n)
+    {
+        count = n;
+        multiplier = (n <= 256) ? ((1u << 24) + n - 1) / n : 0;
+    }
+
+    // Exact for value < 255 * count (checked exhaustively for every count up to 256)
+    inline uint32_t divide(uint32_t value) const
+    {
+        return multiplier ? (value * multiplier) >> 24 : value / count;
+    }
+};
+
+/**
+ * Replace every blockSize x blockSize block of rows [y0, y1) with one color, in place
+ *
+ * The shader turns the summed fields of a block into its frame-order color:
+ *   uint16_t color(int blockX, int blockY, uint32_t sumR5, uint32_t sumG6, uint32_t sumB5,
+ *                  const BlockDivisor &pixels)
+ * where blockX/blockY are block indices and pixels divides by the block's pixel count.
+ *
+ * @param frameBuffer Frame in frame byte order
+ * @param width Frame width
+ * @param height Frame height (blocks on the last row may be shorter)
+ * @param y0 First row, a multiple of blockSize
+ * @param y1 One past the last row
+ * @param blockSize Block edge in pixels (up to 32, so column sums fit 16 bits)
+ * @param shader Block color callback
+ * @return false if the column line could not be allocated
+ */
+template <typename BlockShader>
+bool reduceBlocks(uint16_t *frameBuffer, int width, int height, int y0, int y1, int blockSize, BlockShader &shader)
+{
+    // A few hundred bytes per line at preview sizes, so keep it in internal RAM
+    uint16_t *columnSums = (uint16_t *)malloc(width * 3 * sizeof(uint16_t));
+    if (!columnSums)
+    {
+        return false;
+    }
+    uint16_t *columnR = columnSums;
+    uint16_t *columnG = columnSums + width;
+    uint16_t *columnB = columnSums + 2 * width;
+
+    const int edgeWidth = (width % blockSize) ? (width % blockSize) : blockSize;
+    BlockDivisor fullBlock;
+    BlockDivisor edgeBlock;
+
+    for (int by = y0; by < y1; by += blockSize)
+    {
+        const int rows = min(blockSize, height - by);
+        uint16_t *firstRow = frameBuffer + by * width;
+
+        memset(columnSums, 0, width * 3 * sizeof(uint16_t));
+        for (int y = 0; y < rows; y++)
+        {
+            accumulate565(firstRow + y * width, width, columnR, columnG, columnB);
+        }
+
+        // At most two block shapes per block row: full width and the right edge
+        fullBlock.set(blockSize * rows);
+        edgeBlock.set(edgeWidth * rows);
+
+        for (int bx = 0; bx < width; bx += blockSize)
+        {
+            const int endX = min(bx + blockSize, width);
+
+            uint32_t sumR = 0, sumG = 0, sumB = 0;
+            for (int x = bx; x < endX; x++)
+            {
+                sumR += columnR[x];
+                sumG += columnG[x];
+                sumB += columnB[x];
+            }
+
+            const BlockDivisor &pixels = (endX - bx == blockSize) ? fullBlock : edgeBlock;
+            fill565(firstRow + bx, endX - bx, shader.color(bx / blockSize, by / blockSize, sumR, sumG, sumB, pixels));
+        }
+
+        for (int y = 1; y < rows; y++)
+        {
+            memcpy(firstRow + y * width, firstRow, width * sizeof(uint16_t));
+        }
+    }
+
+    free(columnSums);
+    return true;
+}
+
+#endif // BLOCK_REDUCE_H
@@ -0,0 +1,272 @@
+#ifndef BLUE_NOISE_H
+#define BLUE_NOISE_H
+
+#include <Arduino.h>
+
+// 64x64 tileable blue-noise threshold texture (void-and-cluster, sigma 1.5).
+// Every value 0-255 appears exactly 16 times, so the texture is an unbiased
+// threshold map just like the Bayer matrices, but without their cross-hatch.
+// Index with [(y & BLUE_NOISE_MASK) * BLUE_NOISE_SIZE + (x & BLUE_NOISE_MASK)].
+const int BLUE_NOISE_SIZE = 64;
+const int BLUE_NOISE_MASK = BLUE_NOISE_SIZE - 1;
+
+const uint8_t BLUE_NOISE_64X64[BLUE_NOISE_SIZE * BLUE_NOISE_SIZE] = {
+     23, 103, 218,   7, 125,  86, 172, 153,  42, 113,  15,  95, 165, 221, 189,  12,
+     41, 207,  67, 245, 180, 119,  75,   3, 190, 153,  38, 212, 148, 246,  15, 157,
+     67, 207,  90, 117, 173,  43, 121, 141, 181,  10, 114,  42, 185,  63, 167,  47,
+     29, 221,  63, 114, 196,  77, 254,  54, 189, 165, 246, 128, 151,  80, 251, 163,
+    121, 243,  39, 141, 202,  29, 107, 205,  76, 235, 179, 253,  46, 129,  72, 244,
+    177, 117,  28,  98, 154,  34, 251, 137, 209,  79, 241,   8,  69, 189,  85, 123,
+    184,  26, 153, 220,  70, 235, 158,  20, 105, 197, 236, 155,  21, 206, 131, 229,
+    158,  91, 248, 178,  32, 107, 130,  23, 138,  95,   7,  53, 231, 105,  11, 209,
+    192,  82, 168,  62, 255, 180,  58, 226,  23, 134,  60,  85, 206,   4, 112, 157,
+     86, 224, 137, 233,  80, 197,  53, 101,  26, 122, 176, 104, 132, 218,  37, 230,
+    103, 242,  46, 134,   4,  92, 202, 246,  67,  88, 134,  58, 224, 102,   8,  75,
+    189, 136,  12, 144,  48, 212, 159, 235,  70, 221, 113, 205,  33, 186, 139,  69,
+    152,  18, 228, 116,  89,  12, 149, 126,  92, 193, 161,  32, 144, 182, 235,  23,
+     50, 194,   2, 166,  22, 128, 223, 164, 238,  44,  61, 205,  23, 165,  58, 144,
+      6, 166,  64, 198, 178, 113,  55,  29, 164, 214,   3, 177,  82, 146, 244, 120,
+     26,  57, 201,  74, 232,  94,   1, 197,  36, 178, 154,  64, 168,  90, 226,  36,
+    212,  98, 185,  45, 160, 236, 191,  46, 245,  13, 218, 104, 227,  64,  96, 213,
+    149,  71, 105, 211,  61, 179,  89,  12, 140, 187, 231, 153,  89, 252, 109, 195,
+     78, 209,  99, 255,  35, 151, 227, 138, 189,  42, 124, 251,  28, 202,  43, 167,
+    236, 102, 219, 151, 114, 186,  64, 122,  87, 239,  18, 127, 250,   4, 118,  57,
+    167, 130,   1, 215, 134,  33,  78, 112, 174, 141,  54, 123,  19, 169,  35, 128,
+    183, 255,  41, 146, 239, 112,  38, 210,  67,  96,   1, 126,  40, 183,  14, 225,
+     41, 140,  20, 125,  83, 186,  11,  78, 108, 230, 160,  62, 112, 184,  93,  65,
+    196, 127,  41,  15, 244,  28, 166, 214, 148,  52, 101, 211,  75, 194, 145, 242,
+     80,  49, 249,  68, 101, 202, 225,   7,  69, 207,  88, 250, 196, 139, 242,  81,
+     10, 116, 173,  83,   8, 200, 153, 250, 117, 168, 219,  80, 238,  64, 119, 154,
+     92, 238, 171, 220,  58, 208, 129, 243,  57,  16,  93, 216, 141,  13, 220, 154,
+      2,  82, 183, 160,  86, 136,  45, 252,  10, 190, 140,  28, 160,  44,  95,  24,
+    230, 112, 193, 146,  20, 169, 123, 150, 232,  33, 162,   1,  76,  49, 110, 208,
+     59, 218,  28, 227, 137,  56,  80,  22, 192,  51,  31, 200, 138, 174, 212,  26,
+    187,  51, 110,   0, 159, 102,  28, 168, 203, 122, 175,  32,  77, 238, 124,  38,
+    255, 140, 230,  64, 218, 190, 103,  77, 117, 226,  60, 242, 114, 222, 176, 201,
+    140,  32, 172,  83, 240,  60,  41,  92, 191, 107, 130, 186, 222, 151,  22, 189,
+    160, 140,  99, 191, 119, 243, 182, 101, 132, 236, 156, 109,  10,  48,  99, 250,
+     72, 132, 201,  77, 246,  45, 224,  88, 146,  40, 245, 193, 150,  52, 180, 102,
+    201,  54, 109,  29, 121,   4, 208, 177,  22, 163,  92, 181,  14,  62, 126,  10,
+    160,  57, 226,   7, 110, 213, 180, 251,  21,  57, 237,  37,  98, 177, 237,  86,
+     39, 247,  72,  49,  20, 158,  40, 223,   5,  85,  63, 186, 218,  82, 166, 143,
+      9, 228,  33, 180, 141, 115, 190,   7,  70, 218, 104,   3,  90, 211,  18,  73,
+    165,  22, 209, 174, 248,  52, 146,  66, 217, 131,  33, 205, 149,  94, 254,  75,
+    186,  98, 127, 204, 155,  29, 132,  75, 163, 208, 144,  71, 120,   9,  57, 132,
+    106,   3, 203, 171, 217, 108,  74, 167, 202, 147, 254,  21, 130, 234,  30, 206,
+    117, 160,  92, 236,  14,  64, 157, 253, 128, 171,  56, 134, 162, 249, 119, 143,
+    240,  93, 135,  74, 156,  94, 234,  35, 107, 248,  79,  52, 235, 173,  40, 214,
+     16, 246,  44, 176,  64,  95, 226,   4, 119,  90,  14, 194, 253, 148, 217, 199,
+    166, 232, 145,  84, 129,   9, 234,  51, 120,  34, 104, 163,  56, 111, 191,  67,
+     43, 218,  60, 125, 171,  99, 210,  48,  93,  17, 199, 225,  33,  66, 197,  45,
+    183,   5, 220,  39, 196,  13, 132, 202, 155,   7, 185, 139, 111,   0, 135, 106,
+     66, 143,  86,  21, 242, 140, 196,  53, 240, 177, 219,  50, 168,  89,  34,  73,
+     18, 118,  55,  32, 252, 187, 143,  91, 178, 208,  71, 222, 181,   2, 139, 238,
+    103, 183,  22, 198,  42, 226,  26, 139, 181, 239, 115,  78, 182, 102,  11, 229,
+    109,  65, 163, 118, 228, 106,  72, 174,  55,  95, 228,  26, 212,  82, 228, 199,
+    172, 232, 191, 120, 210,  37, 171,  85, 151,  31, 108, 135,  19, 115, 180, 242,
+     96, 191, 225, 176, 101,  64, 211,  23, 246,  11, 142,  43,  94, 248,  80, 156,
+     14, 132,  76, 249, 143,  82, 119, 204,  73,  39, 147,  23, 243, 132, 157,  81,
+    205, 130, 245,  27,  58, 186, 254,  19, 214, 118, 167,  68, 191,  50, 157,  29,
+     47, 111,   3, 161,  72, 106,  16, 128, 202,  65, 247,  79, 204, 234,  60, 131,
+    159,  27,  71, 126,  16, 163,  42, 133, 114,  83, 230, 197, 131,  37, 172,  53,
+    201, 229, 164, 105,   2, 187, 240,  14, 162, 223,  96, 167,  57, 208,  38, 174,
+     17,  47, 177,  85, 141, 160,  42, 127,  83, 241,  39, 146, 121, 236,  91, 129,
+    204,  80, 219,  52, 255, 187, 220,  46, 230,   6, 143, 175,  37, 150,   1, 215,
+     48, 249, 148, 198, 221,  81, 242, 195, 173,  54, 157, 106,  22, 209, 225, 118,
+     94,  32,  50, 214,  63, 156,  46, 106,  60, 129, 190,   3, 220, 114,  91, 253,
+    146, 231, 103, 213,   1, 224,  98, 191, 150,  14, 203,  98,  10, 174,  24, 249,
+    166,  35, 146, 123,  21, 138,  92, 164, 110, 190,  95,  56, 223, 104,  81, 196,
+    116,  88,   8, 110,  36, 151, 104,  69,  30, 239,   8, 184,  61, 146,  73,   5,
+    254, 185, 147, 120, 245,  91, 178, 228, 201,  25, 251,  86, 142,  26, 195,  59,
+    120,  74,  22, 196, 122,  70,  27, 237,  49, 181,  61, 251, 210,  72, 140,  99,
+     64, 187, 239,  88, 179,  62, 235,  13,  71, 156, 236,  24, 123, 187, 161,  38,
+    233, 177, 208,  61, 236, 186,   1, 224, 126,  93, 213, 123, 247, 100, 193, 164,
+    128,  79,  17, 203,  30, 130,   9, 141,  76, 113,  46, 175,  67, 238, 156,   6,
+    221, 188, 162,  52, 250, 173, 139, 204,  77, 115, 134, 158,  33, 189, 222,   6,
+    229, 108,  13, 210, 153,  36, 197, 121, 214,  35, 133, 202,  72, 254,  13, 136,
+     67,  24, 155, 128,  92, 139,  56, 162, 205, 146,  73,  36, 169,  18,  45, 236,
+     59, 211,  99, 172,  73, 234, 194,  37, 167, 234, 150, 206, 122,  37, 182, 133,
+     96,  33, 113, 142,  83,  35, 110,  16, 164, 218,   4,  85, 110,  48, 119, 154,
+     31, 136,  76,  48, 114, 246,  84, 172,  52, 248,  87,   5, 172,  52,  96, 204,
+    167, 105, 244,  45, 215,  27, 255, 108,  16,  47, 178, 229,  87, 208, 141, 108,
+     12, 153, 231,  46, 116, 160,  56, 103, 210,  11,  94,  21, 231, 102,  75, 248,
+     51, 209, 239,   9, 221, 183, 211,  92, 242,  40, 188, 227, 169, 244,  78, 207,
+     55, 251, 161, 185, 216,   0, 136,  23, 145, 183, 115, 225, 151, 129, 238,  42,
+    221,  78, 194,   6, 174,  71, 183,  84, 197, 244, 111,   3, 126, 161,  66, 223,
+    182,  35, 133, 187,  21, 214,  82, 250, 125,  65, 188, 137,  55, 172, 200,  20,
+    147,  72, 174, 100,  60, 155,  46, 130,  66, 151, 103,  59,  25, 131,  15, 178,
+     94, 198, 124,  26,  97,  71, 230, 194,  99,  65,  27, 195,  78,  17, 185, 118,
+     21, 142,  55, 125,  97, 147, 223,  38, 135,  63, 148, 193,  53, 252,  24,  85,
+    120, 246,  71,  93, 239, 148,   6, 140,  29, 170, 245,  78, 215,   1, 117, 226,
+    165, 126,  18, 200, 120, 248,   3, 226, 193,  22, 254, 144, 211, 184, 105, 145,
+    224,   7,  66, 241, 145, 169, 116,  44, 209, 162, 242,  43, 106, 212,  66, 155,
+     90, 251, 163, 206, 241,  15, 116, 166,  18, 212,  86,  30, 219, 103, 175, 200,
+     48, 159,   0, 199,  54, 105, 179, 201,  51, 212, 101,  36, 163, 143,  91,  62,
+     34, 194,  87, 228,  31, 140,  85, 109, 163,  78, 123,  44,  91,  65, 241,  40,
+     77, 116, 180,  36, 203,  56,  14, 253,  81,   7, 119, 142, 229, 168,  36, 234,
+    200,  10, 110,  35,  65, 189,  48, 233,  99, 175, 239, 156,  74, 135,   8, 145,
+    214, 101, 224, 168, 128,  34, 228,  89, 117, 154,   9, 124, 233,  46, 243, 180,
+    108, 255,  49, 160,  69, 188, 171,  55, 216,  12, 203, 171, 232,   3, 192, 162,
+    210, 150, 232,  89, 127, 223, 184, 153, 131, 221, 178,  57,  88,   2, 127, 101,
+     49,  73, 179, 229,  89, 141, 208,  73, 130,  52,   6, 121, 187,  40, 234,  81,
+     29,  63, 118,  19, 255,  73, 159,  14, 241,  74, 222, 181,  86, 199,  24, 136,
+    215,   9, 142, 111, 208,  13, 243,  35, 133, 237, 105,  31, 152, 109, 127,  28,
+     99,  15,  53, 166,  22,  71, 104,  32,  61,  97,  18, 207, 157, 249, 195, 172,
+    142, 216, 121, 157,   0, 107, 161,  23, 252, 195, 106, 226,  59, 210, 166, 123,
+    249, 178, 151,  87, 183, 208, 133,  59, 188,  41, 131,  21,  62, 114, 168,  77,
+     55,  96, 182, 234,  39,  94, 120, 200,  89, 150,  65, 194,  80, 223,  51, 252,
+    182, 134, 207, 111, 249, 144, 200, 238, 164, 193, 244,  40, 115,  67,  32,  81,
+     16, 245,  30,  55, 212, 242,  40, 179,  86, 146,  34, 161,  90,  19, 107,  44,
+    195,  10, 230,  55,  39, 109,  25, 216,  98, 162, 204, 252, 150, 217,   5, 240,
+    158, 204,  25,  76, 134, 223, 153,  62,   6, 185,  41, 246,  13, 173, 142,  73,
+     37, 239,  69,   2, 183,  44,  87,   8, 121,  49, 135,  84, 185, 145, 225, 205,
+    113, 188,  87, 133, 186,  70, 126, 224,  12, 216,  69, 247, 136, 202, 240, 149,
+     67, 103, 135, 200, 241, 149, 171, 247, 122,   5,  81, 105,  34, 178,  95, 126,
+     36, 113, 247, 168,  53, 181,  21, 250, 165, 226, 112, 135,  94, 212,  20, 201,
+    153, 116, 170,  95, 217, 131, 228, 176,  75, 225, 156,  20, 236,   8, 103,  45,
+    161,  62, 231, 168,  17, 101, 154,  54,  96, 123, 188,  22, 176,  53,   3,  85,
+    226, 170,  20,  95,  70,   9,  86,  37,  66, 181, 228,  56, 133, 234,  51, 211,
+    184,  63, 144,   2, 106, 206,  79, 100, 127,  29,  74, 219, 161,  59, 121,  87,
+     17,  56, 230,  29, 156,  61,  24, 107, 209,  30,  96, 199, 122,  63, 179, 255,
+    138,   4,  97,  43, 248, 201,  27, 239, 169, 206,  47, 107,  75, 124, 159, 211,
+    126,  37, 189, 220, 120, 184, 230, 132, 199, 144,  19, 160, 194,  17,  78, 149,
+     12, 224,  87, 194, 232,  35, 146, 214,  50, 176, 200,   0,  44, 185, 244, 222,
+    178, 198, 129,  82, 191, 116, 247, 151,  65, 180, 251,  47, 170, 220,  86,  23,
+    119, 223, 197, 146, 117,  79, 178, 135,  68,   5, 155, 233, 217, 184,  98,  26,
+     60, 252, 145,  52, 162,  31, 209, 100,  48, 239, 110, 212,  91, 120, 169, 251,
+    100, 132,  39, 161, 121,  62, 171,   8, 232,  93, 149, 252, 105, 143,  30, 100,
+     76,   5, 255,  43, 210,   9, 173,  44, 132,   0, 115,  76, 139,  36, 154, 210,
+     74, 164,  30,  69, 216,   8, 231,  40, 112, 252,  87, 137,  15,  41, 244, 196,
+    168, 107,  83,  12, 240,  76, 152,   3, 173,  82,  31,  62, 243,  41, 197,  67,
+     27, 203, 238,  76,  16, 254, 133, 190, 114,  59,  20, 127,  81, 207,  62, 160,
+    213, 108, 140, 167, 102,  70, 220,  91, 205, 235, 163, 213,  17, 234, 105, 187,
+     47, 243, 111, 188,  49, 128, 160,  85, 212, 183,  33, 198,  64, 145,  81, 119,
+      6, 231, 202, 134, 181, 112,  59, 253, 125, 220, 142, 185, 155,   1, 137, 218,
+    117, 155,  51, 180, 220, 102,  83,  41, 243, 159, 195, 229, 173,   9, 240, 127,
+     48, 232,  61,  25, 227, 148, 125,  19, 187,  71,  34,  99, 191, 127,  61,   6,
+    136,  91,  19, 170, 251,  98, 198,  16, 141,  58, 126, 106, 236, 173, 217,  51,
+    155,  68,  29,  96,  41, 222, 195,  94,  42, 201,  14, 115,  77, 231,  94,  53,
+    186,  10,  89, 126,  31, 149, 211,  13, 138,  88,  31,  71,  49, 108, 191,  26,
+    181, 153, 200,  88, 179,  39, 238,  56, 157, 111, 145,  53, 247,  80, 170, 238,
+    204, 155, 218,  76, 138,  33,  63, 222, 169,  22, 216, 164,   0,  97,  31, 135,
+    191, 219, 164, 249, 148,  17, 131,  27, 154,  72, 246,  50, 209, 174,  33, 162,
+    227, 107, 247, 164, 204,  54, 183,  72, 222, 174, 206, 123, 158, 216, 141,  94,
+     71,   8, 124, 247,  15, 110, 196,  93, 253,   7, 220, 173,  13, 149,  41, 114,
+     30,  63, 123,   1, 233, 186, 120, 240, 100,  80, 247,  46,  73, 204, 253, 107,
+     18,  88, 123,  57, 199,  84, 171, 233, 189, 100, 166, 134,  18, 104, 254, 130,
+     77,  28, 194,  69,   2, 110, 248, 124,  47, 104,   3, 249,  79,  15,  44, 244,
+    207, 100,  41, 159,  65, 215, 142,  24, 182, 128,  85, 202, 122, 224, 197,  93,
+    176, 231, 201,  48, 156,  90,  13, 152,  42, 188, 112, 154, 128, 179,  58, 152,
+    229,  43, 180,   2, 114, 226,  48, 108,  59,   4, 225,  84, 192, 148,  66,   5,
+    206, 147,  45, 136, 233,  82, 160,  22, 150, 234,  58, 138, 185, 225, 165, 122,
+    148, 237, 177, 221, 135,  84,  49, 167,  70, 229,  29,  60,  98,  25,  70, 252,
+      9, 143,  82, 109, 174, 215,  53, 205, 131,   7, 201,  25, 239,  92,  10, 197,
+     77, 141, 240, 213,  74, 157,  13, 242, 141, 211, 122,  27, 236,  47, 218, 177,
+    113, 242, 184,  95, 208, 175,  40, 221,  90, 192, 169,  25, 111,  92,  60,  22,
+     83,  29,  57, 113,   3, 187, 235, 112, 204,  44, 140, 246, 163, 187, 137, 118,
+     54, 164,  36, 247,  23,  71, 115, 255,  75, 172, 232,  66, 145,  38, 226, 111,
+    171,  22,  98, 129,  32, 193, 124, 175,  80,  38, 182,  68, 162,  97, 127,  37,
+     87,  57,  11, 122,  25,  62, 133, 200,  14, 119,  75, 214,  39, 199, 253, 175,
+    230, 137, 193,  90, 251,  36, 153,  10,  95, 158, 184, 110,   1, 234,  37, 196,
+    215, 100, 188, 132, 222, 144, 182,  18, 159,  92,  47, 106, 208, 168, 125,  51,
+    249,  63, 205, 165,  50, 255,  94,  22, 200, 152, 250, 111, 210,  12, 245, 202,
+    151, 217, 169, 228, 152, 240, 106,  72, 252,  43, 146, 241, 127, 154,  11, 116,
+     67, 211,  19, 169, 206,  68, 125, 213, 244,  19,  71, 207,  89,  58, 156,  79,
+     18, 237,  68,   6,  91,  42, 234, 101,  36, 216, 139, 187,   4,  73, 216,  26,
+    190, 150,  11,  80, 220, 142,  65, 214,  50,  98,   7,  54, 144,  81, 168,  21,
+     71, 105,  32,  83,  49, 190,   7, 179, 157, 217, 101,   5,  64,  85, 186,  42,
+    101, 155, 120,  49, 142, 102, 184,  47,  80, 121, 227,  33, 130, 179, 113, 227,
+    139, 172, 118, 199, 158, 207,  61, 129, 195, 239,  21, 121, 248,  97, 158, 137,
+     83, 109, 236, 182, 102,   4, 161, 116, 238, 136, 170, 224, 194,  36, 117, 190,
+    132, 253, 195, 118, 214, 142,  94, 124,  28,  58, 191, 170, 205, 238, 139, 222,
+      0, 245,  79, 232,  12, 219,  24, 140, 163, 196,  53, 149, 254, 213,  10,  48,
+     96,  33,  56, 244,  28, 109, 177,   3, 153,  65,  84, 170,  55, 198,  16, 241,
+     43, 217,  30, 127,  45, 192, 229,  28, 181,  77,  21, 122,  92, 241,  62, 226,
+     46,   0, 161,  65,  18, 248,  44, 203, 228, 138,  84,  35, 111,  51,  24, 167,
+     60, 184,  34, 197, 165,  75, 246,  95, 233,   4, 174,  99,  21,  66, 166, 203,
+    248, 184, 146,  84, 131, 215,  76, 249,  41, 116, 211, 145,  34, 227,  66, 118,
+    177, 147,  68, 166, 246,  72, 135,  91,  45, 201, 246,  66, 179,   8, 156,  99,
+    177,  85, 233, 135, 182,  86, 160,  68, 112,  15, 244, 156, 217, 131,  90, 203,
+    149,  87, 133, 105,  52, 118, 191,  38,  64, 114, 221,  74, 192, 108, 144,  83,
+    122,   2, 224, 193,  17,  50, 164, 100, 188, 227,  11, 181, 101, 135, 189,  89,
+      1, 204,  97,  18, 209, 107,  14, 214, 158, 105, 143,  38, 207, 136, 215,  20,
+    143, 203,  51, 102,  35, 207,   4, 236, 171, 197, 102,  62,   8, 175, 250, 119,
+    233,  15, 208, 255, 152,   6, 169, 132, 204, 155,  33, 138, 232,  43, 240,  23,
+     61, 162, 103,  67, 238, 143, 229,  14, 133,  88,  49, 254,  73,  19, 163, 233,
+     56, 252, 132, 185,  52, 151, 178, 239,  60,   1, 222, 165,  96,  50,  77, 240,
+    114,  27, 221, 157, 243, 116, 147,  95,  50,  26, 145, 225, 192,  75,  45,  27,
+    190, 159,  63,  27,  91, 236, 211,  80,  16, 250,  87, 182,   7, 119, 199, 173,
+    219, 130,  42, 171,  93, 119,  37, 201,  68, 174, 155, 113, 193, 222,  37, 124,
+    152,  80,  34, 113, 242,  82,  40, 117, 194, 131,  74,  26, 254, 125, 170,  38,
+    188,  70, 124,  11,  78,  58, 188, 213, 127, 252,  84,  36, 122, 162, 212, 106,
+     77, 123, 222, 178, 129,  67,  32, 110, 184,  51, 126, 215,  58, 154,  73,  96,
+     32, 188, 250,  13, 209, 184,  78, 151, 217,  27, 238,   5, 143,  54, 108, 207,
+     11, 193, 224, 163,   5, 216, 144,  19,  89, 243, 174, 111, 190,  12, 230, 103,
+    149, 246, 170, 194, 217, 133,  39,  17,  75, 158, 183, 107, 243,  20, 142,  53,
+    240,   4,  98,  45, 195, 158, 221, 139, 235, 161,  24, 102, 170, 245,  16, 230,
+    148,  65, 112, 152,  57,  25, 245, 109,  48, 128,  97, 202,  79, 174, 245,  93,
+    169,  52, 138,  68,  92, 186,  55, 229, 157,  39, 210,  55, 148,  79, 199,  61,
+      6,  90,  52,  32,  99, 166, 235, 176, 222,  54,   5, 207,  58,  92, 220, 171,
+     38, 205, 150, 244,  17, 103,  55,   8,  94,  70, 227, 198,  82,  39, 136, 109,
+    208,   5, 233,  83, 221, 130, 167,   0, 231, 186,  59, 223,  34, 137,  17,  66,
+    217, 106,  20, 236, 205, 130, 104, 173,  68, 125,   7,  93, 226,  32, 135, 165,
+    207, 232, 139, 117, 255,   2,  83, 112, 138,  95, 231, 147, 125, 195,  13, 133,
+     85, 176,  59, 118,  74, 206, 252, 166, 191,  40, 144,   0, 118, 223, 181,  51,
+     86, 193, 125,  40, 179,  97,  64, 206,  90, 145,  13, 160, 101, 237, 196, 125,
+     31, 248, 158, 117,  42,  14, 253,  30, 219, 198, 153, 247, 176, 120, 218,  46,
+    111,  26, 179, 199,  68, 152,  46, 206,  23, 192,  43, 168,  29,  71, 253, 111,
+    227, 137,  28, 230, 183, 132,  34, 113, 216, 129, 248, 177,  63, 150,  21, 255,
+    167,  25, 154, 204,  15, 251, 157,  31, 176,  73, 249, 120, 180,  49,  88, 153,
+    183,  81, 198,  60, 177, 152,  77, 139,  97,  19, 113,  43,  70,  18,  96, 251,
+     77, 157,  58,  19, 222,  93, 239, 161,  66, 250, 115,  83, 235, 179, 150,  55,
+      9, 188,  97, 156,   2,  87, 149,  63,  12,  83, 104,  46, 202,  89, 212, 129,
+     69, 101, 240,  74, 110,  47, 137, 234, 117,  44, 198,  20,  68, 218,   9, 233,
+     45, 134,   8, 232,  90, 216, 195,  49, 176, 235,  81, 190, 211, 145, 172,   1,
+    192, 129, 214, 105, 168, 136,  31, 122, 185,  16, 143, 218,   1, 103,  35, 213,
+    124, 247,  68, 217,  52, 241, 171, 203, 237, 184,  28, 165, 242,  11, 107,  42,
+    223, 189,  54, 144, 220, 194,  84,  11, 217,  98, 136, 233, 148, 104, 167, 117,
+     72, 215, 100, 145,  34, 116,   0, 242, 124,  60, 161, 129,  30, 242,  53, 115,
+    232,  32,  84, 245,  10, 192,  59, 229, 102,  76, 175,  57, 130, 193, 161,  82,
+     27, 166,  38, 117, 197, 102,  24,  79,  47, 140, 225, 119,  72, 137, 192, 162,
+      3, 136,  31, 176,   7, 124, 169,  67, 149, 182,  32,  84, 206,  42, 190,  26,
+    254, 175,  25, 193, 245,  69, 165,  86,  28, 210,   6, 226, 104,  78, 198, 159,
+     64, 147, 181,  46, 119,  75, 213,   5, 147, 241,  31, 210,  91, 249,  63, 202,
+    235,  90, 140, 178,  16, 143, 215, 122, 159,  97,  16, 210, 154,  53, 237,  81,
+    114, 249,  89, 228, 100,  38, 237, 205,  25, 253,  59, 165,   5, 126, 228,  93,
+    140,  62, 112, 158,  49, 129, 189, 227, 151, 180,  92,  50, 185, 137,  10, 225,
+     95,  20, 237, 139, 206, 154,  97, 172,  50, 196, 112, 158,  45,  12, 141, 107,
+    185,   6, 225,  78, 254,  58, 175,  36, 247, 192,  61,  91,  35, 200,  20, 175,
+     58, 203, 163,  69, 197, 152,  54, 108,  87, 128, 213, 111, 237,  65, 153,  50,
+    200,   4, 210,  84, 223,  11,  99,  41,  65, 115, 255, 147,  23, 238, 112,  41,
+    175, 212, 109,  67,  25, 253,  39, 224, 131,  86,  15, 232, 123, 180, 219,  48,
+     72, 114, 203,  44, 129,  96, 231,  73,  10, 113, 230, 164, 252, 103, 126, 225,
+    146,  14,  43, 118,  17, 248, 134, 189,   2, 154,  43, 195,  90, 176,  15, 221,
+    167, 128, 240,  33, 181, 138, 249, 203, 141,  15, 199,  74, 166,  61, 205, 149,
+     74, 128,   3, 199,  88, 176, 114,  20,  69, 246, 170,  61, 204,  97,  25, 159,
+    243, 148,  21, 164, 193,   4, 155, 202, 137, 178,  45, 131,   4, 183,  72,  29,
+     97, 216, 134, 231, 168,  79,  30, 220, 171, 243,  76,  19, 136, 245, 115,  77,
+     38, 100,  66, 150, 109,  53,  79,  26, 104, 224,  40, 121, 216,  99,  28, 190,
+    251,  51, 165, 234, 150,  56, 194, 139, 208, 152, 104,  34, 144,  75, 227, 127,
+     35, 212,  98,  54, 227, 115,  39,  88, 224,  28,  80, 213,  63, 151, 207, 241,
+    170,  82, 188,  57,  98, 209, 121,  70,  48, 102, 186, 223,  37,  56, 187, 141,
+    251, 198, 173,  24, 219, 192, 165, 231, 152, 175,  85, 186,  11, 244, 134,  88,
+     14, 218, 100,  35, 121,   9, 241,  81,  43,   2, 219, 189, 253,   9, 172,  57,
+    187,  70, 250, 137,  81, 173, 241,  57, 109, 157, 191,  99, 237,  40, 110,  51,
+    124,   1, 254,  33, 182,   8, 159, 235, 143,  11, 120, 151, 169, 104, 209,  27,
+     91,   9, 121, 237,  88,   2, 116,  44,  69,   7, 241, 138,  47, 159,  67, 180,
+    116, 142, 192,  76, 180, 215, 101, 158, 185, 124,  89,  52, 130,  85, 201, 108,
+      2, 123, 167,  16, 214,  27, 147, 200,  19, 250, 123,  10, 172, 134,  17, 164,
+    196,  69, 155, 113, 138, 243,  39,  86, 197, 215,  60,  82, 235,   0,  70, 162,
+    227, 147,  45, 206,  59, 142, 244, 196, 126, 209, 100,  60, 229, 109, 213,  37,
+    237,  56,  23, 247, 133,  68,  30, 228,  61, 243, 175,  24, 159, 235,  30, 152,
+    237, 205,  42, 108, 189,  69, 128,  94, 177,  70,  50, 228,  76, 199, 248,  84,
+    230,  24, 221,  88, 198,  62, 107, 174,  23, 130, 254,  25, 195, 133, 219, 110,
+     54, 190,  79, 162, 106, 182,  18,  93, 163,  31, 147, 173,  24, 192,   0, 147,
+     79, 169, 209,  96,  46, 148, 201, 118,  12, 144, 106, 223,  64, 115, 213,  89,
+     59, 179,  78, 156, 233,  47, 245,   0, 219, 138, 203, 149,  29, 108,  55, 150,
+    103, 134, 170,  47,  13, 214, 148, 231,  56,  95, 172, 115,  50,  93, 177,  34,
+    239, 131,  12, 250,  30, 211,  75, 225,  54, 253,  78, 219, 125,  87, 250, 105,
+    198, 125,   6, 156, 229,  15, 170,  90, 215,  38,  74, 196,  17, 181,  44, 135
+};
+
+#endif // BLUE_NOISE_H
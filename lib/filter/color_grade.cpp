@@ -0,0 +1,359 @@
+#include "color_grade.h"
+#include "parallel.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ColorGradeBandContext
+{
+    uint16_t *frameBuffer;
+    int width;
+    const uint16_t *table;
+};
+
+static RowBandFilter colorGradeBands = {"ColorGrade", true, 0, {}, nullptr};
+
+// Keyword at the start of line, followed by whitespace or the end; returns the rest
+static const char *matchKeyword(const char *line, const char *keyword)
+{
+    size_t length = strlen(keyword);
+    if (strncmp(line, keyword, length) != 0 || (line[length] && !isspace((unsigned char)line[length])))
+    {
+        return nullptr;
+    }
+    return line + length;
+}
+
+// Parse count finite floats; returns the rest of the text, nullptr if any is missing
+static const char *parseFloats(const char *text, float *values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        char *end;
+        values[i] = strtof(text, &end);
+        if (end == text || !isfinite(values[i]))
+        {
+            return nullptr;
+        }
+        text = end;
+    }
+    return text;
+}
+
+static bool isBlank(const char *text)
+{
+    while (isspace((unsigned char)*text))
+    {
+        text++;
+    }
+    return !*text;
+}
+
+void cubeLutBegin(CubeLut &cube)
+{
+    cube.size = 0;
+    for (int c = 0; c < 3; c++)
+    {
+        cube.domainMin[c] = 0.0f;
+        cube.domainMax[c] = 1.0f;
+    }
+    cube.lattice = nullptr;
+    cube.points = 0;
+    cube.line = 0;
+    cube.error = nullptr;
+}
+
+bool cubeLutParseLine(CubeLut &cube, const char *line)
+{
+    if (cube.error)
+    {
+        return false;
+    }
+    cube.line++;
+
+    while (isspace((unsigned char)*line))
+    {
+        line++;
+    }
+    if (!*line || *line == '#')
+    {
+        return true;
+    }
+
+    const char *rest;
+    if (isdigit((unsigned char)*line) || *line == '-' || *line == '+' || *line == '.')
+    {
+        float rgb[3];
+        if (!cube.lattice)
+        {
+            cube.error = "data before LUT_3D_SIZE";
+        }
+        else if (cube.points >= cube.size * cube.size * cube.size)
+        {
+            cube.error = "more points than LUT_3D_SIZE";
+        }
+        else if (!(rest = parseFloats(line, rgb, 3)) || !isBlank(rest))
+        {
+            cube.error = "bad data line";
+        }
+        else
+        {
+            uint16_t *point = cube.lattice + cube.points * 3;
+            for (int c = 0; c < 3; c++)
+            {
+                // Grades meant for HDR can leave 0-1; the frame cannot show it anyway
+                point[c] = (uint16_t)(constrain(rgb[c], 0.0f, 1.0f) * 65535.0f + 0.5f);
+            }
+            cube.points++;
+        }
+    }
+    else if ((rest = matchKeyword(line, "LUT_3D_SIZE")) != nullptr)
+    {
+        int size = atoi(rest);
+        if (cube.lattice)
+        {
+            cube.error = "LUT_3D_SIZE given twice";
+        }
+        else if (size < 2 || size > CUBE_LUT_MAX_SIZE)
+        {
+            cube.error = "LUT_3D_SIZE out of range";
+        }
+        else
+        {
+            cube.lattice = (uint16_t *)ps_malloc((size_t)size * size * size * 3 * sizeof(uint16_t));
+            if (!cube.lattice)
+            {
+                cube.error = "out of memory";
+            }
+            cube.size = size;
+        }
+    }
+    else if ((rest = matchKeyword(line, "DOMAIN_MIN")) != nullptr)
+    {
+        if (!parseFloats(rest, cube.domainMin, 3))
+        {
+            cube.error = "bad DOMAIN_MIN";
+        }
+    }
+    else if ((rest = matchKeyword(line, "DOMAIN_MAX")) != nullptr)
+    {
+        if (!parseFloats(rest, cube.domainMax, 3))
+        {
+            cube.error = "bad DOMAIN_MAX";
+        }
+    }
+    else if ((rest = matchKeyword(line, "LUT_3D_INPUT_RANGE")) != nullptr)
+    {
+        // Resolve's form of the domain, one range for all channels
+        float range[2];
+        if (!parseFloats(rest, range, 2))
+        {
+            cube.error = "bad LUT_3D_INPUT_RANGE";
+        }
+        for (int c = 0; c < 3 && !cube.error; c++)
+        {
+            cube.domainMin[c] = range[0];
+            cube.domainMax[c] = range[1];
+        }
+    }
+    else if (matchKeyword(line, "LUT_1D_SIZE"))
+    {
+        cube.error = "1D LUTs are not supported";
+    }
+    else if (!isalpha((unsigned char)*line))
+    {
+        cube.error = "unrecognized line";
+    }
+    // TITLE and vendor keywords carry nothing the grade needs
+
+    return cube.error == nullptr;
+}
+
+bool cubeLutFinish(CubeLut &cube)
+{
+    if (cube.error)
+    {
+        return false;
+    }
+    if (!cube.lattice)
+    {
+        cube.error = "no LUT_3D_SIZE";
+    }
+    else if (cube.points != cube.size * cube.size * cube.size)
+    {
+        cube.error = "fewer points than LUT_3D_SIZE";
+    }
+    for (int c = 0; c < 3 && !cube.error; c++)
+    {
+        if (cube.domainMax[c] <= cube.domainMin[c])
+        {
+            cube.error = "empty domain";
+        }
+    }
+    return cube.error == nullptr;
+}
+
+void cubeLutRelease(CubeLut &cube)
+{
+    free(cube.lattice);
+    cube.lattice = nullptr;
+}
+
+// Lattice coordinate of channel value v (0-1) on one axis, split into cell and fraction
+static inline void latticeCoordinate(const CubeLut &cube, int channel, float v, int &cell, float &fraction)
+{
+    float t = (v - cube.domainMin[channel]) / (cube.domainMax[channel] - cube.domainMin[channel]);
+    float position = constrain(t, 0.0f, 1.0f) * (cube.size - 1);
+    cell = min((int)position, cube.size - 2);
+    fraction = position - cell;
+}
+
+bool colorGradeCompile(const CubeLut &cube, uint16_t *table)
+{
+    if (!cube.lattice || cube.points != cube.size * cube.size * cube.size || !table)
+    {
+        return false;
+    }
+
+    const int n = cube.size;
+    // Steps between neighbouring lattice points along red, green and blue
+    const int stepR = 3;
+    const int stepG = 3 * n;
+    const int stepB = 3 * n * n;
+
+    for (uint32_t index = 0; index < COLOR_GRADE_TABLE_ENTRIES; index++)
+    {
+        uint16_t pixel = (uint16_t)((index << 8) | (index >> 8));
+        int r5 = (pixel >> 11) & 0x1F;
+        int g6 = (pixel >> 5) & 0x3F;
+        int b5 = pixel & 0x1F;
+
+        // Full scale, so white reaches the top of the domain
+        int ri, gi, bi;
+        float dr, dg, db;
+        latticeCoordinate(cube, 0, r5 / 31.0f, ri, dr);
+        latticeCoordinate(cube, 1, g6 / 63.0f, gi, dg);
+        latticeCoordinate(cube, 2, b5 / 31.0f, bi, db);
+
+        // The cell splits into six tetrahedra along its diagonal; the order of the
+        // fractions picks the one holding the color and the path from c000 to c111
+        const uint16_t *c000 = cube.lattice + ri * stepR + gi * stepG + bi * stepB;
+        const uint16_t *c111 = c000 + stepR + stepG + stepB;
+        const uint16_t *first;
+        const uint16_t *second;
+        float w0, w1, w2, w3;
+        if (dr > dg)
+        {
+            if (dg > db)
+            {
+                first = c000 + stepR;
+                second = first + stepG;
+                w0 = 1.0f - dr;
+                w1 = dr - dg;
+                w2 = dg - db;
+                w3 = db;
+            }
+            else if (dr > db)
+            {
+                first = c000 + stepR;
+                second = first + stepB;
+                w0 = 1.0f - dr;
+                w1 = dr - db;
+                w2 = db - dg;
+                w3 = dg;
+            }
+            else
+            {
+                first = c000 + stepB;
+                second = first + stepR;
+                w0 = 1.0f - db;
+                w1 = db - dr;
+                w2 = dr - dg;
+                w3 = dg;
+            }
+        }
+        else
+        {
+            if (db > dg)
+            {
+                first = c000 + stepB;
+                second = first + stepG;
+                w0 = 1.0f - db;
+                w1 = db - dg;
+                w2 = dg - dr;
+                w3 = dr;
+            }
+            else if (db > dr)
+            {
+                first = c000 + stepG;
+                second = first + stepB;
+                w0 = 1.0f - dg;
+                w1 = dg - db;
+                w2 = db - dr;
+                w3 = dr;
+            }
+            else
+            {
+                first = c000 + stepG;
+                second = first + stepR;
+                w0 = 1.0f - dg;
+                w1 = dg - dr;
+                w2 = dr - db;
+                w3 = db;
+            }
+        }
+
+        int out[3];
+        for (int c = 0; c < 3; c++)
+        {
+            float v = w0 * c000[c] + w1 * first[c] + w2 * second[c] + w3 * c111[c];
+            out[c] = (int)(v + 0.5f);
+        }
+        int outR = (out[0] * 31 + 32767) / 65535;
+        int outG = (out[1] * 63 + 32767) / 65535;
+        int outB = (out[2] * 31 + 32767) / 65535;
+        uint16_t graded = (uint16_t)((outR << 11) | (outG << 5) | outB);
+        table[index] = (uint16_t)((graded << 8) | (graded >> 8));
+    }
+    return true;
+}
+
+void applyColorGradeRun(uint16_t *pixels, size_t count, const uint16_t *table)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint16_t p0 = pixels[i];
+        uint16_t p1 = pixels[i + 1];
+        uint16_t p2 = pixels[i + 2];
+        uint16_t p3 = pixels[i + 3];
+        pixels[i] = table[p0];
+        pixels[i + 1] = table[p1];
+        pixels[i + 2] = table[p2];
+        pixels[i + 3] = table[p3];
+    }
+    for (; i < count; i++)
+    {
+        pixels[i] = table[pixels[i]];
+    }
+}
+
+// Run one row band through the grading table in place
+static void colorGradeBand(const RowBand &band, void *ctx)
+{
+    const ColorGradeBandContext &c = *(const ColorGradeBandContext *)ctx;
+
+    applyColorGradeRun(c.frameBuffer + band.y0 * c.width, (size_t)(band.y1 - band.y0) * c.width, c.table);
+}
+
+void applyColorGrade(camera_fb_t *cameraFb, const uint16_t *table)
+{
+    if (!cameraFb || !table)
+    {
+        return;
+    }
+
+    ColorGradeBandContext ctx = {(uint16_t *)cameraFb->buf, (int)cameraFb->width, table};
+    parallelForRows(colorGradeBands, cameraFb->height, 1, colorGradeBand, &ctx);
+}
@@ -0,0 +1,81 @@
+#ifndef COLOR_GRADE_H
+#define COLOR_GRADE_H
+
+#include <Arduino.h>
+#include <esp_camera.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// 3D color grading
+//
+// Adobe .cube 3D LUTs are parsed a line at a time into a lattice of size^3 colors, then
+// compiled into a table with one entry per RGB565 value. Entries are found by tetrahedral
+// interpolation between the four lattice points around the color, and both the index
+// and the entry are in frame byte order, so grading a frame is one lookup per pixel.
+// RGB565 is itself a 32x64x32 lattice, so the table loses nothing the frame could show.
+//
+// The table is 128 KB. Compiling it is slow next to reading it back, so callers keep
+// compiled tables (COLOR_GRADE_CACHE_MAGIC header, then the table) next to the .cube.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const int CUBE_LUT_MAX_SIZE = 65;                 // Largest LUT_3D_SIZE accepted (1.6 MB lattice)
+const size_t COLOR_GRADE_TABLE_ENTRIES = 65536;   // One per RGB565 value
+const uint32_t COLOR_GRADE_CACHE_MAGIC = 0x35363547; // "G565"
+const uint16_t COLOR_GRADE_CACHE_VERSION = 1;
+
+// A .cube file being parsed
+struct CubeLut
+{
+    int size;            // Lattice points per axis, 0 until LUT_3D_SIZE is read
+    float domainMin[3];  // Input range mapped onto the lattice (DOMAIN_MIN / DOMAIN_MAX)
+    float domainMax[3];
+    uint16_t *lattice;   // size^3 RGB triples scaled to 0-65535, red varying fastest
+    int points;          // Triples read so far
+    int line;            // Lines parsed
+    const char *error;   // First problem found, nullptr while the file is valid
+};
+
+// Written in front of a compiled table; the source fields tell a stale cache apart
+struct ColorGradeCacheHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t cubeSize;
+    uint32_t sourceBytes; // Size of the .cube the table was compiled from
+    uint32_t sourceTime;  // Its modification time
+};
+
+void cubeLutBegin(CubeLut &cube);
+
+/**
+ * Parse one line of a .cube file
+ *
+ * Comments, TITLE and unknown keywords are skipped. LUT_3D_SIZE allocates the lattice
+ * (PSRAM); 1D LUTs, numbers that are not finite, data lines without exactly three
+ * values and lines that are neither data nor a keyword are rejected.
+ *
+ * @param cube Parser state from cubeLutBegin
+ * @param line Line without its terminator
+ * @return false once the file is known to be invalid (cube.error says why)
+ */
+bool cubeLutParseLine(CubeLut &cube, const char *line);
+
+// Check that every lattice point was read; false with cube.error set if not
+bool cubeLutFinish(CubeLut &cube);
+void cubeLutRelease(CubeLut &cube);
+
+/**
+ * Compile a parsed cube into a grading table
+ *
+ * @param cube Cube that passed cubeLutFinish
+ * @param table COLOR_GRADE_TABLE_ENTRIES entries, indexed and filled in frame byte order
+ * @return false if the cube is incomplete
+ */
+bool colorGradeCompile(const CubeLut &cube, uint16_t *table);
+
+// Grade a frame in place (rows split across both cores)
+void applyColorGrade(camera_fb_t *cameraFb, const uint16_t *table);
+
+// Grade count frame-order pixels in place on the calling core
+void applyColorGradeRun(uint16_t *pixels, size_t count, const uint16_t *table);
+
+#endif // COLOR_GRADE_H
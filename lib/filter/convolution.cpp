@@ -0,0 +1,321 @@
+#include "convolution.h"
+#include "parallel.h"
+#include <limits.h>
+#include <stdint.h>
+
+// Non-zero weight of a non-separable kernel, at column dx / row dy of the window
+struct ConvolutionTap
+{
+    int dx;
+    int dy;
+    int weight;
+};
+
+struct ConvolutionContext
+{
+    const uint16_t *source;
+    uint16_t *output;
+    int width;
+    int height;
+    const ConvolutionKernel *kernel;
+    ConvolutionOptions options;
+    ConvolutionTap taps[CONVOLUTION_MAX_SIZE * CONVOLUTION_MAX_SIZE];
+    int tapCount;
+    int32_t multiplier; // 2^16 / divisor, rounded
+};
+
+static RowBandFilter convolutionBands = {"Convolve", true, CONVOLUTION_HALO, {}, nullptr};
+
+static inline int borderIndex(int i, int length, ConvolutionBorder border)
+{
+    if (i < 0)
+    {
+        i = (border == CONVOLVE_BORDER_MIRROR) ? -i : 0;
+    }
+    else if (i >= length)
+    {
+        i = (border == CONVOLVE_BORDER_MIRROR) ? 2 * (length - 1) - i : length - 1;
+    }
+    // Mirroring past the far edge of a frame narrower than the kernel
+    return constrain(i, 0, length - 1);
+}
+
+static inline void unpack(uint16_t pixel, int &r, int &g, int &b)
+{
+    pixel = (pixel << 8) | (pixel >> 8);
+    r = ((pixel >> 11) & 0x1F) << 3;
+    g = ((pixel >> 5) & 0x3F) << 2;
+    b = (pixel & 0x1F) << 3;
+}
+
+static inline int luma(int r, int g, int b)
+{
+    // Same weights as edge detection
+    return (r * 30 + g * 59 + b * 11) / 100;
+}
+
+/**
+ * Unpack source row sy into planes of stride values, radius padding values on each side
+ */
+static void unpackRow(const ConvolutionContext &c, int sy, int16_t *line, int stride, int planes, int radius)
+{
+    const uint16_t *src = c.source + sy * c.width;
+    const int width = c.width;
+
+    if (planes == 1)
+    {
+        int16_t *l = line + radius;
+        for (int x = 0; x < width; x++)
+        {
+            int r, g, b;
+            unpack(src[x], r, g, b);
+            l[x] = luma(r, g, b);
+        }
+    }
+    else
+    {
+        int16_t *lr = line + radius;
+        int16_t *lg = lr + stride;
+        int16_t *lb = lg + stride;
+        for (int x = 0; x < width; x++)
+        {
+            int r, g, b;
+            unpack(src[x], r, g, b);
+            lr[x] = r;
+            lg[x] = g;
+            lb[x] = b;
+        }
+    }
+
+    for (int p = 0; p < planes; p++)
+    {
+        int16_t *plane = line + p * stride + radius;
+        for (int i = 1; i <= radius; i++)
+        {
+            plane[-i] = plane[borderIndex(-i, width, c.options.border)];
+            plane[width - 1 + i] = plane[borderIndex(width - 1 + i, width, c.options.border)];
+        }
+    }
+}
+
+static inline int postProcess(const ConvolutionOptions &options, int value, int source)
+{
+    switch (options.postOp)
+    {
+    case CONVOLVE_POST_THRESHOLD:
+        return value >= options.postParam ? 255 : 0;
+    case CONVOLVE_POST_INVERT:
+        return 255 - value;
+    case CONVOLVE_POST_ADD_SOURCE:
+        return source + (((value - source) * options.postParam) >> 4);
+    default:
+        return value;
+    }
+}
+
+static void convolutionBand(const RowBand &band, void *ctx)
+{
+    const ConvolutionContext &c = *(const ConvolutionContext *)ctx;
+    const ConvolutionKernel &k = *c.kernel;
+    const int width = c.width;
+    const int size = k.size;
+    const int radius = size / 2;
+    const int planes = (c.options.channels == CONVOLVE_LUMA) ? 1 : 3;
+    const int stride = width + 2 * radius;
+    const int lineValues = planes * stride;
+
+    // size cached lines, plus one unpacked row that separable kernels filter from.
+    // A few KB at preview sizes, so keep it in internal RAM
+    int16_t *cache = (int16_t *)malloc((size + 1) * lineValues * sizeof(int16_t));
+    if (!cache)
+    {
+        // Leave the band unfiltered rather than garbage
+        memcpy(c.output + band.y0 * width, c.source + band.y0 * width, (band.y1 - band.y0) * width * sizeof(uint16_t));
+        return;
+    }
+    int16_t *unpacked = cache + size * lineValues;
+    int slotRow[CONVOLUTION_MAX_SIZE];
+    for (int i = 0; i < size; i++)
+    {
+        slotRow[i] = INT_MIN;
+    }
+    const int16_t *rows[CONVOLUTION_MAX_SIZE];
+
+    for (int y = band.y0; y < band.y1; y++)
+    {
+        // Slide the window: only the row entering at the bottom is normally missing
+        for (int i = 0; i < size; i++)
+        {
+            int v = y - radius + i;
+            int slot = ((v % size) + size) % size;
+            int16_t *line = cache + slot * lineValues;
+            if (slotRow[slot] != v)
+            {
+                int sy = borderIndex(v, c.height, c.options.border);
+                if (k.separable)
+                {
+                    unpackRow(c, sy, unpacked, stride, planes, radius);
+                    for (int p = 0; p < planes; p++)
+                    {
+                        const int16_t *in = unpacked + p * stride;
+                        int16_t *out = line + p * stride;
+                        for (int x = 0; x < width; x++)
+                        {
+                            int sum = 0;
+                            for (int t = 0; t < size; t++)
+                            {
+                                sum += k.row[t] * in[x + t];
+                            }
+                            out[x] = sum;
+                        }
+                    }
+                }
+                else
+                {
+                    unpackRow(c, sy, line, stride, planes, radius);
+                }
+                slotRow[slot] = v;
+            }
+            rows[i] = line;
+        }
+
+        const uint16_t *srcRow = c.source + y * width;
+        uint16_t *dstRow = c.output + y * width;
+        for (int x = 0; x < width; x++)
+        {
+            int value[3];
+            for (int p = 0; p < planes; p++)
+            {
+                const int offset = p * stride + x;
+                int32_t sum = 0;
+                if (k.separable)
+                {
+                    for (int t = 0; t < size; t++)
+                    {
+                        sum += k.column[t] * rows[t][offset];
+                    }
+                }
+                else
+                {
+                    for (int t = 0; t < c.tapCount; t++)
+                    {
+                        const ConvolutionTap &tap = c.taps[t];
+                        sum += tap.weight * rows[tap.dy][offset + tap.dx];
+                    }
+                }
+                value[p] = ((sum * c.multiplier + 0x8000) >> 16) + k.bias;
+            }
+
+            int r, g, b;
+            if (c.options.postOp == CONVOLVE_POST_ADD_SOURCE)
+            {
+                unpack(srcRow[x], r, g, b);
+            }
+            else
+            {
+                r = g = b = 0;
+            }
+            if (planes == 1)
+            {
+                int gray = constrain(postProcess(c.options, value[0], luma(r, g, b)), 0, 255);
+                r = g = b = gray;
+            }
+            else
+            {
+                r = constrain(postProcess(c.options, value[0], r), 0, 255);
+                g = constrain(postProcess(c.options, value[1], g), 0, 255);
+                b = constrain(postProcess(c.options, value[2], b), 0, 255);
+            }
+
+            uint16_t pixel = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+            dstRow[x] = (pixel << 8) | (pixel >> 8);
+        }
+    }
+
+    free(cache);
+}
+
+static int absoluteSum(const int8_t *taps, int count)
+{
+    int sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sum += abs(taps[i]);
+    }
+    return sum;
+}
+
+// A row sum of 8-bit values must fit the int16 row cache, and the largest window sum
+// times the 16-bit reciprocal must fit an int32
+static bool kernelInRange(const ConvolutionKernel &kernel, int32_t multiplier)
+{
+    int gain;
+    if (kernel.separable)
+    {
+        int rowGain = absoluteSum(kernel.row, kernel.size);
+        if (rowGain > CONVOLUTION_MAX_ROW_GAIN)
+        {
+            return false;
+        }
+        gain = rowGain * absoluteSum(kernel.column, kernel.size);
+    }
+    else
+    {
+        gain = absoluteSum(kernel.weights, kernel.size * kernel.size);
+    }
+    return (int64_t)gain * 255 * abs(multiplier) + 0x8000 <= INT32_MAX;
+}
+
+bool convolveFrame(camera_fb_t *cameraFb, const ConvolutionKernel &kernel, const ConvolutionOptions &options)
+{
+    if (!psramFound() || !cameraFb || (kernel.size != 3 && kernel.size != 5) || kernel.divisor == 0)
+    {
+        return false;
+    }
+    const int32_t multiplier = ((1 << 16) + abs(kernel.divisor) / 2) / kernel.divisor;
+    if (!kernelInRange(kernel, multiplier))
+    {
+        return false;
+    }
+
+    const int width = cameraFb->width;
+    const int height = cameraFb->height;
+    uint16_t *frameBuffer = (uint16_t *)cameraFb->buf;
+    const size_t frameBytes = (size_t)width * height * sizeof(uint16_t);
+
+    ConvolutionContext ctx;
+    ctx.source = frameBuffer;
+    ctx.width = width;
+    ctx.height = height;
+    ctx.kernel = &kernel;
+    ctx.options = options;
+    ctx.multiplier = multiplier;
+    ctx.tapCount = 0;
+    if (!kernel.separable)
+    {
+        for (int dy = 0; dy < kernel.size; dy++)
+        {
+            for (int dx = 0; dx < kernel.size; dx++)
+            {
+                int weight = kernel.weights[dy * kernel.size + dx];
+                if (weight)
+                {
+                    ConvolutionTap tap = {dx, dy, weight};
+                    ctx.taps[ctx.tapCount++] = tap;
+                }
+            }
+        }
+    }
+
+    ctx.output = (uint16_t *)ps_malloc(frameBytes);
+    if (!ctx.output)
+    {
+        return false;
+    }
+
+    parallelForRows(convolutionBands, height, 1, convolutionBand, &ctx);
+
+    memcpy(frameBuffer, ctx.output, frameBytes);
+    free(ctx.output);
+    return true;
+}
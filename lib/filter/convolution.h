@@ -0,0 +1,82 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include <Arduino.h>
+#include <esp_camera.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Integer convolution engine
+//
+// Runs a 3x3 or 5x5 integer kernel over a frame-order RGB565 frame. Each band keeps a
+// sliding cache of kernel-size source rows, unpacked to 8-bit channels (or luma) and
+// padded at both ends according to the border mode, so every source row is unpacked
+// once. A separable kernel is applied horizontally as a row enters the cache, leaving a
+// single column sum per output pixel; other kernels visit only their non-zero taps.
+// The sum is divided by the kernel's divisor (reciprocal multiply), offset by its bias
+// and run through an optional post-op before being packed back to RGB565.
+//
+// Rows are split across both cores; bands read their halo from the untouched frame and
+// write to a separate output, which is copied back when both are done.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const int CONVOLUTION_MAX_SIZE = 5;
+const int CONVOLUTION_HALO = CONVOLUTION_MAX_SIZE / 2; // Rows read above and below a band
+
+// Separable kernels: most the absolute row taps may add up to (row sums are cached as int16)
+const int CONVOLUTION_MAX_ROW_GAIN = 128;
+
+enum ConvolutionChannels
+{
+    CONVOLVE_RGB = 0, // Each channel on its own
+    CONVOLVE_LUMA,    // Luma only; the output is gray
+};
+
+// Source pixels the kernel sees past the frame edge
+enum ConvolutionBorder
+{
+    CONVOLVE_BORDER_CLAMP = 0, // Edge pixel repeated
+    CONVOLVE_BORDER_MIRROR,    // Reflected about the edge pixel (edge not repeated)
+};
+
+// Applied to each scaled channel value before packing
+enum ConvolutionPostOp
+{
+    CONVOLVE_POST_NONE = 0,
+    CONVOLVE_POST_THRESHOLD,  // 255 at or above postParam, 0 below
+    CONVOLVE_POST_INVERT,     // 255 - value
+    CONVOLVE_POST_ADD_SOURCE, // source + (value - source) * postParam / 16; negative
+                              // postParam with a blur kernel is an unsharp mask
+};
+
+struct ConvolutionKernel
+{
+    int size;                                              // 3 or 5
+    bool separable;                                        // weights[y][x] = column[y] * row[x]
+    int8_t weights[CONVOLUTION_MAX_SIZE * CONVOLUTION_MAX_SIZE]; // Non-separable, row-major size x size
+    int8_t row[CONVOLUTION_MAX_SIZE];                      // Separable: horizontal taps, see CONVOLUTION_MAX_ROW_GAIN
+    int8_t column[CONVOLUTION_MAX_SIZE];                   // Separable: vertical taps
+    int divisor;                                           // Sum of absolute weights x 255 x 2^16 / divisor must fit an int32
+    int bias;                                              // Added after dividing (128 centers signed results)
+};
+
+struct ConvolutionOptions
+{
+    ConvolutionChannels channels;
+    ConvolutionBorder border;
+    ConvolutionPostOp postOp;
+    int postParam;
+};
+
+/**
+ * Convolve a frame in place
+ *
+ * @param cameraFb Frame in frame byte order
+ * @param kernel Kernel (3x3 or 5x5)
+ * @param options Channel mode, border handling and post-op
+ * @return false if the frame or kernel is invalid (including one whose sums could
+ *         overflow, see divisor and CONVOLUTION_MAX_ROW_GAIN) or scratch memory ran out
+ *         (frame unchanged)
+ */
+bool convolveFrame(camera_fb_t *cameraFb, const ConvolutionKernel &kernel, const ConvolutionOptions &options);
+
+#endif // CONVOLUTION_H
@@ -0,0 +1,374 @@
+#ifndef DIFFUSION_H
+#define DIFFUSION_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "parallel.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Error-diffusion engine
+//
+// One templated implementation shared by every error-diffusion dither. A kernel is a
+// compile-time list of taps (dx, dy, weight) plus a divisor; the tap list is expanded
+// by the compiler into straight-line integer code, so there is no per-tap loop, no
+// float math and no bounds check in the inner loop.
+//
+// Errors are kept as int16 accumulators of (error * weight) in a small ring of rows
+// (kernel rows + 1, padded by the kernel reach on both sides). The weights arriving at
+// one pixel sum to at most the divisor and the error is bounded by +/-255, so the
+// accumulators can never overflow (worst case 255 * 48 for Jarvis-Judice-Ninke).
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <int DX, int DY, int Weight>
+struct DiffusionTap
+{
+    static const int dx = DX;
+    static const int dy = DY;
+    static const int weight = Weight;
+};
+
+template <typename... Taps>
+struct DiffusionSpread;
+
+template <>
+struct DiffusionSpread<>
+{
+    static inline void apply(int16_t *const *, int, int, int, int, int) {}
+};
+
+template <typename Tap, typename... Rest>
+struct DiffusionSpread<Tap, Rest...>
+{
+    static inline void apply(int16_t *const *rows, int x, int dir, int errR, int errG, int errB)
+    {
+        int16_t *cell = rows[Tap::dy] + (x + Tap::dx * dir) * 3;
+        cell[0] += errR * Tap::weight;
+        cell[1] += errG * Tap::weight;
+        cell[2] += errB * Tap::weight;
+        DiffusionSpread<Rest...>::apply(rows, x, dir, errR, errG, errB);
+    }
+};
+
+/**
+ * Error-diffusion kernel description
+ *
+ * @tparam Divisor Sum the tap weights are normalized by
+ * @tparam Rows Number of rows below the current one that receive error
+ * @tparam Reach Largest horizontal tap distance
+ * @tparam Taps DiffusionTap list, dx relative to the scan direction
+ */
+template <int Divisor, int Rows, int Reach, typename... Taps>
+struct DiffusionKernel
+{
+    static const int kDivisor = Divisor;
+    static const int kRows = Rows;
+    static const int kReach = Reach;
+
+    static inline void spread(int16_t *const *rows, int x, int dir, int errR, int errG, int errB)
+    {
+        DiffusionSpread<Taps...>::apply(rows, x, dir, errR, errG, errB);
+    }
+
+    // Accumulated (error * weight) back to pixel units, rounded half away from zero
+    static inline int settle(int accumulated)
+    {
+        return (accumulated >= 0) ? (accumulated + Divisor / 2) / Divisor
+                                  : -((-accumulated + Divisor / 2) / Divisor);
+    }
+};
+
+//        X   7
+//    3   5   1      (/16)
+typedef DiffusionKernel<16, 1, 1,
+                        DiffusionTap<1, 0, 7>,
+                        DiffusionTap<-1, 1, 3>, DiffusionTap<0, 1, 5>, DiffusionTap<1, 1, 1>>
+    FloydSteinbergKernel;
+
+//        X   1   1
+//    1   1   1
+//        1          (/8, only 6/8 of the error is propagated)
+typedef DiffusionKernel<8, 2, 2,
+                        DiffusionTap<1, 0, 1>, DiffusionTap<2, 0, 1>,
+                        DiffusionTap<-1, 1, 1>, DiffusionTap<0, 1, 1>, DiffusionTap<1, 1, 1>,
+                        DiffusionTap<0, 2, 1>>
+    AtkinsonKernel;
+
+//        X   2
+//    1   1          (/4)
+typedef DiffusionKernel<4, 1, 1,
+                        DiffusionTap<1, 0, 2>,
+                        DiffusionTap<-1, 1, 1>, DiffusionTap<0, 1, 1>>
+    SierraLiteKernel;
+
+//            X   8   4
+//    2   4   8   4   2
+//    1   2   4   2   1      (/42)
+typedef DiffusionKernel<42, 2, 2,
+                        DiffusionTap<1, 0, 8>, DiffusionTap<2, 0, 4>,
+                        DiffusionTap<-2, 1, 2>, DiffusionTap<-1, 1, 4>, DiffusionTap<0, 1, 8>, DiffusionTap<1, 1, 4>, DiffusionTap<2, 1, 2>,
+                        DiffusionTap<-2, 2, 1>, DiffusionTap<-1, 2, 2>, DiffusionTap<0, 2, 4>, DiffusionTap<1, 2, 2>, DiffusionTap<2, 2, 1>>
+    StuckiKernel;
+
+//            X   7   5
+//    3   5   7   5   3
+//    1   3   5   3   1      (/48)
+typedef DiffusionKernel<48, 2, 2,
+                        DiffusionTap<1, 0, 7>, DiffusionTap<2, 0, 5>,
+                        DiffusionTap<-2, 1, 3>, DiffusionTap<-1, 1, 5>, DiffusionTap<0, 1, 7>, DiffusionTap<1, 1, 5>, DiffusionTap<2, 1, 3>,
+                        DiffusionTap<-2, 2, 1>, DiffusionTap<-1, 2, 3>, DiffusionTap<0, 2, 5>, DiffusionTap<1, 2, 3>, DiffusionTap<2, 2, 1>>
+    JarvisJudiceNinkeKernel;
+
+// Scan order of the error-diffusion engine
+enum DiffusionScan
+{
+    DIFFUSION_SERPENTINE, // Alternate direction every row (fewer directional artifacts)
+    DIFFUSION_RASTER      // Left to right on every row (required by the wavefront)
+};
+
+// Diffuse one pixel: add the accumulated error, quantize, spread the new error
+template <typename Kernel, typename Quantizer>
+inline void diffuseErrorPixel(int16_t *const *rows, int x, int y, int dir, Quantizer &quantizer)
+{
+    int16_t *cell = rows[0] + x * 3;
+
+    int r, g, b;
+    quantizer.load(x, y, r, g, b);
+
+    r = constrain(r + Kernel::settle(cell[0]), 0, 255);
+    g = constrain(g + Kernel::settle(cell[1]), 0, 255);
+    b = constrain(b + Kernel::settle(cell[2]), 0, 255);
+
+    int qr = r, qg = g, qb = b;
+    quantizer.quantize(x, y, qr, qg, qb);
+
+    Kernel::spread(rows, x, dir, r - qr, g - qg, b - qb);
+}
+
+/**
+ * Run error diffusion over a width x height image
+ *
+ * The quantizer supplies and consumes the pixels, so the engine works for any pixel
+ * format and output target (in place is fine: each pixel is read once before it is
+ * written). It must provide:
+ *   void load(int x, int y, int &r, int &g, int &b)      - source value, 0-255 per channel
+ *   void quantize(int x, int y, int &r, int &g, int &b)  - store the nearest output color
+ *                                                          for r/g/b and return it in r/g/b
+ *
+ * @param width Image width
+ * @param height Image height
+ * @param quantizer Pixel source/sink
+ * @param scan Serpentine or raster scanning
+ * @return false if the error rows could not be allocated
+ */
+template <typename Kernel, typename Quantizer>
+bool diffuseErrors(int width, int height, Quantizer &quantizer, DiffusionScan scan = DIFFUSION_SERPENTINE)
+{
+    const int ringRows = Kernel::kRows + 1;
+    const int stride = (width + 2 * Kernel::kReach) * 3;
+
+    // A few KB at preview sizes, so keep it in internal RAM rather than PSRAM
+    int16_t *ring = (int16_t *)calloc(ringRows * stride, sizeof(int16_t));
+    if (!ring)
+    {
+        return false;
+    }
+
+    int16_t *rows[Kernel::kRows + 1];
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int i = 0; i < ringRows; i++)
+        {
+            rows[i] = ring + ((y + i) % ringRows) * stride + Kernel::kReach * 3;
+        }
+
+        const int dir = (scan == DIFFUSION_SERPENTINE && (y & 1)) ? -1 : 1;
+        int x = (dir > 0) ? 0 : width - 1;
+
+        for (int n = 0; n < width; n++, x += dir)
+        {
+            diffuseErrorPixel<Kernel>(rows, x, y, dir, quantizer);
+        }
+
+        // This row is done; its slot becomes the furthest row below on the next line
+        memset(rows[0] - Kernel::kReach * 3, 0, stride * sizeof(int16_t));
+    }
+
+    free(ring);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Wavefront error diffusion
+//
+// Rows are dealt alternately to the two cores (even rows on the caller, odd rows on the
+// worker). A row may process pixel x once the row above has finished pixel x + lag:
+// by then every error the row above sends to x has arrived, and the cells the two rows
+// write never overlap. With lag = 2 * reach + 1 this holds for one- and two-row kernels
+// (Floyd-Steinberg: 3, Stucki/JJN: 5). Each worker publishes its progress through one
+// atomic counter, so there are no locks, and since every error is an integer the order
+// in which contributions land in a cell does not matter: the output is bit-identical to
+// diffuseErrors() with DIFFUSION_RASTER.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Kernel, typename Quantizer>
+struct DiffusionWavefront
+{
+    static const int kLag = 2 * Kernel::kReach + 1;
+    // One extra row: the trailing row spreads one line further than the leading one
+    static const int kRingRows = Kernel::kRows + 2;
+
+    int width;
+    int height;
+    int stride;
+    int16_t *ring;
+    Quantizer *quantizer;
+
+    // Pixels finished by each worker, as y * width + x + 1 of its latest pixel
+    std::atomic<int> progress[PARALLEL_WORKERS];
+    uint32_t micros[PARALLEL_WORKERS];
+    uint32_t stalls[PARALLEL_WORKERS];
+
+    static void run(int worker, void *ctx)
+    {
+        DiffusionWavefront &job = *(DiffusionWavefront *)ctx;
+        const int width = job.width;
+        const int other = worker ^ 1;
+
+        uint32_t start = ::micros();
+        uint32_t stalls = 0;
+        int16_t *rows[Kernel::kRows + 1];
+
+        for (int y = worker; y < job.height; y += PARALLEL_WORKERS)
+        {
+            for (int i = 0; i <= Kernel::kRows; i++)
+            {
+                rows[i] = job.ring + ((y + i) % kRingRows) * job.stride + Kernel::kReach * 3;
+            }
+
+            const int rowAbove = (y - 1) * width;
+            int ready = (y == 0) ? width : job.progress[other].load(std::memory_order_acquire) - rowAbove;
+
+            for (int x = 0; x < width; x++)
+            {
+                const int need = min(x + kLag, width);
+                if (ready < need)
+                {
+                    stalls++;
+                    for (;;)
+                    {
+                        ready = job.progress[other].load(std::memory_order_acquire) - rowAbove;
+                        if (ready >= need)
+                        {
+                            break;
+                        }
+                        parallelSpinPause();
+                    }
+                }
+
+                diffuseErrorPixel<Kernel>(rows, x, y, 1, *job.quantizer);
+                job.progress[worker].store(y * width + x + 1, std::memory_order_release);
+            }
+
+            // Nobody touches this row's slot again until it comes round as a new row,
+            // which is written by this worker's next row or by rows that wait on it
+            memset(rows[0] - Kernel::kReach * 3, 0, job.stride * sizeof(int16_t));
+        }
+
+        job.micros[worker] = ::micros() - start;
+        job.stalls[worker] = stalls;
+    }
+};
+
+/**
+ * Run raster-order error diffusion on both cores with a diagonal wavefront
+ *
+ * Falls back to the serial raster engine (same output) for tiny images, when band
+ * splitting is disabled or when the other core is not available.
+ *
+ * @param width Image width
+ * @param height Image height
+ * @param quantizer Pixel source/sink; load() and quantize() are called from both cores,
+ *                  for different pixels
+ * @param stats Filter declaration the run is recorded in
+ * @return false if the error rows could not be allocated
+ */
+template <typename Kernel, typename Quantizer>
+bool diffuseErrorsWavefront(int width, int height, Quantizer &quantizer, RowBandFilter &stats)
+{
+    typedef DiffusionWavefront<Kernel, Quantizer> Job;
+
+    uint32_t start = micros();
+
+    Job job;
+    job.width = width;
+    job.height = height;
+    job.stride = (width + 2 * Kernel::kReach) * 3;
+    job.ring = nullptr;
+    job.quantizer = &quantizer;
+    for (int i = 0; i < PARALLEL_WORKERS; i++)
+    {
+        job.progress[i].store(0, std::memory_order_relaxed);
+        job.micros[i] = 0;
+        job.stalls[i] = 0;
+    }
+
+    bool split = false;
+    if (height >= 2 && width >= 1 && parallelEnabled())
+    {
+        job.ring = (int16_t *)calloc(Job::kRingRows * job.stride, sizeof(int16_t));
+        if (!job.ring)
+        {
+            return false;
+        }
+
+        split = parallelRun(Job::run, &job);
+        free(job.ring);
+    }
+
+    if (!split)
+    {
+        if (!diffuseErrors<Kernel>(width, height, quantizer, DIFFUSION_RASTER))
+        {
+            return false;
+        }
+        job.micros[0] = micros() - start;
+    }
+
+    parallelRecordRun(stats, split, micros() - start, job.micros, job.stalls[0] + job.stalls[1]);
+    return true;
+}
+
+/**
+ * Dispatch a dither type to the matching diffusion kernel
+ *
+ * @param kernel Diffusion kernel: 1=Floyd-Steinberg, 4=Atkinson, 5=Sierra Lite, 6=Stucki, 7=Jarvis-Judice-Ninke
+ * @return false for unknown kernels or allocation failure
+ */
+template <typename Quantizer>
+bool diffuseErrorsWith(int kernel, int width, int height, Quantizer &quantizer)
+{
+    switch (kernel)
+    {
+    case 1:
+        return diffuseErrors<FloydSteinbergKernel>(width, height, quantizer);
+    case 4:
+        return diffuseErrors<AtkinsonKernel>(width, height, quantizer);
+    case 5:
+        return diffuseErrors<SierraLiteKernel>(width, height, quantizer);
+    case 6:
+        return diffuseErrors<StuckiKernel>(width, height, quantizer);
+    case 7:
+        return diffuseErrors<JarvisJudiceNinkeKernel>(width, height, quantizer);
+    default:
+        return false;
+    }
+}
+
+// True if the dither type is handled by the error-diffusion engine
+inline bool isDiffusionDither(int dithering)
+{
+    return dithering == 1 || (dithering >= 4 && dithering <= 7);
+}
+
+#endif // DIFFUSION_H
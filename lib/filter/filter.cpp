@@ -1,7 +1,57 @@
 #include "filter.h"
+#include "blue_noise.h"
+#include "diffusion.h"
+#include "parallel.h"
+#include "pixel_simd.h"
+#include "block_reduce.h"
+#include "resample.h"
+#include "palette_table.h"
+#include <limits.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// Error-diffusion quantizer for applyDithering: reduces each channel to 2^bits levels in place
+struct BitDepthQuantizer
+{
+    uint16_t *frameBuffer;
+    int width;
+    int redMax;
+    int greenMax;
+    int blueMax;
+    bool grayscale;
+
+    inline void load(int x, int y, int &r, int &g, int &b)
+    {
+        uint16_t pixel = frameBuffer[y * width + x];
+        pixel = ((pixel << 8) | (pixel >> 8));
+
+        r = ((pixel >> 11) & 0x1F) << 3;
+        g = ((pixel >> 5) & 0x3F) << 2;
+        b = (pixel & 0x1F) << 3;
+
+        if (grayscale)
+        {
+            r = g = b = (r * 30 + g * 59 + b * 11) / 100;
+        }
+    }
+
+    static inline int quantizeChannel(int value, int levelMax)
+    {
+        int level = (value * levelMax + 127) / 255;
+        return (level * 255 + levelMax / 2) / levelMax;
+    }
+
+    inline void quantize(int x, int y, int &r, int &g, int &b)
+    {
+        r = quantizeChannel(r, redMax);
+        g = quantizeChannel(g, greenMax);
+        b = quantizeChannel(b, blueMax);
+
+        uint16_t color = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+        frameBuffer[y * width + x] = ((color << 8) | (color >> 8));
+    }
+};
+
 /**
  * Apply dithering directly to camera frame buffer
  *
@@ -10,7 +60,8 @@
  * @param greenBits Number of bits for green channel
  * @param blueBits Number of bits for blue channel
  * @param grayscale Whether to convert to grayscale
- * @param algorithm Dithering algorithm: 0 = Floyd-Steinberg, 1 = Bayer
+ * @param algorithm Dithering algorithm: 0 = Floyd-Steinberg, 1 = Bayer, 2 = Blue noise,
+ *                  3 = Atkinson, 4 = Sierra Lite, 5 = Stucki, 6 = Jarvis-Judice-Ninke
  * @param bayerSize Bayer matrix size (2, 4, or 8) - only used when algorithm = 1
  */
 void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueBits, bool grayscale, int algorithm, int bayerSize)
@@ -40,6 +91,15 @@ void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueB
     int greenMax = greenLevels - 1;
     int blueMax = blueLevels - 1;
 
+    // Error diffusion runs in place on the frame buffer, no full-frame buffers needed
+    int diffusionKernel = (algorithm == 0) ? 1 : (algorithm >= 3 && algorithm <= 6) ? algorithm + 1 : 0;
+    if (diffusionKernel)
+    {
+        BitDepthQuantizer quantizer = {frameBuffer, width, redMax, greenMax, blueMax, grayscale};
+        diffuseErrorsWith(diffusionKernel, width, height, quantizer);
+        return;
+    }
+
     float redScale = 255.0f / redMax;
     float greenScale = 255.0f / greenMax;
     float blueScale = 255.0f / blueMax;
@@ -81,38 +141,8 @@ void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueB
     uint8_t *redBuffer = (uint8_t *)ps_malloc(width * height * sizeof(uint8_t));
     uint8_t *greenBuffer = (uint8_t *)ps_malloc(width * height * sizeof(uint8_t));
     uint8_t *blueBuffer = (uint8_t *)ps_malloc(width * height * sizeof(uint8_t));
-    float *redErrorBuffer = nullptr;
-    float *greenErrorBuffer = nullptr;
-    float *blueErrorBuffer = nullptr;
     uint16_t *outputBuffer = (uint16_t *)ps_malloc(width * height * sizeof(uint16_t));
 
-    // Only allocate error buffers for Floyd-Steinberg
-    if (algorithm == 0)
-    {
-        redErrorBuffer = (float *)ps_malloc(width * height * sizeof(float));
-        greenErrorBuffer = (float *)ps_malloc(width * height * sizeof(float));
-        blueErrorBuffer = (float *)ps_malloc(width * height * sizeof(float));
-
-        if (!redErrorBuffer || !greenErrorBuffer || !blueErrorBuffer)
-        {
-            if (redBuffer)
-                free(redBuffer);
-            if (greenBuffer)
-                free(greenBuffer);
-            if (blueBuffer)
-                free(blueBuffer);
-            if (redErrorBuffer)
-                free(redErrorBuffer);
-            if (greenErrorBuffer)
-                free(greenErrorBuffer);
-            if (blueErrorBuffer)
-                free(blueErrorBuffer);
-            if (outputBuffer)
-                free(outputBuffer);
-            return;
-        }
-    }
-
     if (!redBuffer || !greenBuffer || !blueBuffer || !outputBuffer)
     {
         // Clean up if any allocation failed
@@ -122,12 +152,6 @@ void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueB
             free(greenBuffer);
         if (blueBuffer)
             free(blueBuffer);
-        if (redErrorBuffer)
-            free(redErrorBuffer);
-        if (greenErrorBuffer)
-            free(greenErrorBuffer);
-        if (blueErrorBuffer)
-            free(blueErrorBuffer);
         if (outputBuffer)
             free(outputBuffer);
         return;
@@ -158,128 +182,9 @@ void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueB
         redBuffer[i] = r;
         greenBuffer[i] = g;
         blueBuffer[i] = b;
-
-        // Initialize error buffers only for Floyd-Steinberg
-        if (algorithm == 0)
-        {
-            redErrorBuffer[i] = r;
-            greenErrorBuffer[i] = g;
-            blueErrorBuffer[i] = b;
-        }
     }
 
-    if (algorithm == 0)
-    {
-        // Floyd-Steinberg dithering
-        // Precalculate error distribution factors
-        const float f7_16 = 7.0f / 16.0f;
-        const float f3_16 = 3.0f / 16.0f;
-        const float f5_16 = 5.0f / 16.0f;
-        const float f1_16 = 1.0f / 16.0f;
-
-        // Apply Floyd-Steinberg dithering with serpentine scanning
-        for (int y = 0; y < height; y++)
-        {
-            bool leftToRight = (y % 2 == 0);
-            int xStart = leftToRight ? 0 : width - 1;
-            int xEnd = leftToRight ? width : -1;
-            int xStep = leftToRight ? 1 : -1;
-
-            for (int x = xStart; x != xEnd; x += xStep)
-            {
-                int idx = y * width + x;
-
-                // Get current pixel with accumulated error for each channel
-                float oldR = redErrorBuffer[idx];
-                float oldG = greenErrorBuffer[idx];
-                float oldB = blueErrorBuffer[idx];
-
-                // Quantize to the target bit depth
-                uint8_t newR = round(round(oldR / redScale) * redScale);
-                uint8_t newG = round(round(oldG / greenScale) * greenScale);
-                uint8_t newB = round(round(oldB / blueScale) * blueScale);
-
-                // Calculate quantization error
-                float errorR = oldR - newR;
-                float errorG = oldG - newG;
-                float errorB = oldB - newB;
-
-                // Store the quantized value
-                redBuffer[idx] = newR;
-                greenBuffer[idx] = newG;
-                blueBuffer[idx] = newB;
-
-                // Distribute error to neighboring pixels
-                if (leftToRight)
-                {
-                    // Left to right pattern
-                    if (x + 1 < width)
-                    {
-                        redErrorBuffer[idx + 1] += errorR * f7_16;
-                        greenErrorBuffer[idx + 1] += errorG * f7_16;
-                        blueErrorBuffer[idx + 1] += errorB * f7_16;
-                    }
-
-                    if (y + 1 < height)
-                    {
-                        int nextRow = (y + 1) * width;
-
-                        if (x - 1 >= 0)
-                        {
-                            redErrorBuffer[nextRow + x - 1] += errorR * f3_16;
-                            greenErrorBuffer[nextRow + x - 1] += errorG * f3_16;
-                            blueErrorBuffer[nextRow + x - 1] += errorB * f3_16;
-                        }
-
-                        redErrorBuffer[nextRow + x] += errorR * f5_16;
-                        greenErrorBuffer[nextRow + x] += errorG * f5_16;
-                        blueErrorBuffer[nextRow + x] += errorB * f5_16;
-
-                        if (x + 1 < width)
-                        {
-                            redErrorBuffer[nextRow + x + 1] += errorR * f1_16;
-                            greenErrorBuffer[nextRow + x + 1] += errorG * f1_16;
-                            blueErrorBuffer[nextRow + x + 1] += errorB * f1_16;
-                        }
-                    }
-                }
-                else
-                {
-                    // Right to left pattern
-                    if (x - 1 >= 0)
-                    {
-                        redErrorBuffer[idx - 1] += errorR * f7_16;
-                        greenErrorBuffer[idx - 1] += errorG * f7_16;
-                        blueErrorBuffer[idx - 1] += errorB * f7_16;
-                    }
-
-                    if (y + 1 < height)
-                    {
-                        int nextRow = (y + 1) * width;
-
-                        if (x + 1 < width)
-                        {
-                            redErrorBuffer[nextRow + x + 1] += errorR * f3_16;
-                            greenErrorBuffer[nextRow + x + 1] += errorG * f3_16;
-                            blueErrorBuffer[nextRow + x + 1] += errorB * f3_16;
-                        }
-
-                        redErrorBuffer[nextRow + x] += errorR * f5_16;
-                        greenErrorBuffer[nextRow + x] += errorG * f5_16;
-                        blueErrorBuffer[nextRow + x] += errorB * f5_16;
-
-                        if (x - 1 >= 0)
-                        {
-                            redErrorBuffer[nextRow + x - 1] += errorR * f1_16;
-                            greenErrorBuffer[nextRow + x - 1] += errorG * f1_16;
-                            blueErrorBuffer[nextRow + x - 1] += errorB * f1_16;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    else if (algorithm == 1)
+    if (algorithm == 1)
     {
         // Bayer dithering
         for (int y = 0; y < height; y++)
@@ -338,6 +243,35 @@ void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueB
             }
         }
     }
+    else if (algorithm == 2)
+    {
+        // Blue-noise ordered dithering: same per-pixel independence as Bayer, but the
+        // threshold comes from a tileable blue-noise texture so there is no cross-hatch.
+        // level = floor(value / step + threshold), with threshold in [0, 1) of a step.
+        for (int y = 0; y < height; y++)
+        {
+            const uint8_t *noiseRow = &BLUE_NOISE_64X64[(y & BLUE_NOISE_MASK) * BLUE_NOISE_SIZE];
+
+            for (int x = 0; x < width; x++)
+            {
+                int idx = y * width + x;
+                int noise = noiseRow[x & BLUE_NOISE_MASK];
+
+                int levelR = (redBuffer[idx] * redMax * 256 / 255 + noise) >> 8;
+                int levelG = (greenBuffer[idx] * greenMax * 256 / 255 + noise) >> 8;
+                int levelB = (blueBuffer[idx] * blueMax * 256 / 255 + noise) >> 8;
+
+                levelR = min(levelR, redMax);
+                levelG = min(levelG, greenMax);
+                levelB = min(levelB, blueMax);
+
+                // Store the quantized value
+                redBuffer[idx] = levelR * 255 / redMax;
+                greenBuffer[idx] = levelG * 255 / greenMax;
+                blueBuffer[idx] = levelB * 255 / blueMax;
+            }
+        }
+    }
 
     // Convert back to RGB565 format
     for (int i = 0; i < width * height; i++)
@@ -367,28 +301,65 @@ void applyDithering(camera_fb_t *cameraFb, int redBits, int greenBits, int blueB
     free(redBuffer);
     free(greenBuffer);
     free(blueBuffer);
-    if (algorithm == 0)
-    {
-        free(redErrorBuffer);
-        free(greenErrorBuffer);
-        free(blueErrorBuffer);
-    }
     free(outputBuffer);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
+
+struct PixelateBandContext
+{
+    uint16_t *frameBuffer;
+    int width;
+    int height;
+    int blockSize;
+    bool grayscale;
+};
+
+static RowBandFilter pixelateBands = {"Pixelate", true, 0, {}, nullptr};
+
+// Block color for applyPixelate: the block average, optionally in grayscale
+struct PixelateShader
+{
+    bool grayscale;
+
+    inline uint16_t color(int, int, uint32_t sumR, uint32_t sumG, uint32_t sumB, const BlockDivisor &pixels)
+    {
+        // Average in 8-bit units, as if every pixel had been expanded first
+        uint8_t avgR = pixels.divide(sumR << 3);
+        uint8_t avgG = pixels.divide(sumG << 2);
+        uint8_t avgB = pixels.divide(sumB << 3);
+
+        if (grayscale)
+        {
+            // Convert to grayscale using standard luminance formula
+            uint8_t gray = (avgR * 30 + avgG * 59 + avgB * 11) / 100;
+            avgR = avgG = avgB = gray;
+        }
+
+        uint16_t avgPixel = ((avgR >> 3) << 11) | ((avgG >> 2) << 5) | (avgB >> 3);
+        return ((avgPixel << 8) | (avgPixel >> 8));
+    }
+};
+
+// Pixelate the blocks of one row band in place (bands start on block boundaries)
+static void pixelateBand(const RowBand &band, void *ctx)
+{
+    const PixelateBandContext &c = *(const PixelateBandContext *)ctx;
+
+    PixelateShader shader = {c.grayscale};
+    reduceBlocks(c.frameBuffer, c.width, c.height, band.y0, band.y1, c.blockSize, shader);
+}
+
 /**
  * Apply pixelation filter directly to camera frame buffer
  *
  * @param cameraFb Pointer to camera frame buffer
- * @param width Image width
- * @param height Image height
  * @param blockSize Size of pixelation blocks
  * @param grayscale Whether to convert to grayscale
  */
 void applyPixelate(camera_fb_t *cameraFb, int blockSize, bool grayscale)
 {
-    if (!psramFound() || !cameraFb)
+    if (!psramFound() || !cameraFb || blockSize < 1)
     {
         return;
     }
@@ -397,95 +368,9 @@ void applyPixelate(camera_fb_t *cameraFb, int blockSize, bool grayscale)
     int height = cameraFb->height;
     uint16_t *frameBuffer = (uint16_t *)cameraFb->buf;
 
-    // GC0308 outputs RGB565 little-endian frames, so no byte swapping is required.
-    const bool swapBytes = true;
-
-    // Allocate memory using PSRAM for output buffer
-    uint16_t *outputBuffer = (uint16_t *)ps_malloc(width * height * sizeof(uint16_t));
-
-    if (!outputBuffer)
-    {
-        return;
-    }
-
-    // Process image in blocks
-    for (int blockY = 0; blockY < height; blockY += blockSize)
-    {
-        for (int blockX = 0; blockX < width; blockX += blockSize)
-        {
-            // Calculate block boundaries
-            int blockEndY = min(blockY + blockSize, height);
-            int blockEndX = min(blockX + blockSize, width);
-
-            // Calculate average color for this block
-            long sumR = 0, sumG = 0, sumB = 0;
-            int count = 0;
-
-            for (int y = blockY; y < blockEndY; y++)
-            {
-                for (int x = blockX; x < blockEndX; x++)
-                {
-                    int idx = y * width + x;
-                    uint16_t pixel = frameBuffer[idx];
-
-                    if (swapBytes)
-                    {
-                        pixel = ((pixel << 8) | (pixel >> 8));
-                    }
-
-                    // Extract RGB components from RGB565 format
-                    uint8_t r = ((pixel >> 11) & 0x1F) << 3; // 5 bits to 8 bits
-                    uint8_t g = ((pixel >> 5) & 0x3F) << 2;  // 6 bits to 8 bits
-                    uint8_t b = (pixel & 0x1F) << 3;         // 5 bits to 8 bits
-
-                    sumR += r;
-                    sumG += g;
-                    sumB += b;
-                    count++;
-                }
-            }
-
-            // Calculate average color
-            uint8_t avgR = sumR / count;
-            uint8_t avgG = sumG / count;
-            uint8_t avgB = sumB / count;
-
-            if (grayscale)
-            {
-                // Convert to grayscale using standard luminance formula
-                uint8_t gray = (avgR * 30 + avgG * 59 + avgB * 11) / 100;
-                avgR = avgG = avgB = gray;
-            }
-
-            // Convert back to RGB565 format
-            uint8_t r5 = avgR >> 3; // Convert 8-bit to 5-bit (for red)
-            uint8_t g6 = avgG >> 2; // Convert 8-bit to 6-bit (for green)
-            uint8_t b5 = avgB >> 3; // Convert 8-bit to 5-bit (for blue)
-
-            uint16_t avgPixel = (r5 << 11) | (g6 << 5) | b5;
-
-            if (swapBytes)
-            {
-                avgPixel = ((avgPixel << 8) | (avgPixel >> 8));
-            }
-
-            // Fill the entire block with the average color
-            for (int y = blockY; y < blockEndY; y++)
-            {
-                for (int x = blockX; x < blockEndX; x++)
-                {
-                    int idx = y * width + x;
-                    outputBuffer[idx] = avgPixel;
-                }
-            }
-        }
-    }
-
-    // Copy the processed image back to the camera frame buffer
-    memcpy(frameBuffer, outputBuffer, width * height * sizeof(uint16_t));
-
-    // Free memory
-    free(outputBuffer);
+    // Blocks never straddle a band boundary, so both cores can write in place
+    PixelateBandContext ctx = {frameBuffer, width, height, blockSize, grayscale};
+    parallelForRows(pixelateBands, height, blockSize, pixelateBand, &ctx);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -501,32 +386,103 @@ int colorDistance(uint8_t r1, uint8_t g1, uint8_t b1, uint8_t r2, uint8_t g2, ui
     return dr * dr * 2 + dg * dg * 4 + db * db * 3;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-/**
- * Apply color palette with optional dithering
- *
- * @param imageBuffer Pointer to image buffer
- * @param width Image width
- * @param height Image height
- * @param palette Pointer to palette array
- * @param paletteSize Number of colors in palette
- * @param dithering Dithering algorithm: 0=OFF, 1=Floyd-Steinberg, 2=Bayer
- * @param pixelSize Pixelation size (1 = no pixelation)
- * @param bayerSize Bayer matrix size (2, 4, or 8) - only used when dithering = 2
- */
-void applyColorPalette(uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize, int dithering, int pixelSize, int bayerSize)
+// Nearest-entry searches the palette filter is compiled for: r, g and b are the entries'
+// channels, nearest() the search
+struct PaletteIndexSearch
 {
+    const PaletteIndex *index;
+    const uint8_t *r;
+    const uint8_t *g;
+    const uint8_t *b;
 
-    if (!psramFound())
+    inline int nearest(int red, int green, int blue) const
     {
-        return;
+        return paletteIndexNearest(*index, red, green, blue);
+    }
+};
+
+// Built-in palettes: compile-time channels, scan unrolled for the palette size
+template <size_t N>
+struct PaletteTableSearch
+{
+    const PaletteTableView *table;
+    const uint8_t *r;
+    const uint8_t *g;
+    const uint8_t *b;
+
+    inline int nearest(int red, int green, int blue) const
+    {
+        return paletteTableNearest<N>(*table, red, green, blue);
+    }
+};
+
+// Error-diffusion quantizer for the palette filter: maps each pixel to the index of its
+// nearest palette color
+template <typename Search>
+struct PaletteQuantizer
+{
+    const uint16_t *source;
+    uint8_t *output;
+    int width;
+    Search search;
+
+    inline void load(int x, int y, int &r, int &g, int &b)
+    {
+        uint16_t pixel = source[y * width + x];
+        pixel = ((pixel << 8) | (pixel >> 8));
+
+        r = ((pixel >> 11) & 0x1F) << 3;
+        g = ((pixel >> 5) & 0x3F) << 2;
+        b = (pixel & 0x1F) << 3;
+    }
+
+    inline void quantize(int x, int y, int &r, int &g, int &b)
+    {
+        int index = search.nearest(r, g, b);
+        r = search.r[index];
+        g = search.g[index];
+        b = search.b[index];
+
+        output[y * width + x] = index;
     }
+};
+
+// One palette mapping pass, whatever the search
+struct PaletteMapping
+{
+    const uint16_t *source;
+    uint8_t *output;
+    int width;
+    int height;
+    int dithering;
+    int pixelSize;
+    int bayerSize;
+    int bayerDivisor;
+};
+
+template <typename Search>
+struct PaletteBandContext
+{
+    PaletteMapping mapping;
+    Search search;
+};
+
+static RowBandFilter paletteBands = {"Palette", true, 0, {}, nullptr};
+static RowBandFilter floydSteinbergWavefront = {"FS wavefront", false, 0, {}, nullptr};
+
+// Map one row band to the palette without dithering or with an ordered (Bayer / blue noise) threshold
+template <typename Search>
+static void paletteBand(const RowBand &band, void *ctx)
+{
+    const PaletteBandContext<Search> &context = *(const PaletteBandContext<Search> *)ctx;
+    const PaletteMapping &c = context.mapping;
+    const int width = c.width;
+    const int pixelSize = c.pixelSize;
+    const int bayerSize = c.bayerSize;
+    const int bayerDivisor = c.bayerDivisor;
 
     // GC0308 outputs RGB565 little-endian frames, so no byte swapping is required.
     const bool swapBytes = true;
-    const int origWidth = width;
-    const int origHeight = height;
-    const int downscale = (pixelSize == 2 || pixelSize == 4 || pixelSize == 8) ? pixelSize : 1;
 
     // Bayer matrix definitions
     const int bayer2x2[2][2] = {
@@ -552,191 +508,37 @@ void applyColorPalette(uint16_t *imageBuffer, int width, int height, const uint3
         {63, 31, 55, 23, 61, 29, 53, 21}
     };
 
-    // Clamp bayerSize to valid values
-    if (bayerSize != 2 && bayerSize != 4 && bayerSize != 8)
+    for (int y = band.y0; y < band.y1; y++)
     {
-        bayerSize = 4; // Default to 4x4
-    }
-
-    int bayerDivisor = (bayerSize == 2) ? 4 : (bayerSize == 4) ? 16 : 64;
+        for (int x = 0; x < width; x++)
+        {
+            int idx = y * width + x;
 
-    // Downscale if requested (2x2, 4x4, 8x8)
-    uint16_t *workingBuffer = imageBuffer;
-    int workWidth = width;
-    int workHeight = height;
-    bool usedDownscale = false;
-    uint16_t *downscaledBuffer = nullptr;
+            // Determine which pixel to sample (block center for pixelation, or current pixel)
+            int sampleIdx = idx;
+            if (pixelSize > 1)
+            {
+                int blockX = (x / pixelSize) * pixelSize + pixelSize / 2;
+                int blockY = (y / pixelSize) * pixelSize + pixelSize / 2;
+                blockX = constrain(blockX, 0, width - 1);
+                blockY = constrain(blockY, 0, c.height - 1);
+                sampleIdx = blockY * width + blockX;
+            }
 
-    if (downscale > 1)
-    {
-        workWidth = (width + downscale - 1) / downscale;
-        workHeight = (height + downscale - 1) / downscale;
-        downscaledBuffer = (uint16_t *)ps_malloc(workWidth * workHeight * sizeof(uint16_t));
-        if (!downscaledBuffer)
-        {
-            return;
-        }
+            uint16_t pixel = c.source[sampleIdx];
 
-        for (int by = 0; by < height; by += downscale)
-        {
-            for (int bx = 0; bx < width; bx += downscale)
+            if (swapBytes)
             {
-                uint32_t sumR = 0, sumG = 0, sumB = 0;
-                int count = 0;
-                for (int dy = 0; dy < downscale && (by + dy) < height; ++dy)
-                {
-                    for (int dx = 0; dx < downscale && (bx + dx) < width; ++dx)
-                    {
-                        int srcIdx = (by + dy) * width + (bx + dx);
-                        uint16_t px = imageBuffer[srcIdx];
-                        if (swapBytes)
-                        {
-                            px = ((px << 8) | (px >> 8));
-                        }
-                        uint8_t r = ((px >> 11) & 0x1F) << 3;
-                        uint8_t g = ((px >> 5) & 0x3F) << 2;
-                        uint8_t b = (px & 0x1F) << 3;
-                        sumR += r;
-                        sumG += g;
-                        sumB += b;
-                        ++count;
-                    }
-                }
+                pixel = ((pixel << 8) | (pixel >> 8));
+            }
 
-                uint8_t avgR = count ? (sumR / count) : 0;
-                uint8_t avgG = count ? (sumG / count) : 0;
-                uint8_t avgB = count ? (sumB / count) : 0;
-
-                uint16_t avgPixel = ((avgR >> 3) << 11) | ((avgG >> 2) << 5) | (avgB >> 3);
-                if (swapBytes)
-                {
-                    avgPixel = ((avgPixel << 8) | (avgPixel >> 8));
-                }
-
-                int dstIdx = (by / downscale) * workWidth + (bx / downscale);
-                downscaledBuffer[dstIdx] = avgPixel;
-            }
-        }
-
-        workingBuffer = downscaledBuffer;
-        usedDownscale = true;
-        pixelSize = 1; // internal processing uses native resolution
-    }
-
-    // Allocate memory using PSRAM for buffers
-    uint16_t *outputBuffer = (uint16_t *)ps_malloc(workWidth * workHeight * sizeof(uint16_t));
-    float *redErrorBuffer = nullptr;
-    float *greenErrorBuffer = nullptr;
-    float *blueErrorBuffer = nullptr;
-
-    if (!outputBuffer)
-    {
-        if (downscaledBuffer)
-        {
-            free(downscaledBuffer);
-        }
-        return;
-    }
-
-    // Allocate error buffers only if Floyd-Steinberg dithering is enabled
-    if (dithering == 1)
-    {
-        redErrorBuffer = (float *)ps_malloc(workWidth * workHeight * sizeof(float));
-        greenErrorBuffer = (float *)ps_malloc(workWidth * workHeight * sizeof(float));
-        blueErrorBuffer = (float *)ps_malloc(workWidth * workHeight * sizeof(float));
-
-        if (!redErrorBuffer || !greenErrorBuffer || !blueErrorBuffer)
-        {
-            if (outputBuffer)
-            if (redErrorBuffer)
-                free(redErrorBuffer);
-            if (greenErrorBuffer)
-                free(greenErrorBuffer);
-            if (blueErrorBuffer)
-                free(blueErrorBuffer);
-            if (downscaledBuffer)
-                free(downscaledBuffer);
-            return;
-        }
-    }
-
-    // Initialize error buffers with original pixel values (only if Floyd-Steinberg is enabled)
-    if (dithering == 1)
-    {
-        for (int i = 0; i < workWidth * workHeight; i++)
-        {
-            uint16_t pixel = workingBuffer[i];
-
-            if (swapBytes)
-            {
-                pixel = ((pixel << 8) | (pixel >> 8));
-            }
-
-            // Extract RGB components from RGB565 format
-            redErrorBuffer[i] = ((pixel >> 11) & 0x1F) << 3;  // 5 bits to 8 bits
-            greenErrorBuffer[i] = ((pixel >> 5) & 0x3F) << 2; // 6 bits to 8 bits
-            blueErrorBuffer[i] = (pixel & 0x1F) << 3;         // 5 bits to 8 bits
-        }
-    }
-
-    // Precalculate error distribution factors for Floyd-Steinberg dithering
-    const float f7_16 = 7.0f / 16.0f;
-    const float f3_16 = 3.0f / 16.0f;
-    const float f5_16 = 5.0f / 16.0f;
-    const float f1_16 = 1.0f / 16.0f;
-
-    // Process each pixel
-    for (int y = 0; y < workHeight; y++)
-    {
-        bool leftToRight = (y % 2 == 0);
-        int xStart = leftToRight ? 0 : workWidth - 1;
-        int xEnd = leftToRight ? workWidth : -1;
-        int xStep = leftToRight ? 1 : -1;
-
-        for (int x = xStart; x != xEnd; x += xStep)
-        {
-            int idx = y * workWidth + x;
-
-            // Get current pixel color
-            uint8_t r, g, b;
-
-            // Determine which pixel to sample (block center for pixelation, or current pixel)
-            int sampleIdx = idx;
-            if (pixelSize > 1)
-            {
-                int blockX = (x / pixelSize) * pixelSize + pixelSize / 2;
-                int blockY = (y / pixelSize) * pixelSize + pixelSize / 2;
-                blockX = constrain(blockX, 0, workWidth - 1);
-                blockY = constrain(blockY, 0, workHeight - 1);
-                sampleIdx = blockY * workWidth + blockX;
-            }
-
-            // Get color from appropriate source (error buffer for Floyd-Steinberg, image buffer otherwise)
-            if (dithering == 1)
-            {
-                // Floyd-Steinberg uses error buffers
-                r = constrain(round(redErrorBuffer[sampleIdx]), 0, 255);
-                g = constrain(round(greenErrorBuffer[sampleIdx]), 0, 255);
-                b = constrain(round(blueErrorBuffer[sampleIdx]), 0, 255);
-            }
-            else
-            {
-                // Bayer and no dithering use image buffer directly
-                uint16_t pixel = workingBuffer[sampleIdx];
-
-                if (swapBytes)
-                {
-                    pixel = ((pixel << 8) | (pixel >> 8));
-                }
-
-                // Extract RGB components from RGB565 format
-                r = ((pixel >> 11) & 0x1F) << 3; // 5 bits to 8 bits
-                g = ((pixel >> 5) & 0x3F) << 2;  // 6 bits to 8 bits
-                b = (pixel & 0x1F) << 3;         // 5 bits to 8 bits
-            }
+            // Extract RGB components from RGB565 format
+            uint8_t r = ((pixel >> 11) & 0x1F) << 3; // 5 bits to 8 bits
+            uint8_t g = ((pixel >> 5) & 0x3F) << 2;  // 6 bits to 8 bits
+            uint8_t b = (pixel & 0x1F) << 3;         // 5 bits to 8 bits
 
             // Apply Bayer threshold if using Bayer dithering
-            if (dithering == 2)
+            if (c.dithering == 2)
             {
                 // Get Bayer threshold value based on matrix size
                 // Use block center coordinates for pixelation to ensure uniform blocks
@@ -776,165 +578,427 @@ void applyColorPalette(uint16_t *imageBuffer, int width, int height, const uint3
                 g = constrain(g + threshold - 127.5f, 0, 255);
                 b = constrain(b + threshold - 127.5f, 0, 255);
             }
+            else if (c.dithering == 3)
+            {
+                // Blue-noise threshold, sampled at the block center like Bayer so blocks stay uniform
+                int noiseX = x;
+                int noiseY = y;
+                if (pixelSize > 1)
+                {
+                    noiseX = (x / pixelSize) * pixelSize + pixelSize / 2;
+                    noiseY = (y / pixelSize) * pixelSize + pixelSize / 2;
+                }
+                int noise = BLUE_NOISE_64X64[(noiseY & BLUE_NOISE_MASK) * BLUE_NOISE_SIZE + (noiseX & BLUE_NOISE_MASK)];
+
+                // Same +/-127.5 threshold span as the Bayer path, in integer arithmetic
+                r = constrain(r + noise - 128, 0, 255);
+                g = constrain(g + noise - 128, 0, 255);
+                b = constrain(b + noise - 128, 0, 255);
+            }
 
             // Find the closest color in the palette
-            int minDistance = INT_MAX;
-            int closestIndex = 0;
+            c.output[idx] = context.search.nearest(r, g, b);
+        }
+    }
+}
 
-            for (int j = 0; j < paletteSize; j++)
-            {
-                uint32_t paletteColor = palette[j];
-                uint8_t pr = (paletteColor >> 16) & 0xFF;
-                uint8_t pg = (paletteColor >> 8) & 0xFF;
-                uint8_t pb = paletteColor & 0xFF;
+/**
+ * Map the working frame to palette indices with one search
+ *
+ * @return false if error diffusion ran out of memory
+ */
+template <typename Search>
+static bool mapToPalette(const PaletteMapping &mapping, const Search &search)
+{
+    if (isDiffusionDither(mapping.dithering))
+    {
+        // Error diffusion (Floyd-Steinberg, Atkinson, Sierra Lite, Stucki, JJN). Floyd-Steinberg
+        // scans in raster order so both cores can diffuse it as a wavefront; the others keep
+        // serpentine scanning on one core
+        PaletteQuantizer<Search> quantizer = {mapping.source, mapping.output, mapping.width, search};
+        return (mapping.dithering == 1)
+                   ? diffuseErrorsWavefront<FloydSteinbergKernel>(mapping.width, mapping.height, quantizer, floydSteinbergWavefront)
+                   : diffuseErrorsWith(mapping.dithering, mapping.width, mapping.height, quantizer);
+    }
 
-                int distance = colorDistance(r, g, b, pr, pg, pb);
+    // No dithering or ordered dithering: every pixel is independent, so split the
+    // rows across both cores (bands start on pixel-block boundaries)
+    PaletteBandContext<Search> ctx = {mapping, search};
+    parallelForRows(paletteBands, mapping.height, mapping.pixelSize, paletteBand<Search>, &ctx);
+    return true;
+}
 
-                if (distance < minDistance)
-                {
-                    minDistance = distance;
-                    closestIndex = j;
-                }
-            }
+template <size_t N>
+static bool mapToPaletteTable(const PaletteMapping &mapping, const PaletteTableView &table)
+{
+    PaletteTableSearch<N> search = {&table, table.r, table.g, table.b};
+    return mapToPalette(mapping, search);
+}
 
-            // Get the closest palette color
-            uint32_t closestColor = palette[closestIndex];
-            uint8_t newR = (closestColor >> 16) & 0xFF;
-            uint8_t newG = (closestColor >> 8) & 0xFF;
-            uint8_t newB = closestColor & 0xFF;
+typedef bool (*PaletteTableMapper)(const PaletteMapping &mapping, const PaletteTableView &table);
 
-            // Calculate quantization error (only if Floyd-Steinberg is enabled)
-            float errorR = 0, errorG = 0, errorB = 0;
-            if (dithering == 1)
-            {
-                errorR = r - newR;
-                errorG = g - newG;
-                errorB = b - newB;
-            }
+// The unrolled scan for a built-in palette size, nullptr for sizes that go through
+// PaletteIndex. Only 2 entries beat the index in the golden nearest-color timings; at 4
+// the grid's one or two candidates per cell already cost less than every distance
+static PaletteTableMapper paletteTableMapper(int size)
+{
+    switch (size)
+    {
+    case 2:
+        return mapToPaletteTable<2>;
+    default:
+        return nullptr;
+    }
+}
 
-            // Convert back to RGB565 format
-            uint8_t r5 = newR >> 3; // Convert 8-bit to 5-bit (for red)
-            uint8_t g6 = newG >> 2; // Convert 8-bit to 6-bit (for green)
-            uint8_t b5 = newB >> 3; // Convert 8-bit to 5-bit (for blue)
+/**
+ * Band alignment for applyColorPalette
+ *
+ * Ordered thresholds repeat every matrix (or noise tile) of pixel blocks, so bands that
+ * start on a multiple of that period give exactly the whole-frame result. Error
+ * diffusion carries error from row to row and cannot be split.
+ *
+ * @param dithering Dithering algorithm, as for applyColorPalette
+ * @param pixelSize Pixelation size
+ * @param bayerSize Bayer matrix size
+ * @return Band alignment in rows, 0 if the frame must be processed in one piece
+ */
+int colorPaletteBandAlign(int dithering, int pixelSize, int bayerSize)
+{
+    if (isDiffusionDither(dithering))
+    {
+        return 0;
+    }
 
-            uint16_t newPixel = (r5 << 11) | (g6 << 5) | b5;
+    if (bayerSize != 2 && bayerSize != 4 && bayerSize != 8)
+    {
+        bayerSize = 4;
+    }
 
-            if (swapBytes)
-            {
-                newPixel = ((newPixel << 8) | (newPixel >> 8));
-            }
+    int pattern = (dithering == 2) ? bayerSize : (dithering == 3) ? BLUE_NOISE_SIZE : 1;
+    return pattern * max(pixelSize, 1);
+}
 
-            outputBuffer[idx] = newPixel;
+//////////////////////////////////////////////////////////////////////////////////////////
 
-            // Distribute error to neighboring pixels using Floyd-Steinberg algorithm (only if Floyd-Steinberg is enabled)
-            if (dithering == 1)
-            {
-                if (leftToRight)
-                {
-                    // Left to right pattern
-                    if (x + 1 < workWidth)
-                    {
-                        redErrorBuffer[idx + 1] += errorR * f7_16;
-                        greenErrorBuffer[idx + 1] += errorG * f7_16;
-                        blueErrorBuffer[idx + 1] += errorB * f7_16;
-                    }
+void buildPaletteLut565(const uint32_t *palette, int paletteSize, uint16_t *lut, bool frameOrder)
+{
+    paletteSize = constrain(paletteSize, 0, PALETTE_INDEX_MAX);
+    const PaletteTableView *table = builtinPaletteTable(palette, paletteSize);
+    if (table)
+    {
+        memcpy(lut, frameOrder ? table->frame565 : table->native565, paletteSize * sizeof(uint16_t));
+        return;
+    }
+    for (int i = 0; i < paletteSize; i++)
+    {
+        uint32_t color = palette[i];
+        uint16_t pixel = (((color >> 16) & 0xF8) << 8) | (((color >> 8) & 0xFC) << 3) | ((color & 0xFF) >> 3);
+        lut[i] = frameOrder ? ((pixel << 8) | (pixel >> 8)) : pixel;
+    }
+}
 
-                    if (y + 1 < workHeight)
-                    {
-                        int nextRow = (y + 1) * workWidth;
+void expandPaletteIndices(const uint8_t *indices, uint16_t *pixels, size_t count, const uint16_t *lut)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        pixels[i] = lut[indices[i]];
+    }
+}
 
-                        if (x - 1 >= 0)
-                        {
-                            redErrorBuffer[nextRow + x - 1] += errorR * f3_16;
-                            greenErrorBuffer[nextRow + x - 1] += errorG * f3_16;
-                            blueErrorBuffer[nextRow + x - 1] += errorB * f3_16;
-                        }
+/**
+ * What quantizeToPalette searches a palette with: the unrolled scan over its compile-time
+ * table, or else its cached PaletteIndex (built here on first use)
+ *
+ * @return false if the palette is empty or the index could not be built
+ */
+static bool paletteSearchFor(const uint32_t *palette, int paletteSize, int matching, const PaletteTableView *&table,
+                             PaletteTableMapper &tableMapper, const PaletteIndex *&index)
+{
+    // Two-color built-in palettes matched by RGB need no index: their tables were made while compiling
+    table = (matching == PALETTE_MATCH_RGB) ? builtinPaletteTable(palette, paletteSize) : nullptr;
+    tableMapper = table ? paletteTableMapper(table->size) : nullptr;
+    index = tableMapper ? nullptr : paletteIndexFor(palette, paletteSize, matching);
+    return tableMapper || index;
+}
 
-                        redErrorBuffer[nextRow + x] += errorR * f5_16;
-                        greenErrorBuffer[nextRow + x] += errorG * f5_16;
-                        blueErrorBuffer[nextRow + x] += errorB * f5_16;
+/**
+ * Map a frame to palette indices with optional dithering
+ *
+ * Pixel sizes 2, 4 and 8 are quantized at the reduced resolution: the returned indices
+ * then cover ceil(width / downscale) x ceil(height / downscale) blocks, and the caller
+ * repeats each one over its block.
+ *
+ * @param target Where full-resolution indices may be written directly (nullptr: allocate)
+ * @param downscale Set to the block size the indices were quantized at (1 = per pixel)
+ * @return The indices (target or a PSRAM buffer the caller frees), nullptr on failure
+ */
+static uint8_t *quantizeToPalette(const uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize,
+                                  int dithering, int pixelSize, int bayerSize, int matching, uint8_t *target, int &downscale)
+{
+    if (!psramFound() || !palette || paletteSize <= 0)
+    {
+        return nullptr;
+    }
+    paletteSize = min(paletteSize, PALETTE_INDEX_MAX);
 
-                        if (x + 1 < workWidth)
-                        {
-                            redErrorBuffer[nextRow + x + 1] += errorR * f1_16;
-                            greenErrorBuffer[nextRow + x + 1] += errorG * f1_16;
-                            blueErrorBuffer[nextRow + x + 1] += errorB * f1_16;
-                        }
-                    }
-                }
-                else
-                {
-                    // Right to left pattern
-                    if (x - 1 >= 0)
-                    {
-                        redErrorBuffer[idx - 1] += errorR * f7_16;
-                        greenErrorBuffer[idx - 1] += errorG * f7_16;
-                        blueErrorBuffer[idx - 1] += errorB * f7_16;
-                    }
+    const PaletteTableView *table;
+    PaletteTableMapper tableMapper;
+    const PaletteIndex *index;
+    if (!paletteSearchFor(palette, paletteSize, matching, table, tableMapper, index))
+    {
+        return nullptr;
+    }
 
-                    if (y + 1 < workHeight)
-                    {
-                        int nextRow = (y + 1) * workWidth;
+    // GC0308 outputs RGB565 little-endian frames, so no byte swapping is required.
+    const bool swapBytes = true;
+    downscale = (pixelSize == 2 || pixelSize == 4 || pixelSize == 8) ? pixelSize : 1;
 
-                        if (x + 1 < workWidth)
-                        {
-                            redErrorBuffer[nextRow + x + 1] += errorR * f3_16;
-                            greenErrorBuffer[nextRow + x + 1] += errorG * f3_16;
-                            blueErrorBuffer[nextRow + x + 1] += errorB * f3_16;
-                        }
+    // Clamp bayerSize to valid values
+    if (bayerSize != 2 && bayerSize != 4 && bayerSize != 8)
+    {
+        bayerSize = 4; // Default to 4x4
+    }
+
+    int bayerDivisor = (bayerSize == 2) ? 4 : (bayerSize == 4) ? 16 : 64;
+
+    // Downscale if requested (2x2, 4x4, 8x8)
+    const uint16_t *workingBuffer = imageBuffer;
+    int workWidth = width;
+    int workHeight = height;
+    uint16_t *downscaledBuffer = nullptr;
 
-                        redErrorBuffer[nextRow + x] += errorR * f5_16;
-                        greenErrorBuffer[nextRow + x] += errorG * f5_16;
-                        blueErrorBuffer[nextRow + x] += errorB * f5_16;
+    if (downscale > 1)
+    {
+        workWidth = (width + downscale - 1) / downscale;
+        workHeight = (height + downscale - 1) / downscale;
+        downscaledBuffer = (uint16_t *)ps_malloc(workWidth * workHeight * sizeof(uint16_t));
+        if (!downscaledBuffer)
+        {
+            return nullptr;
+        }
 
-                        if (x - 1 >= 0)
+        for (int by = 0; by < height; by += downscale)
+        {
+            for (int bx = 0; bx < width; bx += downscale)
+            {
+                uint32_t sumR = 0, sumG = 0, sumB = 0;
+                int count = 0;
+                for (int dy = 0; dy < downscale && (by + dy) < height; ++dy)
+                {
+                    for (int dx = 0; dx < downscale && (bx + dx) < width; ++dx)
+                    {
+                        int srcIdx = (by + dy) * width + (bx + dx);
+                        uint16_t px = imageBuffer[srcIdx];
+                        if (swapBytes)
                         {
-                            redErrorBuffer[nextRow + x - 1] += errorR * f1_16;
-                            greenErrorBuffer[nextRow + x - 1] += errorG * f1_16;
-                            blueErrorBuffer[nextRow + x - 1] += errorB * f1_16;
+                            px = ((px << 8) | (px >> 8));
                         }
+                        uint8_t r = ((px >> 11) & 0x1F) << 3;
+                        uint8_t g = ((px >> 5) & 0x3F) << 2;
+                        uint8_t b = (px & 0x1F) << 3;
+                        sumR += r;
+                        sumG += g;
+                        sumB += b;
+                        ++count;
                     }
                 }
+
+                uint8_t avgR = count ? (sumR / count) : 0;
+                uint8_t avgG = count ? (sumG / count) : 0;
+                uint8_t avgB = count ? (sumB / count) : 0;
+
+                uint16_t avgPixel = ((avgR >> 3) << 11) | ((avgG >> 2) << 5) | (avgB >> 3);
+                if (swapBytes)
+                {
+                    avgPixel = ((avgPixel << 8) | (avgPixel >> 8));
+                }
+
+                int dstIdx = (by / downscale) * workWidth + (bx / downscale);
+                downscaledBuffer[dstIdx] = avgPixel;
             }
         }
+
+        workingBuffer = downscaledBuffer;
+        pixelSize = 1; // internal processing uses native resolution
+    }
+
+    // One index byte per working pixel, in PSRAM unless the caller's buffer fits exactly
+    uint8_t *outputBuffer = (downscale == 1 && target) ? target : (uint8_t *)ps_malloc(workWidth * workHeight);
+
+    if (!outputBuffer)
+    {
+        if (downscaledBuffer)
+        {
+            free(downscaledBuffer);
+        }
+        return nullptr;
+    }
+
+    PaletteMapping mapping = {workingBuffer, outputBuffer, workWidth, workHeight, dithering, pixelSize, bayerSize, bayerDivisor};
+    bool mapped = false;
+    if (tableMapper)
+    {
+        mapped = tableMapper(mapping, *table);
+    }
+    else
+    {
+        PaletteIndexSearch search = {index, index->r, index->g, index->b};
+        mapped = mapToPalette(mapping, search);
+    }
+    if (!mapped)
+    {
+        if (outputBuffer != target)
+        {
+            free(outputBuffer);
+        }
+        if (downscaledBuffer)
+        {
+            free(downscaledBuffer);
+        }
+        return nullptr;
     }
 
-    // Copy the processed image back to the input buffer (with optional upscale)
-    if (usedDownscale)
+    if (downscaledBuffer)
     {
-        for (int y = 0; y < origHeight; ++y)
+        free(downscaledBuffer);
+    }
+    return outputBuffer;
+}
+
+/**
+ * Apply color palette with optional dithering
+ *
+ * @param imageBuffer Pointer to image buffer
+ * @param width Image width
+ * @param height Image height
+ * @param palette Pointer to palette array
+ * @param paletteSize Number of colors in palette
+ * @param dithering Dithering algorithm: 0=OFF, 1=Floyd-Steinberg, 2=Bayer, 3=Blue noise,
+ *                  4=Atkinson, 5=Sierra Lite, 6=Stucki, 7=Jarvis-Judice-Ninke
+ * @param pixelSize Pixelation size (1 = no pixelation)
+ * @param bayerSize Bayer matrix size (2, 4, or 8) - only used when dithering = 2
+ * @param matching Color distance for the nearest entry, PALETTE_MATCH_RGB or PALETTE_MATCH_OKLAB
+ */
+void applyColorPalette(uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize, int dithering, int pixelSize, int bayerSize, int matching)
+{
+    int downscale = 1;
+    uint8_t *indices = quantizeToPalette(imageBuffer, width, height, palette, paletteSize, dithering, pixelSize, bayerSize, matching, nullptr, downscale);
+    if (!indices)
+    {
+        return;
+    }
+
+    // Built-in palettes come with their frame-order colors ready
+    uint16_t builtLut[PALETTE_INDEX_MAX];
+    const PaletteTableView *table = builtinPaletteTable(palette, paletteSize);
+    const uint16_t *lut = table ? table->frame565 : builtLut;
+    if (!table)
+    {
+        buildPaletteLut565(palette, paletteSize, builtLut, true);
+    }
+
+    // Expand the indices back into the input buffer (with optional upscale)
+    if (downscale > 1)
+    {
+        const int workWidth = (width + downscale - 1) / downscale;
+        for (int y = 0; y < height; ++y)
         {
-            int srcY = y / downscale;
-            for (int x = 0; x < origWidth; ++x)
+            const uint8_t *srcRow = indices + (y / downscale) * workWidth;
+            uint16_t *dstRow = imageBuffer + y * width;
+            for (int x = 0; x < width; ++x)
             {
-                int srcX = x / downscale;
-                int dstIdx = y * origWidth + x;
-                int srcIdx = srcY * workWidth + srcX;
-                imageBuffer[dstIdx] = outputBuffer[srcIdx];
+                dstRow[x] = lut[srcRow[x / downscale]];
             }
         }
     }
     else
     {
-        memcpy(imageBuffer, outputBuffer, workWidth * workHeight * sizeof(uint16_t));
+        expandPaletteIndices(indices, imageBuffer, (size_t)width * height, lut);
     }
 
-    // Free memory
-    free(outputBuffer);
-    if (dithering == 1)
+    free(indices);
+}
+
+/**
+ * Apply color palette with optional dithering, keeping the result as palette indices
+ *
+ * Same mapping as applyColorPalette, but the frame is left untouched and each pixel's
+ * palette index is written to indices instead, so the output can be handed on at one
+ * byte per pixel (expandPaletteIndices, an indexed PNG).
+ *
+ * @param imageBuffer Frame to quantize (frame order RGB565, not modified)
+ * @param indices Output, width * height bytes
+ * @return false if there was no memory for the working buffers
+ */
+bool applyColorPaletteIndexed(const uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize, uint8_t *indices, int dithering, int pixelSize, int bayerSize, int matching)
+{
+    if (!indices)
     {
-        free(redErrorBuffer);
-        free(greenErrorBuffer);
-        free(blueErrorBuffer);
+        return false;
     }
-    if (downscaledBuffer)
+
+    int downscale = 1;
+    uint8_t *blocks = quantizeToPalette(imageBuffer, width, height, palette, paletteSize, dithering, pixelSize, bayerSize, matching, indices, downscale);
+    if (!blocks)
     {
-        free(downscaledBuffer);
+        return false;
     }
+
+    if (blocks != indices)
+    {
+        // Repeat each block's index over its pixels
+        const int workWidth = (width + downscale - 1) / downscale;
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t *srcRow = blocks + (y / downscale) * workWidth;
+            uint8_t *dstRow = indices + y * width;
+            for (int x = 0; x < width; ++x)
+            {
+                dstRow[x] = srcRow[x / downscale];
+            }
+        }
+        free(blocks);
+    }
+    return true;
+}
+
+bool prepareColorPalette(const uint32_t *palette, int paletteSize, int matching)
+{
+    if (!palette || paletteSize <= 0)
+    {
+        return false;
+    }
+
+    const PaletteTableView *table;
+    PaletteTableMapper tableMapper;
+    const PaletteIndex *index;
+    return paletteSearchFor(palette, min(paletteSize, PALETTE_INDEX_MAX), matching, table, tableMapper, index);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// Error-diffusion quantizer for createSmallDitheredImage: 1-bit black/white from a grayscale buffer
+struct MonochromeQuantizer
+{
+    const uint8_t *gray;
+    uint16_t *output;
+    int width;
+
+    inline void load(int x, int y, int &r, int &g, int &b)
+    {
+        r = g = b = gray[y * width + x];
+    }
+
+    inline void quantize(int x, int y, int &r, int &g, int &b)
+    {
+        // Quantize to 1-bit (0 or 255); white and black are the same after byte swapping
+        bool white = r >= 128;
+        r = g = b = white ? 255 : 0;
+        output[y * width + x] = white ? 0xFFFF : 0x0000;
+    }
+};
+
 /**
  * Create a downscaled 128x64 version of the camera image with 1-bit dithering
  *
@@ -959,153 +1023,56 @@ uint16_t *createSmallDitheredImage(camera_fb_t *cameraFb)
 
     // Allocate buffers
     uint16_t *outputBuffer = (uint16_t *)ps_malloc(targetWidth * targetHeight * sizeof(uint16_t));
-    float *errorBuffer = (float *)ps_malloc(targetWidth * targetHeight * sizeof(float));
+    uint8_t *grayBuffer = (uint8_t *)ps_malloc(targetWidth * targetHeight * sizeof(uint8_t));
 
-    if (!outputBuffer || !errorBuffer)
+    if (!outputBuffer || !grayBuffer)
     {
         if (outputBuffer)
             free(outputBuffer);
-        if (errorBuffer)
-            free(errorBuffer);
+        if (grayBuffer)
+            free(grayBuffer);
         return nullptr;
     }
 
-    // Calculate scaling factors
-    float scaleX = (float)srcWidth / targetWidth;
-    float scaleY = (float)srcHeight / targetHeight;
-
-    // Downsample and convert to grayscale, storing in error buffer
-    for (int y = 0; y < targetHeight; y++)
+    // Area-average into the output buffer first; dithering overwrites it afterwards
+    if (!resampleImage(srcBuffer, srcWidth, srcHeight, outputBuffer, targetWidth, targetHeight, RESAMPLE_BOX))
     {
-        for (int x = 0; x < targetWidth; x++)
-        {
-            // Calculate source coordinates (center of the scaled region)
-            int srcX = (int)((x + 0.5f) * scaleX);
-            int srcY = (int)((y + 0.5f) * scaleY);
-
-            // Clamp to valid range
-            srcX = constrain(srcX, 0, srcWidth - 1);
-            srcY = constrain(srcY, 0, srcHeight - 1);
-
-            int srcIdx = srcY * srcWidth + srcX;
-            uint16_t pixel = srcBuffer[srcIdx];
-
-            if (swapBytes)
-            {
-                pixel = ((pixel << 8) | (pixel >> 8));
-            }
-
-            // Extract RGB and convert to grayscale
-            uint8_t r = ((pixel >> 11) & 0x1F) << 3;
-            uint8_t g = ((pixel >> 5) & 0x3F) << 2;
-            uint8_t b = (pixel & 0x1F) << 3;
-
-            // Standard luminance formula
-            float gray = (r * 0.299f + g * 0.587f + b * 0.114f);
-
-            int idx = y * targetWidth + x;
-            errorBuffer[idx] = gray;
-        }
+        free(outputBuffer);
+        free(grayBuffer);
+        return nullptr;
     }
 
-    // Apply Floyd-Steinberg dithering for 1-bit (black and white)
-    const float f7_16 = 7.0f / 16.0f;
-    const float f3_16 = 3.0f / 16.0f;
-    const float f5_16 = 5.0f / 16.0f;
-    const float f1_16 = 1.0f / 16.0f;
-    const float threshold = 128.0f;
-
-    for (int y = 0; y < targetHeight; y++)
+    // Convert to grayscale
+    for (int i = 0; i < targetWidth * targetHeight; i++)
     {
-        bool leftToRight = (y % 2 == 0);
-        int xStart = leftToRight ? 0 : targetWidth - 1;
-        int xEnd = leftToRight ? targetWidth : -1;
-        int xStep = leftToRight ? 1 : -1;
+        uint16_t pixel = outputBuffer[i];
 
-        for (int x = xStart; x != xEnd; x += xStep)
+        if (swapBytes)
         {
-            int idx = y * targetWidth + x;
-
-            float oldPixel = errorBuffer[idx];
-
-            // Quantize to 1-bit (0 or 255)
-            uint8_t newPixel = (oldPixel >= threshold) ? 255 : 0;
-
-            // Calculate error
-            float error = oldPixel - newPixel;
-
-            // Convert to RGB565 (black or white)
-            uint16_t color;
-            if (newPixel == 255)
-            {
-                color = 0xFFFF; // White
-            }
-            else
-            {
-                color = 0x0000; // Black
-            }
-
-            if (swapBytes)
-            {
-                color = ((color << 8) | (color >> 8));
-            }
-
-            outputBuffer[idx] = color;
-
-            // Distribute error to neighboring pixels
-            if (leftToRight)
-            {
-                if (x + 1 < targetWidth)
-                {
-                    errorBuffer[idx + 1] += error * f7_16;
-                }
-
-                if (y + 1 < targetHeight)
-                {
-                    int nextRow = (y + 1) * targetWidth;
-
-                    if (x - 1 >= 0)
-                    {
-                        errorBuffer[nextRow + x - 1] += error * f3_16;
-                    }
-
-                    errorBuffer[nextRow + x] += error * f5_16;
-
-                    if (x + 1 < targetWidth)
-                    {
-                        errorBuffer[nextRow + x + 1] += error * f1_16;
-                    }
-                }
-            }
-            else
-            {
-                if (x - 1 >= 0)
-                {
-                    errorBuffer[idx - 1] += error * f7_16;
-                }
+            pixel = ((pixel << 8) | (pixel >> 8));
+        }
 
-                if (y + 1 < targetHeight)
-                {
-                    int nextRow = (y + 1) * targetWidth;
+        // Extract RGB and convert to grayscale
+        uint8_t r = ((pixel >> 11) & 0x1F) << 3;
+        uint8_t g = ((pixel >> 5) & 0x3F) << 2;
+        uint8_t b = (pixel & 0x1F) << 3;
 
-                    if (x + 1 < targetWidth)
-                    {
-                        errorBuffer[nextRow + x + 1] += error * f3_16;
-                    }
+        // Standard luminance formula
+        grayBuffer[i] = (r * 299 + g * 587 + b * 114) / 1000;
+    }
 
-                    errorBuffer[nextRow + x] += error * f5_16;
+    // Apply Floyd-Steinberg dithering for 1-bit (black and white)
+    MonochromeQuantizer quantizer = {grayBuffer, outputBuffer, targetWidth};
+    bool ok = diffuseErrors<FloydSteinbergKernel>(targetWidth, targetHeight, quantizer);
 
-                    if (x - 1 >= 0)
-                    {
-                        errorBuffer[nextRow + x - 1] += error * f1_16;
-                    }
-                }
-            }
-        }
-    }
+    // Free grayscale buffer
+    free(grayBuffer);
 
-    // Free error buffer
-    free(errorBuffer);
+    if (!ok)
+    {
+        free(outputBuffer);
+        return nullptr;
+    }
 
     return outputBuffer;
 }
@@ -1135,52 +1102,26 @@ void reduceResolution(camera_fb_t *cameraFb, int targetWidth, int targetHeight)
     {
         return;
     }
-    
-    uint16_t *srcBuffer = (uint16_t *)cameraFb->buf;
 
-    // Allocate temporary buffer for downsampled image
-    uint16_t *outputBuffer = (uint16_t *)ps_malloc(targetWidth * targetHeight * sizeof(uint16_t));
-
-    if (!outputBuffer)
+    // The result is written back into the framebuffer, which cannot grow
+    if (targetWidth > srcWidth || targetHeight > srcHeight)
     {
         return;
     }
+    
+    uint16_t *srcBuffer = (uint16_t *)cameraFb->buf;
 
-    // Calculate scaling factors
-    float scaleX = (float)srcWidth / targetWidth;
-    float scaleY = (float)srcHeight / targetHeight;
-
-    // Downsample using nearest neighbor
-    for (int y = 0; y < targetHeight; y++)
+    // Area-average in place: when shrinking, each output row only overwrites pixels
+    // that have already been read
+    if (!resampleImage(srcBuffer, srcWidth, srcHeight, srcBuffer, targetWidth, targetHeight, RESAMPLE_BOX))
     {
-        for (int x = 0; x < targetWidth; x++)
-        {
-            // Calculate source coordinates (center of the scaled region)
-            int srcX = (int)((x + 0.5f) * scaleX);
-            int srcY = (int)((y + 0.5f) * scaleY);
-
-            // Clamp to valid range
-            srcX = constrain(srcX, 0, srcWidth - 1);
-            srcY = constrain(srcY, 0, srcHeight - 1);
-
-            int srcIdx = srcY * srcWidth + srcX;
-            int dstIdx = y * targetWidth + x;
-
-            // Copy pixel directly to maintain same format as source
-            outputBuffer[dstIdx] = srcBuffer[srcIdx];
-        }
+        return;
     }
 
-    // Copy downsampled image back to framebuffer
-    memcpy(srcBuffer, outputBuffer, targetWidth * targetHeight * sizeof(uint16_t));
-
     // Update framebuffer dimensions
     cameraFb->width = targetWidth;
     cameraFb->height = targetHeight;
     cameraFb->len = targetWidth * targetHeight * sizeof(uint16_t);
-
-    // Free temporary buffer
-    free(outputBuffer);
 }
 
 
@@ -1341,52 +1282,45 @@ void applyColorReduction(camera_fb_t *cameraFb)
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-/**
- * Apply Sobel edge detection filter to the camera frame buffer
- * Detects edges by computing gradients in X and Y directions
- * 
- * @param cameraFb Pointer to camera frame buffer
- * @param mode Edge detection mode: 1=Grayscale, 2=Color
- */
-void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
+
+struct EdgeBandContext
 {
-    if (!psramFound() || !cameraFb)
-    {
-        return;
-    }
+    const uint16_t *source;
+    uint16_t *output;
+    int width;
+    int height;
+    int mode;
+};
 
-    int width = cameraFb->width;
-    int height = cameraFb->height;
-    uint16_t *frameBuffer = (uint16_t *)cameraFb->buf;
-    int totalPixels = width * height;
+static RowBandFilter edgeBands = {"Edge", true, EDGE_DETECTION_HALO, {}, nullptr};
+
+// Sobel one row band from the untouched source into the output buffer
+static void edgeBand(const RowBand &band, void *ctx)
+{
+    const EdgeBandContext &c = *(const EdgeBandContext *)ctx;
+    const int width = c.width;
+    const int height = c.height;
 
     // GC0308 outputs RGB565 little-endian frames, so no byte swapping is required.
     const bool swapBytes = true;
 
-    // Allocate temporary buffer for edge-detected image
-    uint16_t *edgeBuffer = (uint16_t *)ps_malloc(totalPixels * sizeof(uint16_t));
-    if (!edgeBuffer)
-    {
-        return;
-    }
-
     // Sobel kernels for edge detection
     // Gx (horizontal edges)
-    int sobelX[3][3] = {
+    const int sobelX[3][3] = {
         {-1, 0, 1},
         {-2, 0, 2},
         {-1, 0, 1}
     };
     
     // Gy (vertical edges)
-    int sobelY[3][3] = {
+    const int sobelY[3][3] = {
         {-1, -2, -1},
         { 0,  0,  0},
         { 1,  2,  1}
     };
 
-    // Process each pixel
-    for (int y = 0; y < height; y++)
+    // Process each pixel of the band; the 3x3 window reads one row of halo from the source
+    for (int y = band.y0; y < band.y1; y++)
     {
         for (int x = 0; x < width; x++)
         {
@@ -1395,11 +1329,11 @@ void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
             // Skip border pixels
             if (x == 0 || x == width - 1 || y == 0 || y == height - 1)
             {
-                edgeBuffer[idx] = 0; // Black border
+                c.output[idx] = 0; // Black border
                 continue;
             }
 
-            if (mode == 1)
+            if (c.mode == 1)
             {
                 // Grayscale edge detection
                 int gx = 0, gy = 0;
@@ -1410,7 +1344,7 @@ void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
                     for (int kx = -1; kx <= 1; kx++)
                     {
                         int pixelIdx = (y + ky) * width + (x + kx);
-                        uint16_t pixel = frameBuffer[pixelIdx];
+                        uint16_t pixel = c.source[pixelIdx];
                         
                         if (swapBytes)
                         {
@@ -1450,9 +1384,9 @@ void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
                     rgb565 = ((rgb565 << 8) | (rgb565 >> 8));
                 }
                 
-                edgeBuffer[idx] = rgb565;
+                c.output[idx] = rgb565;
             }
-            else if (mode == 2)
+            else if (c.mode == 2)
             {
                 // Color edge detection - apply Sobel to each channel separately
                 int gx_r = 0, gy_r = 0;
@@ -1465,7 +1399,7 @@ void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
                     for (int kx = -1; kx <= 1; kx++)
                     {
                         int pixelIdx = (y + ky) * width + (x + kx);
-                        uint16_t pixel = frameBuffer[pixelIdx];
+                        uint16_t pixel = c.source[pixelIdx];
                         
                         if (swapBytes)
                         {
@@ -1516,26 +1450,20 @@ void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
                     rgb565 = ((rgb565 << 8) | (rgb565 >> 8));
                 }
                 
-                edgeBuffer[idx] = rgb565;
+                c.output[idx] = rgb565;
             }
         }
     }
-
-    // Copy edge-detected image back to frame buffer
-    memcpy(frameBuffer, edgeBuffer, totalPixels * sizeof(uint16_t));
-
-    // Free temporary buffer
-    free(edgeBuffer);
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Auto-adjust brightness, contrast, and gamma based on histogram analysis
- * Analyzes the image and applies optimal adjustments
+ * Apply Sobel edge detection filter to the camera frame buffer
+ * Detects edges by computing gradients in X and Y directions
  * 
  * @param cameraFb Pointer to camera frame buffer
+ * @param mode Edge detection mode: 1=Grayscale, 2=Color
  */
-void applyAutoAdjust(camera_fb_t *cameraFb)
+void applyEdgeDetection(camera_fb_t *cameraFb, int mode)
 {
     if (!psramFound() || !cameraFb)
     {
@@ -1547,27 +1475,81 @@ void applyAutoAdjust(camera_fb_t *cameraFb)
     uint16_t *frameBuffer = (uint16_t *)cameraFb->buf;
     int totalPixels = width * height;
 
+    // Allocate temporary buffer for edge-detected image
+    uint16_t *edgeBuffer = (uint16_t *)ps_malloc(totalPixels * sizeof(uint16_t));
+    if (!edgeBuffer)
+    {
+        return;
+    }
+
+    // Every output pixel depends only on its 3x3 source window, so split the rows across both cores
+    EdgeBandContext ctx = {frameBuffer, edgeBuffer, width, height, mode};
+    parallelForRows(edgeBands, height, 1, edgeBand, &ctx);
+
+    // Copy edge-detected image back to frame buffer
+    memcpy(frameBuffer, edgeBuffer, totalPixels * sizeof(uint16_t));
+
+    // Free temporary buffer
+    free(edgeBuffer);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct AutoAdjustBandContext
+{
+    uint16_t *frameBuffer;
+    int width;
+    const Lut565 *lut;
+};
+
+static RowBandFilter autoAdjustBands = {"AutoAdjust", true, 0, {}, nullptr};
+
+// Run one row band through the contrast/brightness/gamma LUT in place
+static void autoAdjustBand(const RowBand &band, void *ctx)
+{
+    const AutoAdjustBandContext &c = *(const AutoAdjustBandContext *)ctx;
+
+    applyLut565(c.frameBuffer + band.y0 * c.width, (band.y1 - band.y0) * c.width, *c.lut);
+}
+
+/**
+ * Build the auto-adjust LUT from the histogram of an image region
+ *
+ * @param pixels First pixel of the region
+ * @param width Region width
+ * @param height Region height
+ * @param stride Row stride in pixels
+ * @param lut Contrast/brightness/gamma table to fill
+ */
+void buildAutoAdjustLut(const uint16_t *pixels, int width, int height, int stride, Lut565 &lut)
+{
+    int totalPixels = width * height;
+
     // Detect byte swapping
     bool swapBytes = true;
     // Build histogram for luminance
     int histogram[256] = {0};
     
-    for (int i = 0; i < totalPixels; i++)
+    for (int y = 0; y < height; y++)
     {
-        uint16_t pixel = frameBuffer[i];
-        
-        if (swapBytes)
+        const uint16_t *row = pixels + y * stride;
+        for (int x = 0; x < width; x++)
         {
-            pixel = ((pixel << 8) | (pixel >> 8));
+            uint16_t pixel = row[x];
+            
+            if (swapBytes)
+            {
+                pixel = ((pixel << 8) | (pixel >> 8));
+            }
+            
+            // Extract RGB and calculate luminance
+            uint8_t r = ((pixel >> 11) & 0x1F) << 3;
+            uint8_t g = ((pixel >> 5) & 0x3F) << 2;
+            uint8_t b = (pixel & 0x1F) << 3;
+            uint8_t lum = (r * 30 + g * 59 + b * 11) / 100;
+            
+            histogram[lum]++;
         }
-        
-        // Extract RGB and calculate luminance
-        uint8_t r = ((pixel >> 11) & 0x1F) << 3;
-        uint8_t g = ((pixel >> 5) & 0x3F) << 2;
-        uint8_t b = (pixel & 0x1F) << 3;
-        uint8_t lum = (r * 30 + g * 59 + b * 11) / 100;
-        
-        histogram[lum]++;
     }
 
     // Find min and max values (1% and 99% percentiles to ignore outliers)
@@ -1614,39 +1596,114 @@ void applyAutoAdjust(camera_fb_t *cameraFb)
         gamma_lut[i] = static_cast<uint8_t>(v + 0.5f);
     }
 
-    // Apply adjustments to each pixel
-    for (int i = 0; i < totalPixels; i++)
+    // Fold the LUT into RGB565 fields so each pixel is three lookups, no unpack/repack
+    buildLut565(gamma_lut, lut);
+}
+
+/**
+ * Auto-adjust brightness, contrast, and gamma based on histogram analysis
+ * Analyzes the image and applies optimal adjustments
+ * 
+ * @param cameraFb Pointer to camera frame buffer
+ */
+void applyAutoAdjust(camera_fb_t *cameraFb)
+{
+    if (!psramFound() || !cameraFb)
     {
-        uint16_t pixel = frameBuffer[i];
-        
-        if (swapBytes)
+        return;
+    }
+
+    int width = cameraFb->width;
+    int height = cameraFb->height;
+    uint16_t *frameBuffer = (uint16_t *)cameraFb->buf;
+
+    Lut565 lut565;
+    buildAutoAdjustLut(frameBuffer, width, height, width, lut565);
+    applyAutoAdjustLut(cameraFb, lut565);
+}
+
+void applyAutoAdjustLut(camera_fb_t *cameraFb, const Lut565 &lut)
+{
+    if (!cameraFb)
+    {
+        return;
+    }
+
+    // Applying the LUT is per pixel, so split the rows across both cores
+    AutoAdjustBandContext ctx = {(uint16_t *)cameraFb->buf, (int)cameraFb->width, &lut};
+    parallelForRows(autoAdjustBands, cameraFb->height, 1, autoAdjustBand, &ctx);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct CRTBandContext
+{
+    uint16_t *frameBuffer;
+    int width;
+    int height;
+    int pixelSize;
+};
+
+static RowBandFilter crtBands = {"CRT", true, 0, {}, nullptr};
+
+// Block color for applyCRT: one channel of the block average, darkened on odd block rows
+struct CRTShader
+{
+    inline uint16_t color(int blockX, int blockY, uint32_t sumR, uint32_t sumG, uint32_t sumB, const BlockDivisor &pixels)
+    {
+        // Determine channel for this block based on scanline rotation
+        // Line 0: R,G,B,R,G,B... (offset 0)
+        // Line 1: B,R,G,B,R,G... (offset 2)
+        // Line 2: G,B,R,G,B,R... (offset 1)
+        int lineOffset = (blockY % 3) * 2;
+        int channel = (blockX + lineOffset) % 3;
+
+        // Average of the kept channel, in its RGB565 field
+        uint16_t blockColor;
+        if (channel == 0)
         {
-            pixel = ((pixel << 8) | (pixel >> 8));
+            blockColor = pixels.divide(sumR) << 11;
         }
-        
-        // Extract RGB
-        uint8_t r = ((pixel >> 11) & 0x1F) << 3;
-        uint8_t g = ((pixel >> 5) & 0x3F) << 2;
-        uint8_t b = (pixel & 0x1F) << 3;
-        
-        // Apply contrast/brightness + gamma via LUT
-        uint8_t rf = gamma_lut[r];
-        uint8_t gf = gamma_lut[g];
-        uint8_t bf = gamma_lut[b];
-        
-        // Convert back to RGB565
-        uint8_t r5 = (uint8_t)rf >> 3;
-        uint8_t g6 = (uint8_t)gf >> 2;
-        uint8_t b5 = (uint8_t)bf >> 3;
-        uint16_t rgb565 = (r5 << 11) | (g6 << 5) | b5;
-        
-        if (swapBytes)
+        else if (channel == 1)
         {
-            rgb565 = ((rgb565 << 8) | (rgb565 >> 8));
+            blockColor = pixels.divide(sumG) << 5;
         }
-        
-        frameBuffer[i] = rgb565;
+        else
+        {
+            blockColor = pixels.divide(sumB);
+        }
+
+        // Reduce brightness to 25% for scanlines on odd block rows; a single field is
+        // set, so shifting the whole value quarters it without bleeding into the others
+        if (blockY & 1)
+        {
+            uint16_t field = (channel == 0) ? 0xF800 : (channel == 1) ? 0x07E0 : 0x001F;
+            blockColor = (blockColor >> 2) & field;
+        }
+
+        return ((blockColor << 8) | (blockColor >> 8));
     }
+};
+
+// CRT one row band in place (bands start on block boundaries)
+static void crtBand(const RowBand &band, void *ctx)
+{
+    const CRTBandContext &c = *(const CRTBandContext *)ctx;
+
+    CRTShader shader;
+    reduceBlocks(c.frameBuffer, c.width, c.height, band.y0, band.y1, c.pixelSize, shader);
+}
+
+/**
+ * Band alignment for applyCRT: the channel order repeats every 3 block rows and the
+ * scanlines every 2, so bands start on multiples of 6 block rows
+ *
+ * @param pixelSize Size of blocks
+ * @return Band alignment in rows
+ */
+int crtBandAlign(int pixelSize)
+{
+    return 6 * max(pixelSize, 1);
 }
 
 /**
@@ -1657,7 +1714,7 @@ void applyAutoAdjust(camera_fb_t *cameraFb)
  */
 void applyCRT(camera_fb_t *cameraFb, int pixelSize)
 {
-    if (!psramFound() || !cameraFb)
+    if (!psramFound() || !cameraFb || pixelSize < 1)
     {
         return;
     }
@@ -1665,126 +1722,54 @@ void applyCRT(camera_fb_t *cameraFb, int pixelSize)
     int width = cameraFb->width;
     int height = cameraFb->height;
     uint16_t *frameBuffer = (uint16_t *)cameraFb->buf;
-    
-    const bool swapBytes = true;
 
-    // Process image in blocks
-    for (int by = 0; by < height; by += pixelSize)
-    {
-        for (int bx = 0; bx < width; bx += pixelSize)
-        {
-            // Determine channel for this block based on scanline rotation
-            // Line 0: R,G,B,R,G,B... (offset 0)
-            // Line 1: B,R,G,B,R,G... (offset 2)
-            // Line 2: G,B,R,G,B,R... (offset 1)
-            int blockX = bx / pixelSize;
-            int blockY = by / pixelSize;
-            int lineOffset = (blockY % 3) * 2;
-            int channel = (blockX + lineOffset) % 3;
-            
-            // First pass: Calculate average color for this block
-            uint32_t sumR = 0, sumG = 0, sumB = 0;
-            int pixelCount = 0;
-            
-            for (int dy = 0; dy < pixelSize && (by + dy) < height; dy++)
-            {
-                for (int dx = 0; dx < pixelSize && (bx + dx) < width; dx++)
-                {
-                    int x = bx + dx;
-                    int y = by + dy;
-                    int i = y * width + x;
-                    
-                    uint16_t pixel = frameBuffer[i];
-                    
-                    if (swapBytes)
-                    {
-                        pixel = ((pixel << 8) | (pixel >> 8));
-                    }
-                    
-                    // Extract RGB565 components and accumulate
-                    sumR += (pixel >> 11) & 0x1F;
-                    sumG += (pixel >> 5) & 0x3F;
-                    sumB += pixel & 0x1F;
-                    pixelCount++;
-                }
-            }
-            
-            // Calculate average RGB values
-            uint8_t avgR5 = sumR / pixelCount;
-            uint8_t avgG6 = sumG / pixelCount;
-            uint8_t avgB5 = sumB / pixelCount;
-            
-            // Apply channel filter based on block
-            if (channel == 0)
-            {
-                // Keep red only
-                avgG6 = 0;
-                avgB5 = 0;
-            }
-            else if (channel == 1)
-            {
-                // Keep green only
-                avgR5 = 0;
-                avgB5 = 0;
-            }
-            else // channel == 2
-            {
-                // Keep blue only
-                avgR5 = 0;
-                avgG6 = 0;
-            }
-            
-            // Reconstruct averaged and filtered RGB565
-            uint16_t blockColor = (avgR5 << 11) | (avgG6 << 5) | avgB5;
-            
-            if (swapBytes)
-            {
-                blockColor = ((blockColor << 8) | (blockColor >> 8));
-            }
-            
-            // Determine if this block row should be darkened (odd block rows)
-            int blockRowIndex = by / pixelSize;
-            bool darkenBlock = (blockRowIndex % 2 == 1);
-            
-            // Apply darkening to the block color if it's on an odd block row
-            uint16_t finalBlockColor = blockColor;
-            if (darkenBlock)
-            {
-                // Extract RGB components
-                uint16_t tempPixel = blockColor;
-                if (swapBytes)
-                {
-                    tempPixel = ((tempPixel << 8) | (tempPixel >> 8));
-                }
-                
-                // Reduce brightness to 25% for scanlines
-                uint8_t r5 = ((tempPixel >> 11) & 0x1F) * 0.25;
-                uint8_t g6 = ((tempPixel >> 5) & 0x3F) * 0.25;
-                uint8_t b5 = (tempPixel & 0x1F) * 0.25;
-                
-                // Reconstruct pixel
-                finalBlockColor = (r5 << 11) | (g6 << 5) | b5;
-                
-                if (swapBytes)
-                {
-                    finalBlockColor = ((finalBlockColor << 8) | (finalBlockColor >> 8));
-                }
-            }
-            
-            // Second pass: Fill entire block with the (possibly darkened) filtered color
-            for (int dy = 0; dy < pixelSize && (by + dy) < height; dy++)
-            {
-                for (int dx = 0; dx < pixelSize && (bx + dx) < width; dx++)
-                {
-                    int x = bx + dx;
-                    int y = by + dy;
-                    int i = y * width + x;
-                    
-                    frameBuffer[i] = finalBlockColor;
-                }
-            }
-        }
-    }
+    // Blocks never straddle a band boundary, so both cores can write in place
+    CRTBandContext ctx = {frameBuffer, width, height, pixelSize};
+    parallelForRows(crtBands, height, pixelSize, crtBand, &ctx);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Apply a 5x5 box blur (separable)
+ * @param cameraFb Pointer to camera frame buffer
+ */
+void applyBoxBlur(camera_fb_t *cameraFb)
+{
+    static const ConvolutionKernel kernel = {5, true, {}, {1, 1, 1, 1, 1}, {1, 1, 1, 1, 1}, 25, 0};
+    static const ConvolutionOptions options = {CONVOLVE_RGB, CONVOLVE_BORDER_CLAMP, CONVOLVE_POST_NONE, 0};
+    convolveFrame(cameraFb, kernel, options);
+}
+
+/**
+ * Apply a 3x3 sharpen (center 5, cross -1) to each channel
+ * @param cameraFb Pointer to camera frame buffer
+ */
+void applySharpen(camera_fb_t *cameraFb)
+{
+    static const ConvolutionKernel kernel = {3, false, {0, -1, 0, -1, 5, -1, 0, -1, 0}, {}, {}, 1, 0};
+    static const ConvolutionOptions options = {CONVOLVE_RGB, CONVOLVE_BORDER_CLAMP, CONVOLVE_POST_NONE, 0};
+    convolveFrame(cameraFb, kernel, options);
+}
+
+/**
+ * Apply a gray emboss: luma relief lit from the top left, flat areas mid gray
+ * @param cameraFb Pointer to camera frame buffer
+ */
+void applyEmboss(camera_fb_t *cameraFb)
+{
+    static const ConvolutionKernel kernel = {3, false, {-1, -1, 0, -1, 0, 1, 0, 1, 1}, {}, {}, 1, 128};
+    static const ConvolutionOptions options = {CONVOLVE_LUMA, CONVOLVE_BORDER_CLAMP, CONVOLVE_POST_NONE, 0};
+    convolveFrame(cameraFb, kernel, options);
+}
+
+/**
+ * Apply an unsharp mask: the source plus 1.5x its difference from a 5x5 Gaussian blur
+ * @param cameraFb Pointer to camera frame buffer
+ */
+void applyUnsharpMask(camera_fb_t *cameraFb)
+{
+    static const ConvolutionKernel kernel = {5, true, {}, {1, 4, 6, 4, 1}, {1, 4, 6, 4, 1}, 256, 0};
+    static const ConvolutionOptions options = {CONVOLVE_RGB, CONVOLVE_BORDER_MIRROR, CONVOLVE_POST_ADD_SOURCE, -24};
+    convolveFrame(cameraFb, kernel, options);
+}
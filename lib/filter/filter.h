@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 #include <esp_camera.h>
+#include "pixel_simd.h"
+#include "convolution.h"
+#include "palette_index.h"
 
 
 // Helper functions
@@ -12,11 +15,36 @@ uint16_t *createSmallDitheredImage(camera_fb_t *cameraFb);
 // Main filter functions
 void applyDithering(camera_fb_t *cameraFb, int redBits = 1, int greenBits = 1, int blueBits = 1, bool grayscale = false, int algorithm = 0, int bayerSize = 4);
 void applyPixelate(camera_fb_t *cameraFb, int blockSize = 8, bool grayscale = false);
-void applyColorPalette(uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize, int dithering = 1, int pixelSize = 1, int bayerSize = 4);
+void applyColorPalette(uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize, int dithering = 1, int pixelSize = 1, int bayerSize = 4, int matching = PALETTE_MATCH_RGB);
+bool applyColorPaletteIndexed(const uint16_t *imageBuffer, int width, int height, const uint32_t *palette, int paletteSize, uint8_t *indices, int dithering = 1, int pixelSize = 1, int bayerSize = 4, int matching = PALETTE_MATCH_RGB);
+// Build the nearest-color index (or Oklab table) applyColorPalette will use for a palette,
+// so the first filtered frame does not pay for it; false if it could not be built
+bool prepareColorPalette(const uint32_t *palette, int paletteSize, int matching = PALETTE_MATCH_RGB);
 void reduceResolution(camera_fb_t *cameraFb, int targetWidth, int targetHeight);
 void applyColorReduction(camera_fb_t *cameraFb);
 void applyEdgeDetection(camera_fb_t *cameraFb, int mode = 1);
 void applyAutoAdjust(camera_fb_t *cameraFb);
+void applyAutoAdjustLut(camera_fb_t *cameraFb, const Lut565 &lut); // Reuse a LUT from buildAutoAdjustLut
 void applyCRT(camera_fb_t *cameraFb, int pixelSize = 1);
 
+// Convolution filters (convolution.h); each reads CONVOLUTION_HALO rows around a band
+void applyBoxBlur(camera_fb_t *cameraFb);
+void applySharpen(camera_fb_t *cameraFb);
+void applyEmboss(camera_fb_t *cameraFb);
+void applyUnsharpMask(camera_fb_t *cameraFb);
+
+// Palette-indexed frames: one byte per pixel naming an entry of the palette the filter
+// used. A LUT of the palette as RGB565 (frame order for frames, native for the display)
+// turns them back into pixels. Palettes hold up to PALETTE_INDEX_MAX entries (palette_index.h).
+void buildPaletteLut565(const uint32_t *palette, int paletteSize, uint16_t *lut, bool frameOrder);
+void expandPaletteIndices(const uint8_t *indices, uint16_t *pixels, size_t count, const uint16_t *lut);
+
+// Running a filter on separate horizontal bands of one frame (stills are processed in bands).
+// Bands must start on a multiple of the alignment; edge detection reads this many rows
+// above and below each band.
+const int EDGE_DETECTION_HALO = 1;
+int colorPaletteBandAlign(int dithering, int pixelSize = 1, int bayerSize = 4);
+int crtBandAlign(int pixelSize = 1);
+void buildAutoAdjustLut(const uint16_t *pixels, int width, int height, int stride, Lut565 &lut);
+
 #endif // FILTER_H
\ No newline at end of file
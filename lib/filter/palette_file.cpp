@@ -0,0 +1,124 @@
+#include "palette_file.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+void paletteFileBegin(PaletteFile &file, bool gpl)
+{
+    file.size = 0;
+    file.gpl = gpl;
+    file.headerSeen = false;
+    file.line = 0;
+    file.error = nullptr;
+}
+
+static bool addColor(PaletteFile &file, uint32_t color)
+{
+    if (file.size >= PALETTE_INDEX_MAX)
+    {
+        file.error = "more than 256 colors";
+        return false;
+    }
+    file.colors[file.size++] = color & 0xFFFFFF;
+    return true;
+}
+
+static void parseHexLine(PaletteFile &file, const char *line)
+{
+    if (*line == '#')
+    {
+        line++;
+    }
+    else if (line[0] == '0' && (line[1] == 'x' || line[1] == 'X'))
+    {
+        line += 2;
+    }
+
+    int digits = 0;
+    while (isxdigit((unsigned char)line[digits]))
+    {
+        digits++;
+    }
+    const char *rest = line + digits;
+    while (isspace((unsigned char)*rest))
+    {
+        rest++;
+    }
+    if (digits != 6 || *rest)
+    {
+        file.error = "expected RRGGBB";
+        return;
+    }
+    addColor(file, strtoul(line, nullptr, 16));
+}
+
+static void parseGplLine(PaletteFile &file, const char *line)
+{
+    if (!file.headerSeen)
+    {
+        if (strncmp(line, "GIMP Palette", 12) != 0)
+        {
+            file.error = "missing GIMP Palette header";
+            return;
+        }
+        file.headerSeen = true;
+        return;
+    }
+    if (*line == '#' || !isdigit((unsigned char)*line))
+    {
+        // Comments and Name:/Columns: lines
+        return;
+    }
+
+    long rgb[3];
+    const char *text = line;
+    for (int c = 0; c < 3; c++)
+    {
+        char *end;
+        rgb[c] = strtol(text, &end, 10);
+        if (end == text || rgb[c] < 0 || rgb[c] > 255)
+        {
+            file.error = "expected R G B from 0 to 255";
+            return;
+        }
+        text = end;
+    }
+    addColor(file, ((uint32_t)rgb[0] << 16) | ((uint32_t)rgb[1] << 8) | (uint32_t)rgb[2]);
+}
+
+bool paletteFileParseLine(PaletteFile &file, const char *line)
+{
+    if (file.error)
+    {
+        return false;
+    }
+    file.line++;
+
+    while (isspace((unsigned char)*line))
+    {
+        line++;
+    }
+    if (!*line)
+    {
+        return true;
+    }
+
+    if (file.gpl)
+    {
+        parseGplLine(file, line);
+    }
+    else
+    {
+        parseHexLine(file, line);
+    }
+    return file.error == nullptr;
+}
+
+bool paletteFileFinish(PaletteFile &file)
+{
+    if (!file.error && file.size == 0)
+    {
+        file.error = file.gpl && !file.headerSeen ? "missing GIMP Palette header" : "no colors";
+    }
+    return file.error == nullptr;
+}
@@ -0,0 +1,42 @@
+#ifndef PALETTE_FILE_H
+#define PALETTE_FILE_H
+
+#include <Arduino.h>
+#include "palette_index.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Palette files
+//
+// The two formats Lospec exports, parsed a line at a time:
+//   .hex - one RRGGBB color per line ('#' or 0x prefix allowed)
+//   .gpl - GIMP palette: "GIMP Palette" header, Name:/Columns: lines, '#' comments,
+//          then "R G B [name]" in decimal
+// Up to PALETTE_INDEX_MAX colors, in file order.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct PaletteFile
+{
+    uint32_t colors[PALETTE_INDEX_MAX]; // 0xRRGGBB, as in palettes.h
+    int size;
+    bool gpl;           // GIMP format, else .hex
+    bool headerSeen;    // .gpl "GIMP Palette" line read
+    int line;           // Lines parsed
+    const char *error;  // First problem found, nullptr while the file is valid
+};
+
+// Start parsing; gpl picks the GIMP format (by file extension)
+void paletteFileBegin(PaletteFile &file, bool gpl);
+
+/**
+ * Parse one line of a palette file
+ *
+ * @param file Parser state from paletteFileBegin
+ * @param line Line without its terminator
+ * @return false once the file is known to be invalid (file.error says why)
+ */
+bool paletteFileParseLine(PaletteFile &file, const char *line);
+
+// Check that the file held at least one color; false with file.error set if not
+bool paletteFileFinish(PaletteFile &file);
+
+#endif // PALETTE_FILE_H
@@ -0,0 +1,354 @@
+#include "palette_index.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+const int PALETTE_INDEX_CACHE_SLOTS = 3; // Preview, capture and one spare
+
+static PaletteIndex cacheSlots[PALETTE_INDEX_CACHE_SLOTS];
+static uint32_t cacheLastUse[PALETTE_INDEX_CACHE_SLOTS];
+static uint32_t cacheClock = 0;
+
+static uint32_t paletteKey(const uint32_t *palette, int paletteSize, int matching)
+{
+    // FNV-1a over the entries, the size and the matching
+    uint32_t hash = 2166136261u ^ (uint32_t)paletteSize ^ ((uint32_t)matching << 16);
+    for (int i = 0; i < paletteSize; i++)
+    {
+        hash = (hash ^ (palette[i] & 0xFFFFFF)) * 16777619u;
+    }
+    return hash;
+}
+
+// Hashes can collide; palettes are short enough to compare outright
+static bool sameEntries(const PaletteIndex &index, const uint32_t *palette, int paletteSize, int matching)
+{
+    if (index.size != paletteSize || index.matching != matching)
+    {
+        return false;
+    }
+    for (int j = 0; j < paletteSize; j++)
+    {
+        uint32_t color = ((uint32_t)index.r[j] << 16) | ((uint32_t)index.g[j] << 8) | index.b[j];
+        if (color != (palette[j] & 0xFFFFFF))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Squared distance along one axis from v to the cell [lo, lo + cell width)
+static inline int axisMin(int v, int lo)
+{
+    int hi = lo + (1 << PALETTE_GRID_SHIFT) - 1;
+    int d = v < lo ? lo - v : (v > hi ? v - hi : 0);
+    return d * d;
+}
+
+static inline int axisMax(int v, int lo)
+{
+    int hi = lo + (1 << PALETTE_GRID_SHIFT) - 1;
+    int d = max(v - lo, hi - v);
+    return d * d;
+}
+
+/**
+ * Entries that can be nearest to some color in one cell
+ *
+ * @param out Entry numbers in ascending order (nullptr to only count them)
+ * @return Number of entries
+ */
+static int cellCandidates(const PaletteIndex &index, int rc, int gc, int bc, uint8_t *out)
+{
+    const int rLo = rc << PALETTE_GRID_SHIFT;
+    const int gLo = gc << PALETTE_GRID_SHIFT;
+    const int bLo = bc << PALETTE_GRID_SHIFT;
+
+    // No color in the cell is farther than this from its nearest entry
+    int bound = INT_MAX;
+    for (int j = 0; j < index.size; j++)
+    {
+        int farthest = axisMax(index.r[j], rLo) * 2 + axisMax(index.g[j], gLo) * 4 + axisMax(index.b[j], bLo) * 3;
+        bound = min(bound, farthest);
+    }
+
+    int count = 0;
+    for (int j = 0; j < index.size; j++)
+    {
+        int nearest = axisMin(index.r[j], rLo) * 2 + axisMin(index.g[j], gLo) * 4 + axisMin(index.b[j], bLo) * 3;
+        if (nearest <= bound)
+        {
+            if (out)
+            {
+                out[count] = (uint8_t)j;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static float srgbToLinear(int c)
+{
+    float v = c / 255.0f;
+    return v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f);
+}
+
+// Oklab from linear sRGB (Ottosson's matrices)
+static void linearToOklab(float r, float g, float b, float lab[3])
+{
+    float l = cbrtf(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    float m = cbrtf(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    float s = cbrtf(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+    lab[0] = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+    lab[1] = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+    lab[2] = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+}
+
+void paletteOklab(int r, int g, int b, float lab[3])
+{
+    linearToOklab(srgbToLinear(r), srgbToLinear(g), srgbToLinear(b), lab);
+}
+
+struct OklabEntry
+{
+    float lab[3];
+    int index; // Palette entry
+};
+
+/**
+ * Nearest entry in Oklab
+ *
+ * Entries are sorted by lightness, so the scan starts at the color's own L and walks
+ * outwards in both directions until the lightness difference alone exceeds the best
+ * distance found.
+ */
+static int oklabNearest(const OklabEntry *sorted, int size, const float lab[3])
+{
+    int hi = 0;
+    int count = size;
+    while (count > 0)
+    {
+        int step = count / 2;
+        if (sorted[hi + step].lab[0] < lab[0])
+        {
+            hi += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    int lo = hi - 1;
+
+    float best = FLT_MAX;
+    int closest = 0;
+    while (lo >= 0 || hi < size)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            int &i = side ? lo : hi;
+            if (i < 0 || i >= size)
+            {
+                continue;
+            }
+            const OklabEntry &entry = sorted[i];
+            float dl = entry.lab[0] - lab[0];
+            if (dl * dl > best)
+            {
+                i = side ? -1 : size; // Everything further out is darker / lighter still
+                continue;
+            }
+            float da = entry.lab[1] - lab[1];
+            float db = entry.lab[2] - lab[2];
+            float distance = dl * dl + da * da + db * db;
+            // Ties go to the lower index, as in the RGB search
+            if (distance < best || (distance == best && entry.index < closest))
+            {
+                best = distance;
+                closest = entry.index;
+            }
+            i += side ? -1 : 1;
+        }
+    }
+    return closest;
+}
+
+// Working set of buildOklabTable, about 4.6 KB: too much for the loop task's stack
+struct OklabBuild
+{
+    OklabEntry sorted[PALETTE_INDEX_MAX];
+    // Channels as the filter unpacks them from RGB565
+    float red[32];
+    float green[64];
+    float blue[32];
+};
+
+static bool buildOklabTable(PaletteIndex &index)
+{
+    index.nearest565 = (uint8_t *)ps_malloc(PALETTE_MATCH_TABLE_ENTRIES);
+    OklabBuild *build = (OklabBuild *)malloc(sizeof(OklabBuild));
+    if (!index.nearest565 || !build)
+    {
+        free(build);
+        return false;
+    }
+
+    OklabEntry *sorted = build->sorted;
+    for (int j = 0; j < index.size; j++)
+    {
+        paletteOklab(index.r[j], index.g[j], index.b[j], sorted[j].lab);
+        sorted[j].index = j;
+    }
+    std::sort(sorted, sorted + index.size, [](const OklabEntry &a, const OklabEntry &b)
+              { return a.lab[0] < b.lab[0] || (a.lab[0] == b.lab[0] && a.index < b.index); });
+
+    for (int i = 0; i < 64; i++)
+    {
+        build->green[i] = srgbToLinear(i << 2);
+        if (i < 32)
+        {
+            build->red[i] = build->blue[i] = srgbToLinear(i << 3);
+        }
+    }
+
+    for (uint32_t color = 0; color < PALETTE_MATCH_TABLE_ENTRIES; color++)
+    {
+        float lab[3];
+        linearToOklab(build->red[color >> 11], build->green[(color >> 5) & 0x3F], build->blue[color & 0x1F], lab);
+        index.nearest565[color] = oklabNearest(sorted, index.size, lab);
+    }
+    free(build);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+bool paletteIndexBuild(PaletteIndex &index, const uint32_t *palette, int paletteSize, int matching)
+{
+    index.cellStart = nullptr;
+    index.candidates = nullptr;
+    index.candidateCount = 0;
+    index.nearest565 = nullptr;
+    index.size = 0;
+    if (!palette || paletteSize <= 0)
+    {
+        return false;
+    }
+
+    paletteSize = min(paletteSize, PALETTE_INDEX_MAX);
+    index.size = paletteSize;
+    index.matching = matching;
+    index.key = paletteKey(palette, paletteSize, matching);
+    for (int j = 0; j < paletteSize; j++)
+    {
+        index.r[j] = (palette[j] >> 16) & 0xFF;
+        index.g[j] = (palette[j] >> 8) & 0xFF;
+        index.b[j] = palette[j] & 0xFF;
+    }
+
+    if (matching == PALETTE_MATCH_OKLAB)
+    {
+        if (!buildOklabTable(index))
+        {
+            paletteIndexRelease(index);
+            return false;
+        }
+        return true;
+    }
+
+    index.cellStart = (uint32_t *)ps_malloc((PALETTE_GRID_CELLS + 1) * sizeof(uint32_t));
+    if (!index.cellStart)
+    {
+        paletteIndexRelease(index);
+        return false;
+    }
+
+    // Count first so the lists take exactly the memory they need
+    uint32_t total = 0;
+    int cell = 0;
+    for (int rc = 0; rc < PALETTE_GRID_SIZE; rc++)
+    {
+        for (int gc = 0; gc < PALETTE_GRID_SIZE; gc++)
+        {
+            for (int bc = 0; bc < PALETTE_GRID_SIZE; bc++, cell++)
+            {
+                index.cellStart[cell] = total;
+                total += cellCandidates(index, rc, gc, bc, nullptr);
+            }
+        }
+    }
+    index.cellStart[PALETTE_GRID_CELLS] = total;
+
+    index.candidates = (uint8_t *)ps_malloc(total);
+    if (!index.candidates)
+    {
+        paletteIndexRelease(index);
+        return false;
+    }
+    index.candidateCount = total;
+
+    cell = 0;
+    for (int rc = 0; rc < PALETTE_GRID_SIZE; rc++)
+    {
+        for (int gc = 0; gc < PALETTE_GRID_SIZE; gc++)
+        {
+            for (int bc = 0; bc < PALETTE_GRID_SIZE; bc++, cell++)
+            {
+                cellCandidates(index, rc, gc, bc, index.candidates + index.cellStart[cell]);
+            }
+        }
+    }
+    return true;
+}
+
+void paletteIndexRelease(PaletteIndex &index)
+{
+    free(index.cellStart);
+    free(index.candidates);
+    free(index.nearest565);
+    index.cellStart = nullptr;
+    index.candidates = nullptr;
+    index.nearest565 = nullptr;
+    index.candidateCount = 0;
+    index.size = 0;
+}
+
+const PaletteIndex *paletteIndexFor(const uint32_t *palette, int paletteSize, int matching)
+{
+    if (!palette || paletteSize <= 0)
+    {
+        return nullptr;
+    }
+    paletteSize = min(paletteSize, PALETTE_INDEX_MAX);
+    uint32_t key = paletteKey(palette, paletteSize, matching);
+
+    int victim = 0;
+    for (int i = 0; i < PALETTE_INDEX_CACHE_SLOTS; i++)
+    {
+        PaletteIndex &slot = cacheSlots[i];
+        if (slot.size && slot.key == key && sameEntries(slot, palette, paletteSize, matching))
+        {
+            cacheLastUse[i] = ++cacheClock;
+            return &slot;
+        }
+        if (cacheLastUse[i] < cacheLastUse[victim])
+        {
+            victim = i;
+        }
+    }
+
+    PaletteIndex &slot = cacheSlots[victim];
+    paletteIndexRelease(slot);
+    cacheLastUse[victim] = 0;
+    if (!paletteIndexBuild(slot, palette, paletteSize, matching))
+    {
+        return nullptr;
+    }
+    cacheLastUse[victim] = ++cacheClock;
+    return &slot;
+}
@@ -0,0 +1,111 @@
+#ifndef PALETTE_INDEX_H
+#define PALETTE_INDEX_H
+
+#include <Arduino.h>
+#include <limits.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Nearest palette color search
+//
+// A linear scan of the palette costs one weighted distance per entry per pixel: fine for
+// 8 colors, far too slow for 256. PaletteIndex splits RGB space into a 16x16x16 grid and
+// keeps, for each cell, the entries that can be nearest to some color in it - those
+// whose distance to the cell is no more than the smallest farthest-corner distance of
+// any entry. A search scans only its cell's list, in palette order, so it returns
+// exactly what the linear scan would (ties go to the lower index).
+//
+// Building an index is one pass of 4096 cells over the palette; paletteIndexFor keeps the
+// last few so a palette is indexed once, not once per frame.
+//
+// Weighted RGB distance picks visibly wrong entries on palettes of close hues (sunset,
+// sakura). PALETTE_MATCH_OKLAB measures distance in Oklab instead; that is far too slow
+// per pixel, so the index then holds the nearest entry for every RGB565 color, worked out
+// once when the palette is indexed, and a search is a single table lookup.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const int PALETTE_INDEX_MAX = 256;                            // Most entries a palette can have
+const int PALETTE_GRID_SHIFT = 4;                             // 8-bit channel >> shift = cell coordinate
+const int PALETTE_GRID_SIZE = 256 >> PALETTE_GRID_SHIFT;      // Cells per axis
+const int PALETTE_GRID_CELLS = PALETTE_GRID_SIZE * PALETTE_GRID_SIZE * PALETTE_GRID_SIZE;
+const size_t PALETTE_MATCH_TABLE_ENTRIES = 65536;              // One per RGB565 color
+
+// Color distance a palette is matched by
+const int PALETTE_MATCH_RGB = 0;   // Weighted RGB (colorDistance)
+const int PALETTE_MATCH_OKLAB = 1; // Euclidean in Oklab (perceptual)
+
+struct PaletteIndex
+{
+    int size;                     // Palette entries
+    int matching;                 // PALETTE_MATCH_*
+    uint32_t key;                 // Hash of the palette and matching it was built from
+    uint8_t r[PALETTE_INDEX_MAX]; // Entry channels, 8-bit
+    uint8_t g[PALETTE_INDEX_MAX];
+    uint8_t b[PALETTE_INDEX_MAX];
+    uint32_t *cellStart;          // PALETTE_GRID_CELLS + 1 offsets into candidates (PSRAM)
+    uint8_t *candidates;          // Entry numbers, ascending within each cell (PSRAM)
+    uint32_t candidateCount;
+    uint8_t *nearest565;          // PALETTE_MATCH_OKLAB: entry per native RGB565 color (PSRAM)
+};
+
+// Same weights as colorDistance
+static inline int paletteColorDistance(int r1, int g1, int b1, int r2, int g2, int b2)
+{
+    int dr = r1 - r2;
+    int dg = g1 - g2;
+    int db = b1 - b2;
+    return dr * dr * 2 + dg * dg * 4 + db * db * 3;
+}
+
+/**
+ * Build the nearest-color index of a palette
+ *
+ * @param index Index to fill; release it with paletteIndexRelease
+ * @param palette 0xRRGGBB entries
+ * @param paletteSize Entries, 1 to PALETTE_INDEX_MAX
+ * @param matching PALETTE_MATCH_RGB builds the grid, PALETTE_MATCH_OKLAB the RGB565 table
+ * @return false if the palette is empty or PSRAM ran out
+ */
+bool paletteIndexBuild(PaletteIndex &index, const uint32_t *palette, int paletteSize, int matching = PALETTE_MATCH_RGB);
+void paletteIndexRelease(PaletteIndex &index);
+
+/**
+ * Cached index for a palette, built on first use
+ *
+ * Call from one task; the result stays valid until a few other palettes have been used.
+ *
+ * @return nullptr if the index could not be built
+ */
+const PaletteIndex *paletteIndexFor(const uint32_t *palette, int paletteSize, int matching = PALETTE_MATCH_RGB);
+
+// Oklab L, a, b of an 8-bit sRGB color
+void paletteOklab(int r, int g, int b, float lab[3]);
+
+// Entry nearest to an 8-bit color (0-255 per channel)
+static inline int paletteIndexNearest(const PaletteIndex &index, int r, int g, int b)
+{
+    if (index.nearest565)
+    {
+        return index.nearest565[((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)];
+    }
+
+    int cell = ((r >> PALETTE_GRID_SHIFT) * PALETTE_GRID_SIZE + (g >> PALETTE_GRID_SHIFT)) * PALETTE_GRID_SIZE +
+               (b >> PALETTE_GRID_SHIFT);
+    const uint8_t *candidate = index.candidates + index.cellStart[cell];
+    const uint8_t *end = index.candidates + index.cellStart[cell + 1];
+
+    int closest = *candidate;
+    int minDistance = INT_MAX;
+    for (; candidate < end; candidate++)
+    {
+        int j = *candidate;
+        int distance = paletteColorDistance(r, g, b, index.r[j], index.g[j], index.b[j]);
+        if (distance < minDistance)
+        {
+            minDistance = distance;
+            closest = j;
+        }
+    }
+    return closest;
+}
+
+#endif // PALETTE_INDEX_H
@@ -0,0 +1,80 @@
+#include "palette_table.h"
+#include "../../include/palettes.h"
+
+// Expanded while compiling; a _SIZE constant that disagrees with its array does not compile
+constexpr PaletteTable<PALETTE_SUNSET_SIZE> PALETTE_SUNSET_TABLE = makePaletteTable(PALETTE_SUNSET);
+constexpr PaletteTable<PALETTE_YELLOW_BROWN_SIZE> PALETTE_YELLOW_BROWN_TABLE = makePaletteTable(PALETTE_YELLOW_BROWN);
+constexpr PaletteTable<PALETTE_GRAYSCALE_SIZE> PALETTE_GRAYSCALE_TABLE = makePaletteTable(PALETTE_GRAYSCALE);
+constexpr PaletteTable<PALETTE_GAMEBOY_SIZE> PALETTE_GAMEBOY_TABLE = makePaletteTable(PALETTE_GAMEBOY);
+constexpr PaletteTable<PALETTE_CYBERPUNK_SIZE> PALETTE_CYBERPUNK_TABLE = makePaletteTable(PALETTE_CYBERPUNK);
+constexpr PaletteTable<PALETTE_AUTUMN_SIZE> PALETTE_AUTUMN_TABLE = makePaletteTable(PALETTE_AUTUMN);
+constexpr PaletteTable<PALETTE_OCEAN_SIZE> PALETTE_OCEAN_TABLE = makePaletteTable(PALETTE_OCEAN);
+constexpr PaletteTable<PALETTE_DESERT_SIZE> PALETTE_DESERT_TABLE = makePaletteTable(PALETTE_DESERT);
+constexpr PaletteTable<PALETTE_SAKURA_SIZE> PALETTE_SAKURA_TABLE = makePaletteTable(PALETTE_SAKURA);
+constexpr PaletteTable<PALETTE_MINT_SIZE> PALETTE_MINT_TABLE = makePaletteTable(PALETTE_MINT);
+constexpr PaletteTable<PALETTE_FIRE_SIZE> PALETTE_FIRE_TABLE = makePaletteTable(PALETTE_FIRE);
+constexpr PaletteTable<PALETTE_ARCTIC_SIZE> PALETTE_ARCTIC_TABLE = makePaletteTable(PALETTE_ARCTIC);
+constexpr PaletteTable<PALETTE_SEPIA_SIZE> PALETTE_SEPIA_TABLE = makePaletteTable(PALETTE_SEPIA);
+constexpr PaletteTable<PALETTE_NEON_SIZE> PALETTE_NEON_TABLE = makePaletteTable(PALETTE_NEON);
+constexpr PaletteTable<PALETTE_BW_SIZE> PALETTE_BW_TABLE = makePaletteTable(PALETTE_BW);
+constexpr PaletteTable<PALETTE_4COLOR_SIZE> PALETTE_4COLOR_TABLE = makePaletteTable(PALETTE_4COLOR);
+constexpr PaletteTable<PALETTE_16COLOR_SIZE> PALETTE_16COLOR_TABLE = makePaletteTable(PALETTE_16COLOR);
+constexpr PaletteTable<PALETTE_FRESTA_SIZE> PALETTE_FRESTA_TABLE = makePaletteTable(PALETTE_FRESTA);
+
+static const PaletteTableView BUILTIN_PALETTES[] = {
+    paletteTableView(PALETTE_SUNSET, PALETTE_SUNSET_TABLE),
+    paletteTableView(PALETTE_YELLOW_BROWN, PALETTE_YELLOW_BROWN_TABLE),
+    paletteTableView(PALETTE_GRAYSCALE, PALETTE_GRAYSCALE_TABLE),
+    paletteTableView(PALETTE_GAMEBOY, PALETTE_GAMEBOY_TABLE),
+    paletteTableView(PALETTE_CYBERPUNK, PALETTE_CYBERPUNK_TABLE),
+    paletteTableView(PALETTE_AUTUMN, PALETTE_AUTUMN_TABLE),
+    paletteTableView(PALETTE_OCEAN, PALETTE_OCEAN_TABLE),
+    paletteTableView(PALETTE_DESERT, PALETTE_DESERT_TABLE),
+    paletteTableView(PALETTE_SAKURA, PALETTE_SAKURA_TABLE),
+    paletteTableView(PALETTE_MINT, PALETTE_MINT_TABLE),
+    paletteTableView(PALETTE_FIRE, PALETTE_FIRE_TABLE),
+    paletteTableView(PALETTE_ARCTIC, PALETTE_ARCTIC_TABLE),
+    paletteTableView(PALETTE_SEPIA, PALETTE_SEPIA_TABLE),
+    paletteTableView(PALETTE_NEON, PALETTE_NEON_TABLE),
+    paletteTableView(PALETTE_BW, PALETTE_BW_TABLE),
+    paletteTableView(PALETTE_4COLOR, PALETTE_4COLOR_TABLE),
+    paletteTableView(PALETTE_16COLOR, PALETTE_16COLOR_TABLE),
+    paletteTableView(PALETTE_FRESTA, PALETTE_FRESTA_TABLE),
+};
+static const int BUILTIN_PALETTE_COUNT = sizeof(BUILTIN_PALETTES) / sizeof(BUILTIN_PALETTES[0]);
+
+static bool sameColors(const PaletteTableView &table, const uint32_t *palette, int paletteSize)
+{
+    if (table.size != paletteSize)
+    {
+        return false;
+    }
+    if (table.colors == palette)
+    {
+        return true;
+    }
+    for (int j = 0; j < paletteSize; j++)
+    {
+        if ((table.colors[j] & 0xFFFFFF) != (palette[j] & 0xFFFFFF))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const PaletteTableView *builtinPaletteTable(const uint32_t *palette, int paletteSize)
+{
+    if (!palette)
+    {
+        return nullptr;
+    }
+    for (int i = 0; i < BUILTIN_PALETTE_COUNT; i++)
+    {
+        if (sameColors(BUILTIN_PALETTES[i], palette, paletteSize))
+        {
+            return &BUILTIN_PALETTES[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,143 @@
+#ifndef PALETTE_TABLE_H
+#define PALETTE_TABLE_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include <stddef.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Palettes preprocessed at compile time
+//
+// palettes.h keeps each palette as 0xRRGGBB entries. makePaletteTable expands one into a
+// PaletteTable while compiling: the 8-bit channels as separate arrays, and every entry
+// as RGB565 in frame (byte-swapped) and display order, so the filter never unpacks or
+// repacks a built-in palette. The entry count is a template parameter, and
+// paletteTableNearest expands the nearest-color scan into straight-line code for it, the
+// same way the diffusion kernels expand their taps.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <size_t N>
+struct PaletteTable
+{
+    uint8_t r[N];
+    uint8_t g[N];
+    uint8_t b[N];
+    uint16_t frame565[N];  // Byte-swapped, as camera frames hold pixels
+    uint16_t native565[N]; // As LVGL and the display take them
+};
+
+// What the filter sees of a table, whatever its size
+struct PaletteTableView
+{
+    const uint32_t *colors; // The palettes.h array it was made from
+    int size;
+    const uint8_t *r;
+    const uint8_t *g;
+    const uint8_t *b;
+    const uint16_t *frame565;
+    const uint16_t *native565;
+};
+
+constexpr uint16_t paletteNative565(uint32_t color)
+{
+    return (uint16_t)((((color >> 16) & 0xF8) << 8) | (((color >> 8) & 0xFC) << 3) | ((color & 0xFF) >> 3));
+}
+
+constexpr uint16_t paletteFrame565(uint32_t color)
+{
+    return (uint16_t)((paletteNative565(color) << 8) | (paletteNative565(color) >> 8));
+}
+
+// Entry positions 0..N-1 as a parameter pack (C++11 has no std::index_sequence)
+template <size_t... I>
+struct PaletteEntries
+{
+};
+
+template <size_t N, size_t... I>
+struct MakePaletteEntries : MakePaletteEntries<N - 1, N - 1, I...>
+{
+};
+
+template <size_t... I>
+struct MakePaletteEntries<0, I...>
+{
+    typedef PaletteEntries<I...> type;
+};
+
+template <size_t N, size_t... I>
+constexpr PaletteTable<N> makePaletteTable(const uint32_t (&colors)[N], PaletteEntries<I...>)
+{
+    return PaletteTable<N>{{(uint8_t)((colors[I] >> 16) & 0xFF)...},
+                           {(uint8_t)((colors[I] >> 8) & 0xFF)...},
+                           {(uint8_t)(colors[I] & 0xFF)...},
+                           {paletteFrame565(colors[I])...},
+                           {paletteNative565(colors[I])...}};
+}
+
+/**
+ * Expand a palettes.h array at compile time
+ *
+ * @param colors constexpr 0xRRGGBB array; its length becomes the table size
+ */
+template <size_t N>
+constexpr PaletteTable<N> makePaletteTable(const uint32_t (&colors)[N])
+{
+    return makePaletteTable(colors, typename MakePaletteEntries<N>::type());
+}
+
+template <size_t N>
+constexpr PaletteTableView paletteTableView(const uint32_t (&colors)[N], const PaletteTable<N> &table)
+{
+    return PaletteTableView{colors, (int)N, table.r, table.g, table.b, table.frame565, table.native565};
+}
+
+// One entry of the scan, then the rest; ties keep the lower index as in paletteIndexNearest
+template <size_t I, size_t N>
+struct PaletteScan
+{
+    static inline void step(const PaletteTableView &table, int r, int g, int b, int &minDistance, int &closest)
+    {
+        int dr = r - table.r[I];
+        int dg = g - table.g[I];
+        int db = b - table.b[I];
+        int distance = dr * dr * 2 + dg * dg * 4 + db * db * 3;
+        if (distance < minDistance)
+        {
+            minDistance = distance;
+            closest = I;
+        }
+        PaletteScan<I + 1, N>::step(table, r, g, b, minDistance, closest);
+    }
+};
+
+template <size_t N>
+struct PaletteScan<N, N>
+{
+    static inline void step(const PaletteTableView &, int, int, int, int &, int &) {}
+};
+
+/**
+ * Entry nearest to an 8-bit color by colorDistance, for a table of exactly N entries
+ *
+ * Gives the same entry as the linear scan and PaletteIndex.
+ */
+template <size_t N>
+static inline int paletteTableNearest(const PaletteTableView &table, int r, int g, int b)
+{
+    int minDistance = INT_MAX;
+    int closest = 0;
+    PaletteScan<0, N>::step(table, r, g, b, minDistance, closest);
+    return closest;
+}
+
+/**
+ * The compile-time table of a built-in palette (palettes.h)
+ *
+ * Matched by content, so any copy of a built-in palette finds its table.
+ *
+ * @return nullptr if the palette is not one of the built-in ones
+ */
+const PaletteTableView *builtinPaletteTable(const uint32_t *palette, int paletteSize);
+
+#endif // PALETTE_TABLE_H
@@ -0,0 +1,227 @@
+#include "parallel.h"
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+static bool splitEnabled = true;
+static bool jobActive = false;
+static RowBandFilter *registeredFilters = nullptr;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(ESP_PLATFORM)
+
+static TaskHandle_t workerTask = nullptr;
+static TaskHandle_t callerTask = nullptr;
+static ParallelJobFn workerFn = nullptr;
+static void *workerCtx = nullptr;
+
+static void parallelWorkerLoop(void *param)
+{
+    (void)param;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        workerFn(1, workerCtx);
+        xTaskNotifyGive(callerTask);
+    }
+}
+
+// Create the worker on the core the caller is not running on (first use only)
+static bool startWorker()
+{
+    if (workerTask)
+    {
+        return true;
+    }
+
+    int core = (xPortGetCoreID() == 0) ? 1 : 0;
+
+    // Same priority as the caller so neither half of a job starves the other
+    if (xTaskCreatePinnedToCore(parallelWorkerLoop, "filter_worker", 4096, nullptr,
+                                uxTaskPriorityGet(nullptr), &workerTask, core) != pdPASS)
+    {
+        workerTask = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool parallelRun(ParallelJobFn fn, void *ctx)
+{
+    if (jobActive || !startWorker())
+    {
+        return false;
+    }
+
+    jobActive = true;
+    workerFn = fn;
+    workerCtx = ctx;
+    callerTask = xTaskGetCurrentTaskHandle();
+
+    xTaskNotifyGive(workerTask);
+    fn(0, ctx);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    jobActive = false;
+    return true;
+}
+
+#else
+
+bool parallelRun(ParallelJobFn fn, void *ctx)
+{
+    if (jobActive)
+    {
+        return false;
+    }
+
+    jobActive = true;
+
+    std::thread worker(fn, 1, ctx);
+    fn(0, ctx);
+    worker.join();
+
+    jobActive = false;
+    return true;
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct BandJob
+{
+    RowBandFn fn;
+    void *ctx;
+    RowBand bands[PARALLEL_WORKERS];
+    uint32_t micros[PARALLEL_WORKERS];
+};
+
+static void runBandJob(int worker, void *ctx)
+{
+    BandJob *job = (BandJob *)ctx;
+
+    uint32_t start = micros();
+    job->fn(job->bands[worker], job->ctx);
+    job->micros[worker] = micros() - start;
+}
+
+static RowBand makeBand(int y0, int y1, int halo, int height)
+{
+    RowBand band;
+    band.y0 = y0;
+    band.y1 = y1;
+    band.readY0 = max(0, y0 - halo);
+    band.readY1 = min(height, y1 + halo);
+    return band;
+}
+
+static void registerFilter(RowBandFilter &filter)
+{
+    for (RowBandFilter *f = registeredFilters; f; f = f->next)
+    {
+        if (f == &filter)
+        {
+            return;
+        }
+    }
+
+    filter.next = registeredFilters;
+    registeredFilters = &filter;
+}
+
+void parallelForRows(RowBandFilter &filter, int height, int rowAlign, RowBandFn fn, void *ctx)
+{
+    if (height <= 0)
+    {
+        return;
+    }
+
+    if (rowAlign < 1)
+    {
+        rowAlign = 1;
+    }
+
+    // Split as close to the middle as the alignment allows
+    int splitRow = ((height / 2 + rowAlign / 2) / rowAlign) * rowAlign;
+
+    BandJob job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.micros[0] = 0;
+    job.micros[1] = 0;
+
+    uint32_t start = micros();
+
+    bool split = splitEnabled && filter.bandParallel && splitRow > 0 && splitRow < height;
+    if (split)
+    {
+        job.bands[0] = makeBand(0, splitRow, filter.halo, height);
+        job.bands[1] = makeBand(splitRow, height, filter.halo, height);
+        split = parallelRun(runBandJob, &job);
+    }
+
+    if (!split)
+    {
+        job.bands[0] = makeBand(0, height, filter.halo, height);
+        runBandJob(0, &job);
+    }
+
+    parallelRecordRun(filter, split, micros() - start, job.micros, 0);
+}
+
+void parallelRecordRun(RowBandFilter &filter, bool split, uint32_t wallMicros, const uint32_t *workerMicros, uint32_t stalls)
+{
+    registerFilter(filter);
+
+    uint32_t busy = 0;
+    uint32_t slowest = 0;
+    for (int i = 0; i < PARALLEL_WORKERS; i++)
+    {
+        busy += workerMicros[i];
+        slowest = max(slowest, workerMicros[i]);
+    }
+    uint32_t speedup = wallMicros ? (busy * 100) / wallMicros : 100;
+
+    ParallelStats &stats = filter.stats;
+    stats.speedupX100 = stats.runs ? (stats.speedupX100 * 7 + speedup) / 8 : speedup;
+    stats.runs++;
+    if (split)
+    {
+        stats.parallelRuns++;
+    }
+    stats.wallMicros = wallMicros;
+    stats.busyMicros = busy;
+    stats.overheadMicros = (wallMicros > slowest) ? wallMicros - slowest : 0;
+    stats.stalls = stalls;
+}
+
+void parallelSetEnabled(bool enabled)
+{
+    splitEnabled = enabled;
+}
+
+bool parallelEnabled()
+{
+    return splitEnabled;
+}
+
+void parallelLogStats()
+{
+    for (RowBandFilter *f = registeredFilters; f; f = f->next)
+    {
+        const ParallelStats &s = f->stats;
+        Serial.printf("[parallel] %s: runs=%lu split=%lu wall=%luus busy=%luus overhead=%luus speedup=%lu.%02lux stalls=%lu\n",
+                      f->name,
+                      (unsigned long)s.runs, (unsigned long)s.parallelRuns,
+                      (unsigned long)s.wallMicros, (unsigned long)s.busyMicros,
+                      (unsigned long)s.overheadMicros,
+                      (unsigned long)(s.speedupX100 / 100), (unsigned long)(s.speedupX100 % 100),
+                      (unsigned long)s.stalls);
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <Arduino.h>
+
+#if !defined(ESP_PLATFORM)
+#include <thread>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Dual-core fork-join scheduler
+//
+// The camera pipeline runs on the Arduino loop task (core 1). Row-local filters split
+// the frame into two row bands: the calling task processes the top band while a worker
+// task pinned to core 0 processes the bottom one, then both join before the filter
+// returns. On host builds the worker is a std::thread so filters can be checked off
+// target.
+//
+// Call from one task at a time (the loop task). A call made while the worker is busy,
+// or from inside a band callback, simply runs serially.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Number of workers a job is forked over (caller + one worker)
+const int PARALLEL_WORKERS = 2;
+
+// Timing of a band-parallel filter, updated after every call
+struct ParallelStats
+{
+    uint32_t runs;           // Calls
+    uint32_t parallelRuns;   // Calls that were actually split across both cores
+    uint32_t wallMicros;     // Last call: fork to join
+    uint32_t busyMicros;     // Last call: time spent inside band callbacks, summed over cores
+    uint32_t overheadMicros; // Last call: wall time not covered by the slowest band
+    uint32_t speedupX100;    // Smoothed busy / wall ratio x100 (200 = perfect two-core split)
+    uint32_t stalls;         // Last call: times a cooperating worker had to wait for the other
+};
+
+// Per-filter declaration of how its rows may be scheduled
+struct RowBandFilter
+{
+    const char *name;
+    bool bandParallel; // Output rows can be produced independently of each other
+    int halo;          // Rows above and below its band a callback reads from the source
+    ParallelStats stats;
+    RowBandFilter *next; // Registration list for parallelLogStats(), filled on first run
+};
+
+// Rows handed to one band callback
+struct RowBand
+{
+    int y0;     // First row to write
+    int y1;     // One past the last row to write
+    int readY0; // First row that may be read (halo included, clamped to the image)
+    int readY1; // One past the last row that may be read
+};
+
+typedef void (*RowBandFn)(const RowBand &band, void *ctx);
+typedef void (*ParallelJobFn)(int worker, void *ctx);
+
+/**
+ * Run fn(0, ctx) on the calling task and fn(1, ctx) on the other core, and wait for both
+ *
+ * Workers that need to cooperate (e.g. a wavefront) must not block on each other unless
+ * the caller has checked the return value: when no worker is available the job is not
+ * started and false is returned.
+ *
+ * @param fn Job body, called once per worker index
+ * @param ctx Job context
+ * @return false if the job could not be forked (nothing was run)
+ */
+bool parallelRun(ParallelJobFn fn, void *ctx);
+
+/**
+ * Process rows [0, height) in bands across both cores
+ *
+ * Band boundaries are multiples of rowAlign, so filters that work in blocks of rows
+ * (pixelate, CRT) can write in place. Filters that read neighbouring rows must read
+ * them from a buffer no band writes to, and declare how far in filter.halo.
+ *
+ * @param filter Filter declaration; its stats are updated
+ * @param height Number of rows
+ * @param rowAlign Band boundary alignment in rows (1 for per-pixel filters)
+ * @param fn Band callback
+ * @param ctx Callback context
+ */
+void parallelForRows(RowBandFilter &filter, int height, int rowAlign, RowBandFn fn, void *ctx);
+
+/**
+ * Record one run of a filter in its stats (parallelForRows does this itself)
+ *
+ * For cooperating jobs such as a wavefront the worker times include the time spent
+ * waiting, so compare wall time against a run with parallelSetEnabled(false) instead
+ * of reading the speedup.
+ *
+ * @param filter Filter declaration whose stats are updated
+ * @param split Whether the run was forked across both cores
+ * @param wallMicros Fork to join time
+ * @param workerMicros Time spent by each of the PARALLEL_WORKERS workers
+ * @param stalls Number of waits on the other worker
+ */
+void parallelRecordRun(RowBandFilter &filter, bool split, uint32_t wallMicros, const uint32_t *workerMicros, uint32_t stalls);
+
+// Back-off inside a spin wait on the other worker
+inline void parallelSpinPause()
+{
+#if !defined(ESP_PLATFORM)
+    // Host threads may share a core, give the other one a chance to make progress
+    std::this_thread::yield();
+#endif
+}
+
+// Globally enable or disable band splitting (for A/B timing); enabled by default
+void parallelSetEnabled(bool enabled);
+bool parallelEnabled();
+
+// Print the stats of every filter that has run so far to Serial
+void parallelLogStats();
+
+#endif // PARALLEL_H
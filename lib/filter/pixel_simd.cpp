@@ -0,0 +1,438 @@
+#include "pixel_simd.h"
+
+#if PIXEL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if PIXEL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "pixel_simd assumes a little-endian target (pixel i in the low half of a word)"
+#endif
+
+// Two pixels in one 32-bit word; may_alias so it can be read through uint16_t buffers
+typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+static inline uint16_t swap16(uint16_t pixel)
+{
+    return (pixel << 8) | (pixel >> 8);
+}
+
+static inline uint32_t swapPair(uint32_t pair)
+{
+    return ((pair & 0x00FF00FF) << 8) | ((pair >> 8) & 0x00FF00FF);
+}
+
+static inline bool wordAligned(const void *p)
+{
+    return ((uintptr_t)p & 3) == 0;
+}
+
+// True if two buffers reach word alignment at the same pixel index
+static inline bool sameAlignment(const void *a, const void *b)
+{
+    return (((uintptr_t)a ^ (uintptr_t)b) & 3) == 0;
+}
+
+void buildLut565(const uint8_t *lut8, Lut565 &out)
+{
+    for (int i = 0; i < 32; i++)
+    {
+        out.r[i] = swap16((lut8[i << 3] >> 3) << 11);
+        out.b[i] = swap16(lut8[i << 3] >> 3);
+    }
+    for (int i = 0; i < 64; i++)
+    {
+        out.g[i] = swap16((lut8[i << 2] >> 2) << 5);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Scalar reference
+
+void swapBytes565Scalar(const uint16_t *src, uint16_t *dst, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = swap16(src[i]);
+    }
+}
+
+void unpack565Scalar(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t pixel = swap16(src[i]);
+        r[i] = ((pixel >> 11) & 0x1F) << 3;
+        g[i] = ((pixel >> 5) & 0x3F) << 2;
+        b[i] = (pixel & 0x1F) << 3;
+    }
+}
+
+void pack565Scalar(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t pixel = ((r[i] >> 3) << 11) | ((g[i] >> 2) << 5) | (b[i] >> 3);
+        dst[i] = swap16(pixel);
+    }
+}
+
+void accumulate565Scalar(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB)
+{
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t pixel = swap16(src[i]);
+        sumR[i] += (pixel >> 11) & 0x1F;
+        sumG[i] += (pixel >> 5) & 0x3F;
+        sumB[i] += pixel & 0x1F;
+    }
+}
+
+void fill565Scalar(uint16_t *dst, int count, uint16_t color)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = color;
+    }
+}
+
+void applyLut565Scalar(uint16_t *pixels, int count, const Lut565 &lut)
+{
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t pixel = swap16(pixels[i]);
+        pixels[i] = lut.r[pixel >> 11] | lut.g[(pixel >> 5) & 0x3F] | lut.b[pixel & 0x1F];
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SWAR: two pixels per 32-bit word. Word accesses must be aligned on the ESP32-S3, so an
+// odd leading pixel is handled on its own and buffers that can never line up fall back
+// to the scalar loop.
+
+void swapBytes565Swar(const uint16_t *src, uint16_t *dst, int count)
+{
+    if (!sameAlignment(src, dst))
+    {
+        swapBytes565Scalar(src, dst, count);
+        return;
+    }
+
+    int i = 0;
+    if (count > 0 && !wordAligned(src))
+    {
+        dst[0] = swap16(src[0]);
+        i = 1;
+    }
+
+    const PixelPair *s = (const PixelPair *)(src + i);
+    PixelPair *d = (PixelPair *)(dst + i);
+    for (; i + 2 <= count; i += 2)
+    {
+        *d++ = swapPair(*s++);
+    }
+
+    if (i < count)
+    {
+        dst[i] = swap16(src[i]);
+    }
+}
+
+void unpack565Swar(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    int i = 0;
+    if (count > 0 && !wordAligned(src))
+    {
+        unpack565Scalar(src, 1, r, g, b);
+        i = 1;
+    }
+
+    const PixelPair *s = (const PixelPair *)(src + i);
+    for (; i + 2 <= count; i += 2)
+    {
+        uint32_t pair = swapPair(*s++);
+        uint32_t pr = ((pair >> 11) & 0x001F001F) << 3;
+        uint32_t pg = ((pair >> 5) & 0x003F003F) << 2;
+        uint32_t pb = (pair & 0x001F001F) << 3;
+
+        r[i] = (uint8_t)pr;
+        r[i + 1] = (uint8_t)(pr >> 16);
+        g[i] = (uint8_t)pg;
+        g[i + 1] = (uint8_t)(pg >> 16);
+        b[i] = (uint8_t)pb;
+        b[i + 1] = (uint8_t)(pb >> 16);
+    }
+
+    if (i < count)
+    {
+        unpack565Scalar(src + i, 1, r + i, g + i, b + i);
+    }
+}
+
+void pack565Swar(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst)
+{
+    int i = 0;
+    if (count > 0 && !wordAligned(dst))
+    {
+        pack565Scalar(r, g, b, 1, dst);
+        i = 1;
+    }
+
+    PixelPair *d = (PixelPair *)(dst + i);
+    for (; i + 2 <= count; i += 2)
+    {
+        uint32_t pr = r[i] | ((uint32_t)r[i + 1] << 16);
+        uint32_t pg = g[i] | ((uint32_t)g[i + 1] << 16);
+        uint32_t pb = b[i] | ((uint32_t)b[i + 1] << 16);
+
+        uint32_t pair = (((pr >> 3) & 0x001F001F) << 11) | (((pg >> 2) & 0x003F003F) << 5) | ((pb >> 3) & 0x001F001F);
+        *d++ = swapPair(pair);
+    }
+
+    if (i < count)
+    {
+        pack565Scalar(r + i, g + i, b + i, 1, dst + i);
+    }
+}
+
+// The column sums are added a pair at a time; each half stays below 65536 as long as
+// fewer than 1040 rows are accumulated, so no carry crosses into the other column
+void accumulate565Swar(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB)
+{
+    if (!sameAlignment(src, sumR) || !sameAlignment(src, sumG) || !sameAlignment(src, sumB))
+    {
+        accumulate565Scalar(src, count, sumR, sumG, sumB);
+        return;
+    }
+
+    int i = 0;
+    if (count > 0 && !wordAligned(src))
+    {
+        accumulate565Scalar(src, 1, sumR, sumG, sumB);
+        i = 1;
+    }
+
+    const PixelPair *s = (const PixelPair *)(src + i);
+    PixelPair *sr = (PixelPair *)(sumR + i);
+    PixelPair *sg = (PixelPair *)(sumG + i);
+    PixelPair *sb = (PixelPair *)(sumB + i);
+    for (; i + 2 <= count; i += 2)
+    {
+        uint32_t pair = swapPair(*s++);
+        *sr++ += (pair >> 11) & 0x001F001F;
+        *sg++ += (pair >> 5) & 0x003F003F;
+        *sb++ += pair & 0x001F001F;
+    }
+
+    if (i < count)
+    {
+        accumulate565Scalar(src + i, 1, sumR + i, sumG + i, sumB + i);
+    }
+}
+
+void fill565Swar(uint16_t *dst, int count, uint16_t color)
+{
+    int i = 0;
+    if (count > 0 && !wordAligned(dst))
+    {
+        dst[0] = color;
+        i = 1;
+    }
+
+    const uint32_t pair = color | ((uint32_t)color << 16);
+    PixelPair *d = (PixelPair *)(dst + i);
+    for (; i + 2 <= count; i += 2)
+    {
+        *d++ = pair;
+    }
+
+    if (i < count)
+    {
+        dst[i] = color;
+    }
+}
+
+void applyLut565Swar(uint16_t *pixels, int count, const Lut565 &lut)
+{
+    int i = 0;
+    if (count > 0 && !wordAligned(pixels))
+    {
+        applyLut565Scalar(pixels, 1, lut);
+        i = 1;
+    }
+
+    PixelPair *p = (PixelPair *)(pixels + i);
+    for (; i + 2 <= count; i += 2, p++)
+    {
+        uint32_t pair = swapPair(*p);
+        uint32_t lo = lut.r[(pair >> 11) & 0x1F] | lut.g[(pair >> 5) & 0x3F] | lut.b[pair & 0x1F];
+        uint32_t hi = lut.r[pair >> 27] | lut.g[(pair >> 21) & 0x3F] | lut.b[(pair >> 16) & 0x1F];
+        *p = lo | (hi << 16);
+    }
+
+    if (i < count)
+    {
+        applyLut565Scalar(pixels + i, 1, lut);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SSE2: eight pixels per register, unaligned loads and stores
+
+#if PIXEL_SIMD_SSE2
+
+static inline __m128i swapBytesSse2(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+void swapBytes565Sse2(const uint16_t *src, uint16_t *dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), swapBytesSse2(v));
+    }
+    swapBytes565Scalar(src + i, dst + i, count - i);
+}
+
+void unpack565Sse2(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = swapBytesSse2(_mm_loadu_si128((const __m128i *)(src + i)));
+        __m128i vr = _mm_slli_epi16(_mm_srli_epi16(v, 11), 3);
+        __m128i vg = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 5), mask6), 2);
+        __m128i vb = _mm_slli_epi16(_mm_and_si128(v, mask5), 3);
+
+        _mm_storel_epi64((__m128i *)(r + i), _mm_packus_epi16(vr, vr));
+        _mm_storel_epi64((__m128i *)(g + i), _mm_packus_epi16(vg, vg));
+        _mm_storel_epi64((__m128i *)(b + i), _mm_packus_epi16(vb, vb));
+    }
+    unpack565Scalar(src + i, count - i, r + i, g + i, b + i);
+}
+
+void pack565Sse2(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i vr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r + i)), zero);
+        __m128i vg = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(g + i)), zero);
+        __m128i vb = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(b + i)), zero);
+
+        __m128i v = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(vr, 3), 11),
+                                              _mm_slli_epi16(_mm_srli_epi16(vg, 2), 5)),
+                                 _mm_srli_epi16(vb, 3));
+        _mm_storeu_si128((__m128i *)(dst + i), swapBytesSse2(v));
+    }
+    pack565Scalar(r + i, g + i, b + i, count - i, dst + i);
+}
+
+void accumulate565Sse2(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB)
+{
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = swapBytesSse2(_mm_loadu_si128((const __m128i *)(src + i)));
+        __m128i *sr = (__m128i *)(sumR + i);
+        __m128i *sg = (__m128i *)(sumG + i);
+        __m128i *sb = (__m128i *)(sumB + i);
+
+        _mm_storeu_si128(sr, _mm_add_epi16(_mm_loadu_si128(sr), _mm_srli_epi16(v, 11)));
+        _mm_storeu_si128(sg, _mm_add_epi16(_mm_loadu_si128(sg), _mm_and_si128(_mm_srli_epi16(v, 5), mask6)));
+        _mm_storeu_si128(sb, _mm_add_epi16(_mm_loadu_si128(sb), _mm_and_si128(v, mask5)));
+    }
+    accumulate565Scalar(src + i, count - i, sumR + i, sumG + i, sumB + i);
+}
+
+#endif // PIXEL_SIMD_SSE2
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// NEON: eight pixels per register
+
+#if PIXEL_SIMD_NEON
+
+static inline uint16x8_t swapBytesNeon(uint16x8_t v)
+{
+    return vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(v)));
+}
+
+void swapBytes565Neon(const uint16_t *src, uint16_t *dst, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u16(dst + i, swapBytesNeon(vld1q_u16(src + i)));
+    }
+    swapBytes565Scalar(src + i, dst + i, count - i);
+}
+
+void unpack565Neon(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = swapBytesNeon(vld1q_u16(src + i));
+        uint16x8_t vr = vshlq_n_u16(vshrq_n_u16(v, 11), 3);
+        uint16x8_t vg = vshlq_n_u16(vandq_u16(vshrq_n_u16(v, 5), mask6), 2);
+        uint16x8_t vb = vshlq_n_u16(vandq_u16(v, mask5), 3);
+
+        vst1_u8(r + i, vmovn_u16(vr));
+        vst1_u8(g + i, vmovn_u16(vg));
+        vst1_u8(b + i, vmovn_u16(vb));
+    }
+    unpack565Scalar(src + i, count - i, r + i, g + i, b + i);
+}
+
+void pack565Neon(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t vr = vmovl_u8(vld1_u8(r + i));
+        uint16x8_t vg = vmovl_u8(vld1_u8(g + i));
+        uint16x8_t vb = vmovl_u8(vld1_u8(b + i));
+
+        uint16x8_t v = vorrq_u16(vorrq_u16(vshlq_n_u16(vshrq_n_u16(vr, 3), 11),
+                                           vshlq_n_u16(vshrq_n_u16(vg, 2), 5)),
+                                 vshrq_n_u16(vb, 3));
+        vst1q_u16(dst + i, swapBytesNeon(v));
+    }
+    pack565Scalar(r + i, g + i, b + i, count - i, dst + i);
+}
+
+void accumulate565Neon(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB)
+{
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = swapBytesNeon(vld1q_u16(src + i));
+
+        vst1q_u16(sumR + i, vaddq_u16(vld1q_u16(sumR + i), vshrq_n_u16(v, 11)));
+        vst1q_u16(sumG + i, vaddq_u16(vld1q_u16(sumG + i), vandq_u16(vshrq_n_u16(v, 5), mask6)));
+        vst1q_u16(sumB + i, vaddq_u16(vld1q_u16(sumB + i), vandq_u16(v, mask5)));
+    }
+    accumulate565Scalar(src + i, count - i, sumR + i, sumG + i, sumB + i);
+}
+
+#endif // PIXEL_SIMD_NEON
@@ -0,0 +1,128 @@
+#ifndef PIXEL_SIMD_H
+#define PIXEL_SIMD_H
+
+#include <Arduino.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Batched RGB565 pixel kernels
+//
+// Every kernel works on a run of pixels in frame byte order (the camera's big-endian
+// RGB565, i.e. byte swapped when read as uint16_t) and comes in several backends:
+//   Scalar - one pixel at a time, the reference every other backend must match
+//   Swar   - two pixels per 32-bit word, portable C; the ESP32-S3 backend
+//   Sse2   - eight pixels per 128-bit register, x86 host builds
+//   Neon   - eight pixels per 128-bit register, ARM host builds
+// The unsuffixed functions call the best backend compiled into this build.
+//
+// 565 -> 888 expansion matches the filters: r = r5 << 3, g = g6 << 2, b = b5 << 3.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__SSE2__)
+#define PIXEL_SIMD_SSE2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_SIMD_NEON 1
+#endif
+
+// Per-channel lookup table folded into RGB565 fields, already in frame byte order
+struct Lut565
+{
+    uint16_t r[32];
+    uint16_t g[64];
+    uint16_t b[32];
+};
+
+/**
+ * Build a Lut565 from an 8-bit per-channel table
+ *
+ * Entry i of each channel holds the field for lut8[i expanded to 8 bits], so applying
+ * it gives exactly what unpacking, looking up and repacking every pixel would.
+ *
+ * @param lut8 256-entry table applied to every channel
+ * @param out Table to fill
+ */
+void buildLut565(const uint8_t *lut8, Lut565 &out);
+
+// Byte swap count pixels (frame order <-> native RGB565); src and dst may be the same
+void swapBytes565Scalar(const uint16_t *src, uint16_t *dst, int count);
+void swapBytes565Swar(const uint16_t *src, uint16_t *dst, int count);
+
+// Expand count frame-order pixels into 8-bit channel planes
+void unpack565Scalar(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b);
+void unpack565Swar(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b);
+
+// Pack 8-bit channel planes into count frame-order pixels (low bits truncated)
+void pack565Scalar(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst);
+void pack565Swar(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst);
+
+// Add the raw 5/6/5-bit fields of count frame-order pixels to per-column sums
+void accumulate565Scalar(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB);
+void accumulate565Swar(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB);
+
+// Set count pixels to one color (any byte order)
+void fill565Scalar(uint16_t *dst, int count, uint16_t color);
+void fill565Swar(uint16_t *dst, int count, uint16_t color);
+
+// Map count frame-order pixels through a Lut565 in place
+void applyLut565Scalar(uint16_t *pixels, int count, const Lut565 &lut);
+void applyLut565Swar(uint16_t *pixels, int count, const Lut565 &lut);
+
+#if PIXEL_SIMD_SSE2
+void swapBytes565Sse2(const uint16_t *src, uint16_t *dst, int count);
+void unpack565Sse2(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b);
+void pack565Sse2(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst);
+void accumulate565Sse2(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB);
+#endif
+
+#if PIXEL_SIMD_NEON
+void swapBytes565Neon(const uint16_t *src, uint16_t *dst, int count);
+void unpack565Neon(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b);
+void pack565Neon(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst);
+void accumulate565Neon(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Best backend of this build
+
+#if PIXEL_SIMD_SSE2
+#define PIXEL_SIMD_BACKEND(fn) fn##Sse2
+#elif PIXEL_SIMD_NEON
+#define PIXEL_SIMD_BACKEND(fn) fn##Neon
+#else
+#define PIXEL_SIMD_BACKEND(fn) fn##Swar
+#endif
+
+inline void swapBytes565(const uint16_t *src, uint16_t *dst, int count)
+{
+    PIXEL_SIMD_BACKEND(swapBytes565)(src, dst, count);
+}
+
+inline void unpack565(const uint16_t *src, int count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    PIXEL_SIMD_BACKEND(unpack565)(src, count, r, g, b);
+}
+
+inline void pack565(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count, uint16_t *dst)
+{
+    PIXEL_SIMD_BACKEND(pack565)(r, g, b, count, dst);
+}
+
+inline void accumulate565(const uint16_t *src, int count, uint16_t *sumR, uint16_t *sumG, uint16_t *sumB)
+{
+    PIXEL_SIMD_BACKEND(accumulate565)(src, count, sumR, sumG, sumB);
+}
+
+// Runs are a block wide (a few pixels), too short for 128-bit stores to pay off
+inline void fill565(uint16_t *dst, int count, uint16_t color)
+{
+    fill565Swar(dst, count, color);
+}
+
+// Table lookups do not vectorize without a gather, so every build uses the SWAR loop
+inline void applyLut565(uint16_t *pixels, int count, const Lut565 &lut)
+{
+    applyLut565Swar(pixels, count, lut);
+}
+
+#endif // PIXEL_SIMD_H
@@ -0,0 +1,130 @@
+#include "quality_governor.h"
+#include "diffusion.h"
+
+// Going back up to a better level is only tried after this many hold periods, since the
+// level that was over budget usually still is
+static const int GOVERNOR_STEP_DOWN_HOLD = 4;
+
+// Step down in quality when the smoothed time is over budget by 1/8; step back up only
+// when there is plenty of room (under 60% of budget)
+static bool overBudget(const QualityGovernor &governor)
+{
+    return governor.smoothedMicros > governor.targetMicros + governor.targetMicros / 8;
+}
+
+static bool wellUnderBudget(const QualityGovernor &governor)
+{
+    return governor.smoothedMicros < governor.targetMicros * 3 / 5;
+}
+
+static bool sameRecipe(const PreviewRecipe &a, const PreviewRecipe &b)
+{
+    return a.dithering == b.dithering && a.pixelSize == b.pixelSize && a.autoAdjust == b.autoAdjust;
+}
+
+// True if a level degrades anything compared to the level below it
+static bool levelChangesRecipe(const PreviewRecipe &requested, int level)
+{
+    switch (level)
+    {
+    case 1:
+        return requested.autoAdjust;
+    case 2:
+        return isDiffusionDither(requested.dithering);
+    case 3:
+    case 4:
+        return governorRecipe(requested, level).pixelSize != governorRecipe(requested, level - 1).pixelSize;
+    default:
+        return false;
+    }
+}
+
+void governorInit(QualityGovernor &governor, uint32_t targetMicros, int holdFrames)
+{
+    governor.targetMicros = targetMicros;
+    governor.smoothedMicros = 0;
+    governor.level = 0;
+    governor.framesAtLevel = 0;
+    governor.holdFrames = holdFrames;
+    governor.requested = {0, 1, false};
+}
+
+int governorUpdate(QualityGovernor &governor, const PreviewRecipe &requested, uint32_t frameMicros)
+{
+    if (!sameRecipe(requested, governor.requested))
+    {
+        governor.requested = requested;
+        governor.level = 0;
+        governor.framesAtLevel = 0;
+        governor.smoothedMicros = frameMicros;
+        return 0;
+    }
+
+    // 1/4 weight: reacts within a few frames, ignores a single slow one
+    if (governor.framesAtLevel == 0)
+    {
+        governor.smoothedMicros = frameMicros;
+    }
+    else
+    {
+        governor.smoothedMicros = governor.smoothedMicros - governor.smoothedMicros / 4 + frameMicros / 4;
+    }
+    governor.framesAtLevel++;
+
+    if (governor.framesAtLevel < governor.holdFrames)
+    {
+        return governor.level;
+    }
+
+    int level = governor.level;
+    if (overBudget(governor))
+    {
+        do
+        {
+            level++;
+        } while (level <= GOVERNOR_MAX_LEVEL && !levelChangesRecipe(requested, level));
+        if (level > GOVERNOR_MAX_LEVEL)
+        {
+            return governor.level; // Nothing left to give up
+        }
+    }
+    else if (wellUnderBudget(governor) && governor.level > 0 &&
+             governor.framesAtLevel >= governor.holdFrames * GOVERNOR_STEP_DOWN_HOLD)
+    {
+        do
+        {
+            level--;
+        } while (level > 0 && !levelChangesRecipe(requested, level));
+    }
+    else
+    {
+        return governor.level;
+    }
+
+    governor.level = level;
+    governor.framesAtLevel = 0;
+    return level;
+}
+
+PreviewRecipe governorRecipe(const PreviewRecipe &requested, int level)
+{
+    PreviewRecipe recipe = requested;
+
+    if (level >= 2 && isDiffusionDither(recipe.dithering))
+    {
+        recipe.dithering = GOVERNOR_ORDERED_DITHER;
+    }
+    for (int l = 3; l <= level && l <= GOVERNOR_MAX_LEVEL; l++)
+    {
+        if (recipe.pixelSize > 0 && recipe.pixelSize < 8)
+        {
+            recipe.pixelSize *= 2;
+        }
+    }
+    return recipe;
+}
+
+bool governorRefreshAutoAdjust(int level, uint32_t frameIndex)
+{
+    return level < 1 || frameIndex % GOVERNOR_AUTO_ADJUST_INTERVAL == 0;
+}
@@ -0,0 +1,84 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Preview quality governor
+//
+// Watches how long the preview spends processing each frame and, when the selected
+// recipe is over budget, degrades the preview one level at a time until it fits:
+//
+//   Level 1  Auto-adjust histogram refreshed every few frames instead of every frame
+//   Level 2  Error diffusion replaced by blue-noise ordered dithering
+//   Level 3  Pixel size doubled
+//   Level 4  Pixel size doubled again (up to 8)
+//
+// Levels that would change nothing for the selected recipe are skipped. Frame times are
+// smoothed and every change is held for a number of frames, with a wide gap between the
+// step-up and step-down thresholds, so the preview does not flicker between levels.
+//
+// Captures do not go through the governor. Plain integer logic with no driver
+// dependency, so policies can be replayed on the host against synthetic timing traces.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const int GOVERNOR_MAX_LEVEL = 4;
+const int GOVERNOR_AUTO_ADJUST_INTERVAL = 8; // Frames between histogram refreshes at level 1+
+const int GOVERNOR_ORDERED_DITHER = 3;       // Blue noise
+
+// What the preview runs for one frame
+struct PreviewRecipe
+{
+    int dithering;   // Dither type as used by applyColorPalette (0 = none)
+    int pixelSize;   // 1, 2, 4 or 8 (0 = the filter has no pixel size)
+    bool autoAdjust; // Auto-adjust enabled
+};
+
+struct QualityGovernor
+{
+    uint32_t targetMicros;   // Processing time budget per frame
+    uint32_t smoothedMicros; // Exponential average of recent frame times
+    int level;               // 0 = full quality
+    int framesAtLevel;       // Frames since the last level change
+    int holdFrames;          // Frames to wait after a change before stepping again
+    PreviewRecipe requested; // Recipe the governed levels were computed for
+};
+
+/**
+ * Reset to full quality
+ *
+ * @param governor Governor to set up
+ * @param targetMicros Processing time budget per frame
+ * @param holdFrames Frames to wait after a level change before judging it
+ */
+void governorInit(QualityGovernor &governor, uint32_t targetMicros, int holdFrames);
+
+/**
+ * Feed the processing time of one preview frame
+ *
+ * A change of requested recipe returns the governor to full quality first.
+ *
+ * @param governor Governor state
+ * @param requested Recipe the user selected
+ * @param frameMicros Time the frame took to process
+ * @return Level to use for the next frame
+ */
+int governorUpdate(QualityGovernor &governor, const PreviewRecipe &requested, uint32_t frameMicros);
+
+/**
+ * Recipe to run at a level
+ *
+ * @param requested Recipe the user selected
+ * @param level Governor level (0 returns the requested recipe)
+ */
+PreviewRecipe governorRecipe(const PreviewRecipe &requested, int level);
+
+/**
+ * Whether the auto-adjust histogram should be rebuilt for a frame
+ *
+ * @param level Governor level
+ * @param frameIndex Running preview frame count
+ */
+bool governorRefreshAutoAdjust(int level, uint32_t frameIndex);
+
+#endif // QUALITY_GOVERNOR_H
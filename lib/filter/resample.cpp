@@ -0,0 +1,401 @@
+#include "resample.h"
+#include "block_reduce.h"
+#include "pixel_simd.h"
+
+static inline uint16_t swap16(uint16_t pixel)
+{
+    return (pixel << 8) | (pixel >> 8);
+}
+
+/**
+ * Step one axis of the window with a 16.16 DDA and fill its tables
+ *
+ * @param start First source index of the window
+ * @param length Window length in source pixels
+ * @param outLength Output length
+ * @param mode Sampling mode
+ * @param index Per output index: source index (nearest), first index (box), low index (bilinear)
+ * @param span Box: indices covered; Bilinear: high index
+ * @param weight Bilinear: weight of the high index
+ * @return Widest span (box), 1 otherwise
+ */
+static int buildAxis(int start, int length, int outLength, ResampleMode mode,
+                     uint16_t *index, uint16_t *span, uint8_t *weight)
+{
+    const uint32_t step = ((uint32_t)length << 16) / outLength;
+    const int last = length - 1;
+    int widest = 1;
+
+    if (mode == RESAMPLE_NEAREST)
+    {
+        // Sample under the output pixel center
+        uint32_t pos = step >> 1;
+        for (int i = 0; i < outLength; i++, pos += step)
+        {
+            index[i] = start + min((int)(pos >> 16), last);
+        }
+    }
+    else if (mode == RESAMPLE_BOX)
+    {
+        // Cover [i * step, (i + 1) * step); upscaling degenerates to one pixel per output
+        uint32_t pos = 0;
+        for (int i = 0; i < outLength; i++)
+        {
+            int a = min((int)(pos >> 16), last);
+            pos += step;
+            int b = (i == outLength - 1) ? length : min((int)(pos >> 16), length);
+            if (b <= a)
+            {
+                b = a + 1;
+            }
+            index[i] = start + a;
+            span[i] = b - a;
+            widest = max(widest, b - a);
+        }
+    }
+    else
+    {
+        // Output centers mapped back to source coordinates, half a pixel before the center
+        int32_t pos = (int32_t)(step >> 1) - 0x8000;
+        for (int i = 0; i < outLength; i++, pos += step)
+        {
+            int32_t p = (pos < 0) ? 0 : pos;
+            int low = p >> 16;
+            int w = (p >> 8) & 0xFF;
+            if (low >= last)
+            {
+                low = last;
+                w = 0;
+            }
+            index[i] = start + low;
+            span[i] = start + min(low + 1, last);
+            weight[i] = w;
+        }
+    }
+
+    return widest;
+}
+
+void resamplerRelease(Resampler &resampler)
+{
+    free(resampler.columnX);
+    free(resampler.rowY);
+    free(resampler.lines);
+    free(resampler.divisors);
+    memset(&resampler, 0, sizeof(resampler));
+}
+
+bool resamplerPrepare(Resampler &resampler, int srcWidth, int srcHeight, const ResampleWindow &window,
+                      int dstWidth, int dstHeight, ResampleMode mode)
+{
+    ResampleWindow clipped;
+    clipped.x = constrain(window.x, 0, srcWidth - 1);
+    clipped.y = constrain(window.y, 0, srcHeight - 1);
+    clipped.width = min(window.width, srcWidth - clipped.x);
+    clipped.height = min(window.height, srcHeight - clipped.y);
+
+    if (srcWidth <= 0 || srcHeight <= 0 || srcWidth > 0x7FFF || srcHeight > 0x7FFF ||
+        clipped.width <= 0 || clipped.height <= 0 || dstWidth <= 0 || dstHeight <= 0)
+    {
+        return false;
+    }
+
+    if (resampler.columnX && resampler.mode == mode &&
+        resampler.srcWidth == srcWidth && resampler.srcHeight == srcHeight &&
+        resampler.window.x == clipped.x && resampler.window.y == clipped.y &&
+        resampler.window.width == clipped.width && resampler.window.height == clipped.height &&
+        resampler.dstWidth == dstWidth && resampler.dstHeight == dstHeight)
+    {
+        return true;
+    }
+
+    resamplerRelease(resampler);
+
+    // One allocation per axis: index, span and weight tables back to back
+    const size_t entryBytes = 2 * sizeof(uint16_t) + sizeof(uint8_t);
+    uint8_t *columns = (uint8_t *)malloc(dstWidth * entryBytes);
+    uint8_t *rows = (uint8_t *)malloc(dstHeight * entryBytes);
+
+    int lineCount = (mode == RESAMPLE_BOX) ? 1 : (mode == RESAMPLE_BILINEAR) ? 2 : 0;
+    uint32_t *lines = nullptr;
+    if (lineCount)
+    {
+        lines = (uint32_t *)malloc(lineCount * dstWidth * 3 * sizeof(uint32_t));
+    }
+
+    if (!columns || !rows || (lineCount && !lines))
+    {
+        free(columns);
+        free(rows);
+        free(lines);
+        return false;
+    }
+
+    resampler.mode = mode;
+    resampler.srcWidth = srcWidth;
+    resampler.srcHeight = srcHeight;
+    resampler.window = clipped;
+    resampler.dstWidth = dstWidth;
+    resampler.dstHeight = dstHeight;
+    resampler.columnX = (uint16_t *)columns;
+    resampler.columnSpan = resampler.columnX + dstWidth;
+    resampler.columnWeight = (uint8_t *)(resampler.columnSpan + dstWidth);
+    resampler.rowY = (uint16_t *)rows;
+    resampler.rowSpan = resampler.rowY + dstHeight;
+    resampler.rowWeight = (uint8_t *)(resampler.rowSpan + dstHeight);
+    resampler.lines = lines;
+
+    resampler.maxColumnSpan = buildAxis(clipped.x, clipped.width, dstWidth, mode,
+                                        resampler.columnX, resampler.columnSpan, resampler.columnWeight);
+    buildAxis(clipped.y, clipped.height, dstHeight, mode,
+              resampler.rowY, resampler.rowSpan, resampler.rowWeight);
+
+    if (mode == RESAMPLE_BOX)
+    {
+        resampler.divisors = (BlockDivisor *)malloc((resampler.maxColumnSpan + 1) * sizeof(BlockDivisor));
+        if (!resampler.divisors)
+        {
+            resamplerRelease(resampler);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static void resampleNearest(const Resampler &rs, const uint16_t *src, uint16_t *dst, int dstStride, int y0, int y1, bool swapOutput)
+{
+    const uint16_t *columnX = rs.columnX;
+    int previousY = -1;
+    uint16_t *previousRow = nullptr;
+
+    for (int y = y0; y < y1; y++)
+    {
+        uint16_t *dstRow = dst + (y - y0) * dstStride;
+
+        // Upscaling repeats source rows: copy the finished output row instead
+        if (rs.rowY[y] == previousY)
+        {
+            memcpy(dstRow, previousRow, rs.dstWidth * sizeof(uint16_t));
+            continue;
+        }
+
+        const uint16_t *srcRow = src + rs.rowY[y] * rs.srcWidth;
+        for (int x = 0; x < rs.dstWidth; x++)
+        {
+            dstRow[x] = srcRow[columnX[x]];
+        }
+
+        if (swapOutput)
+        {
+            swapBytes565(dstRow, dstRow, rs.dstWidth);
+        }
+
+        previousY = rs.rowY[y];
+        previousRow = dstRow;
+    }
+}
+
+static void resampleBox(const Resampler &rs, const uint16_t *src, uint16_t *dst, int dstStride, int y0, int y1, bool swapOutput)
+{
+    const int width = rs.dstWidth;
+    uint32_t *sumR = rs.lines;
+    uint32_t *sumG = sumR + width;
+    uint32_t *sumB = sumG + width;
+
+    for (int y = y0; y < y1; y++)
+    {
+        const int rowCount = rs.rowSpan[y];
+
+        memset(sumR, 0, width * 3 * sizeof(uint32_t));
+        for (int sy = rs.rowY[y]; sy < rs.rowY[y] + rowCount; sy++)
+        {
+            const uint16_t *srcRow = src + sy * rs.srcWidth;
+            for (int x = 0; x < width; x++)
+            {
+                const uint16_t *p = srcRow + rs.columnX[x];
+                const uint16_t *end = p + rs.columnSpan[x];
+                uint32_t r = 0, g = 0, b = 0;
+                for (; p < end; p++)
+                {
+                    uint16_t pixel = swap16(*p);
+                    r += pixel >> 11;
+                    g += (pixel >> 5) & 0x3F;
+                    b += pixel & 0x1F;
+                }
+                sumR[x] += r;
+                sumG[x] += g;
+                sumB[x] += b;
+            }
+        }
+
+        // Area sums only take a couple of column spans per row, so set their divisors once
+        for (int span = 1; span <= rs.maxColumnSpan; span++)
+        {
+            rs.divisors[span].set(span * rowCount);
+        }
+
+        uint16_t *dstRow = dst + (y - y0) * dstStride;
+        for (int x = 0; x < width; x++)
+        {
+            const BlockDivisor &pixels = rs.divisors[rs.columnSpan[x]];
+            const uint32_t half = pixels.count >> 1;
+            uint16_t pixel = (pixels.divide(sumR[x] + half) << 11) |
+                             (pixels.divide(sumG[x] + half) << 5) |
+                             pixels.divide(sumB[x] + half);
+            dstRow[x] = swapOutput ? pixel : swap16(pixel);
+        }
+    }
+}
+
+// Horizontally interpolate one source row into 8.8 fixed-point field lines
+static void filterBilinearLine(const Resampler &rs, const uint16_t *srcRow, uint32_t *line)
+{
+    const int width = rs.dstWidth;
+    uint32_t *lineR = line;
+    uint32_t *lineG = line + width;
+    uint32_t *lineB = line + 2 * width;
+
+    for (int x = 0; x < width; x++)
+    {
+        uint16_t left = swap16(srcRow[rs.columnX[x]]);
+        uint16_t right = swap16(srcRow[rs.columnSpan[x]]);
+        uint32_t wr = rs.columnWeight[x];
+        uint32_t wl = 256 - wr;
+
+        lineR[x] = (left >> 11) * wl + (right >> 11) * wr;
+        lineG[x] = ((left >> 5) & 0x3F) * wl + ((right >> 5) & 0x3F) * wr;
+        lineB[x] = (left & 0x1F) * wl + (right & 0x1F) * wr;
+    }
+}
+
+// Filtered line holding source row sy, filling a slot not holding keepRow if needed
+static uint32_t *bilinearLine(Resampler &rs, const uint16_t *src, int sy, int keepRow)
+{
+    const int lineSize = rs.dstWidth * 3;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (rs.lineRows[i] == sy)
+        {
+            return rs.lines + i * lineSize;
+        }
+    }
+
+    int slot = (rs.lineRows[0] == keepRow) ? 1 : 0;
+    uint32_t *line = rs.lines + slot * lineSize;
+    filterBilinearLine(rs, src + sy * rs.srcWidth, line);
+    rs.lineRows[slot] = sy;
+    return line;
+}
+
+static void resampleBilinear(Resampler &rs, const uint16_t *src, uint16_t *dst, int dstStride, int y0, int y1, bool swapOutput)
+{
+    const int width = rs.dstWidth;
+
+    // Cached lines may be reused by later row ranges of the same frame, never by a new frame
+    if (y0 == 0)
+    {
+        rs.lineRows[0] = -1;
+        rs.lineRows[1] = -1;
+    }
+
+    for (int y = y0; y < y1; y++)
+    {
+        const uint32_t *top = bilinearLine(rs, src, rs.rowY[y], -1);
+        const uint32_t *bottom = bilinearLine(rs, src, rs.rowSpan[y], rs.rowY[y]);
+        uint32_t wb = rs.rowWeight[y];
+        uint32_t wt = 256 - wb;
+
+        uint16_t *dstRow = dst + (y - y0) * dstStride;
+        for (int x = 0; x < width; x++)
+        {
+            uint32_t r = (top[x] * wt + bottom[x] * wb + 0x8000) >> 16;
+            uint32_t g = (top[x + width] * wt + bottom[x + width] * wb + 0x8000) >> 16;
+            uint32_t b = (top[x + 2 * width] * wt + bottom[x + 2 * width] * wb + 0x8000) >> 16;
+            uint16_t pixel = (r << 11) | (g << 5) | b;
+            dstRow[x] = swapOutput ? pixel : swap16(pixel);
+        }
+    }
+}
+
+void resampleRows(Resampler &resampler, const uint16_t *src, uint16_t *dst, int dstStride, int y0, int y1, bool swapOutput)
+{
+    if (!resampler.columnX || !src || !dst)
+    {
+        return;
+    }
+
+    y0 = max(y0, 0);
+    y1 = min(y1, resampler.dstHeight);
+    if (y0 >= y1)
+    {
+        return;
+    }
+
+    switch (resampler.mode)
+    {
+    case RESAMPLE_BOX:
+        resampleBox(resampler, src, dst, dstStride, y0, y1, swapOutput);
+        break;
+    case RESAMPLE_BILINEAR:
+        resampleBilinear(resampler, src, dst, dstStride, y0, y1, swapOutput);
+        break;
+    default:
+        resampleNearest(resampler, src, dst, dstStride, y0, y1, swapOutput);
+        break;
+    }
+}
+
+void resampleFrame(Resampler &resampler, const uint16_t *src, uint16_t *dst, int dstStride, bool swapOutput)
+{
+    resampleRows(resampler, src, dst, dstStride, 0, resampler.dstHeight, swapOutput);
+}
+
+void resampleIndexedFrame(const Resampler &resampler, const uint8_t *src, uint16_t *dst, int dstStride, const uint16_t *lut)
+{
+    if (!resampler.columnX || resampler.mode != RESAMPLE_NEAREST || !src || !dst || !lut)
+    {
+        return;
+    }
+
+    const uint16_t *columnX = resampler.columnX;
+    int previousY = -1;
+    uint16_t *previousRow = nullptr;
+
+    for (int y = 0; y < resampler.dstHeight; y++)
+    {
+        uint16_t *dstRow = dst + y * dstStride;
+        if (resampler.rowY[y] == previousY)
+        {
+            memcpy(dstRow, previousRow, resampler.dstWidth * sizeof(uint16_t));
+            continue;
+        }
+
+        const uint8_t *srcRow = src + resampler.rowY[y] * resampler.srcWidth;
+        for (int x = 0; x < resampler.dstWidth; x++)
+        {
+            dstRow[x] = lut[srcRow[columnX[x]]];
+        }
+
+        previousY = resampler.rowY[y];
+        previousRow = dstRow;
+    }
+}
+
+bool resampleImage(const uint16_t *src, int srcWidth, int srcHeight, uint16_t *dst, int dstWidth, int dstHeight, ResampleMode mode)
+{
+    Resampler resampler = {};
+    ResampleWindow window = {0, 0, srcWidth, srcHeight};
+
+    if (!resamplerPrepare(resampler, srcWidth, srcHeight, window, dstWidth, dstHeight, mode))
+    {
+        return false;
+    }
+
+    resampleFrame(resampler, src, dst, dstWidth, false);
+    resamplerRelease(resampler);
+    return true;
+}
@@ -0,0 +1,136 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <Arduino.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Fixed-point RGB565 resampler
+//
+// Scales a window of a frame to any output size. All source positions are stepped with
+// a 16.16 fixed-point DDA when the plan is prepared and stored in per-column and per-row
+// tables, so producing a frame needs no division or float math per pixel. Output rows
+// are streamed straight into the destination, which may be the source frame itself when
+// shrinking (see resampleFrame).
+//
+// Modes:
+//   Nearest  - source pixel under each output pixel center
+//   Box      - average of every source pixel the output pixel covers (area downscale)
+//   Bilinear - blend of the four source pixels around each output pixel center
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct BlockDivisor;
+
+enum ResampleMode
+{
+    RESAMPLE_NEAREST = 0,
+    RESAMPLE_BOX,
+    RESAMPLE_BILINEAR
+};
+
+struct ResampleWindow
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Tables and line buffers for one source window / output size / mode combination
+struct Resampler
+{
+    ResampleMode mode;
+    int srcWidth;  // Source row stride in pixels
+    int srcHeight;
+    ResampleWindow window;
+    int dstWidth;
+    int dstHeight;
+
+    uint16_t *columnX;      // Nearest: source column; Box: first column; Bilinear: left column
+    uint16_t *columnSpan;   // Box: columns covered; Bilinear: right column
+    uint8_t *columnWeight;  // Bilinear: weight of the right column (0-255)
+    uint16_t *rowY;         // Same meaning as columnX, per output row
+    uint16_t *rowSpan;      // Same meaning as columnSpan, per output row
+    uint8_t *rowWeight;     // Same meaning as columnWeight, per output row
+    uint32_t *lines;        // Box: one line of field sums; Bilinear: two filtered lines
+    int lineRows[2];        // Bilinear: source row held by each filtered line (-1 = none)
+    int maxColumnSpan;      // Box: widest column span
+    BlockDivisor *divisors; // Box: divisor per column span for the current output row
+};
+
+/**
+ * Build (or keep) the tables for a resampling job
+ *
+ * Call with a zero-initialized Resampler the first time. If every parameter matches the
+ * previous call nothing is rebuilt, so a static Resampler can be prepared once per frame.
+ *
+ * @param resampler Plan to fill
+ * @param srcWidth Source frame width (row stride)
+ * @param srcHeight Source frame height
+ * @param window Source region to scale, clamped to the frame
+ * @param dstWidth Output width
+ * @param dstHeight Output height
+ * @param mode Sampling mode
+ * @return false if the sizes are invalid or the tables could not be allocated
+ */
+bool resamplerPrepare(Resampler &resampler, int srcWidth, int srcHeight, const ResampleWindow &window,
+                      int dstWidth, int dstHeight, ResampleMode mode);
+
+/**
+ * Free the tables of a plan; it can be prepared again afterwards
+ */
+void resamplerRelease(Resampler &resampler);
+
+/**
+ * Scale the plan's window of a frame into dst
+ *
+ * Both frames are in frame byte order. dst may be the same buffer as src when the
+ * window starts at the origin and the output is no larger than the window in either
+ * direction: every output pixel is then written only after the source pixels at and
+ * beyond it have been read.
+ *
+ * @param resampler Prepared plan
+ * @param src Source frame
+ * @param dst Output pixels
+ * @param dstStride Output row stride in pixels
+ * @param swapOutput Byte swap the output to native RGB565 (for display buffers)
+ */
+void resampleFrame(Resampler &resampler, const uint16_t *src, uint16_t *dst, int dstStride, bool swapOutput);
+
+/**
+ * Produce output rows [y0, y1) only, for streaming a frame out in bands
+ *
+ * Row ranges of one frame should be requested in increasing order starting at row 0
+ * (ranges may overlap); starting at row 0 again begins a new frame.
+ *
+ * @param resampler Prepared plan
+ * @param src Source frame
+ * @param dst Where output row y0 goes
+ * @param dstStride Output row stride in pixels
+ * @param y0 First output row
+ * @param y1 One past the last output row
+ * @param swapOutput Byte swap the output to native RGB565
+ */
+void resampleRows(Resampler &resampler, const uint16_t *src, uint16_t *dst, int dstStride, int y0, int y1, bool swapOutput);
+
+/**
+ * Nearest-neighbour scale of a palette-indexed frame, expanded to RGB565 through a LUT
+ *
+ * The plan must be RESAMPLE_NEAREST (indices cannot be blended); src is one byte per
+ * pixel with the plan's source stride.
+ *
+ * @param resampler Prepared plan
+ * @param src Source indices
+ * @param dst Output pixels
+ * @param dstStride Output row stride in pixels
+ * @param lut RGB565 color of each index, in the byte order wanted in dst
+ */
+void resampleIndexedFrame(const Resampler &resampler, const uint8_t *src, uint16_t *dst, int dstStride, const uint16_t *lut);
+
+/**
+ * One-shot resample of a whole frame (prepares and releases its own plan)
+ *
+ * @return false if the plan could not be prepared
+ */
+bool resampleImage(const uint16_t *src, int srcWidth, int srcHeight, uint16_t *dst, int dstWidth, int dstHeight, ResampleMode mode);
+
+#endif // RESAMPLE_H
@@ -0,0 +1,345 @@
+#include "tile_cache.h"
+#include "parallel.h"
+
+// Tiles are at least this many pixels on a side so the per-tile overhead (copy in,
+// filter call, copy out) stays small next to the filtering itself
+static const int TILE_MIN_SIZE = 16;
+
+// Luma change per sample that still counts as sensor noise (samples run 0..125)
+static const int TILE_NOISE_LEVEL = 6;
+
+// Samples past the noise level that make a tile changed; one is easily a hot pixel
+static const int TILE_CHANGED_SAMPLES = 3;
+
+// Above this share of changed tiles (in 1/8ths) one whole-frame pass is cheaper
+static const int TILE_FULL_FRAME_EIGHTHS = 6;
+
+// Luma proxy of a frame-order RGB565 pixel: r5 + g6 + b5 (0..125)
+static inline int tileLuma(uint16_t pixel)
+{
+    uint16_t value = (pixel << 8) | (pixel >> 8);
+    return (value >> 11) + ((value >> 5) & 0x3F) + (value & 0x1F);
+}
+
+static int roundUp(int value, int multiple)
+{
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+// Smallest multiple of period covering TILE_MIN_SIZE, kept even so tiles start on a sample
+static int tileSize(int period)
+{
+    int size = roundUp(TILE_MIN_SIZE, period);
+    return (size & 1) ? size + period : size;
+}
+
+static void freeBuffers(TileCache &cache)
+{
+    free(cache.current);
+    free(cache.filtered);
+    free(cache.dirty);
+    free(cache.output);
+    free(cache.scratch);
+    cache.current = nullptr;
+    cache.filtered = nullptr;
+    cache.dirty = nullptr;
+    cache.output = nullptr;
+    cache.scratch = nullptr;
+}
+
+// (Re)build the tile grid for a frame size and filter period; false if out of memory
+static bool layoutTiles(TileCache &cache, int width, int height, int alignX, int alignY, int halo)
+{
+    int tileWidth = tileSize(alignX);
+    int tileHeight = tileSize(alignY);
+    // The halo is read around each tile; keep it on the filter's period too
+    int haloX = halo ? roundUp(halo, alignX) : 0;
+    int haloY = halo ? roundUp(halo, alignY) : 0;
+    int paddedHalo = max(haloX, haloY);
+
+    if (cache.output && cache.width == width && cache.height == height && cache.tileWidth == tileWidth &&
+        cache.tileHeight == tileHeight && cache.halo == paddedHalo)
+    {
+        return true;
+    }
+
+    freeBuffers(cache);
+    cache.valid = false;
+    cache.width = width;
+    cache.height = height;
+    cache.tileWidth = tileWidth;
+    cache.tileHeight = tileHeight;
+    cache.halo = paddedHalo;
+    cache.columns = (width + tileWidth - 1) / tileWidth;
+    cache.rows = (height + tileHeight - 1) / tileHeight;
+    cache.refreshFrame = 0;
+
+    cache.sampleStride = width / 2;
+
+    // Under 11 KB per plane at preview size; compared every frame, so internal RAM
+    int tiles = cache.columns * cache.rows;
+    int samples = cache.sampleStride * ((height + 1) / 2);
+    cache.current = (uint8_t *)malloc(samples);
+    cache.filtered = (uint8_t *)malloc(samples);
+    cache.dirty = (uint8_t *)malloc(tiles);
+    cache.output = (uint16_t *)ps_malloc(width * height * sizeof(uint16_t));
+    cache.scratch = (uint16_t *)ps_malloc((tileWidth + 2 * paddedHalo) * (tileHeight + 2 * paddedHalo) * sizeof(uint16_t));
+    if (!cache.current || !cache.filtered || !cache.dirty || !cache.output || !cache.scratch)
+    {
+        freeBuffers(cache);
+        return false;
+    }
+    return true;
+}
+
+// Luma plane of the frame: the mean of each 2x2 block, so both row parities are seen
+// (a last odd row pairs with itself)
+static void sampleLuma(const TileCache &cache, const uint16_t *pixels)
+{
+    uint8_t *out = cache.current;
+    for (int y = 0; y < cache.height; y += 2)
+    {
+        const uint16_t *row = pixels + y * cache.width;
+        const uint16_t *next = (y + 1 < cache.height) ? row + cache.width : row;
+        for (int i = 0; i < cache.sampleStride; i++)
+        {
+            int sum = tileLuma(row[2 * i]) + tileLuma(row[2 * i + 1]) + tileLuma(next[2 * i]) +
+                      tileLuma(next[2 * i + 1]);
+            *out++ = (uint8_t)((sum + 2) >> 2);
+        }
+    }
+}
+
+// Sample rectangle of a tile
+static void tileSamples(const TileCache &cache, int tx, int ty, int &sx0, int &sy0, int &sx1, int &sy1)
+{
+    sx0 = tx * cache.tileWidth / 2;
+    sy0 = ty * cache.tileHeight / 2;
+    sx1 = min((tx + 1) * cache.tileWidth / 2, cache.sampleStride);
+    sy1 = min(((ty + 1) * cache.tileHeight + 1) / 2, (cache.height + 1) / 2);
+}
+
+static bool tileChanged(const TileCache &cache, int tx, int ty)
+{
+    int sx0, sy0, sx1, sy1;
+    tileSamples(cache, tx, ty, sx0, sy0, sx1, sy1);
+
+    int changed = 0;
+    for (int sy = sy0; sy < sy1; sy++)
+    {
+        const uint8_t *now = cache.current + sy * cache.sampleStride;
+        const uint8_t *then = cache.filtered + sy * cache.sampleStride;
+        for (int sx = sx0; sx < sx1; sx++)
+        {
+            int d = now[sx] - then[sx];
+            if (d > TILE_NOISE_LEVEL || d < -TILE_NOISE_LEVEL)
+            {
+                if (++changed >= TILE_CHANGED_SAMPLES)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Remember the samples a tile was filtered from
+static void keepTileSamples(TileCache &cache, int tx, int ty)
+{
+    int sx0, sy0, sx1, sy1;
+    tileSamples(cache, tx, ty, sx0, sy0, sx1, sy1);
+
+    for (int sy = sy0; sy < sy1; sy++)
+    {
+        int offset = sy * cache.sampleStride + sx0;
+        memcpy(cache.filtered + offset, cache.current + offset, sx1 - sx0);
+    }
+}
+
+// Mark this frame's share of the rotation dirty (each tile once per TILE_REFRESH_FRAMES
+// frames); returns how many were not already
+static int markRefreshTiles(TileCache &cache)
+{
+    int tiles = cache.columns * cache.rows;
+    int first = tiles * cache.refreshFrame / TILE_REFRESH_FRAMES;
+    int end = tiles * (cache.refreshFrame + 1) / TILE_REFRESH_FRAMES;
+    int count = 0;
+
+    for (int t = first; t < end; t++)
+    {
+        if (!cache.dirty[t])
+        {
+            cache.dirty[t] = 3; // Refreshed; its neighbours get their own turn
+            count++;
+        }
+    }
+    cache.refreshFrame = (cache.refreshFrame + 1) % TILE_REFRESH_FRAMES;
+    return count;
+}
+
+// Mark tiles that changed since they were last filtered, and the tiles due for a
+// refresh; returns how many
+static int markDirtyTiles(TileCache &cache)
+{
+    int tiles = cache.columns * cache.rows;
+    int count = 0;
+
+    for (int t = 0; t < tiles; t++)
+    {
+        cache.dirty[t] = tileChanged(cache, t % cache.columns, t / cache.columns) ? 1 : 0;
+        count += cache.dirty[t];
+    }
+
+    if (cache.halo == 0)
+    {
+        return count + markRefreshTiles(cache);
+    }
+
+    // A filter reading across tile edges changes near a changed neighbour too
+    for (int t = 0; t < tiles; t++)
+    {
+        if (cache.dirty[t] != 1)
+        {
+            continue;
+        }
+        int tx = t % cache.columns;
+        int ty = t / cache.columns;
+        for (int ny = max(ty - 1, 0); ny <= min(ty + 1, cache.rows - 1); ny++)
+        {
+            for (int nx = max(tx - 1, 0); nx <= min(tx + 1, cache.columns - 1); nx++)
+            {
+                uint8_t &d = cache.dirty[ny * cache.columns + nx];
+                if (!d)
+                {
+                    d = 2; // Dirty by proximity; not spread further
+                    count++;
+                }
+            }
+        }
+    }
+    return count + markRefreshTiles(cache);
+}
+
+// Filter one tile with its halo (clamped to the frame) and store its interior
+static void filterTile(TileCache &cache, const uint16_t *pixels, int tx, int ty, TileFilterFn fn, void *ctx)
+{
+    int x0 = tx * cache.tileWidth;
+    int y0 = ty * cache.tileHeight;
+    int x1 = min(x0 + cache.tileWidth, cache.width);
+    int y1 = min(y0 + cache.tileHeight, cache.height);
+
+    int sx0 = max(x0 - cache.halo, 0);
+    int sy0 = max(y0 - cache.halo, 0);
+    int sx1 = min(x1 + cache.halo, cache.width);
+    int sy1 = min(y1 + cache.halo, cache.height);
+    int sw = sx1 - sx0;
+    int sh = sy1 - sy0;
+
+    for (int y = sy0; y < sy1; y++)
+    {
+        memcpy(cache.scratch + (y - sy0) * sw, pixels + y * cache.width + sx0, sw * sizeof(uint16_t));
+    }
+
+    camera_fb_t tile = {};
+    tile.buf = (uint8_t *)cache.scratch;
+    tile.len = sw * sh * sizeof(uint16_t);
+    tile.width = sw;
+    tile.height = sh;
+    tile.format = PIXFORMAT_RGB565;
+    fn(&tile, ctx);
+
+    for (int y = y0; y < y1; y++)
+    {
+        memcpy(cache.output + y * cache.width + x0, cache.scratch + (y - sy0) * sw + (x0 - sx0),
+               (x1 - x0) * sizeof(uint16_t));
+    }
+}
+
+void tileCacheRun(TileCache &cache, camera_fb_t *frame, uint32_t recipeKey, int alignX, int alignY, int halo,
+                  TileFilterFn fn, void *ctx)
+{
+    if (!frame || !fn)
+    {
+        return;
+    }
+
+    int width = frame->width;
+    int height = frame->height;
+    uint16_t *pixels = (uint16_t *)frame->buf;
+    size_t frameBytes = width * height * sizeof(uint16_t);
+
+    if (!layoutTiles(cache, width, height, max(alignX, 1), max(alignY, 1), halo))
+    {
+        fn(frame, ctx);
+        return;
+    }
+
+    int tiles = cache.columns * cache.rows;
+    sampleLuma(cache, pixels);
+    cache.stats.frames++;
+    cache.stats.tiles += tiles;
+
+    int changed = tiles;
+    if (cache.valid && cache.recipeKey == recipeKey)
+    {
+        changed = markDirtyTiles(cache);
+    }
+
+    if (changed * 8 > tiles * TILE_FULL_FRAME_EIGHTHS)
+    {
+        fn(frame, ctx);
+        memcpy(cache.output, pixels, frameBytes);
+        memcpy(cache.filtered, cache.current, cache.sampleStride * ((height + 1) / 2));
+        cache.recipeKey = recipeKey;
+        cache.valid = true;
+        cache.stats.fullFrames++;
+        cache.stats.tilesFiltered += tiles;
+        return;
+    }
+
+    // Tiles are too small to be worth splitting across cores
+    bool wasParallel = parallelEnabled();
+    parallelSetEnabled(false);
+    for (int t = 0; t < tiles; t++)
+    {
+        if (cache.dirty[t])
+        {
+            filterTile(cache, pixels, t % cache.columns, t / cache.columns, fn, ctx);
+            keepTileSamples(cache, t % cache.columns, t / cache.columns);
+        }
+    }
+    parallelSetEnabled(wasParallel);
+
+    memcpy(pixels, cache.output, frameBytes);
+    cache.stats.tilesFiltered += changed;
+}
+
+void tileCacheInvalidate(TileCache &cache)
+{
+    cache.valid = false;
+}
+
+void tileCacheRelease(TileCache &cache)
+{
+    freeBuffers(cache);
+    cache.valid = false;
+}
+
+int tileCacheHitPercent(const TileCacheStats &stats)
+{
+    if (!stats.tiles)
+    {
+        return 0;
+    }
+    return (int)((uint64_t)(stats.tiles - stats.tilesFiltered) * 100 / stats.tiles);
+}
+
+void tileCacheLogStats(const TileCache &cache)
+{
+    const TileCacheStats &s = cache.stats;
+    Serial.printf("[tiles] frames=%lu full=%lu tiles=%lu filtered=%lu hit=%d%% grid=%dx%d of %dx%d\n",
+                  (unsigned long)s.frames, (unsigned long)s.fullFrames, (unsigned long)s.tiles,
+                  (unsigned long)s.tilesFiltered, tileCacheHitPercent(s), cache.columns, cache.rows,
+                  cache.tileWidth, cache.tileHeight);
+}
@@ -0,0 +1,95 @@
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#include <Arduino.h>
+#include <esp_camera.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Tile change detection for local filters
+//
+// The frame is cut into tiles. Every frame is reduced to a quarter-size luma plane (the
+// mean of each 2x2 block), and a tile is filtered again only when enough of its samples
+// moved past the sensor noise floor since the last time it was filtered; every other tile
+// takes its previous output from the cache. Slow drift accumulates against the samples
+// the tile was last filtered from, so it cannot creep by unnoticed. A change too small to
+// pass the thresholds is not seen at all, so a rotating share of the tiles is filtered
+// again every frame as well: cached output is never more than TILE_REFRESH_FRAMES frames
+// old. On a static scene only the luma pass, that share and one frame copy remain.
+//
+// Only for filters whose output pixel depends on a bounded neighbourhood (pixelate,
+// CRT, palette with ordered or no dithering, edge detection). Tiles are multiples of
+// the filter's pattern period and filters reading neighbours are given their halo, so a
+// tile filtered again gives what a whole-frame pass would over that region.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Every tile is filtered again at least once per this many frames, changed or not
+const int TILE_REFRESH_FRAMES = 16;
+
+// Filter run on a whole frame or on one tile (plus halo) copied into its own frame
+typedef void (*TileFilterFn)(camera_fb_t *frame, void *ctx);
+
+struct TileCacheStats
+{
+    uint32_t frames;        // Frames run through the cache
+    uint32_t fullFrames;    // Frames filtered whole (first frame, new recipe, big change)
+    uint32_t tiles;         // Tiles seen
+    uint32_t tilesFiltered; // Tiles filtered again
+};
+
+struct TileCache
+{
+    int width;
+    int height;
+    int tileWidth;
+    int tileHeight;
+    int columns;
+    int rows;
+    int halo;
+    uint32_t recipeKey;         // Filter settings the cached output was made with
+    bool valid;                 // output holds a complete filtered frame
+    int sampleStride;           // Luma samples per plane row
+    uint8_t *current;           // Luma samples of the incoming frame
+    uint8_t *filtered;          // Luma samples each tile was last filtered from
+    uint8_t *dirty;
+    int refreshFrame;           // Position in the rotating refresh, 0..TILE_REFRESH_FRAMES-1
+    uint16_t *output;           // Last filtered frame
+    uint16_t *scratch;          // One tile plus halo
+    TileCacheStats stats;
+};
+
+/**
+ * Filter a frame in place, reusing the cached output of tiles that did not change
+ *
+ * @param cache Zero-initialized the first time
+ * @param frame Frame to filter
+ * @param recipeKey Identifies the filter and its settings; a new key drops the cache
+ * @param alignX Horizontal pattern period of the filter in pixels
+ * @param alignY Vertical pattern period in pixels
+ * @param halo Pixels around a tile the filter reads
+ * @param fn Filter
+ * @param ctx Filter context
+ */
+void tileCacheRun(TileCache &cache, camera_fb_t *frame, uint32_t recipeKey, int alignX, int alignY, int halo,
+                  TileFilterFn fn, void *ctx);
+
+/**
+ * Drop the cached output (the next frame is filtered whole)
+ */
+void tileCacheInvalidate(TileCache &cache);
+
+/**
+ * Free the buffers
+ */
+void tileCacheRelease(TileCache &cache);
+
+/**
+ * Share of tiles served from the cache, in percent
+ */
+int tileCacheHitPercent(const TileCacheStats &stats);
+
+/**
+ * Print the counters to Serial
+ */
+void tileCacheLogStats(const TileCache &cache);
+
+#endif // TILE_CACHE_H
@@ -0,0 +1,156 @@
+#include "button_events.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+struct ButtonState
+{
+    uint8_t pin;
+    bool pressed;            // Last reported level
+    uint32_t lastEdgeMicros; // Last accepted edge
+    bool unsettled;          // An edge inside the debounce window was ignored
+    bool ignoredLevel;       // Level read at the last ignored edge
+    uint32_t ignoredMicros;  // and when it was seen
+};
+
+static ButtonState buttons[BUTTON_EVENTS_MAX_BUTTONS];
+static int buttonCount = 0;
+static portMUX_TYPE buttonLock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t eventQueue = nullptr;
+static uint32_t debounceTime = 0;
+static volatile uint32_t droppedEvents = 0;
+
+// Report a level if it differs from the last reported one (call holding buttonLock)
+static bool IRAM_ATTR acceptLevel(int index, bool pressed, uint32_t when, ButtonEvent &event)
+{
+    ButtonState &button = buttons[index];
+    button.unsettled = false;
+    if (pressed == button.pressed)
+    {
+        return false;
+    }
+    button.pressed = pressed;
+    button.lastEdgeMicros = when;
+    event.button = (uint8_t)index;
+    event.pressed = pressed;
+    event.micros = when;
+    return true;
+}
+
+static void IRAM_ATTR buttonIsr(void *arg)
+{
+    int index = (int)(uintptr_t)arg;
+    ButtonState &button = buttons[index];
+    ButtonEvent events[2];
+    int count = 0;
+
+    portENTER_CRITICAL_ISR(&buttonLock);
+    uint32_t now = micros();
+    bool pressed = digitalRead(button.pin) == LOW;
+
+    // A change ignored in an earlier window and not settled yet happened first
+    if (button.unsettled && now - button.lastEdgeMicros >= debounceTime &&
+        acceptLevel(index, button.ignoredLevel, button.ignoredMicros, events[count]))
+    {
+        count++;
+    }
+
+    if (now - button.lastEdgeMicros < debounceTime)
+    {
+        // Bounce, or a real change too soon after the last one: settled once the window ends
+        button.unsettled = true;
+        button.ignoredLevel = pressed;
+        button.ignoredMicros = now;
+    }
+    else if (acceptLevel(index, pressed, now, events[count]))
+    {
+        count++;
+    }
+    portEXIT_CRITICAL_ISR(&buttonLock);
+
+    BaseType_t woken = pdFALSE;
+    for (int i = 0; i < count; i++)
+    {
+        if (xQueueSendFromISR(eventQueue, &events[i], &woken) != pdTRUE)
+        {
+            droppedEvents++;
+        }
+    }
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Re-read buttons whose last edges fell inside a debounce window that has since ended; with
+// no further edge the interrupt never fires again, so the level they settled at is
+// reported from here
+static void settleButtons()
+{
+    for (int i = 0; i < buttonCount; i++)
+    {
+        ButtonEvent event;
+        bool changed = false;
+
+        portENTER_CRITICAL(&buttonLock);
+        ButtonState &button = buttons[i];
+        uint32_t now = micros();
+        if (button.unsettled && now - button.lastEdgeMicros >= debounceTime)
+        {
+            bool pressed = digitalRead(button.pin) == LOW;
+            changed = acceptLevel(i, pressed, pressed == button.ignoredLevel ? button.ignoredMicros : now, event);
+        }
+        portEXIT_CRITICAL(&buttonLock);
+
+        // Nothing newer can be queued before it: the next edge falls in a fresh window
+        if (changed && xQueueSend(eventQueue, &event, 0) != pdTRUE)
+        {
+            droppedEvents++;
+        }
+    }
+}
+
+bool buttonEventsBegin(const int *pins, int count, uint32_t debounceMicros)
+{
+    if (!eventQueue)
+    {
+        eventQueue = xQueueCreate(BUTTON_EVENTS_QUEUE_DEPTH, sizeof(ButtonEvent));
+        if (!eventQueue)
+        {
+            return false;
+        }
+    }
+
+    debounceTime = debounceMicros;
+    if (count > BUTTON_EVENTS_MAX_BUTTONS)
+    {
+        count = BUTTON_EVENTS_MAX_BUTTONS;
+    }
+
+    uint32_t now = micros();
+    for (int i = 0; i < count; i++)
+    {
+        pinMode(pins[i], INPUT_PULLUP);
+        buttons[i].pin = pins[i];
+        buttons[i].pressed = digitalRead(pins[i]) == LOW; // Held at boot is not a press
+        buttons[i].lastEdgeMicros = now;
+        buttons[i].unsettled = false;
+        attachInterruptArg(pins[i], buttonIsr, (void *)(uintptr_t)i, CHANGE);
+    }
+    buttonCount = count;
+    return true;
+}
+
+bool buttonEventsNext(ButtonEvent &event)
+{
+    if (!eventQueue)
+    {
+        return false;
+    }
+    settleButtons();
+    return xQueueReceive(eventQueue, &event, 0) == pdTRUE;
+}
+
+uint32_t buttonEventsDropped()
+{
+    return droppedEvents;
+}
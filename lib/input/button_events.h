@@ -0,0 +1,56 @@
+#ifndef BUTTON_EVENTS_H
+#define BUTTON_EVENTS_H
+
+#include <Arduino.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Interrupt-driven push buttons
+//
+// Every button pin raises an interrupt on both edges. The handler debounces in place
+// (edges closer than the debounce time to the last accepted one are not reported at
+// once, and an edge is only reported if the level differs from the last reported one)
+// and pushes a timestamped event into a queue, so presses made while the loop task is
+// busy (PNG save, long LVGL redraw) are kept, in order, with the time they actually
+// happened. A level reached inside the debounce window (a tap shorter than it) is
+// reported once the window ends, by the next edge or by buttonEventsNext re-reading the
+// pin, so a press is never left without its release.
+//
+// Buttons are active low (INPUT_PULLUP).
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const int BUTTON_EVENTS_MAX_BUTTONS = 4;
+const int BUTTON_EVENTS_QUEUE_DEPTH = 16;
+
+struct ButtonEvent
+{
+    uint8_t button;  // Index into the pin list given to buttonEventsBegin
+    bool pressed;    // true = pressed, false = released
+    uint32_t micros; // When the edge was seen
+};
+
+/**
+ * Configure the pins and attach their interrupts
+ *
+ * @param pins Button GPIOs
+ * @param count Number of pins (at most BUTTON_EVENTS_MAX_BUTTONS)
+ * @param debounceMicros Quiet time after an accepted edge
+ * @return false if the event queue could not be created
+ */
+bool buttonEventsBegin(const int *pins, int count, uint32_t debounceMicros);
+
+/**
+ * Take the oldest event without waiting
+ *
+ * Buttons whose debounce window ended with an unreported level are re-read first.
+ *
+ * @param event Filled with the event
+ * @return false if no event is queued
+ */
+bool buttonEventsNext(ButtonEvent &event);
+
+/**
+ * @return Events lost because the queue was full
+ */
+uint32_t buttonEventsDropped();
+
+#endif // BUTTON_EVENTS_H
@@ -0,0 +1,218 @@
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+const int PROFILE_MAX_DEPTH = 8;
+
+struct OpenScope
+{
+    ProfileStage stage;
+    uint32_t start;
+    uint32_t childTicks; // Time spent in scopes opened inside this one
+};
+
+static const char *const stageNames[PROFILE_STAGE_COUNT] = {
+    "fetch", "auto", "grade", "pixel", "dither", "edge", "crt", "conv", "zoom", "render", "flush"};
+
+static OpenScope openScopes[PROFILE_MAX_DEPTH];
+static int depth = 0;
+static int skippedDepth = 0; // Scopes past PROFILE_MAX_DEPTH, not timed
+static uint32_t frameTicks[PROFILE_STAGE_COUNT];
+static bool frameOpen = false;
+
+static ProfileFrame ring[PROFILE_RING_FRAMES];
+static std::atomic<uint32_t> published(0); // Frames written to the ring so far
+
+#if defined(ESP_PLATFORM)
+static TaskHandle_t ownerTask = nullptr;
+
+static inline uint32_t nowTicks()
+{
+    return ESP.getCycleCount();
+}
+
+static inline uint32_t ticksPerMicro()
+{
+    return getCpuFrequencyMhz();
+}
+
+static bool onOwner()
+{
+    if (!ownerTask)
+    {
+        ownerTask = xTaskGetCurrentTaskHandle();
+    }
+    return ownerTask == xTaskGetCurrentTaskHandle();
+}
+#else
+static std::thread::id ownerThread;
+static bool ownerSet = false;
+
+static inline uint32_t nowTicks()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static inline uint32_t ticksPerMicro()
+{
+    return 1000;
+}
+
+static bool onOwner()
+{
+    if (!ownerSet)
+    {
+        ownerThread = std::this_thread::get_id();
+        ownerSet = true;
+    }
+    return ownerThread == std::this_thread::get_id();
+}
+#endif
+
+void profileFrameBegin()
+{
+    if (!onOwner())
+    {
+        return;
+    }
+
+    if (frameOpen)
+    {
+        uint32_t index = published.load(std::memory_order_relaxed);
+        ProfileFrame &frame = ring[index % PROFILE_RING_FRAMES];
+        uint32_t perMicro = ticksPerMicro();
+        for (int i = 0; i < PROFILE_STAGE_COUNT; i++)
+        {
+            frame.micros[i] = frameTicks[i] / perMicro;
+        }
+        published.store(index + 1, std::memory_order_release);
+    }
+
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++)
+    {
+        frameTicks[i] = 0;
+    }
+    frameOpen = true;
+}
+
+void profileStageBegin(ProfileStage stage)
+{
+    if (!onOwner())
+    {
+        return;
+    }
+    if (depth >= PROFILE_MAX_DEPTH)
+    {
+        skippedDepth++;
+        return;
+    }
+
+    OpenScope &scope = openScopes[depth++];
+    scope.stage = stage;
+    scope.childTicks = 0;
+    scope.start = nowTicks();
+}
+
+void profileStageEnd()
+{
+    uint32_t now = nowTicks();
+
+    if (!onOwner())
+    {
+        return;
+    }
+    if (skippedDepth > 0)
+    {
+        skippedDepth--;
+        return;
+    }
+    if (depth == 0)
+    {
+        return;
+    }
+
+    OpenScope &scope = openScopes[--depth];
+    uint32_t elapsed = now - scope.start;
+    frameTicks[scope.stage] += elapsed - std::min(elapsed, scope.childTicks);
+    if (depth > 0)
+    {
+        openScopes[depth - 1].childTicks += elapsed;
+    }
+}
+
+int profileRecentFrames(ProfileFrame *frames)
+{
+    // One slot is left out: the writer may be filling it while we copy
+    uint32_t end = published.load(std::memory_order_acquire);
+    uint32_t count = std::min<uint32_t>(end, PROFILE_RING_FRAMES - 1);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        frames[i] = ring[(end - count + i) % PROFILE_RING_FRAMES];
+    }
+    return (int)count;
+}
+
+uint32_t profileStagePercentile(ProfileStage stage, int percent)
+{
+    static ProfileFrame frames[PROFILE_RING_FRAMES];
+    uint32_t values[PROFILE_RING_FRAMES];
+
+    int count = profileRecentFrames(frames);
+    if (count == 0 || stage < 0 || stage >= PROFILE_STAGE_COUNT)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = frames[i].micros[stage];
+    }
+
+    percent = constrain(percent, 0, 100);
+    int rank = (percent * (count - 1) + 50) / 100;
+    std::nth_element(values, values + rank, values + count);
+    return values[rank];
+}
+
+const char *profileStageName(ProfileStage stage)
+{
+    if (stage < 0 || stage >= PROFILE_STAGE_COUNT)
+    {
+        return "?";
+    }
+    return stageNames[stage];
+}
+
+void profileDumpCsv()
+{
+    static ProfileFrame frames[PROFILE_RING_FRAMES];
+    int count = profileRecentFrames(frames);
+
+    Serial.print("frame");
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++)
+    {
+        Serial.printf(",%s_us", stageNames[s]);
+    }
+    Serial.println();
+
+    for (int i = 0; i < count; i++)
+    {
+        Serial.printf("%d", i);
+        for (int s = 0; s < PROFILE_STAGE_COUNT; s++)
+        {
+            Serial.printf(",%lu", (unsigned long)frames[i].micros[s]);
+        }
+        Serial.println();
+    }
+}
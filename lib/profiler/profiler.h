@@ -0,0 +1,94 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Frame stage profiler
+//
+// ProfileScope objects time a stage of the preview pipeline with the CPU cycle counter
+// (a steady clock on host builds). Scopes nest: a stage's time excludes the scopes
+// opened inside it, so a scope around lv_task_handler measures LVGL itself and not the
+// camera timer or the display flush it calls.
+//
+// A frame runs from one profileFrameBegin() (the camera fetch) to the next; its stage
+// totals are then published into a ring of recent frames. The ring has a single writer
+// (the loop task) and readers only ever see fully written frames, so no lock is needed.
+//
+// Call from the loop task only; scopes opened on other tasks are ignored.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum ProfileStage
+{
+    PROFILE_FETCH = 0,    // esp_camera_fb_get, including the wait for the frame
+    PROFILE_AUTO_ADJUST,
+    PROFILE_GRADE,        // Color grading LUT
+    PROFILE_PIXELATE,
+    PROFILE_DITHER,
+    PROFILE_EDGE,
+    PROFILE_CRT,
+    PROFILE_CONVOLVE,     // Blur, sharpen, emboss, unsharp mask
+    PROFILE_ZOOM,         // Zoom / byte swap copy into the canvas
+    PROFILE_RENDER,       // LVGL work outside the other stages
+    PROFILE_FLUSH,        // Display flush
+    PROFILE_STAGE_COUNT
+};
+
+const int PROFILE_RING_FRAMES = 64;
+
+struct ProfileFrame
+{
+    uint32_t micros[PROFILE_STAGE_COUNT];
+};
+
+/**
+ * Close the current frame (publishing it to the ring) and start the next one
+ */
+void profileFrameBegin();
+
+/**
+ * Open a stage; must be paired with profileStageEnd in LIFO order (use ProfileScope)
+ */
+void profileStageBegin(ProfileStage stage);
+void profileStageEnd();
+
+/**
+ * Copy the most recent published frames, oldest first
+ *
+ * @param frames Output, room for PROFILE_RING_FRAMES frames
+ * @return Number of frames copied
+ */
+int profileRecentFrames(ProfileFrame *frames);
+
+/**
+ * Percentile of one stage over the frames in the ring
+ *
+ * @param stage Stage to summarize
+ * @param percent 0-100 (50 = median)
+ * @return Stage time in microseconds, 0 if no frame has been published
+ */
+uint32_t profileStagePercentile(ProfileStage stage, int percent);
+
+/**
+ * Short display name of a stage
+ */
+const char *profileStageName(ProfileStage stage);
+
+/**
+ * Print the ring to Serial as CSV (one line per frame, a header line first)
+ */
+void profileDumpCsv();
+
+// Times the enclosing block as one stage
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfileStage stage) { profileStageBegin(stage); }
+    ~ProfileScope() { profileStageEnd(); }
+
+private:
+    ProfileScope(const ProfileScope &);
+    ProfileScope &operator=(const ProfileScope &);
+};
+
+#endif // PROFILER_H
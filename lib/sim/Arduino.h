@@ -0,0 +1,223 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Arduino core for the host simulator
+//
+// The subset of the ESP32 Arduino core the app uses, on top of the C library and
+// std::chrono. Time is real time since the process started; pins are plain levels the
+// simulator's script drives, and an interrupt attached to a pin runs on the script's
+// thread when its level changes. LVGL's C sources include this header for millis(), so
+// the C part stays C.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <string>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Log macros of the ESP32 core; only errors and warnings are printed
+#define log_e(format, ...) printf("[E] " format "\n", ##__VA_ARGS__)
+#define log_w(format, ...) printf("[W] " format "\n", ##__VA_ARGS__)
+#define log_i(format, ...) ((void)0)
+#define log_d(format, ...) ((void)0)
+#define log_v(format, ...) ((void)0)
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// PSRAM is ordinary heap on the host
+bool psramFound();
+void *ps_malloc(size_t size);
+void *ps_calloc(size_t count, size_t size);
+void *ps_realloc(void *ptr, size_t size);
+
+class EspClass
+{
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFreeHeap();
+    uint32_t getFreePsram();
+    void restart();
+};
+
+extern EspClass ESP;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : value(text ? text : "") {}
+    explicit String(const std::string &text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int number) : value(std::to_string(number)) {}
+    explicit String(unsigned int number) : value(std::to_string(number)) {}
+    explicit String(long number) : value(std::to_string(number)) {}
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+
+    const char *c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.length(); }
+    char operator[](unsigned int index) const { return index < value.length() ? value[index] : 0; }
+
+    bool startsWith(const String &prefix) const { return value.compare(0, prefix.value.length(), prefix.value) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return value.length() >= suffix.value.length() &&
+               value.compare(value.length() - suffix.value.length(), suffix.value.length(), suffix.value) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return find(value.find(c, from)); }
+    int indexOf(const String &text, unsigned int from = 0) const { return find(value.find(text.value, from)); }
+    int lastIndexOf(char c) const { return find(value.rfind(c)); }
+    String substring(unsigned int from) const { return from < value.length() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to)
+        {
+            std::swap(from, to);
+        }
+        return from < value.length() ? String(value.substr(from, to - from)) : String();
+    }
+    long toInt() const { return strtol(value.c_str(), nullptr, 10); }
+
+    String &operator+=(const String &other)
+    {
+        value += other.value;
+        return *this;
+    }
+    String &operator+=(const char *other)
+    {
+        value += other ? other : "";
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        value += c;
+        return *this;
+    }
+    String &operator+=(int number) { return *this += String(number); }
+    String &operator+=(unsigned int number) { return *this += String(number); }
+    String &operator+=(long number) { return *this += String(number); }
+    String &operator+=(unsigned long number) { return *this += String(number); }
+
+    bool operator==(const String &other) const { return value == other.value; }
+    bool operator!=(const String &other) const { return value != other.value; }
+    bool operator<(const String &other) const { return value < other.value; }
+    bool operator>(const String &other) const { return value > other.value; }
+
+private:
+    static int find(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+
+    std::string value;
+};
+
+template <typename T>
+inline String operator+(String left, const T &right)
+{
+    left += right;
+    return left;
+}
+
+inline String operator+(const char *left, const String &right)
+{
+    String result(left);
+    result += right;
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Console: output goes to stdout; input is whatever the script sent with "serial"
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char *text);
+    size_t print(const String &text) { return print(text.c_str()); }
+    size_t print(char c);
+    size_t print(int number);
+    size_t print(unsigned int number);
+    size_t print(long number);
+    size_t print(unsigned long number);
+    size_t print(double number);
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t n = print(value);
+        return n + print("\n");
+    }
+    size_t println() { return print("\n"); }
+    size_t write(uint8_t c) { return print((char)c); }
+    size_t write(const uint8_t *data, size_t size);
+    int available();
+    int read();
+    void flush();
+};
+
+extern HardwareSerial Serial;
+
+#endif // __cplusplus
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,56 @@
+#ifndef SIM_FS_H
+#define SIM_FS_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Arduino FS for the host simulator
+//
+// fs::File over stdio and dirent. Copies share one open handle and close() closes it
+// for all of them, as on the board.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include <memory>
+#include <time.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+    struct FileHandle;
+
+    class File
+    {
+    public:
+        File() {}
+        explicit File(std::shared_ptr<FileHandle> handle) : handle(handle) {}
+
+        size_t write(uint8_t c);
+        size_t write(const uint8_t *data, size_t size);
+        int read();
+        size_t read(uint8_t *data, size_t size);
+        bool seek(uint32_t position);
+        size_t position() const;
+        size_t size() const;
+        time_t getLastWrite();
+        void flush();
+        void close();
+        operator bool() const;
+
+        /**
+         * @return File name without its directory, like the ESP32 core's
+         */
+        const char *name() const;
+        const char *path() const;
+        bool isDirectory() const;
+        File openNextFile(const char *mode = FILE_READ);
+
+    private:
+        std::shared_ptr<FileHandle> handle;
+    };
+} // namespace fs
+
+using fs::File;
+
+#endif // SIM_FS_H
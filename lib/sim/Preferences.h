@@ -0,0 +1,42 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// NVS preferences for the host simulator
+//
+// Namespaces live in memory for the run, so every run starts from the defaults.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+
+class Preferences
+{
+public:
+    Preferences() : name(nullptr), readOnly(true) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char *name, bool readOnly = false);
+    void end();
+
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBool(const char *key, bool value) { return put(key, value ? 1 : 0, sizeof(uint8_t)); }
+    size_t putInt(const char *key, int32_t value) { return put(key, value, sizeof(int32_t)); }
+    size_t putUInt(const char *key, uint32_t value) { return put(key, (int64_t)value, sizeof(uint32_t)); }
+    bool getBool(const char *key, bool defaultValue = false) { return get(key, defaultValue ? 1 : 0) != 0; }
+    int32_t getInt(const char *key, int32_t defaultValue = 0) { return (int32_t)get(key, defaultValue); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return (uint32_t)get(key, defaultValue); }
+    size_t putString(const char *key, const char *value);
+    size_t getString(const char *key, char *value, size_t maxLen); // Bytes copied with the terminator, 0 if missing or too long
+
+private:
+    size_t put(const char *key, int64_t value, size_t size);
+    int64_t get(const char *key, int64_t defaultValue);
+
+    const char *name;
+    bool readOnly;
+};
+
+#endif // SIM_PREFERENCES_H
@@ -0,0 +1,44 @@
+#ifndef SIM_SD_H
+#define SIM_SD_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SD card for the host simulator
+//
+// A directory (simSetSdRoot) stands in for the card root. Space is reported for an 8 GB
+// card with 32 KB clusters, so usedBytes() rounds files up the way FAT does (f_getfree in
+// ff.h reports the same volume). Raw sector access (used by USB mass storage) is not
+// available.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <FS.h>
+
+namespace fs
+{
+    class SDFS
+    {
+    public:
+        bool begin(uint8_t csPin = 0);
+        void end() {}
+
+        File open(const char *path, const char *mode = FILE_READ);
+        File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+        bool exists(const char *path);
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path);
+        bool remove(const String &path) { return remove(path.c_str()); }
+        bool mkdir(const char *path);
+        bool rename(const char *from, const char *to);
+
+        uint64_t cardSize();
+        uint64_t totalBytes();
+        uint64_t usedBytes();
+        size_t numSectors();
+        size_t sectorSize() { return 512; }
+        bool readRAW(uint8_t *buffer, uint32_t sector);
+        bool writeRAW(uint8_t *buffer, uint32_t sector);
+    };
+} // namespace fs
+
+extern fs::SDFS SD;
+
+#endif // SIM_SD_H
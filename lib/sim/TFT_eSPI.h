@@ -0,0 +1,54 @@
+#ifndef SIM_TFT_ESPI_H
+#define SIM_TFT_ESPI_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// TFT_eSPI for the host simulator
+//
+// The panel is an RGB565 framebuffer (simSaveScreen writes it out). With an SPI clock
+// set (simSetSpiClock), endWrite() blocks for as long as the pixels pushed since
+// startWrite() would take on the wire, so flush time shows up in the frame timings.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 222
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 480
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+
+class TFT_eSPI
+{
+public:
+    TFT_eSPI(int16_t width = TFT_WIDTH, int16_t height = TFT_HEIGHT);
+
+    void begin();
+    void init() { begin(); }
+    void setRotation(uint8_t rotation);
+    uint8_t getRotation() const { return rotation; }
+    int16_t width() const;
+    int16_t height() const;
+
+    void fillScreen(uint32_t color);
+    void startWrite();
+    void endWrite();
+    void setAddrWindow(int32_t x, int32_t y, int32_t width, int32_t height);
+    void pushColors(uint16_t *data, uint32_t length, bool swap = true);
+
+private:
+    int16_t panelWidth;
+    int16_t panelHeight;
+    uint8_t rotation;
+    int32_t windowX;
+    int32_t windowY;
+    int32_t windowWidth;
+    int32_t windowHeight;
+    uint32_t windowPixel;
+    uint32_t pendingPixels;
+};
+
+#endif // SIM_TFT_ESPI_H
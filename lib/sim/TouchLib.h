@@ -0,0 +1,40 @@
+#ifndef SIM_TOUCHLIB_H
+#define SIM_TOUCHLIB_H
+
+// Touch controller for the host simulator; the script puts the finger down (simSetTouch)
+
+#include <Wire.h>
+
+#define L58_SLAVE_ADDRESS 0x5A
+
+class TP_Point
+{
+public:
+    TP_Point() : id(0), x(0), y(0), size(0), pressure(0), state(0) {}
+
+    uint8_t id;
+    uint16_t x;
+    uint16_t y;
+    uint8_t size;
+    uint8_t pressure;
+    uint8_t state;
+};
+
+class TouchLib
+{
+public:
+    TouchLib(TwoWire &wire, int sda, int scl, uint8_t address)
+    {
+        (void)wire;
+        (void)sda;
+        (void)scl;
+        (void)address;
+    }
+
+    bool init() { return true; }
+    bool read();
+    uint8_t getPointNum();
+    TP_Point getPoint(uint8_t index);
+};
+
+#endif // SIM_TOUCHLIB_H
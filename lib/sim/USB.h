@@ -0,0 +1,40 @@
+#ifndef SIM_USB_H
+#define SIM_USB_H
+
+// USB device stack for the host simulator: there is no host to enumerate with, so the
+// stack starts and no events ever arrive
+
+#include <Arduino.h>
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t eventBase, int32_t eventId, void *eventData);
+
+extern const esp_event_base_t ARDUINO_USB_EVENTS;
+
+typedef enum
+{
+    ARDUINO_USB_ANY_EVENT = -1,
+    ARDUINO_USB_STARTED_EVENT = 0,
+    ARDUINO_USB_STOPPED_EVENT,
+    ARDUINO_USB_SUSPEND_EVENT,
+    ARDUINO_USB_RESUME_EVENT,
+} arduino_usb_event_t;
+
+typedef union
+{
+    struct
+    {
+        bool remote_wakeup_en;
+    } suspend;
+} arduino_usb_event_data_t;
+
+class ESPUSB
+{
+public:
+    bool begin() { return true; }
+    void onEvent(esp_event_handler_t callback) { (void)callback; }
+};
+
+extern ESPUSB USB;
+
+#endif // SIM_USB_H
@@ -0,0 +1,39 @@
+#ifndef SIM_USBMSC_H
+#define SIM_USBMSC_H
+
+// USB mass storage for the host simulator; the callbacks are kept but never called
+
+#include <USB.h>
+
+typedef int32_t (*msc_read_cb)(uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize);
+typedef int32_t (*msc_write_cb)(uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize);
+typedef bool (*msc_start_stop_cb)(uint8_t powerCondition, bool start, bool loadEject);
+
+class USBMSC
+{
+public:
+    USBMSC() : readCb(nullptr), writeCb(nullptr), startStopCb(nullptr), present(false) {}
+
+    bool begin(uint32_t blockCount, uint16_t blockSize)
+    {
+        (void)blockCount;
+        (void)blockSize;
+        return true;
+    }
+    void end() {}
+    void vendorID(const char *vid) { (void)vid; }
+    void productID(const char *pid) { (void)pid; }
+    void productRevision(const char *rev) { (void)rev; }
+    void mediaPresent(bool present) { this->present = present; }
+    void onRead(msc_read_cb cb) { readCb = cb; }
+    void onWrite(msc_write_cb cb) { writeCb = cb; }
+    void onStartStop(msc_start_stop_cb cb) { startStopCb = cb; }
+
+private:
+    msc_read_cb readCb;
+    msc_write_cb writeCb;
+    msc_start_stop_cb startStopCb;
+    bool present;
+};
+
+#endif // SIM_USBMSC_H
@@ -0,0 +1,27 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+// I2C for the host simulator; the devices on the bus (PMU, touch) are simulated above it
+
+#include <Arduino.h>
+
+class TwoWire
+{
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0)
+    {
+        (void)sda;
+        (void)scl;
+        (void)frequency;
+        return true;
+    }
+    bool setClock(uint32_t frequency)
+    {
+        (void)frequency;
+        return true;
+    }
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
@@ -0,0 +1,54 @@
+#ifndef SIM_XPOWERSLIB_H
+#define SIM_XPOWERSLIB_H
+
+// SY6970 charger for the host simulator: a 3.9 V battery on USB power, not charging
+
+#include <Wire.h>
+
+#define SY6970_SLAVE_ADDRESS 0x6A
+
+class PowersSY6970
+{
+public:
+    enum ChargeStatus
+    {
+        CHARGE_STATE_NO_CHARGE,
+        CHARGE_STATE_PRE_CHARGE,
+        CHARGE_STATE_FAST_CHARGE,
+        CHARGE_STATE_DONE,
+        CHARGE_STATE_UNKOWN,
+    };
+
+    enum BusStatus
+    {
+        BUS_STATE_NOINPUT,
+        BUS_STATE_USB_SDP,
+        BUS_STATE_USB_CDP,
+        BUS_STATE_USB_DCP,
+        BUS_STATE_HVDCP,
+        BUS_STATE_ADAPTER,
+        BUS_STATE_NO_STANDARD_ADAPTER,
+        BUS_STATE_OTG,
+    };
+
+    bool init(TwoWire &wire, int sda, int scl, uint8_t address)
+    {
+        (void)wire;
+        (void)sda;
+        (void)scl;
+        (void)address;
+        return true;
+    }
+    void enableStatLed() {}
+    bool setChargeTargetVoltage(uint16_t millivolt) { return millivolt > 0; }
+    bool setPrechargeCurr(uint16_t milliampere) { return milliampere > 0; }
+    bool setChargerConstantCurr(uint16_t milliampere) { return milliampere > 0; }
+    bool enableMeasure() { return true; }
+    uint16_t getBattVoltage() { return 3900; }
+    ChargeStatus chargeStatus() { return CHARGE_STATE_NO_CHARGE; }
+    BusStatus getBusStatus() { return BUS_STATE_USB_SDP; }
+    bool enableOTG() { return true; }
+    bool disableOTG() { return true; }
+};
+
+#endif // SIM_XPOWERSLIB_H
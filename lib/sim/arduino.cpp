@@ -0,0 +1,323 @@
+#include "sim.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdarg.h>
+#include <thread>
+#include <unistd.h>
+
+// Boot time; taken on first use, so static constructors elsewhere may already ask
+static std::chrono::steady_clock::time_point bootTime()
+{
+    static const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+    return boot;
+}
+
+extern "C" unsigned long micros(void)
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - bootTime())
+        .count();
+}
+
+extern "C" unsigned long millis(void)
+{
+    return micros() / 1000;
+}
+
+extern "C" void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+extern "C" void delayMicroseconds(uint32_t us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static const int SIM_PIN_COUNT = 64;
+
+struct SimPin
+{
+    uint8_t mode;
+    uint8_t level;
+    int interruptMode;
+    void (*handler)(void);
+    void (*handlerArg)(void *);
+    void *arg;
+};
+
+static SimPin pins[SIM_PIN_COUNT];
+static bool pinsReady = false;
+
+static SimPin *pinState(uint8_t pin)
+{
+    if (!pinsReady)
+    {
+        // Inputs read high until something drives them (buttons and IRQ lines pull up)
+        for (int i = 0; i < SIM_PIN_COUNT; i++)
+        {
+            pins[i].level = HIGH;
+        }
+        pinsReady = true;
+    }
+    return pin < SIM_PIN_COUNT ? &pins[pin] : nullptr;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    SimPin *p = pinState(pin);
+    if (p)
+    {
+        p->mode = mode;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    SimPin *p = pinState(pin);
+    if (p)
+    {
+        p->level = level ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    SimPin *p = pinState(pin);
+    return p ? p->level : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode)
+{
+    SimPin *p = pinState(pin);
+    if (p)
+    {
+        p->handler = handler;
+        p->handlerArg = nullptr;
+        p->interruptMode = mode;
+    }
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+    SimPin *p = pinState(pin);
+    if (p)
+    {
+        p->handler = nullptr;
+        p->handlerArg = handler;
+        p->arg = arg;
+        p->interruptMode = mode;
+    }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    SimPin *p = pinState(pin);
+    if (p)
+    {
+        p->handler = nullptr;
+        p->handlerArg = nullptr;
+    }
+}
+
+void simSetPin(uint8_t pin, uint8_t level)
+{
+    SimPin *p = pinState(pin);
+    if (!p || p->level == level)
+    {
+        return;
+    }
+    p->level = level;
+
+    bool rising = level == HIGH;
+    bool fire = p->interruptMode == CHANGE || (p->interruptMode == RISING && rising) ||
+                (p->interruptMode == FALLING && !rising);
+    if (!fire)
+    {
+        return;
+    }
+    if (p->handler)
+    {
+        p->handler();
+    }
+    else if (p->handlerArg)
+    {
+        p->handlerArg(p->arg);
+    }
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits)
+{
+    (void)channel;
+    (void)resolutionBits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel)
+{
+    (void)pin;
+    (void)channel;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty)
+{
+    (void)channel;
+    (void)duty;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    if (inMax == inMin)
+    {
+        return outMin;
+    }
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Bytes requested from PSRAM, for allocation budgets
+static std::atomic<uint64_t> psramRequested(0);
+
+uint64_t simPsramAllocated()
+{
+    return psramRequested;
+}
+
+bool psramFound()
+{
+    return true;
+}
+
+void *ps_malloc(size_t size)
+{
+    psramRequested += size;
+    return malloc(size);
+}
+
+void *ps_calloc(size_t count, size_t size)
+{
+    psramRequested += count * size;
+    return calloc(count, size);
+}
+
+void *ps_realloc(void *ptr, size_t size)
+{
+    psramRequested += size;
+    return realloc(ptr, size);
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount()
+{
+    return (uint32_t)(micros() * getCpuFreqMHz());
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return 320 * 1024;
+}
+
+uint32_t EspClass::getFreePsram()
+{
+    return 8 * 1024 * 1024;
+}
+
+void EspClass::restart()
+{
+    // Nothing to come back to; the run ends here
+    printf("[sim] restart requested, exiting\n");
+    fflush(stdout);
+    _exit(0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+HardwareSerial Serial;
+
+static std::mutex serialLock;
+static std::deque<char> serialInput;
+
+int HardwareSerial::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+size_t HardwareSerial::print(const char *text)
+{
+    return fputs(text, stdout) < 0 ? 0 : strlen(text);
+}
+
+size_t HardwareSerial::print(char c)
+{
+    return putchar(c) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::print(int number)
+{
+    return printf("%d", number);
+}
+
+size_t HardwareSerial::print(unsigned int number)
+{
+    return printf("%u", number);
+}
+
+size_t HardwareSerial::print(long number)
+{
+    return printf("%ld", number);
+}
+
+size_t HardwareSerial::print(unsigned long number)
+{
+    return printf("%lu", number);
+}
+
+size_t HardwareSerial::print(double number)
+{
+    return printf("%.2f", number);
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t size)
+{
+    return fwrite(data, 1, size, stdout);
+}
+
+int HardwareSerial::available()
+{
+    std::lock_guard<std::mutex> lock(serialLock);
+    return (int)serialInput.size();
+}
+
+int HardwareSerial::read()
+{
+    std::lock_guard<std::mutex> lock(serialLock);
+    if (serialInput.empty())
+    {
+        return -1;
+    }
+    char c = serialInput.front();
+    serialInput.pop_front();
+    return (uint8_t)c;
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+void simSerialInput(const char *line)
+{
+    std::lock_guard<std::mutex> lock(serialLock);
+    serialInput.insert(serialInput.end(), line, line + strlen(line));
+    serialInput.push_back('\n');
+}
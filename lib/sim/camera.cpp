@@ -0,0 +1,574 @@
+#include "sim.h"
+#include <esp_camera.h>
+#include "frame_sequence.h"
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include <extra/libs/png/lodepng.h>
+}
+
+// The app provides lodepng's allocators (src/main.cpp)
+extern "C" void lodepng_free(void *ptr);
+
+const resolution_info_t resolution[] = {
+    {96, 96}, {160, 120}, {176, 144}, {240, 176}, {240, 240}, {320, 240}, {400, 296}, {480, 320}, {640, 480},
+    {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1600, 1200}, {1920, 1080}, {720, 1280}, {864, 1536},
+    {2048, 1536}};
+
+// Pixel array the readout window is taken from; source images are stretched over it
+static const int SIM_ARRAY_WIDTH = 2048;
+static const int SIM_ARRAY_HEIGHT = 1536;
+
+struct SimImage
+{
+    int width;
+    int height;
+    std::vector<uint8_t> rgb; // 8-bit RGB triplets
+};
+
+struct SimWindow
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+struct SimRecordedFrame
+{
+    FrameSequenceRecord record;
+    std::vector<uint16_t> pixels; // As delivered: frame order RGB565
+};
+
+static std::vector<SimImage> images;
+static std::vector<SimRecordedFrame> recording;
+static sensor_t sensor;
+static SimWindow window = {0, 0, SIM_ARRAY_WIDTH, SIM_ARRAY_HEIGHT};
+static camera_fb_t frame;
+static std::vector<uint16_t> frameBuffer;
+static bool frameOut = false;
+static bool cameraReady = false;
+
+static int framePeriodMicros = 0;
+static uint64_t nextFrameMicros = 0;
+static uint32_t fetched = 0;
+
+struct SimFrameTiming
+{
+    uint32_t atMicros;
+    uint32_t intervalMicros;
+    uint32_t holdMicros; // Fetch to return: the time the app spent on the frame
+    uint32_t hash;       // Frame buffer contents when returned (filtered in place by the preview,
+                         // except uncached palette output, which goes to the canvas as indices)
+    uint16_t width;
+    uint16_t height;
+};
+static std::vector<SimFrameTiming> timings;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static bool loadPpm(const std::string &path, SimImage &image)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    int maxValue = 0;
+    bool ok = fscanf(file, "P6 %d %d %d", &image.width, &image.height, &maxValue) == 3 && maxValue == 255 &&
+              image.width > 0 && image.height > 0 && fgetc(file) != EOF;
+    if (ok)
+    {
+        image.rgb.resize((size_t)image.width * image.height * 3);
+        ok = fread(image.rgb.data(), 1, image.rgb.size(), file) == image.rgb.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+static bool loadPng(const std::string &path, SimImage &image)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    unsigned char *decoded = nullptr;
+    unsigned width = 0;
+    unsigned height = 0;
+    if (lodepng_decode24(&decoded, &width, &height, data.data(), data.size()) != 0)
+    {
+        return false;
+    }
+    image.width = width;
+    image.height = height;
+    image.rgb.assign(decoded, decoded + (size_t)width * height * 3);
+    lodepng_free(decoded);
+    return true;
+}
+
+static bool hasSuffix(const std::string &name, const char *suffix)
+{
+    size_t length = strlen(suffix);
+    if (name.size() < length)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower((unsigned char)name[name.size() - length + i]) != suffix[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool loadImage(const std::string &path)
+{
+    SimImage image;
+    bool ok = hasSuffix(path, ".png") ? loadPng(path, image) : hasSuffix(path, ".ppm") ? loadPpm(path, image) : false;
+    if (!ok)
+    {
+        return false;
+    }
+    images.push_back(image);
+    return true;
+}
+
+bool simLoadFrames(const char *path)
+{
+    images.clear();
+
+    DIR *dir = opendir(path);
+    if (!dir)
+    {
+        loadImage(path);
+    }
+    else
+    {
+        std::vector<std::string> names;
+        while (dirent *entry = readdir(dir))
+        {
+            if (hasSuffix(entry->d_name, ".png") || hasSuffix(entry->d_name, ".ppm"))
+            {
+                names.push_back(entry->d_name);
+            }
+        }
+        closedir(dir);
+
+        std::sort(names.begin(), names.end());
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (!loadImage(std::string(path) + "/" + names[i]))
+            {
+                printf("[sim] could not load %s\n", names[i].c_str());
+            }
+        }
+    }
+
+    printf("[sim] %u camera frame image(s) from %s\n", (unsigned)images.size(), path);
+    return !images.empty();
+}
+
+bool simLoadSequence(const char *path)
+{
+    recording.clear();
+
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    FrameSequenceHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && frameSequenceHeaderValid(header) &&
+              fseek(file, header.headerBytes, SEEK_SET) == 0;
+    while (ok)
+    {
+        SimRecordedFrame frame;
+        if (fread(&frame.record, sizeof(frame.record), 1, file) != 1 ||
+            fseek(file, header.recordBytes - sizeof(frame.record), SEEK_CUR) != 0)
+        {
+            break; // End of file (or a record cut short by power loss)
+        }
+        if (!frameSequenceRecordValid(frame.record))
+        {
+            ok = false;
+            break;
+        }
+        frame.pixels.resize(frame.record.pixelBytes / sizeof(uint16_t));
+        if (fread(frame.pixels.data(), 1, frame.record.pixelBytes, file) != frame.record.pixelBytes)
+        {
+            break;
+        }
+        recording.push_back(frame);
+    }
+    fclose(file);
+
+    if (!ok || recording.empty())
+    {
+        recording.clear();
+        return false;
+    }
+
+    const FrameSequenceRecord &first = recording.front().record;
+    const FrameSequenceRecord &last = recording.back().record;
+    uint32_t span = last.timestampMicros - first.timestampMicros;
+    printf("[sim] replaying %u frame(s) of %s: %ux%u, sensor 0x%x, recorded at %.1f fps\n",
+           (unsigned)recording.size(), path, first.width, first.height, header.sensorPid,
+           span ? 1e6 * (recording.size() - 1) / span : 0.0);
+    return true;
+}
+
+uint32_t simSequenceLength()
+{
+    return recording.size();
+}
+
+void simSetFrameRate(int fps)
+{
+    framePeriodMicros = fps > 0 ? 1000000 / fps : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint16_t packFrameOrder(uint8_t r, uint8_t g, uint8_t b)
+{
+    uint16_t value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    return (value << 8) | (value >> 8);
+}
+
+// Stand-in scene when no images were given: gradients with a square crossing the view
+static void renderTestPattern(uint16_t *pixels, int width, int height, uint32_t index)
+{
+    int squareSize = SIM_ARRAY_HEIGHT / 4;
+    int squareX = (int)((index * 24) % (SIM_ARRAY_WIDTH + squareSize)) - squareSize;
+    int squareY = SIM_ARRAY_HEIGHT / 2 - squareSize / 2;
+
+    for (int y = 0; y < height; y++)
+    {
+        int ay = window.y + y * window.height / height;
+        for (int x = 0; x < width; x++)
+        {
+            int ax = window.x + x * window.width / width;
+            bool square = ax >= squareX && ax < squareX + squareSize && ay >= squareY && ay < squareY + squareSize;
+            uint8_t r = square ? 240 : (uint8_t)(ax * 255 / SIM_ARRAY_WIDTH);
+            uint8_t g = square ? 200 : (uint8_t)(ay * 255 / SIM_ARRAY_HEIGHT);
+            uint8_t b = square ? 40 : (uint8_t)(((ax / 128) + (ay / 128)) & 1 ? 160 : 64);
+            pixels[y * width + x] = packFrameOrder(r, g, b);
+        }
+    }
+}
+
+// Nearest-neighbour sample of the readout window of an image stretched over the array
+static void renderImage(uint16_t *pixels, int width, int height, const SimImage &image)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int ay = window.y + y * window.height / height;
+        int iy = ay * image.height / SIM_ARRAY_HEIGHT;
+        const uint8_t *row = image.rgb.data() + (size_t)iy * image.width * 3;
+        for (int x = 0; x < width; x++)
+        {
+            int ax = window.x + x * window.width / width;
+            const uint8_t *p = row + (ax * image.width / SIM_ARRAY_WIDTH) * 3;
+            pixels[y * width + x] = packFrameOrder(p[0], p[1], p[2]);
+        }
+    }
+}
+
+// Recorded frames go out untouched at their own size; other sizes (a still) are scaled
+static void renderRecorded(uint16_t *pixels, int width, int height, const SimRecordedFrame &frame)
+{
+    int sourceWidth = frame.record.width;
+    int sourceHeight = frame.record.height;
+    if (width == sourceWidth && height == sourceHeight)
+    {
+        memcpy(pixels, frame.pixels.data(), frame.record.pixelBytes);
+        return;
+    }
+    for (int y = 0; y < height; y++)
+    {
+        const uint16_t *row = frame.pixels.data() + (size_t)(y * sourceHeight / height) * sourceWidth;
+        for (int x = 0; x < width; x++)
+        {
+            pixels[y * width + x] = row[x * sourceWidth / width];
+        }
+    }
+}
+
+uint32_t simHash(const void *data, size_t size, uint32_t hash)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static int setFramesize(sensor_t *s, framesize_t framesize)
+{
+    if (framesize < 0 || framesize >= FRAMESIZE_INVALID ||
+        (size_t)resolution[framesize].width * resolution[framesize].height > frameBuffer.size())
+    {
+        return -1;
+    }
+    s->status.framesize = framesize;
+    window = {0, 0, SIM_ARRAY_WIDTH, SIM_ARRAY_HEIGHT};
+    return 0;
+}
+
+static int setResRaw(sensor_t *s, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                     int totalX, int totalY, int outputX, int outputY, bool scale, bool binning)
+{
+    (void)s;
+    (void)totalX;
+    (void)totalY;
+    (void)outputX;
+    (void)outputY;
+    (void)scale;
+    (void)binning;
+
+    // The ISP crops the offsets back off the readout
+    SimWindow w = {startX + offsetX, startY + offsetY, endX - startX + 1 - 2 * offsetX, endY - startY + 1 - 2 * offsetY};
+    if (w.x < 0 || w.y < 0 || w.width <= 0 || w.height <= 0 || w.x + w.width > SIM_ARRAY_WIDTH ||
+        w.y + w.height > SIM_ARRAY_HEIGHT)
+    {
+        return -1;
+    }
+    window = w;
+    return 0;
+}
+
+#define SIM_SENSOR_FLAG(name, field)            \
+    static int name(sensor_t *s, int value)     \
+    {                                           \
+        s->status.field = value;                \
+        return 0;                               \
+    }
+
+SIM_SENSOR_FLAG(setHmirror, hmirror)
+SIM_SENSOR_FLAG(setVflip, vflip)
+SIM_SENSOR_FLAG(setAec2, aec2)
+SIM_SENSOR_FLAG(setDcw, dcw)
+SIM_SENSOR_FLAG(setBpc, bpc)
+SIM_SENSOR_FLAG(setWpc, wpc)
+SIM_SENSOR_FLAG(setGainCtrl, agc)
+SIM_SENSOR_FLAG(setAgcGain, agc_gain)
+SIM_SENSOR_FLAG(setExposureCtrl, aec)
+SIM_SENSOR_FLAG(setAecValue, aec_value)
+
+esp_err_t esp_camera_init(const camera_config_t *config)
+{
+    if (!config || config->pixel_format != PIXFORMAT_RGB565 || config->frame_size >= FRAMESIZE_INVALID)
+    {
+        return ESP_FAIL;
+    }
+
+    // Buffer sized by the configured frame size, like the driver's
+    const resolution_info_t &size = resolution[config->frame_size];
+    frameBuffer.assign((size_t)size.width * size.height, 0);
+
+    sensor = sensor_t();
+    sensor.id.PID = OV3660_PID;
+    sensor.pixformat = PIXFORMAT_RGB565;
+    sensor.status.framesize = config->frame_size;
+    sensor.set_framesize = setFramesize;
+    sensor.set_hmirror = setHmirror;
+    sensor.set_vflip = setVflip;
+    sensor.set_aec2 = setAec2;
+    sensor.set_dcw = setDcw;
+    sensor.set_bpc = setBpc;
+    sensor.set_wpc = setWpc;
+    sensor.set_gain_ctrl = setGainCtrl;
+    sensor.set_agc_gain = setAgcGain;
+    sensor.set_exposure_ctrl = setExposureCtrl;
+    sensor.set_aec_value = setAecValue;
+    sensor.set_res_raw = setResRaw;
+
+    cameraReady = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit()
+{
+    cameraReady = false;
+    return ESP_OK;
+}
+
+sensor_t *esp_camera_sensor_get()
+{
+    return cameraReady ? &sensor : nullptr;
+}
+
+camera_fb_t *esp_camera_fb_get()
+{
+    if (!cameraReady || frameOut)
+    {
+        // One frame buffer: the driver would time out waiting for it to come back
+        return nullptr;
+    }
+
+    if (framePeriodMicros)
+    {
+        uint64_t now = micros();
+        if (nextFrameMicros > now)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(nextFrameMicros - now));
+        }
+        nextFrameMicros = std::max<uint64_t>(nextFrameMicros, now) + framePeriodMicros;
+    }
+
+    const resolution_info_t &size = resolution[sensor.status.framesize];
+    if (!recording.empty())
+    {
+        renderRecorded(frameBuffer.data(), size.width, size.height, recording[fetched % recording.size()]);
+    }
+    else if (images.empty())
+    {
+        renderTestPattern(frameBuffer.data(), size.width, size.height, fetched);
+    }
+    else
+    {
+        renderImage(frameBuffer.data(), size.width, size.height, images[fetched % images.size()]);
+    }
+
+    uint32_t now = micros();
+    SimFrameTiming timing = {now, timings.empty() ? 0 : now - timings.back().atMicros, 0, 0, size.width, size.height};
+    timings.push_back(timing);
+    fetched++;
+
+    frame.buf = (uint8_t *)frameBuffer.data();
+    frame.width = size.width;
+    frame.height = size.height;
+    frame.len = (size_t)size.width * size.height * sizeof(uint16_t);
+    frame.format = PIXFORMAT_RGB565;
+    frame.timestamp.tv_sec = now / 1000000;
+    frame.timestamp.tv_usec = now % 1000000;
+    frameOut = true;
+    return &frame;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    if (fb == &frame && frameOut)
+    {
+        SimFrameTiming &timing = timings.back();
+        timing.holdMicros = micros() - timing.atMicros;
+        timing.hash = simHash(frame.buf, frame.len);
+        frameOut = false;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t simFramesFetched()
+{
+    return fetched;
+}
+
+bool simWriteTimings(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "frame,time_us,interval_us,hold_us,width,height,hash\n");
+    for (size_t i = 0; i < timings.size(); i++)
+    {
+        const SimFrameTiming &t = timings[i];
+        fprintf(file, "%u,%lu,%lu,%lu,%u,%u,%08x\n", (unsigned)i, (unsigned long)t.atMicros,
+                (unsigned long)t.intervalMicros, (unsigned long)t.holdMicros, t.width, t.height, t.hash);
+    }
+    fclose(file);
+    return true;
+}
+
+// Prints count, mean, median, 95th percentile and maximum; returns the sum
+static uint64_t logDistribution(const char *label, std::vector<uint32_t> values)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    uint64_t total = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        total += values[i];
+    }
+    size_t count = values.size();
+    printf("[sim] %s n=%u avg=%luus p50=%luus p95=%luus max=%luus", label, (unsigned)count,
+           (unsigned long)(total / count), (unsigned long)values[count / 2],
+           (unsigned long)values[std::min(count - 1, count * 95 / 100)], (unsigned long)values[count - 1]);
+    return total;
+}
+
+void simLogTimings()
+{
+    if (timings.empty())
+    {
+        printf("[sim] frames=0\n");
+        return;
+    }
+
+    // The preview runs at the first frame's size; a still switches size and stalls on the save
+    uint16_t previewWidth = timings[0].width;
+    uint16_t previewHeight = timings[0].height;
+    std::vector<uint32_t> intervals;
+    std::vector<uint32_t> previewHolds;
+    std::vector<uint32_t> otherHolds;
+    uint32_t digest = SIM_HASH_SEED;
+    for (size_t i = 0; i < timings.size(); i++)
+    {
+        const SimFrameTiming &t = timings[i];
+        bool preview = t.width == previewWidth && t.height == previewHeight;
+        if (i > 0 && preview && timings[i - 1].width == previewWidth && timings[i - 1].height == previewHeight)
+        {
+            intervals.push_back(t.intervalMicros);
+        }
+        (preview ? previewHolds : otherHolds).push_back(t.holdMicros);
+        digest = simHash(&t.hash, sizeof(t.hash), digest);
+    }
+
+    printf("[sim] frames=%lu outputs digest=%08x\n", (unsigned long)fetched, digest);
+    uint64_t total = logDistribution("interval", intervals);
+    if (total)
+    {
+        printf(" (%.1f fps)\n", 1e6 * intervals.size() / total);
+    }
+    char label[32];
+    snprintf(label, sizeof(label), "hold %ux%u", previewWidth, previewHeight);
+    total = logDistribution(label, previewHolds);
+    if (total)
+    {
+        // What the pipeline could sustain if frames arrived as soon as it was ready
+        printf(" (%.1f fps)\n", 1e6 * previewHolds.size() / total);
+    }
+    if (logDistribution("hold other sizes", otherHolds))
+    {
+        printf("\n");
+    }
+}
@@ -0,0 +1,1210 @@
+#include "sim.h"
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "button_events.h"
+#include "color_grade.h"
+#include "convolution.h"
+#include "pixel_simd.h"
+#include "quality_governor.h"
+#include "sensor_queue.h"
+#include "sensor_zoom.h"
+#include "tile_cache.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host checks of library code the golden cases cannot pin down: every backend of a
+// kernel against its reference, state machines driven by made-up traces, parsers fed
+// bad input. Each check prints one FAIL line per mismatch and returns how many it found.
+
+static const int CHECK_MAX_FAILURES = 8; // FAIL lines printed per check before it goes quiet
+
+struct CheckContext
+{
+    const char *name;
+    int failures;
+};
+
+static void checkFail(CheckContext &context, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void checkFail(CheckContext &context, const char *format, ...)
+{
+    if (context.failures++ >= CHECK_MAX_FAILURES)
+    {
+        return;
+    }
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    printf("[check] FAIL %s: %s\n", context.name, message);
+}
+
+static uint32_t checkRandom(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// pixel_simd: every backend against the scalar loop
+
+static const int CHECK_PIXELS = 65536;  // Every RGB565 value once
+static const int CHECK_PAD = 16;        // Pixels either side of a run, to catch stray writes
+static const int CHECK_SHORT_RUNS = 41; // Run lengths 0..40 cover every head/tail split
+static const int CHECK_SUM_ROWS = 1039; // Most rows accumulate565Swar may add up
+
+struct PixelRun
+{
+    int start; // First pixel of the source
+    int shift; // Destination start relative to start, to misalign it against the source
+    int count;
+    bool ramp; // Source is every RGB565 value in turn rather than random pixels
+};
+
+struct PixelBackend
+{
+    const char *name;
+    void (*swapBytes)(const uint16_t *, uint16_t *, int);
+    void (*unpack)(const uint16_t *, int, uint8_t *, uint8_t *, uint8_t *);
+    void (*pack)(const uint8_t *, const uint8_t *, const uint8_t *, int, uint16_t *);
+    void (*accumulate)(const uint16_t *, int, uint16_t *, uint16_t *, uint16_t *);
+    void (*fill)(uint16_t *, int, uint16_t);
+    void (*applyLut)(uint16_t *, int, const Lut565 &);
+};
+
+static const PixelBackend PIXEL_BACKENDS[] = {
+    {"swar", swapBytes565Swar, unpack565Swar, pack565Swar, accumulate565Swar, fill565Swar, applyLut565Swar},
+#if PIXEL_SIMD_SSE2
+    {"sse2", swapBytes565Sse2, unpack565Sse2, pack565Sse2, accumulate565Sse2, nullptr, nullptr},
+#endif
+#if PIXEL_SIMD_NEON
+    {"neon", swapBytes565Neon, unpack565Neon, pack565Neon, accumulate565Neon, nullptr, nullptr},
+#endif
+};
+
+// Every source alignment against every destination alignment, for each short length and
+// for the whole 64K ramp
+static std::vector<PixelRun> pixelRuns()
+{
+    std::vector<PixelRun> runs;
+    uint32_t state = 4242;
+    for (int offset = 0; offset < 4; offset++)
+    {
+        for (int shift = 0; shift < 2; shift++)
+        {
+            for (int count = 0; count < CHECK_SHORT_RUNS; count++)
+            {
+                int start = CHECK_PAD + offset + 4 * (int)(checkRandom(state) % ((CHECK_PIXELS - 64) / 4));
+                runs.push_back(PixelRun{start, shift, count, false});
+            }
+            runs.push_back(PixelRun{CHECK_PAD + offset, shift, CHECK_PIXELS - offset - shift, true});
+        }
+    }
+    return runs;
+}
+
+static std::string describeRun(const PixelRun &run)
+{
+    char text[80];
+    snprintf(text, sizeof(text), "%s start %d shift %d count %d", run.ramp ? "ramp" : "random", run.start,
+             run.shift, run.count);
+    return text;
+}
+
+template <typename T>
+static bool sameBuffers(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+static int checkPixelSimd()
+{
+    CheckContext context = {"pixel_simd", 0};
+    const size_t length = CHECK_PIXELS + 2 * CHECK_PAD;
+
+    std::vector<uint16_t> ramp(length), noise(length);
+    std::vector<uint8_t> planeNoise(length * 3);
+    uint32_t state = 777;
+    for (size_t i = 0; i < length; i++)
+    {
+        ramp[i] = (uint16_t)(i - CHECK_PAD);
+        noise[i] = (uint16_t)checkRandom(state);
+    }
+    for (size_t i = 0; i < planeNoise.size(); i++)
+    {
+        planeNoise[i] = (uint8_t)checkRandom(state);
+    }
+
+    uint8_t lut8[256];
+    for (int i = 0; i < 256; i++)
+    {
+        lut8[i] = (uint8_t)checkRandom(state);
+    }
+    Lut565 lut;
+    buildLut565(lut8, lut);
+
+    // The table must give what unpacking, looking up and repacking gives
+    for (int pixel = 0; pixel < CHECK_PIXELS; pixel++)
+    {
+        uint16_t source = (uint16_t)pixel;
+        uint8_t r, g, b;
+        unpack565Scalar(&source, 1, &r, &g, &b);
+        r = lut8[r];
+        g = lut8[g];
+        b = lut8[b];
+        uint16_t expected;
+        pack565Scalar(&r, &g, &b, 1, &expected);
+        uint16_t mapped = source;
+        applyLut565Scalar(&mapped, 1, lut);
+        if (mapped != expected)
+        {
+            checkFail(context, "buildLut565 maps %04X to %04X, expected %04X", pixel, mapped, expected);
+        }
+    }
+
+    std::vector<PixelRun> runs = pixelRuns();
+    for (size_t k = 0; k < sizeof(PIXEL_BACKENDS) / sizeof(PIXEL_BACKENDS[0]); k++)
+    {
+        const PixelBackend &backend = PIXEL_BACKENDS[k];
+        for (size_t n = 0; n < runs.size(); n++)
+        {
+            const PixelRun &run = runs[n];
+            const std::vector<uint16_t> &source = run.ramp ? ramp : noise;
+            const uint16_t *src = source.data() + run.start;
+            const int at = run.start + run.shift;
+
+            // Separate destination, then in place
+            std::vector<uint16_t> expected(noise), actual(noise);
+            swapBytes565Scalar(src, expected.data() + at, run.count);
+            backend.swapBytes(src, actual.data() + at, run.count);
+            if (!sameBuffers(expected, actual))
+            {
+                checkFail(context, "swapBytes565 %s, %s", backend.name, describeRun(run).c_str());
+            }
+            expected = source;
+            actual = source;
+            swapBytes565Scalar(expected.data() + run.start, expected.data() + run.start, run.count);
+            backend.swapBytes(actual.data() + run.start, actual.data() + run.start, run.count);
+            if (!sameBuffers(expected, actual))
+            {
+                checkFail(context, "swapBytes565 %s in place, %s", backend.name, describeRun(run).c_str());
+            }
+
+            std::vector<uint8_t> expectedPlanes(planeNoise), actualPlanes(planeNoise);
+            unpack565Scalar(src, run.count, expectedPlanes.data() + at, expectedPlanes.data() + length + at,
+                            expectedPlanes.data() + 2 * length + at);
+            backend.unpack(src, run.count, actualPlanes.data() + at, actualPlanes.data() + length + at,
+                           actualPlanes.data() + 2 * length + at);
+            if (!sameBuffers(expectedPlanes, actualPlanes))
+            {
+                checkFail(context, "unpack565 %s, %s", backend.name, describeRun(run).c_str());
+            }
+
+            // Planes from the pixel bytes so the ramp covers every red/green pair
+            const uint8_t *planes = run.ramp ? (const uint8_t *)ramp.data() : planeNoise.data();
+            expected = noise;
+            actual = noise;
+            pack565Scalar(planes + run.start, planes + run.start + 1, planes + length + run.start, run.count,
+                          expected.data() + at);
+            backend.pack(planes + run.start, planes + run.start + 1, planes + length + run.start, run.count,
+                         actual.data() + at);
+            if (!sameBuffers(expected, actual))
+            {
+                checkFail(context, "pack565 %s, %s", backend.name, describeRun(run).c_str());
+            }
+
+            // Sums start from pixel noise kept small enough for the most rows a column takes
+            std::vector<uint16_t> expectedSums(length * 3), actualSums;
+            for (size_t i = 0; i < expectedSums.size(); i++)
+            {
+                expectedSums[i] = noise[i % length] & 0x3FF;
+            }
+            actualSums = expectedSums;
+            int rows = run.ramp ? 1 : 3;
+            for (int row = 0; row < rows; row++)
+            {
+                accumulate565Scalar(src, run.count, expectedSums.data() + at, expectedSums.data() + length + at,
+                                    expectedSums.data() + 2 * length + at);
+                backend.accumulate(src, run.count, actualSums.data() + at, actualSums.data() + length + at,
+                                   actualSums.data() + 2 * length + at);
+            }
+            if (!sameBuffers(expectedSums, actualSums))
+            {
+                checkFail(context, "accumulate565 %s, %s", backend.name, describeRun(run).c_str());
+            }
+
+            if (backend.fill)
+            {
+                expected = noise;
+                actual = noise;
+                fill565Scalar(expected.data() + at, run.count, src[0]);
+                backend.fill(actual.data() + at, run.count, src[0]);
+                if (!sameBuffers(expected, actual))
+                {
+                    checkFail(context, "fill565 %s, %s", backend.name, describeRun(run).c_str());
+                }
+            }
+
+            if (backend.applyLut)
+            {
+                expected = source;
+                actual = source;
+                applyLut565Scalar(expected.data() + run.start, run.count, lut);
+                backend.applyLut(actual.data() + run.start, run.count, lut);
+                if (!sameBuffers(expected, actual))
+                {
+                    checkFail(context, "applyLut565 %s, %s", backend.name, describeRun(run).c_str());
+                }
+            }
+        }
+
+        // Full-scale fields for as many rows as the SWAR pairs can hold without a carry
+        std::vector<uint16_t> white(CHECK_PIXELS, 0xFFFF);
+        std::vector<uint16_t> expectedSums(CHECK_PIXELS * 3, 0), actualSums(CHECK_PIXELS * 3, 0);
+        for (int row = 0; row < CHECK_SUM_ROWS; row++)
+        {
+            accumulate565Scalar(white.data(), CHECK_PIXELS, expectedSums.data(), expectedSums.data() + CHECK_PIXELS,
+                                expectedSums.data() + 2 * CHECK_PIXELS);
+            backend.accumulate(white.data(), CHECK_PIXELS, actualSums.data(), actualSums.data() + CHECK_PIXELS,
+                               actualSums.data() + 2 * CHECK_PIXELS);
+        }
+        if (!sameBuffers(expectedSums, actualSums))
+        {
+            checkFail(context, "accumulate565 %s over %d white rows", backend.name, CHECK_SUM_ROWS);
+        }
+    }
+
+    printf("[check] pixel_simd: %d backends, %d runs each\n", (int)(sizeof(PIXEL_BACKENDS) / sizeof(PIXEL_BACKENDS[0])),
+           (int)runs.size());
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// sensor_zoom: readout windows inside the array, same view as the software zoom
+
+struct ZoomOutput
+{
+    const char *name;
+    int width;
+    int height;
+};
+
+// Preview and still sizes, plus one too large for a 4x window
+static const ZoomOutput ZOOM_OUTPUTS[] = {
+    {"hqvga", 240, 176},
+    {"qvga", 320, 240},
+    {"vga", 640, 480},
+    {"xga", 1024, 768},
+};
+
+static int checkSensorZoom()
+{
+    CheckContext context = {"sensor_zoom", 0};
+    const SensorGeometry &geometry = OV3660_SENSOR_GEOMETRY;
+    int windows = 0;
+
+    for (int level = -1; level <= SENSOR_ZOOM_LEVELS; level++)
+    {
+        int expected = level >= 1 && level < SENSOR_ZOOM_LEVELS ? 1 << level : 1;
+        if (zoomLevelFactor(level) != expected)
+        {
+            checkFail(context, "level %d gives %dx, expected %dx", level, zoomLevelFactor(level), expected);
+        }
+    }
+
+    for (size_t o = 0; o < sizeof(ZOOM_OUTPUTS) / sizeof(ZOOM_OUTPUTS[0]); o++)
+    {
+        const ZoomOutput &output = ZOOM_OUTPUTS[o];
+        SensorWindow window;
+        if (sensorZoomWindow(geometry, 1, output.width, output.height, window))
+        {
+            checkFail(context, "%s: 1x got a window instead of the driver's mode", output.name);
+        }
+
+        for (int level = 1; level < SENSOR_ZOOM_LEVELS; level++)
+        {
+            const int factor = zoomLevelFactor(level);
+
+            // The view the all-software zoom showed: a centered crop of the whole array
+            ZoomCrop reference = softwareZoomCrop(output.width, output.height, factor);
+            const double pixelX = (double)geometry.arrayWidth / output.width;
+            const double pixelY = (double)geometry.arrayHeight / output.height;
+            const double fromX = reference.x * pixelX;
+            const double toX = (reference.x + reference.width) * pixelX;
+            const double fromY = reference.y * pixelY;
+            const double toY = (reference.y + reference.height) * pixelY;
+
+            // Part of the zoom the sensor applies, the rest is cropped from its frame
+            for (int sensorFactor = 2; sensorFactor <= factor; sensorFactor *= 2)
+            {
+                bool fits = geometry.arrayWidth / sensorFactor >= output.width &&
+                            geometry.arrayHeight / sensorFactor >= output.height;
+                if (!sensorZoomWindow(geometry, sensorFactor, output.width, output.height, window))
+                {
+                    if (fits)
+                    {
+                        checkFail(context, "%s %dx: no window though %dx%d fits", output.name, sensorFactor,
+                                  geometry.arrayWidth / sensorFactor, geometry.arrayHeight / sensorFactor);
+                    }
+                    continue;
+                }
+                if (!fits)
+                {
+                    checkFail(context, "%s %dx: window smaller than the output", output.name, sensorFactor);
+                    continue;
+                }
+                windows++;
+
+                // Readout inside the full-frame one (array plus the ISP margin), Bayer aligned
+                int width = window.endX - window.startX + 1 - 2 * window.offsetX;
+                int height = window.endY - window.startY + 1 - 2 * window.offsetY;
+                if (window.startX < 0 || window.startY < 0 ||
+                    window.endX > geometry.arrayWidth + 2 * geometry.offsetX - 1 ||
+                    window.endY > geometry.arrayHeight + 2 * geometry.offsetY - 1)
+                {
+                    checkFail(context, "%s %dx: window %d,%d..%d,%d outside the array", output.name, sensorFactor,
+                              window.startX, window.startY, window.endX, window.endY);
+                }
+                if ((window.startX | window.startY | width | height) & 1)
+                {
+                    checkFail(context, "%s %dx: window %d,%d %dx%d not on even pixels", output.name, sensorFactor,
+                              window.startX, window.startY, width, height);
+                }
+                if (window.offsetX != geometry.offsetX || window.offsetY != geometry.offsetY ||
+                    window.totalX != geometry.totalX || window.totalY > geometry.totalY ||
+                    window.totalY < window.endY - window.startY + 1)
+                {
+                    checkFail(context, "%s %dx: timing %d/%d, offsets %d/%d", output.name, sensorFactor,
+                              window.totalX, window.totalY, window.offsetX, window.offsetY);
+                }
+                if (window.outputX != output.width || window.outputY != output.height || !window.scale ||
+                    window.binning)
+                {
+                    checkFail(context, "%s %dx: output %dx%d scale %d binning %d", output.name, sensorFactor,
+                              window.outputX, window.outputY, window.scale, window.binning);
+                }
+
+                // Window plus the software crop of its frame against the all-software view;
+                // even alignment and whole frame pixels allow a frame pixel and two sensor
+                // pixels of difference
+                ZoomCrop crop = softwareZoomCrop(output.width, output.height, factor / sensorFactor);
+                double scaleX = (double)width / output.width;
+                double scaleY = (double)height / output.height;
+                double startX = window.startX + crop.x * scaleX;
+                double endX = window.startX + (crop.x + crop.width) * scaleX;
+                double startY = window.startY + crop.y * scaleY;
+                double endY = window.startY + (crop.y + crop.height) * scaleY;
+                if (fabs(startX - fromX) > pixelX + 2 || fabs(endX - toX) > pixelX + 2 ||
+                    fabs(startY - fromY) > pixelY + 2 || fabs(endY - toY) > pixelY + 2)
+                {
+                    checkFail(context, "%s %dx (%dx on the sensor): view %.0f,%.0f..%.0f,%.0f, software %.0f,%.0f..%.0f,%.0f",
+                              output.name, factor, sensorFactor, startX, startY, endX, endY, fromX, fromY, toX, toY);
+                }
+            }
+        }
+    }
+
+    printf("[check] sensor_zoom: %d readout windows\n", windows);
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// sensor_queue: a zoom change is published one frame after the window is written
+
+static int queueWindowWrites;
+static int queueModeWrites;
+
+static int queueSetResRaw(sensor_t *, int, int, int, int, int, int, int, int, int, int, bool, bool)
+{
+    queueWindowWrites++;
+    return 0;
+}
+
+static int queueSetFramesize(sensor_t *, framesize_t)
+{
+    queueModeWrites++;
+    return 0;
+}
+
+static int checkSensorQueue()
+{
+    CheckContext context = {"sensor_queue", 0};
+    sensor_t sensor = {};
+    sensor.id.PID = OV3660_PID;
+    sensor.status.framesize = FRAMESIZE_HQVGA;
+    sensor.set_res_raw = queueSetResRaw;
+    sensor.set_framesize = queueSetFramesize;
+
+    // Zoom wanted after each frame, and the zoom each frame must be delivered with (0:
+    // dropped, read out while the window changed)
+    struct Step
+    {
+        int post;
+        int expected;
+    };
+    static const Step steps[] = {{0, 1}, {2, 1}, {0, 0}, {0, 2}, {4, 2}, {0, 0}, {0, 4}, {4, 4},
+                                 {0, 4}, {1, 4}, {0, 0}, {0, 1}, {2, 1}, {1, 0}, {0, 0}, {0, 1}};
+
+    sensorQueueFrameSizeChanged();
+    while (sensorQueuePending())
+    {
+        sensorQueueApply(&sensor);
+    }
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        // Preview order: fetch, read the zoom this frame has, apply what was posted
+        bool keep = sensorQueueFrameFetched();
+        int delivered = keep ? sensorQueueZoomFactor() : 0;
+        if (delivered != steps[i].expected)
+        {
+            checkFail(context, "frame %d delivered at %dx, expected %dx (0: dropped)", (int)i, delivered,
+                      steps[i].expected);
+        }
+        if (steps[i].post)
+        {
+            sensorQueuePost(SENSOR_CMD_ZOOM, steps[i].post);
+        }
+        sensorQueueApply(&sensor);
+    }
+
+    // A frame size change resets the window at once and queues the zoom again
+    sensorQueuePost(SENSOR_CMD_ZOOM, 2);
+    sensorQueueApply(&sensor);
+    sensorQueueFrameSizeChanged();
+    if (!sensorQueueFrameFetched() || sensorQueueZoomFactor() != 1 || !sensorQueuePending())
+    {
+        checkFail(context, "frame size change left zoom %dx, pending %d", sensorQueueZoomFactor(),
+                  sensorQueuePending());
+    }
+    sensorQueuePost(SENSOR_CMD_ZOOM, 1);
+    sensorQueueApply(&sensor);
+    sensorQueueFrameFetched();
+
+    printf("[check] sensor_queue: %d frames, %d window writes, %d mode writes\n",
+           (int)(sizeof(steps) / sizeof(steps[0])), queueWindowWrites, queueModeWrites);
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// button_events: levels reached inside the debounce window are reported after it
+
+static const int CHECK_BUTTON_PIN = 60; // Unused on the board
+static const uint32_t CHECK_DEBOUNCE_US = 10000;
+
+// Take every queued event and compare with the expected press/release sequence, and each
+// event time with when the edge was made (within a millisecond)
+static void expectButtonEvents(CheckContext &context, const char *step, const bool *pressed,
+                               const uint32_t *when, int count)
+{
+    ButtonEvent event;
+    int seen = 0;
+    while (buttonEventsNext(event))
+    {
+        if (seen >= count || event.pressed != pressed[seen] || event.micros - when[seen] > 1000)
+        {
+            checkFail(context, "%s: event %d %s at +%ldus", step, seen, event.pressed ? "press" : "release",
+                      seen < count ? (long)(event.micros - when[seen]) : 0L);
+        }
+        seen++;
+    }
+    if (seen != count)
+    {
+        checkFail(context, "%s: %d events, expected %d", step, seen, count);
+    }
+}
+
+static uint32_t buttonEdge(uint8_t level)
+{
+    uint32_t now = micros();
+    simSetPin(CHECK_BUTTON_PIN, level);
+    return now;
+}
+
+static int checkButtonEvents()
+{
+    CheckContext context = {"button_events", 0};
+    const int pins[] = {CHECK_BUTTON_PIN};
+    simSetPin(CHECK_BUTTON_PIN, HIGH);
+    if (!buttonEventsBegin(pins, 1, CHECK_DEBOUNCE_US))
+    {
+        checkFail(context, "no event queue");
+        return context.failures;
+    }
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+
+    // A tap shorter than the window: the release waits for the window to end
+    bool tap[] = {true, false};
+    uint32_t tapTimes[2];
+    tapTimes[0] = buttonEdge(LOW);
+    delayMicroseconds(2000);
+    tapTimes[1] = buttonEdge(HIGH);
+    expectButtonEvents(context, "short tap, inside the window", tap, tapTimes, 1);
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+    expectButtonEvents(context, "short tap, after the window", tap + 1, tapTimes + 1, 1);
+
+    // Contact bounce settling on the pressed level gives one press, then one release
+    uint32_t bounceTimes[2];
+    bounceTimes[0] = buttonEdge(LOW);
+    buttonEdge(HIGH);
+    buttonEdge(LOW);
+    buttonEdge(HIGH);
+    buttonEdge(LOW);
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+    bounceTimes[1] = buttonEdge(HIGH);
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+    expectButtonEvents(context, "bounce", tap, bounceTimes, 2);
+
+    // An unsettled release is reported by the next edge, ahead of it, even if nothing
+    // polled in between
+    bool twice[] = {true, false, true, false};
+    uint32_t twiceTimes[4];
+    twiceTimes[0] = buttonEdge(LOW);
+    delayMicroseconds(2000);
+    twiceTimes[1] = buttonEdge(HIGH);
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+    twiceTimes[2] = buttonEdge(LOW);
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+    twiceTimes[3] = buttonEdge(HIGH);
+    delayMicroseconds(CHECK_DEBOUNCE_US * 2);
+    expectButtonEvents(context, "two taps, no poll", twice, twiceTimes, 4);
+
+    if (buttonEventsDropped())
+    {
+        checkFail(context, "%lu events dropped", (unsigned long)buttonEventsDropped());
+    }
+    detachInterrupt(CHECK_BUTTON_PIN);
+    printf("[check] button_events: 3 traces\n");
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// quality_governor: level changes along synthetic frame time traces
+
+static const uint32_t GOVERNOR_CHECK_TARGET_US = 10000;
+static const int GOVERNOR_CHECK_HOLD = 5;
+
+// Frame time of the preview at each level, for a recipe whose every level helps
+struct GovernorLoad
+{
+    uint32_t micros[GOVERNOR_MAX_LEVEL + 1];
+};
+
+// Run frames through the governor, each taking the time the load gives for the level in
+// use; levels[i] is the level returned after frame i. Returns the level changes seen.
+static int runGovernor(QualityGovernor &governor, const PreviewRecipe &recipe, const GovernorLoad &load,
+                       int frames, std::vector<int> &levels)
+{
+    int changes = 0;
+    int level = governor.level;
+    for (int i = 0; i < frames; i++)
+    {
+        int next = governorUpdate(governor, recipe, load.micros[level]);
+        changes += next != level;
+        level = next;
+        levels.push_back(level);
+    }
+    return changes;
+}
+
+// Every change must come at least hold frames after the previous one (the first frame of
+// a run may follow a change made before it)
+static void expectHeld(CheckContext &context, const char *trace, const std::vector<int> &levels, int hold)
+{
+    int lastChange = -hold;
+    for (size_t i = 1; i < levels.size(); i++)
+    {
+        if (levels[i] != levels[i - 1])
+        {
+            if ((int)i - lastChange < hold)
+            {
+                checkFail(context, "%s: level %d -> %d at frame %d, %d frames after the last change", trace,
+                          levels[i - 1], levels[i], (int)i, (int)i - lastChange);
+            }
+            lastChange = (int)i;
+        }
+    }
+}
+
+static int checkQualityGovernor()
+{
+    CheckContext context = {"quality_governor", 0};
+    QualityGovernor governor;
+    std::vector<int> levels;
+    const GovernorLoad heavy = {{40000, 30000, 20000, 15000, 12000}};
+
+    // Over budget at every level: one step down per hold period, then it stays at the last
+    PreviewRecipe full = {1, 1, true}; // Floyd-Steinberg, pixel size 1, auto adjust
+    governorInit(governor, GOVERNOR_CHECK_TARGET_US, GOVERNOR_CHECK_HOLD);
+    governorUpdate(governor, full, heavy.micros[0]);
+    runGovernor(governor, full, heavy, 40, levels);
+    for (int i = 0; i < (int)levels.size(); i++)
+    {
+        int expected = std::min((i + 1) / GOVERNOR_CHECK_HOLD, GOVERNOR_MAX_LEVEL);
+        if (levels[i] != expected)
+        {
+            checkFail(context, "step down: frame %d at level %d, expected %d", i, levels[i], expected);
+            break;
+        }
+    }
+    PreviewRecipe degraded = governorRecipe(full, GOVERNOR_MAX_LEVEL);
+    if (degraded.dithering != GOVERNOR_ORDERED_DITHER || degraded.pixelSize != 4 || !degraded.autoAdjust ||
+        !governorRefreshAutoAdjust(0, 3) || governorRefreshAutoAdjust(1, 3) || !governorRefreshAutoAdjust(1, 8))
+    {
+        checkFail(context, "level %d recipe: dither %d, pixel size %d", GOVERNOR_MAX_LEVEL, degraded.dithering,
+                  degraded.pixelSize);
+    }
+
+    // Levels that change nothing for a recipe are skipped: ordered dither and pixel size 2
+    // only have the two pixel size levels, pixel size 8 has none
+    struct SkipCase
+    {
+        PreviewRecipe recipe;
+        int path[3]; // Levels stepped through, -1 after the last
+    };
+    static const SkipCase skips[] = {
+        {{GOVERNOR_ORDERED_DITHER, 2, false}, {3, 4, -1}},
+        {{0, 4, false}, {3, -1, -1}},
+        {{1, 8, false}, {2, -1, -1}},
+        {{0, 8, false}, {-1, -1, -1}},
+        {{0, 0, true}, {1, -1, -1}},
+    };
+    for (size_t k = 0; k < sizeof(skips) / sizeof(skips[0]); k++)
+    {
+        const SkipCase &skip = skips[k];
+        governorInit(governor, GOVERNOR_CHECK_TARGET_US, GOVERNOR_CHECK_HOLD);
+        governorUpdate(governor, skip.recipe, heavy.micros[0]);
+        levels.clear();
+        runGovernor(governor, skip.recipe, heavy, 40, levels);
+
+        std::vector<int> path;
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            if (levels[i] != (i ? levels[i - 1] : 0))
+            {
+                path.push_back(levels[i]);
+            }
+        }
+        std::vector<int> expected;
+        for (int i = 0; i < 3 && skip.path[i] >= 0; i++)
+        {
+            expected.push_back(skip.path[i]);
+        }
+        if (path != expected)
+        {
+            checkFail(context, "skip: dither %d pixel size %d auto %d took %d steps, first to %d", skip.recipe.dithering,
+                      skip.recipe.pixelSize, skip.recipe.autoAdjust, (int)path.size(), path.empty() ? 0 : path[0]);
+        }
+        expectHeld(context, "skip", levels, GOVERNOR_CHECK_HOLD);
+    }
+
+    // Step up: once the load drops, level 2 is well under budget and the governor tries
+    // level 1 after the longer step-up hold. Level 1 fits (between the thresholds), so it
+    // stays there; level 0 would be over budget again and is never tried.
+    const GovernorLoad light = {{13000, 9000, 5000, 4000, 3000}};
+    governorInit(governor, GOVERNOR_CHECK_TARGET_US, GOVERNOR_CHECK_HOLD);
+    governorUpdate(governor, full, heavy.micros[0]);
+    levels.clear();
+    runGovernor(governor, full, heavy, 2 * GOVERNOR_CHECK_HOLD, levels);
+    if (governor.level != 2)
+    {
+        checkFail(context, "step up: heavy load left level %d, expected 2", governor.level);
+    }
+    levels.clear();
+    int changes = runGovernor(governor, full, light, 200, levels);
+    int firstChange = (int)(std::find(levels.begin(), levels.end(), 1) - levels.begin());
+    if (changes != 1 || governor.level != 1 || firstChange + 1 < GOVERNOR_CHECK_HOLD * 4)
+    {
+        checkFail(context, "step up: %d changes over 200 light frames, ending at level %d, first after %d frames",
+                  changes, governor.level, firstChange + 1);
+    }
+
+    // Noise around a level that fits does not make it flap
+    const GovernorLoad noisyLow = {{14000, 12500, 6500, 6000, 6000}};
+    const GovernorLoad noisyHigh = {{16000, 7000, 9500, 6000, 6000}};
+    levels.clear();
+    changes = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        changes += runGovernor(governor, full, i & 1 ? noisyHigh : noisyLow, 1, levels);
+    }
+    if (changes != 0)
+    {
+        checkFail(context, "noise: %d level changes around level 1", changes);
+    }
+
+    // A new recipe starts over at full quality and is held before judging it
+    PreviewRecipe other = {GOVERNOR_ORDERED_DITHER, 2, true};
+    governorInit(governor, GOVERNOR_CHECK_TARGET_US, GOVERNOR_CHECK_HOLD);
+    governorUpdate(governor, full, heavy.micros[0]);
+    levels.clear();
+    runGovernor(governor, full, heavy, 3 * GOVERNOR_CHECK_HOLD, levels);
+    int before = governor.level;
+    int reset = governorUpdate(governor, other, heavy.micros[before]);
+    levels.clear();
+    runGovernor(governor, other, heavy, GOVERNOR_CHECK_HOLD, levels);
+    if (before != 3 || reset != 0 || levels[GOVERNOR_CHECK_HOLD - 2] != 0 || levels[GOVERNOR_CHECK_HOLD - 1] != 1)
+    {
+        checkFail(context, "recipe change at level %d: returned %d, then %d and %d", before, reset,
+                  levels[GOVERNOR_CHECK_HOLD - 2], levels[GOVERNOR_CHECK_HOLD - 1]);
+    }
+
+    printf("[check] quality_governor: %d traces\n", (int)(sizeof(skips) / sizeof(skips[0])) + 4);
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// convolution: kernels whose sums could overflow are refused, the largest allowed ones
+// still give the same frame both ways
+
+static const int CONVOLUTION_CHECK_WIDTH = 64;
+static const int CONVOLUTION_CHECK_HEIGHT = 24;
+
+static void fillConvolutionFrame(std::vector<uint16_t> &pixels, camera_fb_t &frame)
+{
+    uint32_t seed = 0xC0FFEEu;
+    pixels.resize(CONVOLUTION_CHECK_WIDTH * CONVOLUTION_CHECK_HEIGHT);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = (uint16_t)checkRandom(seed);
+    }
+    // White rows and columns drive every channel sum to its largest value
+    for (int x = 0; x < CONVOLUTION_CHECK_WIDTH; x++)
+    {
+        pixels[4 * CONVOLUTION_CHECK_WIDTH + x] = 0xFFFF;
+    }
+    for (int y = 0; y < CONVOLUTION_CHECK_HEIGHT; y++)
+    {
+        pixels[y * CONVOLUTION_CHECK_WIDTH + 9] = 0xFFFF;
+    }
+    memset(&frame, 0, sizeof(frame));
+    frame.buf = (uint8_t *)pixels.data();
+    frame.len = pixels.size() * sizeof(uint16_t);
+    frame.width = CONVOLUTION_CHECK_WIDTH;
+    frame.height = CONVOLUTION_CHECK_HEIGHT;
+    frame.format = PIXFORMAT_RGB565;
+}
+
+static int checkConvolution()
+{
+    CheckContext context = {"convolution", 0};
+    const ConvolutionOptions options = {CONVOLVE_RGB, CONVOLVE_BORDER_CLAMP, CONVOLVE_POST_NONE, 0};
+    std::vector<uint16_t> pixels;
+    std::vector<uint16_t> original;
+    camera_fb_t frame;
+
+    struct Refused
+    {
+        const char *name;
+        ConvolutionKernel kernel;
+    };
+    // Row sums past the int16 cache, and window sums past an int32 once scaled
+    const Refused refused[] = {
+        {"row 127 127", {3, true, {0}, {127, 127, 0}, {1, 0, 0}, 255, 0}},
+        {"row 64 65", {3, true, {0}, {64, 65, 0}, {1, 0, 0}, 256, 0}},
+        {"separable /1", {3, true, {0}, {64, 64, 0}, {64, 64, 0}, 1, 0}},
+        {"5x5 127 /1", {5, false, {127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+                                   127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127},
+                        {0}, {0}, 1, 0}},
+    };
+    for (size_t i = 0; i < sizeof(refused) / sizeof(refused[0]); i++)
+    {
+        fillConvolutionFrame(pixels, frame);
+        original = pixels;
+        if (convolveFrame(&frame, refused[i].kernel, options) || pixels != original)
+        {
+            checkFail(context, "%s: accepted or changed the frame", refused[i].name);
+        }
+    }
+
+    // At the row limit the separable path matches the same kernel written out in full
+    const ConvolutionKernel separable = {3, true, {0}, {64, 0, 64}, {0, 1, 0}, 128, 0};
+    const ConvolutionKernel full = {3, false, {0, 0, 0, 64, 0, 64, 0, 0, 0}, {0}, {0}, 128, 0};
+    std::vector<uint16_t> expected;
+    fillConvolutionFrame(expected, frame);
+    bool fullDone = convolveFrame(&frame, full, options);
+    fillConvolutionFrame(pixels, frame);
+    bool separableDone = convolveFrame(&frame, separable, options);
+    if (!fullDone || !separableDone)
+    {
+        checkFail(context, "row limit: refused (full %d, separable %d)", fullDone, separableDone);
+    }
+    else
+    {
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            if (pixels[i] != expected[i])
+            {
+                checkFail(context, "row limit: pixel %d,%d is %04x, expected %04x",
+                          (int)i % CONVOLUTION_CHECK_WIDTH, (int)i / CONVOLUTION_CHECK_WIDTH, pixels[i],
+                          expected[i]);
+            }
+        }
+    }
+
+    // Near the largest 5x5 sum an int32 takes once scaled: white stays white
+    const ConvolutionKernel widest = {5, false, {127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+                                                 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127},
+                                      {0}, {0}, 25, 0};
+    fillConvolutionFrame(pixels, frame);
+    std::fill(pixels.begin(), pixels.end(), 0xFFFF);
+    if (!convolveFrame(&frame, widest, options) ||
+        std::count(pixels.begin(), pixels.end(), 0xFFFF) != (int)pixels.size())
+    {
+        checkFail(context, "5x5 127 /25: refused or a white frame came out other than white");
+    }
+
+    printf("[check] convolution: %d kernels\n", (int)(sizeof(refused) / sizeof(refused[0])) + 3);
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// color_grade: .cube parsing and the compiled table against tetrahedral interpolation
+// worked out by hand
+
+// Run text through the parser as a file would be, one line at a time; returns the error
+static const char *parseCubeText(CubeLut &cube, const std::string &text)
+{
+    cubeLutBegin(cube);
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+        if (!cubeLutParseLine(cube, text.substr(start, end - start).c_str()))
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    cubeLutFinish(cube);
+    return cube.error;
+}
+
+// The first count points of an identity lattice of the given size, red varying fastest
+static std::string identityCubePoints(int size, int count)
+{
+    std::string text;
+    char line[64];
+    for (int i = 0; i < count; i++)
+    {
+        int r = i % size;
+        int g = i / size % size;
+        int b = i / (size * size);
+        snprintf(line, sizeof(line), "%g %g %g\n", r / (size - 1.0), g / (size - 1.0), b / (size - 1.0));
+        text += line;
+    }
+    return text;
+}
+
+static int checkColorGrade()
+{
+    CheckContext context = {"color_grade", 0};
+    CubeLut cube;
+    std::vector<uint16_t> table(COLOR_GRADE_TABLE_ENTRIES);
+
+    struct Rejection
+    {
+        const char *name;
+        std::string text;
+        const char *error;
+    };
+    const std::string points8 = identityCubePoints(2, 8);
+    const Rejection rejections[] = {
+        {"no LUT_3D_SIZE", "TITLE \"empty\"\n# nothing here\n", "no LUT_3D_SIZE"},
+        {"data first", "0 0 0\nLUT_3D_SIZE 2\n", "data before LUT_3D_SIZE"},
+        {"size 1", "LUT_3D_SIZE 1\n0 0 0\n", "LUT_3D_SIZE out of range"},
+        {"size 66", "LUT_3D_SIZE 66\n", "LUT_3D_SIZE out of range"},
+        {"size twice", "LUT_3D_SIZE 2\nLUT_3D_SIZE 2\n" + points8, "LUT_3D_SIZE given twice"},
+        {"7 points", "LUT_3D_SIZE 2\n" + identityCubePoints(2, 7), "fewer points than LUT_3D_SIZE"},
+        {"9 points", "LUT_3D_SIZE 2\n" + points8 + "1 1 1\n", "more points than LUT_3D_SIZE"},
+        {"26 points", "LUT_3D_SIZE 3\n" + identityCubePoints(3, 26), "fewer points than LUT_3D_SIZE"},
+        {"empty domain", "DOMAIN_MIN 0 0 0\nDOMAIN_MAX 1 0 1\nLUT_3D_SIZE 2\n" + points8, "empty domain"},
+        {"inverted domain", "DOMAIN_MIN 0 0 0\nDOMAIN_MAX 1 1 -1\nLUT_3D_SIZE 2\n" + points8, "empty domain"},
+        {"inverted range", "LUT_3D_INPUT_RANGE 1 0\nLUT_3D_SIZE 2\n" + points8, "empty domain"},
+        {"short DOMAIN_MAX", "DOMAIN_MAX 1 1\nLUT_3D_SIZE 2\n" + points8, "bad DOMAIN_MAX"},
+        {"nan DOMAIN_MIN", "DOMAIN_MIN nan 0 0\nLUT_3D_SIZE 2\n" + points8, "bad DOMAIN_MIN"},
+        {"inf range", "LUT_3D_INPUT_RANGE 0 inf\nLUT_3D_SIZE 2\n" + points8, "bad LUT_3D_INPUT_RANGE"},
+        {"1D", "LUT_1D_SIZE 16\n", "1D LUTs are not supported"},
+        {"two values", "LUT_3D_SIZE 2\n0 0\n" + points8, "bad data line"},
+        {"four values", "LUT_3D_SIZE 2\n0 0 0 0\n" + points8, "bad data line"},
+        {"word in data", "LUT_3D_SIZE 2\n0.5 abc 0.2\n" + points8, "bad data line"},
+        {"overflowing value", "LUT_3D_SIZE 2\n1e99 0 0\n" + points8, "bad data line"},
+        {"symbols", "LUT_3D_SIZE 2\n@@@\n" + points8, "unrecognized line"},
+    };
+    for (size_t i = 0; i < sizeof(rejections) / sizeof(rejections[0]); i++)
+    {
+        const Rejection &rejection = rejections[i];
+        const char *error = parseCubeText(cube, rejection.text);
+        if (!error || strcmp(error, rejection.error) != 0)
+        {
+            checkFail(context, "%s: error \"%s\", expected \"%s\"", rejection.name, error ? error : "none",
+                      rejection.error);
+        }
+        cubeLutRelease(cube);
+    }
+
+    // Comments, blank lines, CR line ends and vendor keywords around an identity lattice:
+    // every RGB565 value grades to itself
+    std::string identity = "# identity\r\nTITLE \"identity\"\r\n\r\nLUT_3D_SIZE 5\r\n"
+                           "DOMAIN_MIN 0 0 0\r\nDOMAIN_MAX 1 1 1\r\nLUT_3D_INPUT_RANGE 0 1\r\nVENDOR_KEY 7\r\n";
+    identity += identityCubePoints(5, 125);
+    const char *error = parseCubeText(cube, identity);
+    if (error || !colorGradeCompile(cube, table.data()))
+    {
+        checkFail(context, "identity: %s", error ? error : "did not compile");
+    }
+    else
+    {
+        std::vector<uint16_t> pixels(COLOR_GRADE_TABLE_ENTRIES);
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            pixels[i] = (uint16_t)i;
+        }
+        camera_fb_t frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.buf = (uint8_t *)pixels.data();
+        frame.len = pixels.size() * sizeof(uint16_t);
+        frame.width = 256;
+        frame.height = 256;
+        frame.format = PIXFORMAT_RGB565;
+        applyColorGrade(&frame, table.data());
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            if (pixels[i] != i)
+            {
+                checkFail(context, "identity: %04x graded to %04x", (unsigned)i, pixels[i]);
+            }
+        }
+    }
+    cubeLutRelease(cube);
+
+    // A 3-point lattice that is not linear in any channel: out = (r * g / 4, (g + 2 - b) / 4,
+    // max(r, b) / 2) at lattice indices r, g, b. Expected colors come from walking c000 to
+    // c111 through the cell in order of falling fraction, one input per tetrahedron.
+    const char *const graded =
+        "LUT_3D_SIZE 3\n"
+        "0 0.5 0\n0 0.5 0.5\n0 0.5 1\n0 0.75 0\n0.25 0.75 0.5\n0.5 0.75 1\n0 1 0\n0.5 1 0.5\n1 1 1\n"
+        "0 0.25 0.5\n0 0.25 0.5\n0 0.25 1\n0 0.5 0.5\n0.25 0.5 0.5\n0.5 0.5 1\n0 0.75 0.5\n0.5 0.75 0.5\n1 0.75 1\n"
+        "0 0 1\n0 0 1\n0 0 1\n0 0.25 1\n0.25 0.25 1\n0.5 0.25 1\n0 0.5 1\n0.5 0.5 1\n1 0.5 1\n";
+    struct Reference
+    {
+        int r5, g6, b5;
+        uint16_t graded; // RGB565, display order
+    };
+    const Reference references[] = {
+        {0, 0, 0, 0x0400},    // Lattice corners
+        {31, 63, 31, 0xFC1F},
+        {23, 12, 2, 0x3477},  // r > g > b
+        {30, 49, 27, 0xC3BE}, // r > b > g
+        {4, 20, 2, 0x14E4},   // g > r > b
+        {8, 63, 13, 0x464D},  // g > b > r
+        {6, 34, 27, 0x22BB},  // b > r > g
+        {20, 13, 13, 0x2B34}, // b > g > r
+    };
+    error = parseCubeText(cube, graded);
+    if (error || !colorGradeCompile(cube, table.data()))
+    {
+        checkFail(context, "reference: %s", error ? error : "did not compile");
+    }
+    else
+    {
+        for (size_t i = 0; i < sizeof(references) / sizeof(references[0]); i++)
+        {
+            const Reference &reference = references[i];
+            uint16_t pixel = (uint16_t)((reference.r5 << 11) | (reference.g6 << 5) | reference.b5);
+            uint16_t entry = table[(uint16_t)((pixel << 8) | (pixel >> 8))];
+            uint16_t result = (uint16_t)((entry << 8) | (entry >> 8));
+            if (result != reference.graded)
+            {
+                checkFail(context, "reference: %d,%d,%d graded to %04x, expected %04x", reference.r5,
+                          reference.g6, reference.b5, result, reference.graded);
+            }
+        }
+    }
+    cubeLutRelease(cube);
+
+    printf("[check] color_grade: %d rejected cubes, identity, %d reference colors\n",
+           (int)(sizeof(rejections) / sizeof(rejections[0])), (int)(sizeof(references) / sizeof(references[0])));
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// tile_cache: cached frames against a whole-frame pass, for changes past the thresholds,
+// changes under them and changes on odd rows only
+
+static const int TILE_CHECK_WIDTH = 96;
+static const int TILE_CHECK_HEIGHT = 64;
+
+// Each 4x4 block takes the value of its top-left pixel, as pixelate does
+static void tileCheckBlocks(camera_fb_t *frame, void *)
+{
+    uint16_t *pixels = (uint16_t *)frame->buf;
+    for (int y = 0; y < (int)frame->height; y++)
+    {
+        for (int x = 0; x < (int)frame->width; x++)
+        {
+            pixels[y * frame->width + x] = pixels[(y & ~3) * frame->width + (x & ~3)];
+        }
+    }
+}
+
+// Each pixel becomes the largest of itself and its four neighbours (reads a 1-pixel halo)
+static void tileCheckSpread(camera_fb_t *frame, void *)
+{
+    const int width = frame->width;
+    const int height = frame->height;
+    uint16_t *pixels = (uint16_t *)frame->buf;
+    std::vector<uint16_t> source(pixels, pixels + width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint16_t value = source[y * width + x];
+            value = std::max(value, source[y * width + std::max(x - 1, 0)]);
+            value = std::max(value, source[y * width + std::min(x + 1, width - 1)]);
+            value = std::max(value, source[std::max(y - 1, 0) * width + x]);
+            value = std::max(value, source[std::min(y + 1, height - 1) * width + x]);
+            pixels[y * width + x] = value;
+        }
+    }
+}
+
+// Pixels where the cache's output of scene differs from filtering scene whole
+static int tileCheckDiff(TileCache &cache, const std::vector<uint16_t> &scene, int align, int halo,
+                         TileFilterFn fn)
+{
+    std::vector<uint16_t> cached(scene);
+    std::vector<uint16_t> whole(scene);
+    camera_fb_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.width = TILE_CHECK_WIDTH;
+    frame.height = TILE_CHECK_HEIGHT;
+    frame.len = scene.size() * sizeof(uint16_t);
+    frame.format = PIXFORMAT_RGB565;
+    frame.buf = (uint8_t *)cached.data();
+    tileCacheRun(cache, &frame, 1, align, align, halo, fn, nullptr);
+    frame.buf = (uint8_t *)whole.data();
+    fn(&frame, nullptr);
+
+    int differ = 0;
+    for (size_t i = 0; i < scene.size(); i++)
+    {
+        differ += cached[i] != whole[i];
+    }
+    return differ;
+}
+
+static int checkTileCache()
+{
+    CheckContext context = {"tile_cache", 0};
+    struct TileFilter
+    {
+        const char *name;
+        int align;
+        int halo;
+        TileFilterFn fn;
+    };
+    const TileFilter filters[] = {
+        {"blocks", 4, 0, tileCheckBlocks},
+        {"spread", 1, 1, tileCheckSpread},
+    };
+
+    for (size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); f++)
+    {
+        const TileFilter &filter = filters[f];
+        TileCache cache = {};
+        uint32_t seed = 0x7153u;
+        std::vector<uint16_t> scene(TILE_CHECK_WIDTH * TILE_CHECK_HEIGHT);
+        for (size_t i = 0; i < scene.size(); i++)
+        {
+            scene[i] = (uint16_t)checkRandom(seed);
+        }
+        tileCheckDiff(cache, scene, filter.align, filter.halo, filter.fn);
+
+        // A static scene refreshes every tile exactly once per TILE_REFRESH_FRAMES frames
+        int tiles = cache.columns * cache.rows;
+        uint32_t filteredBefore = cache.stats.tilesFiltered;
+        for (int i = 0; i < TILE_REFRESH_FRAMES; i++)
+        {
+            tileCheckDiff(cache, scene, filter.align, filter.halo, filter.fn);
+        }
+        if ((int)(cache.stats.tilesFiltered - filteredBefore) != tiles)
+        {
+            checkFail(context, "%s: %d tiles filtered over %d static frames, expected %d", filter.name,
+                      (int)(cache.stats.tilesFiltered - filteredBefore), TILE_REFRESH_FRAMES, tiles);
+        }
+
+        // A bright line on one odd row is seen the next frame
+        for (int x = 24; x < 56; x++)
+        {
+            scene[37 * TILE_CHECK_WIDTH + x] = 0xFFFF;
+        }
+        int differ = tileCheckDiff(cache, scene, filter.align, filter.halo, filter.fn);
+        if (differ)
+        {
+            checkFail(context, "%s: odd-row line left %d stale pixels", filter.name, differ);
+        }
+
+        // One bright pixel moves a single sample, under TILE_CHANGED_SAMPLES; the rotating
+        // refresh catches it within TILE_REFRESH_FRAMES frames
+        scene[20 * TILE_CHECK_WIDTH + 72] = 0xFFFF;
+        differ = 0;
+        for (int i = 0; i < TILE_REFRESH_FRAMES; i++)
+        {
+            differ = tileCheckDiff(cache, scene, filter.align, filter.halo, filter.fn);
+        }
+        if (differ)
+        {
+            checkFail(context, "%s: small change left %d stale pixels after %d frames", filter.name, differ,
+                      TILE_REFRESH_FRAMES);
+        }
+        tileCacheRelease(cache);
+    }
+
+    printf("[check] tile_cache: %d filters\n", (int)(sizeof(filters) / sizeof(filters[0])));
+    return context.failures;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Check
+{
+    const char *name;
+    int (*run)();
+};
+
+static const Check CHECKS[] = {
+    {"pixel_simd", checkPixelSimd},
+    {"sensor_zoom", checkSensorZoom},
+    {"sensor_queue", checkSensorQueue},
+    {"button_events", checkButtonEvents},
+    {"quality_governor", checkQualityGovernor},
+    {"convolution", checkConvolution},
+    {"color_grade", checkColorGrade},
+    {"tile_cache", checkTileCache},
+};
+
+bool simRunChecks(const char *only)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CHECKS) / sizeof(CHECKS[0]); i++)
+    {
+        if (only && !strstr(CHECKS[i].name, only))
+        {
+            continue;
+        }
+        failures += CHECKS[i].run();
+    }
+    if (failures)
+    {
+        printf("[check] %d failures\n", failures);
+    }
+    return failures == 0;
+}
@@ -0,0 +1,6 @@
+#include <USB.h>
+#include <Wire.h>
+
+const esp_event_base_t ARDUINO_USB_EVENTS = "ARDUINO_USB_EVENTS";
+ESPUSB USB;
+TwoWire Wire;
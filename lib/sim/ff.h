@@ -0,0 +1,40 @@
+#ifndef SIM_FF_H
+#define SIM_FF_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// FatFs for the host simulator
+//
+// Only f_getfree, answered from the SD card directory (SD.h) as drive "0:", the drive
+// the SD library mounts the card on. Sector sizes are configured as in ESP-IDF, so
+// FATFS carries ssize.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+#define FF_MIN_SS 512
+#define FF_MAX_SS 4096
+
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef char TCHAR;
+
+typedef enum
+{
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_INT_ERR,
+    FR_NOT_READY,
+    FR_INVALID_DRIVE = 11,
+    FR_NOT_ENABLED = 12,
+} FRESULT;
+
+typedef struct
+{
+    WORD csize;     // Sectors per cluster
+    WORD ssize;     // Bytes per sector
+    DWORD n_fatent; // Clusters + 2
+} FATFS;
+
+FRESULT f_getfree(const TCHAR *path, DWORD *nclst, FATFS **fatfs);
+
+#endif // SIM_FF_H
@@ -0,0 +1,281 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <pthread.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SimTask
+{
+    std::string name;
+    UBaseType_t priority;
+    std::mutex lock;
+    std::condition_variable notified;
+    uint32_t notifyCount;
+};
+
+struct SimQueue
+{
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t itemSize;
+    size_t length;
+};
+
+struct SimSemaphore
+{
+    std::mutex lock;
+    std::condition_variable changed;
+    bool available;
+};
+
+static std::recursive_mutex criticalLock;
+static thread_local SimTask *currentTask = nullptr;
+
+void simEnterCritical()
+{
+    criticalLock.lock();
+}
+
+void simExitCritical()
+{
+    criticalLock.unlock();
+}
+
+// Wait on cv until ready() holds or the ticks run out
+template <typename Ready>
+static bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticks, Ready ready)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    (void)stackDepth;
+    (void)core;
+
+    SimTask *task = new SimTask();
+    task->name = name ? name : "";
+    task->priority = priority;
+    task->notifyCount = 0;
+    // Published before the task runs; the creator may be preempted on the board too
+    if (created)
+    {
+        *created = task;
+    }
+
+    std::thread([task, fn, param]()
+                {
+        currentTask = task;
+        fn(param); })
+        .detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only a task ending itself is supported (the handle stays valid, tasks are never reaped)
+    if (!task || task == currentTask)
+    {
+        pthread_exit(nullptr);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    if (!currentTask)
+    {
+        // Threads not created through xTaskCreate (the one running setup/loop)
+        currentTask = new SimTask();
+        currentTask->name = "loopTask";
+        currentTask->priority = 1;
+        currentTask->notifyCount = 0;
+    }
+    return currentTask;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->priority;
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    if (!task)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(task->lock);
+    task->notifyCount++;
+    task->notified.notify_one();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait)
+{
+    SimTask *task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->lock);
+    waitFor(task->notified, lock, ticksToWait, [task]()
+            { return task->notifyCount > 0; });
+
+    uint32_t count = task->notifyCount;
+    if (count)
+    {
+        task->notifyCount = clearOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    SimQueue *queue = new SimQueue();
+    queue->itemSize = itemSize;
+    queue->length = length;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->changed, lock, ticksToWait, [queue]()
+                 { return queue->items.size() < queue->length; }))
+    {
+        return pdFALSE;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)item;
+    queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->itemSize));
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->changed, lock, ticksToWait, [queue]()
+                 { return !queue->items.empty(); }))
+    {
+        return pdFALSE;
+    }
+
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(queue->lock);
+    return (UBaseType_t)queue->items.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    SimSemaphore *semaphore = new SimSemaphore();
+    semaphore->available = true;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    SimSemaphore *semaphore = new SimSemaphore();
+    semaphore->available = false;
+    return semaphore;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->lock);
+    if (!waitFor(semaphore->changed, lock, ticksToWait, [semaphore]()
+                 { return semaphore->available; }))
+    {
+        return pdFALSE;
+    }
+    semaphore->available = false;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->lock);
+    if (semaphore->available)
+    {
+        return pdFALSE;
+    }
+    semaphore->available = true;
+    semaphore->changed.notify_one();
+    return pdTRUE;
+}
@@ -0,0 +1,48 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// FreeRTOS for the host simulator
+//
+// Tasks are detached std::threads, queues, mutexes and task notifications are built on
+// std::mutex and std::condition_variable, and a tick is one millisecond. Core affinity
+// and priorities are recorded but not enforced. Critical sections share one recursive
+// lock, which is what they amount to on a single core.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+struct SimCriticalSection
+{
+    int unused;
+};
+typedef SimCriticalSection portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void simEnterCritical();
+void simExitCritical();
+
+#define portENTER_CRITICAL(mux) ((void)(mux), simEnterCritical())
+#define portEXIT_CRITICAL(mux) ((void)(mux), simExitCritical())
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux) portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux) portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR() ((void)0)
+
+#endif // SIM_FREERTOS_H
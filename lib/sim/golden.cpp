@@ -0,0 +1,835 @@
+#include "sim.h"
+#include <esp_camera.h>
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <climits>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "filter.h"
+#include "diffusion.h"
+#include "palette_table.h"
+#include "../../include/palettes.h"
+
+extern "C"
+{
+#include <extra/libs/png/lodepng.h>
+}
+
+// The app provides lodepng's allocators (src/main.cpp)
+extern "C" void lodepng_free(void *ptr);
+
+static const int GOLDEN_REPEATS = 3;              // Runs per case; the fastest one is timed
+static const int GOLDEN_RETRIES = 2;              // Reruns of a case over its time budget
+static const uint32_t GOLDEN_TIME_FLOOR_US = 100; // Timer noise allowed on top of the slack
+static const int GOLDEN_FIXTURE_COUNT = 3;        // Photos used, in name order
+
+// As in src/main.cpp (apply_capture_filter) and the preview (ui_HomeScreen.cpp)
+static const int GOLDEN_CAPTURE_PIXELATE_BLOCK = 8;
+static const int GOLDEN_BAYER_SIZE = 2;
+
+enum GoldenFilter
+{
+    GOLDEN_NONE = 0,
+    GOLDEN_PIXELATE,
+    GOLDEN_DITHER,
+    GOLDEN_EDGE,
+    GOLDEN_CRT,
+    GOLDEN_BLUR,
+    GOLDEN_SHARPEN,
+    GOLDEN_EMBOSS,
+    GOLDEN_UNSHARP,
+};
+
+struct GoldenPalette
+{
+    const char *name;
+    const uint32_t *colors;
+    int size;
+};
+
+// The HomeScreen dropdowns, in their order; keep in step when options are added
+static const char *const GOLDEN_FILTER_NAMES[] = {"none", "pixelate", "dither", "edge", "crt",
+                                                  "blur", "sharpen", "emboss", "unsharp"};
+static const char *const GOLDEN_DITHER_NAMES[] = {"off", "floyd-steinberg", "bayer", "blue-noise",
+                                                  "atkinson", "sierra-lite", "stucki", "jarvis"};
+static const int GOLDEN_PIXEL_SIZES[] = {1, 2, 4, 8};
+static const GoldenPalette GOLDEN_PALETTES[] = {
+    {"sunset", PALETTE_SUNSET, PALETTE_SUNSET_SIZE},
+    {"yellow-brown", PALETTE_YELLOW_BROWN, PALETTE_YELLOW_BROWN_SIZE},
+    {"grayscale", PALETTE_GRAYSCALE, PALETTE_GRAYSCALE_SIZE},
+    {"gameboy", PALETTE_GAMEBOY, PALETTE_GAMEBOY_SIZE},
+    {"cyberpunk", PALETTE_CYBERPUNK, PALETTE_CYBERPUNK_SIZE},
+    {"autumn", PALETTE_AUTUMN, PALETTE_AUTUMN_SIZE},
+    {"ocean", PALETTE_OCEAN, PALETTE_OCEAN_SIZE},
+    {"desert", PALETTE_DESERT, PALETTE_DESERT_SIZE},
+    {"sakura", PALETTE_SAKURA, PALETTE_SAKURA_SIZE},
+    {"mint", PALETTE_MINT, PALETTE_MINT_SIZE},
+    {"fire", PALETTE_FIRE, PALETTE_FIRE_SIZE},
+    {"arctic", PALETTE_ARCTIC, PALETTE_ARCTIC_SIZE},
+    {"sepia", PALETTE_SEPIA, PALETTE_SEPIA_SIZE},
+    {"neon", PALETTE_NEON, PALETTE_NEON_SIZE},
+    {"bw", PALETTE_BW, PALETTE_BW_SIZE},
+    {"cga", PALETTE_4COLOR, PALETTE_4COLOR_SIZE},
+    {"vga", PALETTE_16COLOR, PALETTE_16COLOR_SIZE},
+    {"fresta", PALETTE_FRESTA, PALETTE_FRESTA_SIZE},
+};
+
+// Palettes as large as an SD palette may be; filled from a fixed seed (fillLargePalettes)
+static uint32_t GOLDEN_RANDOM_64[64];
+static uint32_t GOLDEN_RANDOM_256[PALETTE_INDEX_MAX];
+static const GoldenPalette GOLDEN_LARGE_PALETTES[] = {
+    {"random-64", GOLDEN_RANDOM_64, 64},
+    {"random-256", GOLDEN_RANDOM_256, PALETTE_INDEX_MAX},
+};
+static const int GOLDEN_PALETTE_COUNT = sizeof(GOLDEN_PALETTES) / sizeof(GOLDEN_PALETTES[0]);
+static const int GOLDEN_LARGE_PALETTE_COUNT = sizeof(GOLDEN_LARGE_PALETTES) / sizeof(GOLDEN_LARGE_PALETTES[0]);
+
+struct GoldenFixture
+{
+    std::string name;
+    bool capture; // Still size (VGA) rather than preview size (HQVGA)
+    int width;
+    int height;
+    std::vector<uint16_t> pixels; // Frame order RGB565, as the camera delivers
+};
+
+struct GoldenCase
+{
+    std::string name;
+    const GoldenFixture *fixture;
+    GoldenFilter filter;
+    int palette;
+    int dithering;
+    int pixelSize;
+    int matching; // PALETTE_MATCH_*
+};
+
+struct GoldenResult
+{
+    uint32_t hash;
+    uint32_t micros;      // Time budget
+    uint64_t psramBytes; // Allocation budget
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Case palette number: the dropdown palettes, then the large ones
+static const GoldenPalette &goldenPalette(int palette)
+{
+    return palette < GOLDEN_PALETTE_COUNT ? GOLDEN_PALETTES[palette] : GOLDEN_LARGE_PALETTES[palette - GOLDEN_PALETTE_COUNT];
+}
+
+static void fillLargePalettes()
+{
+    uint32_t state = 12345;
+    for (int i = 0; i < GOLDEN_LARGE_PALETTE_COUNT; i++)
+    {
+        uint32_t *colors = const_cast<uint32_t *>(GOLDEN_LARGE_PALETTES[i].colors);
+        for (int j = 0; j < GOLDEN_LARGE_PALETTES[i].size; j++)
+        {
+            state = state * 1664525u + 1013904223u;
+            colors[j] = state >> 8;
+        }
+    }
+}
+
+// Nearest-neighbour stretch of a photo to the frame size, so fixtures do not depend on a
+// resampler that may itself be optimised
+static bool loadFixture(const std::string &path, const std::string &name, bool capture, GoldenFixture &fixture)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    std::vector<unsigned char> png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    unsigned char *rgb = nullptr;
+    unsigned width = 0;
+    unsigned height = 0;
+    if (png.empty() || lodepng_decode24(&rgb, &width, &height, png.data(), png.size()) != 0)
+    {
+        return false;
+    }
+
+    const resolution_info_t &size = resolution[capture ? FRAMESIZE_VGA : FRAMESIZE_HQVGA];
+    fixture.name = name;
+    fixture.capture = capture;
+    fixture.width = size.width;
+    fixture.height = size.height;
+    fixture.pixels.resize((size_t)size.width * size.height);
+    for (int y = 0; y < fixture.height; y++)
+    {
+        for (int x = 0; x < fixture.width; x++)
+        {
+            const unsigned char *p = rgb + ((y * height / fixture.height) * width + x * width / fixture.width) * 3;
+            uint16_t value = ((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3);
+            fixture.pixels[y * fixture.width + x] = (value << 8) | (value >> 8);
+        }
+    }
+    lodepng_free(rgb);
+    return true;
+}
+
+static bool loadFixtures(const char *dirPath, std::vector<GoldenFixture> &fixtures)
+{
+    DIR *dir = opendir(dirPath);
+    if (!dir)
+    {
+        return false;
+    }
+    std::vector<std::string> names;
+    while (dirent *entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0)
+        {
+            names.push_back(name.substr(0, name.size() - 4));
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    if (names.size() > (size_t)GOLDEN_FIXTURE_COUNT)
+    {
+        names.resize(GOLDEN_FIXTURE_COUNT);
+    }
+
+    for (int capture = 0; capture < 2; capture++)
+    {
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            GoldenFixture fixture;
+            if (!loadFixture(std::string(dirPath) + "/" + names[i] + ".png", names[i], capture, fixture))
+            {
+                printf("[golden] cannot decode %s.png\n", names[i].c_str());
+                return false;
+            }
+            fixtures.push_back(fixture);
+        }
+    }
+    return !fixtures.empty();
+}
+
+static void addCase(std::vector<GoldenCase> &cases, const GoldenFixture &fixture, GoldenFilter filter, int palette,
+                    int dithering, int pixelSize, int matching = PALETTE_MATCH_RGB)
+{
+    GoldenCase c = {std::string(fixture.capture ? "capture/" : "preview/") + fixture.name + "/" +
+                        GOLDEN_FILTER_NAMES[filter],
+                    &fixture, filter, palette, dithering, pixelSize, matching};
+    if (filter == GOLDEN_DITHER)
+    {
+        c.name += std::string("/") + goldenPalette(palette).name + "/" + GOLDEN_DITHER_NAMES[dithering];
+    }
+    if (pixelSize)
+    {
+        c.name += "/p" + std::to_string(pixelSize);
+    }
+    if (matching == PALETTE_MATCH_OKLAB)
+    {
+        c.name += "/oklab";
+    }
+    cases.push_back(c);
+}
+
+// Every combination the dropdowns can select; settings a filter ignores are not repeated
+static std::vector<GoldenCase> buildCases(const std::vector<GoldenFixture> &fixtures)
+{
+    const int ditherCount = sizeof(GOLDEN_DITHER_NAMES) / sizeof(GOLDEN_DITHER_NAMES[0]);
+    std::vector<GoldenCase> cases;
+    for (size_t f = 0; f < fixtures.size(); f++)
+    {
+        const GoldenFixture &fixture = fixtures[f];
+        addCase(cases, fixture, GOLDEN_NONE, 0, 0, 0);
+        addCase(cases, fixture, GOLDEN_EDGE, 0, 0, 0);
+        for (int filter = GOLDEN_BLUR; filter <= GOLDEN_UNSHARP; filter++)
+        {
+            addCase(cases, fixture, (GoldenFilter)filter, 0, 0, 0);
+        }
+        if (fixture.capture)
+        {
+            // Stills pixelate with a fixed block
+            addCase(cases, fixture, GOLDEN_PIXELATE, 0, 0, 0);
+        }
+        for (int p = 0; p < 4; p++)
+        {
+            int pixelSize = GOLDEN_PIXEL_SIZES[p];
+            if (!fixture.capture)
+            {
+                addCase(cases, fixture, GOLDEN_PIXELATE, 0, 0, pixelSize);
+            }
+            addCase(cases, fixture, GOLDEN_CRT, 0, 0, pixelSize);
+            for (int palette = 0; palette < GOLDEN_PALETTE_COUNT; palette++)
+            {
+                for (int dithering = 0; dithering < ditherCount; dithering++)
+                {
+                    addCase(cases, fixture, GOLDEN_DITHER, palette, dithering, pixelSize);
+                }
+            }
+        }
+        // SD palettes can be far larger than the built-in ones; per pixel is the costly size
+        for (int palette = 0; palette < GOLDEN_LARGE_PALETTE_COUNT; palette++)
+        {
+            for (int dithering = 0; dithering < ditherCount; dithering++)
+            {
+                addCase(cases, fixture, GOLDEN_DITHER, GOLDEN_PALETTE_COUNT + palette, dithering, 1);
+            }
+        }
+        // Perceptual matching only changes which entry is nearest; dithering and pixel size
+        // work the same as with RGB matching
+        for (int palette = 0; palette < GOLDEN_PALETTE_COUNT; palette++)
+        {
+            for (int dithering = 0; dithering < 3; dithering++)
+            {
+                addCase(cases, fixture, GOLDEN_DITHER, palette, dithering, 1, PALETTE_MATCH_OKLAB);
+            }
+        }
+    }
+    return cases;
+}
+
+static void applyCase(const GoldenCase &c, camera_fb_t *frame)
+{
+    switch (c.filter)
+    {
+    case GOLDEN_PIXELATE:
+        applyPixelate(frame, c.fixture->capture ? GOLDEN_CAPTURE_PIXELATE_BLOCK : c.pixelSize, false);
+        break;
+    case GOLDEN_DITHER:
+        applyColorPalette((uint16_t *)frame->buf, frame->width, frame->height, goldenPalette(c.palette).colors,
+                          goldenPalette(c.palette).size, c.dithering, c.pixelSize, GOLDEN_BAYER_SIZE, c.matching);
+        break;
+    case GOLDEN_EDGE:
+        applyEdgeDetection(frame, 1);
+        break;
+    case GOLDEN_CRT:
+        applyCRT(frame, c.pixelSize);
+        break;
+    case GOLDEN_BLUR:
+        applyBoxBlur(frame);
+        break;
+    case GOLDEN_SHARPEN:
+        applySharpen(frame);
+        break;
+    case GOLDEN_EMBOSS:
+        applyEmboss(frame);
+        break;
+    case GOLDEN_UNSHARP:
+        applyUnsharpMask(frame);
+        break;
+    case GOLDEN_NONE:
+    default:
+        break;
+    }
+}
+
+// Runs a case GOLDEN_REPEATS times; false if the runs disagree on the output
+static bool runCase(const GoldenCase &c, std::vector<uint16_t> &work, GoldenResult &result)
+{
+    camera_fb_t frame = {};
+    frame.width = c.fixture->width;
+    frame.height = c.fixture->height;
+    frame.len = c.fixture->pixels.size() * sizeof(uint16_t);
+    frame.format = PIXFORMAT_RGB565;
+
+    bool stable = true;
+    for (int run = 0; run < GOLDEN_REPEATS; run++)
+    {
+        work = c.fixture->pixels;
+        frame.buf = (uint8_t *)work.data();
+
+        uint64_t psramBefore = simPsramAllocated();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        applyCase(c, &frame);
+        uint32_t micros = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+        uint64_t psram = simPsramAllocated() - psramBefore;
+        uint32_t hash = simHash(frame.buf, frame.len);
+
+        if (run == 0)
+        {
+            result.hash = hash;
+            result.micros = micros;
+            result.psramBytes = psram;
+        }
+        else
+        {
+            stable = stable && hash == result.hash;
+            result.micros = std::min(result.micros, micros);
+            result.psramBytes = std::max(result.psramBytes, psram);
+        }
+    }
+    return stable;
+}
+
+// The linear scan the palette filter used before PaletteIndex
+static int linearNearest(const uint32_t *palette, int paletteSize, int r, int g, int b)
+{
+    int minDistance = INT_MAX;
+    int closest = 0;
+    for (int j = 0; j < paletteSize; j++)
+    {
+        int distance = paletteColorDistance(r, g, b, (palette[j] >> 16) & 0xFF, (palette[j] >> 8) & 0xFF, palette[j] & 0xFF);
+        if (distance < minDistance)
+        {
+            minDistance = distance;
+            closest = j;
+        }
+    }
+    return closest;
+}
+
+static double nanosPerPixel(std::chrono::steady_clock::time_point start, size_t pixels)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / pixels;
+}
+
+/**
+ * Time the nearest-color search per pixel for 2, 4, 16, 64 and 256 colors, linear scan against
+ * PaletteIndex (and the unrolled scan for the built-in ones), over the preview fixtures
+ *
+ * @return false if the two searches disagree on any pixel
+ */
+// 8-bit channels of the preview fixtures, unpacked as the palette filter does
+static std::vector<uint8_t> previewRgb(const std::vector<GoldenFixture> &fixtures)
+{
+    std::vector<uint8_t> rgb;
+    for (size_t f = 0; f < fixtures.size(); f++)
+    {
+        if (fixtures[f].capture)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < fixtures[f].pixels.size(); i++)
+        {
+            uint16_t pixel = fixtures[f].pixels[i];
+            pixel = (pixel << 8) | (pixel >> 8);
+            rgb.push_back(((pixel >> 11) & 0x1F) << 3);
+            rgb.push_back(((pixel >> 5) & 0x3F) << 2);
+            rgb.push_back((pixel & 0x1F) << 3);
+        }
+    }
+    return rgb;
+}
+
+// Best time of the unrolled scan over a compile-time table of exactly N entries
+template <size_t N>
+static double unrolledNearestNs(const PaletteTableView &table, const std::vector<uint8_t> &rgb,
+                                std::vector<uint8_t> &nearest)
+{
+    const size_t pixels = rgb.size() / 3;
+    double ns = 1e9;
+    for (int run = 0; run < GOLDEN_REPEATS; run++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < pixels; i++)
+        {
+            nearest[i] = paletteTableNearest<N>(table, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+        }
+        ns = std::min(ns, nanosPerPixel(start, pixels));
+    }
+    return ns;
+}
+
+static bool reportNearestColorCost(const std::vector<GoldenFixture> &fixtures)
+{
+    std::vector<uint8_t> rgb = previewRgb(fixtures);
+    const size_t pixels = rgb.size() / 3;
+    if (pixels == 0)
+    {
+        return true;
+    }
+
+    const GoldenPalette palettes[] = {{"bw", PALETTE_BW, PALETTE_BW_SIZE}, {"cga", PALETTE_4COLOR, PALETTE_4COLOR_SIZE},
+                                      {"vga", PALETTE_16COLOR, PALETTE_16COLOR_SIZE}, GOLDEN_LARGE_PALETTES[0],
+                                      GOLDEN_LARGE_PALETTES[1]};
+    std::vector<uint8_t> linear(pixels);
+    std::vector<uint8_t> indexed(pixels);
+    bool same = true;
+    for (size_t p = 0; p < sizeof(palettes) / sizeof(palettes[0]); p++)
+    {
+        const GoldenPalette &palette = palettes[p];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        PaletteIndex index;
+        bool built = paletteIndexBuild(index, palette.colors, palette.size);
+        double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (!built)
+        {
+            printf("[golden] FAIL nearest color, %d colors: no index\n", palette.size);
+            return false;
+        }
+
+        double linearNs = 1e9;
+        double indexedNs = 1e9;
+        for (int run = 0; run < GOLDEN_REPEATS; run++)
+        {
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pixels; i++)
+            {
+                linear[i] = linearNearest(palette.colors, palette.size, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+            }
+            linearNs = std::min(linearNs, nanosPerPixel(start, pixels));
+
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pixels; i++)
+            {
+                indexed[i] = paletteIndexNearest(index, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+            }
+            indexedNs = std::min(indexedNs, nanosPerPixel(start, pixels));
+        }
+
+        printf("[golden] nearest color, %3d colors: linear %.1f ns/px, indexed %.1f ns/px (%.1fx), "
+               "%.1f candidates/cell, built in %.2f ms\n",
+               palette.size, linearNs, indexedNs, linearNs / indexedNs,
+               (double)index.candidateCount / PALETTE_GRID_CELLS, buildMs);
+        if (linear != indexed)
+        {
+            printf("[golden] FAIL nearest color, %d colors: indexed search differs from linear scan\n", palette.size);
+            same = false;
+        }
+        paletteIndexRelease(index);
+
+        // The unrolled scan over a compile-time table (palette_table.h), which the filter
+        // only takes where it beats the index (paletteTableMapper)
+        const PaletteTableView *table = builtinPaletteTable(palette.colors, palette.size);
+        if (table)
+        {
+            double unrolledNs;
+            switch (table->size)
+            {
+            case PALETTE_BW_SIZE:
+                unrolledNs = unrolledNearestNs<PALETTE_BW_SIZE>(*table, rgb, indexed);
+                break;
+            case PALETTE_4COLOR_SIZE:
+                unrolledNs = unrolledNearestNs<PALETTE_4COLOR_SIZE>(*table, rgb, indexed);
+                break;
+            case PALETTE_16COLOR_SIZE:
+                unrolledNs = unrolledNearestNs<PALETTE_16COLOR_SIZE>(*table, rgb, indexed);
+                break;
+            default:
+                printf("[golden] FAIL nearest color, %d colors: no unrolled scan timed\n", palette.size);
+                return false;
+            }
+            printf("[golden] nearest color, %3d colors: compile-time table, unrolled %.1f ns/px\n", palette.size, unrolledNs);
+            if (linear != indexed)
+            {
+                printf("[golden] FAIL nearest color, %d colors: unrolled scan differs from linear scan\n", palette.size);
+                same = false;
+            }
+        }
+
+        // Oklab matching: all the work is in the build, a search is one lookup
+        start = std::chrono::steady_clock::now();
+        if (!paletteIndexBuild(index, palette.colors, palette.size, PALETTE_MATCH_OKLAB))
+        {
+            printf("[golden] FAIL nearest color, %d colors: no Oklab table\n", palette.size);
+            return false;
+        }
+        buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double tableNs = 1e9;
+        for (int run = 0; run < GOLDEN_REPEATS; run++)
+        {
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pixels; i++)
+            {
+                indexed[i] = paletteIndexNearest(index, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+            }
+            tableNs = std::min(tableNs, nanosPerPixel(start, pixels));
+        }
+        printf("[golden] nearest color, %3d colors: oklab table %.1f ns/px, built in %.2f ms\n", palette.size, tableNs,
+               buildMs);
+        paletteIndexRelease(index);
+    }
+    return same;
+}
+
+// One bit per channel, as applyDithering's default; keeps the quantizer cheap so the
+// timing is mostly the kernel's own error spreading
+struct GoldenThresholdQuantizer
+{
+    const uint16_t *source;
+    uint8_t *output;
+    int width;
+
+    inline void load(int x, int y, int &r, int &g, int &b)
+    {
+        uint16_t pixel = source[y * width + x];
+        pixel = (pixel << 8) | (pixel >> 8);
+        r = ((pixel >> 11) & 0x1F) << 3;
+        g = ((pixel >> 5) & 0x3F) << 2;
+        b = (pixel & 0x1F) << 3;
+    }
+
+    inline void quantize(int x, int y, int &r, int &g, int &b)
+    {
+        r = r < 128 ? 0 : 255;
+        g = g < 128 ? 0 : 255;
+        b = b < 128 ? 0 : 255;
+        output[y * width + x] = (r & 4) | (g & 2) | (b & 1);
+    }
+};
+
+// Time every error-diffusion kernel on one core over the still size fixtures
+static void reportDiffusionCost(const std::vector<GoldenFixture> &fixtures)
+{
+    const int kernels[] = {1, 4, 5, 6, 7};
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+        double nanos = 1e9;
+        size_t pixels = 0;
+        for (size_t f = 0; f < fixtures.size(); f++)
+        {
+            const GoldenFixture &fixture = fixtures[f];
+            if (!fixture.capture)
+            {
+                continue;
+            }
+            std::vector<uint8_t> output(fixture.pixels.size());
+            GoldenThresholdQuantizer quantizer = {fixture.pixels.data(), output.data(), fixture.width};
+            for (int run = 0; run < GOLDEN_REPEATS; run++)
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                diffuseErrorsWith(kernels[k], fixture.width, fixture.height, quantizer);
+                nanos = std::min(nanos, nanosPerPixel(start, fixture.pixels.size()));
+            }
+            pixels += fixture.pixels.size();
+        }
+        if (pixels)
+        {
+            printf("[golden] diffusion %-15s %.1f ns/px\n", GOLDEN_DITHER_NAMES[kernels[k]], nanos);
+        }
+    }
+}
+
+static float oklabError(const float a[3], const float b[3])
+{
+    float dl = a[0] - b[0];
+    float da = a[1] - b[1];
+    float db = a[2] - b[2];
+    return sqrtf(dl * dl + da * da + db * db);
+}
+
+/**
+ * Print how far, in Oklab, each dropdown palette puts the preview fixtures' pixels from
+ * their own color (no dithering) with RGB and with Oklab matching
+ *
+ * @return false if Oklab matching is worse than RGB matching on any palette
+ */
+static bool reportPerceptualError(const std::vector<GoldenFixture> &fixtures)
+{
+    std::vector<uint8_t> rgb = previewRgb(fixtures);
+    const size_t pixels = rgb.size() / 3;
+    if (pixels == 0)
+    {
+        return true;
+    }
+
+    // Pixels come from RGB565, so convert each of those colors once
+    std::vector<float> lab565(PALETTE_MATCH_TABLE_ENTRIES * 3);
+    for (uint32_t color = 0; color < PALETTE_MATCH_TABLE_ENTRIES; color++)
+    {
+        paletteOklab((color >> 11) << 3, ((color >> 5) & 0x3F) << 2, (color & 0x1F) << 3, &lab565[color * 3]);
+    }
+
+    bool better = true;
+    for (int p = 0; p < GOLDEN_PALETTE_COUNT; p++)
+    {
+        const GoldenPalette &palette = GOLDEN_PALETTES[p];
+        float entryLab[PALETTE_INDEX_MAX][3];
+        for (int j = 0; j < palette.size; j++)
+        {
+            paletteOklab((palette.colors[j] >> 16) & 0xFF, (palette.colors[j] >> 8) & 0xFF, palette.colors[j] & 0xFF,
+                         entryLab[j]);
+        }
+
+        double error[2] = {0, 0};
+        const int matchings[2] = {PALETTE_MATCH_RGB, PALETTE_MATCH_OKLAB};
+        for (int m = 0; m < 2; m++)
+        {
+            PaletteIndex index;
+            if (!paletteIndexBuild(index, palette.colors, palette.size, matchings[m]))
+            {
+                printf("[golden] FAIL palette matching %s: no index\n", palette.name);
+                return false;
+            }
+            for (size_t i = 0; i < pixels; i++)
+            {
+                int r = rgb[i * 3], g = rgb[i * 3 + 1], b = rgb[i * 3 + 2];
+                uint32_t color = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+                error[m] += oklabError(&lab565[color * 3], entryLab[paletteIndexNearest(index, r, g, b)]);
+            }
+            paletteIndexRelease(index);
+        }
+
+        printf("[golden] palette matching %-12s mean Oklab error: rgb %.4f, oklab %.4f (%+.1f%%)\n", palette.name,
+               error[0] / pixels, error[1] / pixels, (error[1] - error[0]) * 100.0 / error[0]);
+        if (error[1] > error[0] * 1.0001)
+        {
+            printf("[golden] FAIL palette matching %s: Oklab matching is further off than RGB\n", palette.name);
+            better = false;
+        }
+    }
+    return better;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static bool readGolden(const char *path, std::map<std::string, GoldenResult> &golden)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        GoldenResult result;
+        fields >> name >> std::hex >> result.hash >> std::dec >> result.micros >> result.psramBytes;
+        if (fields)
+        {
+            golden[name] = result;
+        }
+    }
+    return true;
+}
+
+static bool writeGolden(const char *path, const std::vector<GoldenCase> &cases, const std::vector<GoldenResult> &results)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "# Filter regression golden outputs (see lib/sim/sim.h, --golden)\n"
+                  "# case, output hash, time budget in us, PSRAM bytes allocated\n");
+    for (size_t i = 0; i < cases.size(); i++)
+    {
+        fprintf(file, "%s %08x %lu %llu\n", cases[i].name.c_str(), results[i].hash, (unsigned long)results[i].micros,
+                (unsigned long long)results[i].psramBytes);
+    }
+    fclose(file);
+    return true;
+}
+
+bool simRunGolden(const char *goldenPath, const char *photosPath, bool update, int slackPercent, const char *only)
+{
+    std::vector<GoldenFixture> fixtures;
+    if (!loadFixtures(photosPath, fixtures))
+    {
+        printf("[golden] no fixtures in %s\n", photosPath);
+        return false;
+    }
+
+    std::map<std::string, GoldenResult> golden;
+    if (!update && !readGolden(goldenPath, golden))
+    {
+        printf("[golden] cannot read %s\n", goldenPath);
+        return false;
+    }
+
+    fillLargePalettes();
+    std::vector<GoldenCase> cases = buildCases(fixtures);
+    std::vector<GoldenResult> results(cases.size());
+    std::vector<uint16_t> work;
+    int run = 0;
+    int failed = simRunChecks(nullptr) ? 0 : 1;
+    int added = 0;
+    uint64_t totalMicros = 0;
+    for (size_t i = 0; i < cases.size(); i++)
+    {
+        const GoldenCase &c = cases[i];
+        if (only && c.name.find(only) == std::string::npos)
+        {
+            golden.erase(c.name);
+            continue;
+        }
+        run++;
+
+        GoldenResult &result = results[i];
+        if (!runCase(c, work, result))
+        {
+            printf("[golden] FAIL %s: output differs between runs\n", c.name.c_str());
+            failed++;
+        }
+        totalMicros += result.micros;
+        if (update)
+        {
+            continue;
+        }
+
+        std::map<std::string, GoldenResult>::iterator expected = golden.find(c.name);
+        if (expected == golden.end())
+        {
+            printf("[golden] NEW  %s %08x %luus\n", c.name.c_str(), result.hash, (unsigned long)result.micros);
+            added++;
+            continue;
+        }
+        const GoldenResult &budget = expected->second;
+        golden.erase(expected);
+
+        // A host timing over budget is rerun first; another process may have had the core
+        uint32_t timeLimit = budget.micros + budget.micros * slackPercent / 100 + GOLDEN_TIME_FLOOR_US;
+        for (int retry = 0; retry < GOLDEN_RETRIES && result.micros > timeLimit; retry++)
+        {
+            GoldenResult rerun;
+            runCase(c, work, rerun);
+            result.micros = std::min(result.micros, rerun.micros);
+        }
+        if (result.hash != budget.hash)
+        {
+            printf("[golden] FAIL %s: output %08x, expected %08x\n", c.name.c_str(), result.hash, budget.hash);
+            failed++;
+        }
+        else if (result.micros > timeLimit)
+        {
+            printf("[golden] FAIL %s: %luus, budget %luus (+%d%%)\n", c.name.c_str(), (unsigned long)result.micros,
+                   (unsigned long)budget.micros, slackPercent);
+            failed++;
+        }
+        else if (result.psramBytes > budget.psramBytes)
+        {
+            printf("[golden] FAIL %s: %llu PSRAM bytes, budget %llu\n", c.name.c_str(),
+                   (unsigned long long)result.psramBytes, (unsigned long long)budget.psramBytes);
+            failed++;
+        }
+    }
+
+    reportDiffusionCost(fixtures);
+    if (!reportNearestColorCost(fixtures))
+    {
+        failed++;
+    }
+    if (!reportPerceptualError(fixtures))
+    {
+        failed++;
+    }
+
+    // Cases that no longer exist (a dropdown entry or fixture went away)
+    for (std::map<std::string, GoldenResult>::iterator it = golden.begin(); it != golden.end(); ++it)
+    {
+        printf("[golden] GONE %s\n", it->first.c_str());
+        failed++;
+    }
+
+    if (update)
+    {
+        if (only || !writeGolden(goldenPath, cases, results))
+        {
+            printf("[golden] cannot write %s%s\n", goldenPath, only ? " from a partial run" : "");
+            return false;
+        }
+        printf("[golden] wrote %d cases to %s (%.1fs of filtering)\n", run, goldenPath, totalMicros / 1e6);
+        return failed == 0;
+    }
+
+    printf("[golden] cases=%d failed=%d new=%d (%.1fs of filtering)\n", run, failed, added, totalMicros / 1e6);
+    return failed == 0 && added == 0;
+}
@@ -0,0 +1,124 @@
+#include <Preferences.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string.h>
+
+struct SimNamespace
+{
+    std::map<std::string, int64_t> numbers;
+    std::map<std::string, std::string> strings;
+};
+
+// Namespaces outlive the Preferences objects that open them, as flash does
+static std::map<std::string, SimNamespace> namespaces;
+static std::mutex namespacesLock;
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    if (this->name || !name)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    // Opening a namespace read-only fails until something was written to it
+    if (readOnly && namespaces.find(name) == namespaces.end())
+    {
+        return false;
+    }
+    namespaces[name];
+    this->name = name;
+    this->readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end()
+{
+    name = nullptr;
+}
+
+bool Preferences::clear()
+{
+    if (!name || readOnly)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    namespaces[name].numbers.clear();
+    namespaces[name].strings.clear();
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (!name || readOnly)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    SimNamespace &values = namespaces[name];
+    return values.numbers.erase(key) + values.strings.erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    if (!name)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    const SimNamespace &values = namespaces[name];
+    return values.numbers.count(key) || values.strings.count(key);
+}
+
+size_t Preferences::put(const char *key, int64_t value, size_t size)
+{
+    if (!name || readOnly || !key)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    namespaces[name].numbers[key] = value;
+    return size;
+}
+
+int64_t Preferences::get(const char *key, int64_t defaultValue)
+{
+    if (!name || !key)
+    {
+        return defaultValue;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    const SimNamespace &values = namespaces[name];
+    std::map<std::string, int64_t>::const_iterator it = values.numbers.find(key);
+    return it == values.numbers.end() ? defaultValue : it->second;
+}
+
+size_t Preferences::putString(const char *key, const char *value)
+{
+    if (!name || readOnly || !key || !value)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    namespaces[name].strings[key] = value;
+    return strlen(value);
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen)
+{
+    if (!name || !key)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(namespacesLock);
+    const SimNamespace &values = namespaces[name];
+    std::map<std::string, std::string>::const_iterator it = values.strings.find(key);
+    // As on the ESP32, the terminator must fit too
+    if (it == values.strings.end() || !value || it->second.size() + 1 > maxLen)
+    {
+        return 0;
+    }
+    memcpy(value, it->second.c_str(), it->second.size() + 1);
+    return it->second.size() + 1;
+}
@@ -0,0 +1,355 @@
+#include "sim.h"
+#include <SD.h>
+#include <ff.h>
+#include <dirent.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint64_t SIM_CARD_BYTES = 8ULL * 1024 * 1024 * 1024;
+static const uint64_t SIM_CLUSTER_BYTES = 32 * 1024;
+
+static std::string sdRoot = "sim_sd";
+
+void simSetSdRoot(const char *path)
+{
+    sdRoot = path;
+    while (sdRoot.size() > 1 && sdRoot[sdRoot.size() - 1] == '/')
+    {
+        sdRoot.erase(sdRoot.size() - 1);
+    }
+    ::mkdir(sdRoot.c_str(), 0755);
+}
+
+const char *simSdRoot()
+{
+    return sdRoot.c_str();
+}
+
+// Card path ("/IMG_1.png" or "IMG_1.png") to host path
+static std::string hostPath(const char *path)
+{
+    std::string result = sdRoot;
+    if (!path || path[0] != '/')
+    {
+        result += '/';
+    }
+    return result + (path ? path : "");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace fs
+{
+    struct FileHandle
+    {
+        std::string path; // card path
+        FILE *file;
+        DIR *dir;
+        bool written;
+
+        FileHandle() : file(nullptr), dir(nullptr), written(false) {}
+        ~FileHandle() { close(); }
+
+        void close()
+        {
+            if (file)
+            {
+                if (written)
+                {
+                    logWritten();
+                }
+                fclose(file);
+                file = nullptr;
+            }
+            if (dir)
+            {
+                closedir(dir);
+                dir = nullptr;
+            }
+        }
+
+        // Output hash of everything the app saves (photos, screenshots, recordings)
+        void logWritten()
+        {
+            uint8_t chunk[4096];
+            uint32_t hash = SIM_HASH_SEED;
+            size_t bytes = 0;
+            size_t n;
+            fflush(file);
+            rewind(file);
+            while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            {
+                hash = simHash(chunk, n, hash);
+                bytes += n;
+            }
+            printf("[sim] wrote %s bytes=%lu hash=%08x\n", path.c_str(), (unsigned long)bytes, hash);
+        }
+    };
+
+    size_t File::write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+
+    size_t File::write(const uint8_t *data, size_t size)
+    {
+        if (!handle || !handle->file)
+        {
+            return 0;
+        }
+        handle->written = true;
+        return fwrite(data, 1, size, handle->file);
+    }
+
+    int File::read()
+    {
+        return handle && handle->file ? fgetc(handle->file) : -1;
+    }
+
+    size_t File::read(uint8_t *data, size_t size)
+    {
+        return handle && handle->file ? fread(data, 1, size, handle->file) : 0;
+    }
+
+    bool File::seek(uint32_t position)
+    {
+        return handle && handle->file && fseek(handle->file, position, SEEK_SET) == 0;
+    }
+
+    size_t File::position() const
+    {
+        return handle && handle->file ? (size_t)ftell(handle->file) : 0;
+    }
+
+    size_t File::size() const
+    {
+        if (!handle || !handle->file)
+        {
+            return 0;
+        }
+        fflush(handle->file);
+        struct stat info;
+        return fstat(fileno(handle->file), &info) == 0 ? (size_t)info.st_size : 0;
+    }
+
+    time_t File::getLastWrite()
+    {
+        if (!handle || !handle->file)
+        {
+            return 0;
+        }
+        struct stat info;
+        return fstat(fileno(handle->file), &info) == 0 ? info.st_mtime : 0;
+    }
+
+    void File::flush()
+    {
+        if (handle && handle->file)
+        {
+            fflush(handle->file);
+        }
+    }
+
+    void File::close()
+    {
+        if (handle)
+        {
+            handle->close();
+        }
+    }
+
+    File::operator bool() const
+    {
+        return handle && (handle->file || handle->dir);
+    }
+
+    const char *File::name() const
+    {
+        if (!handle)
+        {
+            return nullptr;
+        }
+        size_t slash = handle->path.rfind('/');
+        return handle->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    }
+
+    const char *File::path() const
+    {
+        return handle ? handle->path.c_str() : nullptr;
+    }
+
+    bool File::isDirectory() const
+    {
+        return handle && handle->dir;
+    }
+
+    File File::openNextFile(const char *mode)
+    {
+        if (!handle || !handle->dir)
+        {
+            return File();
+        }
+        while (dirent *entry = readdir(handle->dir))
+        {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            std::string child = handle->path;
+            if (child.empty() || child[child.size() - 1] != '/')
+            {
+                child += '/';
+            }
+            return SD.open((child + entry->d_name).c_str(), mode);
+        }
+        return File();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    bool SDFS::begin(uint8_t csPin)
+    {
+        (void)csPin;
+        struct stat info;
+        return stat(sdRoot.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    File SDFS::open(const char *path, const char *mode)
+    {
+        std::shared_ptr<FileHandle> handle(new FileHandle());
+        handle->path = path && path[0] == '/' ? path : std::string("/") + (path ? path : "");
+
+        std::string host = hostPath(path);
+        struct stat info;
+        if (stat(host.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+        {
+            handle->dir = opendir(host.c_str());
+        }
+        else
+        {
+            // "w+r" and friends: the ESP32 VFS reads only the first letter and the '+'. Files
+            // written are opened for reading too, so they can be hashed when closed.
+            char access = mode && mode[0] ? mode[0] : 'r';
+            std::string hostMode(1, access);
+            if (access != 'r' || (mode && strchr(mode, '+')))
+            {
+                hostMode += '+';
+            }
+            handle->file = fopen(host.c_str(), (hostMode + "b").c_str());
+        }
+        return (handle->file || handle->dir) ? File(handle) : File();
+    }
+
+    bool SDFS::exists(const char *path)
+    {
+        struct stat info;
+        return stat(hostPath(path).c_str(), &info) == 0;
+    }
+
+    bool SDFS::remove(const char *path)
+    {
+        return unlink(hostPath(path).c_str()) == 0;
+    }
+
+    bool SDFS::mkdir(const char *path)
+    {
+        return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+    }
+
+    bool SDFS::rename(const char *from, const char *to)
+    {
+        return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+    }
+
+    uint64_t SDFS::cardSize()
+    {
+        return SIM_CARD_BYTES;
+    }
+
+    uint64_t SDFS::totalBytes()
+    {
+        return SIM_CARD_BYTES;
+    }
+
+    static uint64_t clusterBytes(const std::string &dirPath)
+    {
+        uint64_t used = SIM_CLUSTER_BYTES; // the directory itself
+        DIR *dir = opendir(dirPath.c_str());
+        if (!dir)
+        {
+            return 0;
+        }
+        while (dirent *entry = readdir(dir))
+        {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            std::string child = dirPath + "/" + entry->d_name;
+            struct stat info;
+            if (stat(child.c_str(), &info) != 0)
+            {
+                continue;
+            }
+            if (S_ISDIR(info.st_mode))
+            {
+                used += clusterBytes(child);
+            }
+            else
+            {
+                used += ((uint64_t)info.st_size + SIM_CLUSTER_BYTES - 1) / SIM_CLUSTER_BYTES * SIM_CLUSTER_BYTES;
+            }
+        }
+        closedir(dir);
+        return used;
+    }
+
+    uint64_t SDFS::usedBytes()
+    {
+        return clusterBytes(sdRoot);
+    }
+
+    size_t SDFS::numSectors()
+    {
+        return SIM_CARD_BYTES / sectorSize();
+    }
+
+    bool SDFS::readRAW(uint8_t *buffer, uint32_t sector)
+    {
+        (void)buffer;
+        (void)sector;
+        return false;
+    }
+
+    bool SDFS::writeRAW(uint8_t *buffer, uint32_t sector)
+    {
+        (void)buffer;
+        (void)sector;
+        return false;
+    }
+} // namespace fs
+
+fs::SDFS SD;
+
+FRESULT f_getfree(const TCHAR *path, DWORD *nclst, FATFS **fatfs)
+{
+    static FATFS volume;
+
+    if (!path || strcmp(path, "0:") != 0)
+    {
+        return FR_INVALID_DRIVE;
+    }
+    if (!SD.begin())
+    {
+        return FR_NOT_READY;
+    }
+
+    volume.ssize = 512;
+    volume.csize = SIM_CLUSTER_BYTES / volume.ssize;
+    volume.n_fatent = SIM_CARD_BYTES / SIM_CLUSTER_BYTES + 2;
+    *nclst = (DWORD)((SIM_CARD_BYTES - fs::clusterBytes(sdRoot)) / SIM_CLUSTER_BYTES);
+    *fatfs = &volume;
+    return FR_OK;
+}
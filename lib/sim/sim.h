@@ -0,0 +1,175 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <Arduino.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Headless host simulator
+//
+// Runs the unmodified app (src/main.cpp, the lib/ui screens, the filter library) on
+// Linux: LVGL draws into a framebuffer through the TFT_eSPI stand-in, esp_camera_fb_get
+// serves frames decoded from image files or replayed from a recording, the SD card is
+// a directory and Preferences live in memory. A script presses buttons, touches the
+// screen and types serial commands while setup()/loop() run as they do on the board.
+//
+// Every camera frame is timed from fetch to return and hashed when it comes back (the
+// preview filters in place, so that is its output); files written to the SD card are
+// hashed when closed. Replaying a recording serves its frames in order, one per fetch,
+// so a script that syncs on "frames" gives the same hashes on every run.
+//
+// Usage:
+//   program [--frames DIR|FILE | --replay FILE.fseq] [--sd DIR] [--script FILE]
+//           [--timings FILE.csv] [--fps N] [--spi-mhz N] [--screen FILE.ppm]
+//   program --golden FILE [--update] [--photos DIR] [--slack PCT] [--only TEXT]
+//   program --checks [--only TEXT]
+//
+//   --frames   PNG or binary PPM images, cycled in name order (default: a generated
+//              moving test pattern)
+//   --replay   Raw frame sequence recorded on the board ("rec N" on its serial console)
+//   --sd       Directory standing in for the SD card root (default: ./sim_sd)
+//   --script   Commands to run, one per line (default: "frames 300", or every frame of
+//              the recording once)
+//   --timings  Per-frame CSV: time, interval, hold time, size and output hash of every
+//              camera fetch
+//   --fps      Sensor frame rate; esp_camera_fb_get waits for the next frame (0: never)
+//   --spi-mhz  Display SPI clock; flushes take as long as the transfer would (0: free)
+//   --screen   Save the display as PPM on exit
+//   --golden   Instead of running the app, check every filter setting against the
+//              golden file (lib/sim/golden.txt); exits non-zero on any failure.
+//              --update rewrites it, --photos picks the fixture photos (default
+//              images/photos), --slack the time allowed over budget (default 100%),
+//              --only restricts the run to matching case names
+//   --checks   Only run the host checks (checks.cpp) that the golden run starts with
+//
+// Script commands ("#" starts a comment):
+//   wait MS           Run the loop for MS milliseconds
+//   frames N          Run the loop until N more camera frames were fetched
+//   press I / release I   Hold or let go of user button I (0-based)
+//   button I          Press button I for 100 ms
+//   touch X Y / untouch   Put a finger down at X,Y or lift it
+//   tap X Y           Touch X,Y for 100 ms
+//   serial TEXT       Send a line to the serial console
+//   screen FILE       Save the display as PPM
+//   quit              Stop
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Arduino core (arduino.cpp)
+/**
+ * Drive a pin's input level, running its interrupt handler on a matching edge
+ */
+void simSetPin(uint8_t pin, uint8_t level);
+
+/**
+ * Queue a line on the serial console input
+ */
+void simSerialInput(const char *line);
+
+/**
+ * @return Bytes requested through ps_malloc/ps_calloc/ps_realloc since start
+ */
+uint64_t simPsramAllocated();
+
+// Touch controller (touch.cpp)
+/**
+ * Put a finger down at x, y (or lift it) and pulse the touch interrupt line
+ */
+void simSetTouch(bool pressed, int x, int y);
+
+// Camera (camera.cpp)
+/**
+ * Load the frame source images
+ *
+ * @param path Directory of images or one image file (PNG or binary PPM)
+ * @return false if nothing could be loaded
+ */
+bool simLoadFrames(const char *path);
+
+/**
+ * Load a raw frame sequence (frame_sequence.h) to replay instead of images
+ *
+ * @return false if the file is missing or not a valid sequence
+ */
+bool simLoadSequence(const char *path);
+
+/**
+ * @return Frames in the loaded sequence
+ */
+uint32_t simSequenceLength();
+
+/**
+ * Sensor frame rate; 0 delivers a frame on every esp_camera_fb_get without waiting
+ */
+void simSetFrameRate(int fps);
+
+/**
+ * @return Camera frames fetched so far
+ */
+uint32_t simFramesFetched();
+
+/**
+ * Write the per-frame timings as CSV
+ */
+bool simWriteTimings(const char *path);
+
+/**
+ * Print frame interval and hold time percentiles and a digest of the output hashes
+ */
+void simLogTimings();
+
+const uint32_t SIM_HASH_SEED = 2166136261u;
+
+/**
+ * FNV-1a hash, continued from hash
+ */
+uint32_t simHash(const void *data, size_t size, uint32_t hash = SIM_HASH_SEED);
+
+// Filter regression check (golden.cpp)
+/**
+ * Run every filter setting the HomeScreen dropdowns offer on fixtures made from photos
+ *
+ * Each case is run several times and must give the same output every time. Against the
+ * golden file, a case fails if its output hash differs, its fastest run takes longer
+ * than the recorded time plus slackPercent, or it allocates more PSRAM than recorded.
+ * The nearest-color search is also timed per pixel for 16, 64 and 256 colors, indexed
+ * against a linear scan, and fails if the two ever disagree. Each dropdown palette's mean
+ * Oklab error is printed for RGB and Oklab matching; Oklab must never be the worse.
+ * The host checks (simRunChecks) run first and count as one failure if any fails.
+ *
+ * @param goldenPath Golden file (case, hash, time budget, PSRAM budget per line)
+ * @param photosPath Directory of PNG photos; the first few in name order become preview
+ *                   and still size fixtures
+ * @param update Write the golden file from this run instead of checking against it
+ * @param slackPercent Time allowed over the recorded budget
+ * @param only Run only cases whose name contains this (nullptr: all)
+ * @return true if every case passed (or the file was written)
+ */
+bool simRunGolden(const char *goldenPath, const char *photosPath, bool update, int slackPercent, const char *only);
+
+// Host checks (checks.cpp)
+/**
+ * Check library code against references and made-up traces (also run by simRunGolden)
+ *
+ * @param only Run only checks whose name contains this (nullptr: all)
+ * @return true if every check passed
+ */
+bool simRunChecks(const char *only);
+
+// Display (tft.cpp)
+/**
+ * Display SPI clock used to charge flush time; 0 makes flushes free
+ */
+void simSetSpiClock(int mhz);
+
+/**
+ * Save the display as binary PPM
+ */
+bool simSaveScreen(const char *path);
+
+// SD card (sd.cpp)
+/**
+ * Directory standing in for the card root (created if missing)
+ */
+void simSetSdRoot(const char *path);
+const char *simSdRoot();
+
+#endif // SIM_H
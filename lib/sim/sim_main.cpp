@@ -0,0 +1,324 @@
+#include "sim.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../../include/utilities.h"
+
+// The app's entry points (src/main.cpp)
+void setup();
+void loop();
+
+static const uint8_t SIM_BUTTON_PINS[] = BOARD_USER_BUTTON;
+static const int SIM_BUTTON_COUNT = sizeof(SIM_BUTTON_PINS) / sizeof(SIM_BUTTON_PINS[0]);
+static const uint32_t SIM_TAP_MS = 100;
+static const uint32_t SIM_FRAME_STALL_MS = 10000; // "frames N" gives up when the camera stops
+
+struct SimScript
+{
+    std::vector<std::string> lines;
+    size_t next;
+    uint32_t waitUntilMs; // "wait", and the hold time of "button"/"tap"
+    uint32_t waitFrames;  // "frames": target fetch count
+    uint32_t lastFetched;
+    uint32_t lastFrameMs;
+    std::string release; // command to run once the current wait ends
+};
+
+static SimScript script;
+
+static void usage(const char *program)
+{
+    printf("usage: %s [--frames DIR|FILE | --replay FILE.fseq] [--sd DIR] [--script FILE]\n"
+           "          [--timings FILE.csv] [--fps N] [--spi-mhz N] [--screen FILE.ppm]\n"
+           "       %s --golden FILE [--update] [--photos DIR] [--slack PCT] [--only TEXT]\n"
+           "       %s --checks [--only TEXT]\n",
+           program, program, program);
+}
+
+static void finish(const char *timingsPath, const char *screenPath)
+{
+    simLogTimings();
+    if (timingsPath && !simWriteTimings(timingsPath))
+    {
+        printf("[sim] could not write %s\n", timingsPath);
+    }
+    if (screenPath && !simSaveScreen(screenPath))
+    {
+        printf("[sim] could not write %s\n", screenPath);
+    }
+    fflush(stdout);
+    // Task threads never return; leave without tearing them down
+    _exit(0);
+}
+
+static bool buttonPin(const std::string &argument, uint8_t &pin)
+{
+    int index = atoi(argument.c_str());
+    if (argument.empty() || index < 0 || index >= SIM_BUTTON_COUNT)
+    {
+        printf("[sim] no button %s\n", argument.c_str());
+        return false;
+    }
+    pin = SIM_BUTTON_PINS[index];
+    return true;
+}
+
+// Runs one command; false once the script is over
+static bool runCommand(const std::string &line)
+{
+    std::istringstream words(line);
+    std::string command;
+    words >> command;
+    if (command.empty() || command[0] == '#')
+    {
+        return true;
+    }
+
+    std::string argument;
+    std::getline(words >> std::ws, argument);
+    int x = 0;
+    int y = 0;
+    uint8_t pin = 0;
+
+    if (command == "wait")
+    {
+        script.waitUntilMs = millis() + atoi(argument.c_str());
+    }
+    else if (command == "frames")
+    {
+        script.lastFetched = simFramesFetched();
+        script.lastFrameMs = millis();
+        script.waitFrames = script.lastFetched + atoi(argument.c_str());
+    }
+    else if (command == "press" || command == "release")
+    {
+        if (buttonPin(argument, pin))
+        {
+            simSetPin(pin, command == "press" ? LOW : HIGH);
+        }
+    }
+    else if (command == "button")
+    {
+        if (buttonPin(argument, pin))
+        {
+            simSetPin(pin, LOW);
+            script.waitUntilMs = millis() + SIM_TAP_MS;
+            script.release = "release " + argument;
+        }
+    }
+    else if (command == "touch" || command == "tap")
+    {
+        if (sscanf(argument.c_str(), "%d %d", &x, &y) != 2)
+        {
+            printf("[sim] %s needs X Y\n", command.c_str());
+            return true;
+        }
+        simSetTouch(true, x, y);
+        if (command == "tap")
+        {
+            script.waitUntilMs = millis() + SIM_TAP_MS;
+            script.release = "untouch";
+        }
+    }
+    else if (command == "untouch")
+    {
+        simSetTouch(false, 0, 0);
+    }
+    else if (command == "serial")
+    {
+        simSerialInput(argument.c_str());
+    }
+    else if (command == "screen")
+    {
+        if (!simSaveScreen(argument.c_str()))
+        {
+            printf("[sim] could not write %s\n", argument.c_str());
+        }
+    }
+    else if (command == "quit")
+    {
+        return false;
+    }
+    else
+    {
+        printf("[sim] unknown command: %s\n", line.c_str());
+    }
+    return true;
+}
+
+// Advances the script between loop() iterations; false once it is over
+static bool scriptStep()
+{
+    uint32_t now = millis();
+    if (script.waitUntilMs)
+    {
+        if ((int32_t)(now - script.waitUntilMs) < 0)
+        {
+            return true;
+        }
+        script.waitUntilMs = 0;
+    }
+    if (script.waitFrames)
+    {
+        uint32_t fetched = simFramesFetched();
+        if (fetched != script.lastFetched)
+        {
+            script.lastFetched = fetched;
+            script.lastFrameMs = now;
+        }
+        if (fetched < script.waitFrames)
+        {
+            if (now - script.lastFrameMs < SIM_FRAME_STALL_MS)
+            {
+                return true;
+            }
+            printf("[sim] no camera frame for %lu ms, moving on\n", (unsigned long)SIM_FRAME_STALL_MS);
+        }
+        script.waitFrames = 0;
+    }
+    if (!script.release.empty())
+    {
+        std::string release = script.release;
+        script.release.clear();
+        return runCommand(release);
+    }
+
+    while (script.next < script.lines.size() && !script.waitUntilMs && !script.waitFrames)
+    {
+        if (!runCommand(script.lines[script.next++]))
+        {
+            return false;
+        }
+    }
+    return script.next < script.lines.size() || script.waitUntilMs || script.waitFrames;
+}
+
+int main(int argc, char **argv)
+{
+    const char *framesPath = nullptr;
+    const char *replayPath = nullptr;
+    const char *sdPath = "sim_sd";
+    const char *scriptPath = nullptr;
+    const char *timingsPath = nullptr;
+    const char *screenPath = nullptr;
+    const char *goldenPath = nullptr;
+    const char *photosPath = "images/photos";
+    const char *only = nullptr;
+    bool updateGolden = false;
+    bool checksOnly = false;
+    int slackPercent = 100;
+    int fps = 0;
+    int spiMHz = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--update")
+        {
+            updateGolden = true;
+            continue;
+        }
+        if (option == "--checks")
+        {
+            checksOnly = true;
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (option == "--help" || option == "-h" || !value)
+        {
+            usage(argv[0]);
+            return option == "--help" || option == "-h" ? 0 : 1;
+        }
+        i++;
+        if (option == "--frames")
+            framesPath = value;
+        else if (option == "--replay")
+            replayPath = value;
+        else if (option == "--sd")
+            sdPath = value;
+        else if (option == "--script")
+            scriptPath = value;
+        else if (option == "--timings")
+            timingsPath = value;
+        else if (option == "--screen")
+            screenPath = value;
+        else if (option == "--fps")
+            fps = atoi(value);
+        else if (option == "--spi-mhz")
+            spiMHz = atoi(value);
+        else if (option == "--golden")
+            goldenPath = value;
+        else if (option == "--photos")
+            photosPath = value;
+        else if (option == "--slack")
+            slackPercent = atoi(value);
+        else if (option == "--only")
+            only = value;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (checksOnly)
+    {
+        bool passed = simRunChecks(only);
+        fflush(stdout);
+        _exit(passed ? 0 : 1);
+    }
+    if (goldenPath)
+    {
+        bool passed = simRunGolden(goldenPath, photosPath, updateGolden, slackPercent, only);
+        fflush(stdout);
+        _exit(passed ? 0 : 1);
+    }
+
+    if (framesPath && !simLoadFrames(framesPath))
+    {
+        printf("[sim] no images in %s\n", framesPath);
+        return 1;
+    }
+    if (replayPath && !simLoadSequence(replayPath))
+    {
+        printf("[sim] %s is not a frame sequence\n", replayPath);
+        return 1;
+    }
+    simSetFrameRate(fps);
+    simSetSpiClock(spiMHz);
+    simSetSdRoot(sdPath);
+
+    if (scriptPath)
+    {
+        std::ifstream file(scriptPath);
+        if (!file)
+        {
+            printf("[sim] could not read %s\n", scriptPath);
+            return 1;
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            script.lines.push_back(line);
+        }
+    }
+    else
+    {
+        script.lines.push_back(replayPath ? "frames " + std::to_string(simSequenceLength()) : "frames 300");
+    }
+    script.next = 0;
+    script.waitUntilMs = 0;
+    script.waitFrames = 0;
+    script.lastFetched = 0;
+    script.lastFrameMs = 0;
+
+    setup();
+    while (scriptStep())
+    {
+        loop();
+    }
+    finish(timingsPath, screenPath);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "sim.h"
+#include <TFT_eSPI.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static std::vector<uint16_t> screen;
+static int screenWidth = 0;
+static int screenHeight = 0;
+static int spiMHz = 0;
+
+void simSetSpiClock(int mhz)
+{
+    spiMHz = mhz > 0 ? mhz : 0;
+}
+
+bool simSaveScreen(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", screenWidth, screenHeight);
+    for (size_t i = 0; i < screen.size(); i++)
+    {
+        uint16_t c = screen[i];
+        uint8_t rgb[3] = {(uint8_t)(((c >> 11) & 0x1F) * 255 / 31), (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+                          (uint8_t)((c & 0x1F) * 255 / 31)};
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    fclose(file);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+TFT_eSPI::TFT_eSPI(int16_t width, int16_t height)
+    : panelWidth(width), panelHeight(height), rotation(0), windowX(0), windowY(0), windowWidth(0),
+      windowHeight(0), windowPixel(0), pendingPixels(0)
+{
+}
+
+void TFT_eSPI::begin()
+{
+    setRotation(rotation);
+}
+
+void TFT_eSPI::setRotation(uint8_t rotation)
+{
+    this->rotation = rotation & 3;
+    screenWidth = width();
+    screenHeight = height();
+    screen.assign((size_t)screenWidth * screenHeight, TFT_BLACK);
+}
+
+int16_t TFT_eSPI::width() const
+{
+    return (rotation & 1) ? panelHeight : panelWidth;
+}
+
+int16_t TFT_eSPI::height() const
+{
+    return (rotation & 1) ? panelWidth : panelHeight;
+}
+
+void TFT_eSPI::fillScreen(uint32_t color)
+{
+    std::fill(screen.begin(), screen.end(), (uint16_t)color);
+    pendingPixels += screen.size();
+}
+
+void TFT_eSPI::startWrite()
+{
+    pendingPixels = 0;
+}
+
+void TFT_eSPI::endWrite()
+{
+    if (spiMHz && pendingPixels)
+    {
+        // 16 bits a pixel at one bit a clock
+        std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)pendingPixels * 16 / spiMHz));
+    }
+    pendingPixels = 0;
+}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    windowX = x;
+    windowY = y;
+    windowWidth = width;
+    windowHeight = height;
+    windowPixel = 0;
+}
+
+void TFT_eSPI::pushColors(uint16_t *data, uint32_t length, bool swap)
+{
+    // swap only reorders bytes for the wire; the framebuffer keeps the colour values
+    (void)swap;
+    for (uint32_t i = 0; i < length && windowWidth > 0; i++, windowPixel++)
+    {
+        int32_t x = windowX + (int32_t)(windowPixel % windowWidth);
+        int32_t y = windowY + (int32_t)(windowPixel / windowWidth);
+        if (x >= 0 && x < screenWidth && y >= 0 && y < screenHeight && y < windowY + windowHeight)
+        {
+            screen[(size_t)y * screenWidth + x] = data[i];
+        }
+    }
+    pendingPixels += length;
+}
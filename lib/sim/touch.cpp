@@ -0,0 +1,40 @@
+#include "sim.h"
+#include <TouchLib.h>
+#include <atomic>
+#include "../../include/utilities.h"
+
+// Written by the script thread, read on the I2C bus task
+static std::atomic<bool> touchPressed(false);
+static std::atomic<int> touchX(0);
+static std::atomic<int> touchY(0);
+
+void simSetTouch(bool pressed, int x, int y)
+{
+    touchX = x;
+    touchY = y;
+    touchPressed = pressed;
+
+    // The controller pulses INT low on every report
+    simSetPin(BOARD_TOUCH_IRQ, LOW);
+    simSetPin(BOARD_TOUCH_IRQ, HIGH);
+}
+
+bool TouchLib::read()
+{
+    return touchPressed;
+}
+
+uint8_t TouchLib::getPointNum()
+{
+    return touchPressed ? 1 : 0;
+}
+
+TP_Point TouchLib::getPoint(uint8_t index)
+{
+    TP_Point point;
+    point.id = index;
+    point.x = (uint16_t)touchX;
+    point.y = (uint16_t)touchY;
+    point.pressure = touchPressed ? 1 : 0;
+    return point;
+}
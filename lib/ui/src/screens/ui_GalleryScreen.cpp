@@ -41,6 +41,7 @@ static lv_timer_t *gallery_populate_timer = nullptr;
 
 // SD helpers - defined externally
 extern bool gallery_ensure_sd_initialized();
+extern bool sd_remove_file(const char *path);
 
 static long extract_photo_index(const String &name)
 {
@@ -439,7 +440,7 @@ static void delete_photo_cb(lv_event_t *e)
     }
 
     std::string path = "/" + gallery_current_photo_name;
-    if (SD.remove(path.c_str()))
+    if (sd_remove_file(path.c_str()))
     {
         Serial.printf("Deleted photo %s\n", path.c_str());
         gallery_current_photo_name.clear();
@@ -14,6 +14,15 @@
 #include "ui_GalleryScreen.h"
 #include "../../../include/utilities.h"
 #include "filter.h"
+#include "color_grade.h"
+#include "pixel_simd.h"
+#include "resample.h"
+#include "quality_governor.h"
+#include "tile_cache.h"
+#include "sensor_zoom.h"
+#include "sensor_queue.h"
+#include "i2c_bus.h"
+#include "profiler.h"
 #include "../../../include/palettes.h"
 
 #define EYE_COLOR_INACTIVE lv_color_white()
@@ -23,6 +32,7 @@ extern uint32_t ui_get_sd_free_mb();
 extern uint16_t ui_get_battery_voltage();
 extern bool ui_is_charging();
 extern bool ui_is_usb_connected();
+extern void ui_record_preview_frame(const camera_fb_t *frame);
 
 USBMSC msc;
 SemaphoreHandle_t cam_mutex;
@@ -33,7 +43,11 @@ typedef enum
     CAMERA_FILTER_PIXELATE,
     CAMERA_FILTER_DITHER,
     CAMERA_FILTER_EDGE,
-    CAMERA_FILTER_CRT
+    CAMERA_FILTER_CRT,
+    CAMERA_FILTER_BLUR,
+    CAMERA_FILTER_SHARPEN,
+    CAMERA_FILTER_EMBOSS,
+    CAMERA_FILTER_UNSHARP
 } camera_filter_t;
 
 typedef struct
@@ -69,6 +83,7 @@ static lv_obj_t *ui_DitherDropdown = NULL;
 static lv_obj_t *ui_PixelSizeDropdown = NULL;
 static lv_obj_t *ui_photo_overlay_label = NULL;
 static lv_obj_t *ui_zoom_label = NULL;
+static lv_obj_t *ui_profiler_hud = NULL;
 static lv_obj_t *ui_agc_gain_slider = NULL;
 static lv_obj_t *ui_aec_value_slider = NULL;
 
@@ -81,6 +96,7 @@ static int current_dithering = 0;
 static int current_pixel_size = 1;
 static int current_zoom_level = 0;
 static int current_palette_index = 0;
+static int current_palette_matching = PALETTE_MATCH_RGB;
 
 static Preferences ui_prefs;
 static bool ui_prefs_ready = false;
@@ -98,9 +114,47 @@ static const char *UI_PREF_PIXEL_SIZE_KEY = "pixel_size";
 static const char *UI_PREF_AUTO_ADJUST_KEY = "auto_adjust";
 static const char *UI_PREF_ZOOM_LEVEL_KEY = "zoom_level";
 static const char *UI_PREF_SCREENSHOT_KEY = "screenshot_mode";
+static const char *UI_PREF_STILL_MODE_KEY = "still_mode";
+static const char *UI_PREF_COLOR_GRADE_KEY = "color_grade";
+static const char *UI_PREF_PALETTE_FILE_KEY = "palette_file";
+static const char *UI_PREF_PALETTE_MATCH_KEY = "palette_match";
 
 static uint8_t *camera_canvas_buf = NULL;
 static size_t camera_canvas_buf_size = 0;
+static Resampler zoom_resampler = {}; // Rebuilt only when the zoom window or frame size changes
+
+// Preview processing budget; the governor degrades the preview (never captures) to fit
+static const uint32_t PREVIEW_PROCESS_BUDGET_US = 30000;
+static const int PREVIEW_GOVERNOR_HOLD_FRAMES = 6;
+static QualityGovernor preview_governor;
+static int preview_quality_level = 0;
+static uint32_t preview_frame_index = 0;
+static Lut565 preview_auto_lut;
+static bool preview_auto_lut_valid = false;
+
+// Output of the local filters kept per tile, so a static scene is not filtered again
+static TileCache preview_tiles = {};
+
+// Palette output that goes to the canvas as indices instead of back into the frame
+static uint8_t *preview_indices = NULL;
+static size_t preview_indices_size = 0;
+static bool preview_indexed = false; // preview_indices holds the current frame
+static uint16_t preview_index_lut[PALETTE_INDEX_MAX];
+
+// Color grade applied after auto adjust, compiled from a .cube on SD (main.cpp)
+extern bool color_grade_load(const char *path, uint16_t *table);
+static uint16_t *color_grade_table = NULL; // COLOR_GRADE_TABLE_ENTRIES, allocated on first use
+static bool color_grade_active = false;
+static char color_grade_path[64] = "";
+
+typedef struct
+{
+    const uint32_t *palette;
+    int palette_size;
+    int dithering;
+    int pixel_size;
+    int matching;
+} preview_filter_ctx_t;
 
 static const palette_option_t kPaletteOptions[] = {
     {PALETTE_SUNSET, PALETTE_SUNSET_SIZE},
@@ -123,6 +177,41 @@ static const palette_option_t kPaletteOptions[] = {
     {PALETTE_FRESTA, PALETTE_FRESTA_SIZE},
 };
 static const uint8_t kPaletteOptionCount = sizeof(kPaletteOptions) / sizeof(kPaletteOptions[0]);
+static const char *kPaletteOptionNames =
+    "Sunset\n"
+    "Yellow/Brown\n"
+    "Grayscale\n"
+    "Game Boy\n"
+    "Cyberpunk\n"
+    "Autumn\n"
+    "Ocean\n"
+    "Desert\n"
+    "Sakura\n"
+    "Mint\n"
+    "Fire\n"
+    "Arctic\n"
+    "Sepia\n"
+    "Neon\n"
+    "Black & White\n"
+    "CGA 4-color\n"
+    "VGA 16-color\n"
+    "Fresta";
+
+// Palettes read from SD at startup (main.cpp parses them), listed after the built-in ones
+extern int palette_file_load(const char *path, uint32_t *colors);
+extern bool gallery_ensure_sd_initialized();
+static const char *USER_PALETTE_DIR = "/palettes";
+static const int USER_PALETTE_MAX = 16;
+
+typedef struct
+{
+    char name[32];    // File name without the extension
+    uint32_t *colors; // PSRAM
+    int size;
+} user_palette_t;
+
+static user_palette_t user_palettes[USER_PALETTE_MAX];
+static int user_palette_count = 0;
 
 static int32_t onWrite(uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize)
 {
@@ -298,38 +387,9 @@ void ui_show_photo_overlay(const char *text)
     photo_overlay_timer = lv_timer_create(photo_overlay_timer_cb, 1200, NULL);
 }
 
-void camera_set_safe(void (*fn)(sensor_t *s))
-{
-    // Pause streaming to avoid SCCB bus contention
-    ui_pause_camera_timer();
-
-    // Wait for current timer callback to finish
-    vTaskDelay(pdMS_TO_TICKS(100));
-
-    // Drain all queued frame buffers from DMA
-    camera_fb_t *fb;
-    while ((fb = esp_camera_fb_get()) != NULL)
-    {
-        esp_camera_fb_return(fb);
-    }
-
-    // OV3660 needs quiet time after DMA stops
-    vTaskDelay(pdMS_TO_TICKS(200));
-
-    sensor_t *s = esp_camera_sensor_get();
-    if (s)
-    {
-        fn(s);
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(50));
-
-    ui_resume_camera_timer();
-}
-
 static inline int clamp_palette_index(int idx)
 {
-    if (idx < 0 || idx >= kPaletteOptionCount)
+    if (idx < 0 || idx >= kPaletteOptionCount + user_palette_count)
     {
         return 0;
     }
@@ -338,7 +398,7 @@ static inline int clamp_palette_index(int idx)
 
 static inline int clamp_dither_type(int v)
 {
-    if (v < 0 || v > 2)
+    if (v < 0 || v > 7)
     {
         return 0;
     }
@@ -379,10 +439,112 @@ static inline int pixel_size_to_index(int v)
 static const uint32_t *get_current_palette(int &out_size)
 {
     current_palette_index = clamp_palette_index(current_palette_index);
+    if (current_palette_index >= kPaletteOptionCount)
+    {
+        const user_palette_t &user = user_palettes[current_palette_index - kPaletteOptionCount];
+        out_size = user.size;
+        return user.colors;
+    }
     out_size = kPaletteOptions[current_palette_index].size;
     return kPaletteOptions[current_palette_index].palette;
 }
 
+// Index the dither palette when it is chosen, not inside the first preview frame that
+// quantizes with it (an Oklab table is 65536 searches)
+static void prepare_palette(void)
+{
+    if (current_filter != CAMERA_FILTER_DITHER)
+    {
+        return;
+    }
+    int size = 0;
+    const uint32_t *palette = get_current_palette(size);
+    prepareColorPalette(palette, size, current_palette_matching);
+}
+
+static bool is_palette_file(const char *name)
+{
+    size_t len = strlen(name);
+    return len > 4 && name[0] != '.' &&
+           (strcasecmp(name + len - 4, ".hex") == 0 || strcasecmp(name + len - 4, ".gpl") == 0);
+}
+
+// Read every palette in USER_PALETTE_DIR, sorted by name so the dropdown order is stable
+static void load_user_palettes(void)
+{
+    if (user_palette_count > 0 || !gallery_ensure_sd_initialized())
+    {
+        return;
+    }
+    File dir = SD.open(USER_PALETTE_DIR);
+    if (!dir || !dir.isDirectory())
+    {
+        return;
+    }
+
+    uint32_t colors[PALETTE_INDEX_MAX];
+    File entry;
+    while ((entry = dir.openNextFile()) && user_palette_count < USER_PALETTE_MAX)
+    {
+        if (entry.isDirectory() || !is_palette_file(entry.name()))
+        {
+            entry.close();
+            continue;
+        }
+        char path[96];
+        snprintf(path, sizeof(path), "%s/%s", USER_PALETTE_DIR, entry.name());
+        user_palette_t user;
+        snprintf(user.name, sizeof(user.name), "%.*s", (int)strlen(entry.name()) - 4, entry.name());
+        entry.close();
+
+        user.size = palette_file_load(path, colors);
+        user.colors = user.size > 0 ? (uint32_t *)ps_malloc(user.size * sizeof(uint32_t)) : NULL;
+        if (!user.colors)
+        {
+            continue;
+        }
+        memcpy(user.colors, colors, user.size * sizeof(uint32_t));
+
+        int i = user_palette_count++;
+        while (i > 0 && strcasecmp(user_palettes[i - 1].name, user.name) > 0)
+        {
+            user_palettes[i] = user_palettes[i - 1];
+            i--;
+        }
+        user_palettes[i] = user;
+    }
+}
+
+// Built-in palette names followed by the user palettes
+static void set_palette_dropdown_options(lv_obj_t *dropdown)
+{
+    if (user_palette_count == 0)
+    {
+        lv_dropdown_set_options_static(dropdown, kPaletteOptionNames);
+        return;
+    }
+
+    size_t len = strlen(kPaletteOptionNames) + 1;
+    for (int i = 0; i < user_palette_count; i++)
+    {
+        len += strlen(user_palettes[i].name) + 1;
+    }
+    char *options = (char *)malloc(len);
+    if (!options)
+    {
+        lv_dropdown_set_options_static(dropdown, kPaletteOptionNames);
+        return;
+    }
+    strcpy(options, kPaletteOptionNames);
+    for (int i = 0; i < user_palette_count; i++)
+    {
+        strcat(options, "\n");
+        strcat(options, user_palettes[i].name);
+    }
+    lv_dropdown_set_options(dropdown, options);
+    free(options);
+}
+
 static inline uint16_t swap_rgb565_bytes(uint16_t px)
 {
     return (px >> 8) | (px << 8);
@@ -421,10 +583,7 @@ static void rotate_frame_90_clockwise(uint16_t *dst, const uint16_t *src, size_t
 
 static void copy_frame(uint16_t *dst, const uint16_t *src, size_t pixel_count)
 {
-    for (size_t i = 0; i < pixel_count; i++)
-    {
-        dst[i] = swap_rgb565_bytes(src[i]);
-    }
+    swapBytes565(src, dst, pixel_count);
 }
 
 static void px_swap(uint8_t *a, uint8_t *b)
@@ -434,40 +593,182 @@ static void px_swap(uint8_t *a, uint8_t *b)
     *b = c;
 }
 
+// Preview filters in the form the tile cache runs them
+static void preview_pixelate(camera_fb_t *frame, void *ctx)
+{
+    applyPixelate(frame, ((preview_filter_ctx_t *)ctx)->pixel_size, false);
+}
+
+static void preview_palette(camera_fb_t *frame, void *ctx)
+{
+    const preview_filter_ctx_t *c = (const preview_filter_ctx_t *)ctx;
+    applyColorPalette((uint16_t *)frame->buf, frame->width, frame->height, c->palette, c->palette_size, c->dithering, c->pixel_size, 2, c->matching);
+}
+
+// Palette filter straight to indices; the frame buffer keeps the unfiltered picture
+static bool preview_palette_indexed(camera_fb_t *frame, const preview_filter_ctx_t *c)
+{
+    size_t pixel_count = frame->width * frame->height;
+    if (preview_indices_size < pixel_count)
+    {
+        uint8_t *new_buf = (uint8_t *)realloc(preview_indices, pixel_count);
+        if (!new_buf)
+        {
+            return false;
+        }
+        preview_indices = new_buf;
+        preview_indices_size = pixel_count;
+    }
+
+    if (!applyColorPaletteIndexed((const uint16_t *)frame->buf, frame->width, frame->height, c->palette, c->palette_size,
+                                  preview_indices, c->dithering, c->pixel_size, 2, c->matching))
+    {
+        return false;
+    }
+    buildPaletteLut565(c->palette, c->palette_size, preview_index_lut, false);
+    return true;
+}
+
+static void preview_edge(camera_fb_t *frame, void *ctx)
+{
+    (void)ctx;
+    applyEdgeDetection(frame, 1);
+}
+
+static void preview_crt(camera_fb_t *frame, void *ctx)
+{
+    applyCRT(frame, ((preview_filter_ctx_t *)ctx)->pixel_size);
+}
+
+static void preview_convolution(camera_fb_t *frame, void *ctx)
+{
+    (void)ctx;
+    switch (current_filter)
+    {
+    case CAMERA_FILTER_BLUR:
+        applyBoxBlur(frame);
+        break;
+    case CAMERA_FILTER_SHARPEN:
+        applySharpen(frame);
+        break;
+    case CAMERA_FILTER_EMBOSS:
+        applyEmboss(frame);
+        break;
+    case CAMERA_FILTER_UNSHARP:
+        applyUnsharpMask(frame);
+        break;
+    default:
+        break;
+    }
+}
+
+// Preview filter pass, at whatever quality level the governor currently allows
 static void apply_selected_filter(camera_fb_t *frame)
 {
-    if (ui_get_auto_adjust_enabled())
+    uint32_t start = micros();
+
+    bool uses_pixel_size = current_filter == CAMERA_FILTER_PIXELATE || current_filter == CAMERA_FILTER_DITHER ||
+                           current_filter == CAMERA_FILTER_CRT;
+    PreviewRecipe requested = {current_filter == CAMERA_FILTER_DITHER ? current_dithering : 0,
+                               uses_pixel_size ? current_pixel_size : 0,
+                               ui_get_auto_adjust_enabled()};
+    PreviewRecipe recipe = governorRecipe(requested, preview_quality_level);
+
+    if (recipe.autoAdjust)
+    {
+        ProfileScope scope(PROFILE_AUTO_ADJUST);
+        if (!preview_auto_lut_valid || governorRefreshAutoAdjust(preview_quality_level, preview_frame_index))
+        {
+            buildAutoAdjustLut((const uint16_t *)frame->buf, frame->width, frame->height, frame->width, preview_auto_lut);
+            preview_auto_lut_valid = true;
+        }
+        applyAutoAdjustLut(frame, preview_auto_lut);
+    }
+
+    const uint16_t *grade = ui_get_color_grade();
+    if (grade)
     {
-        applyAutoAdjust(frame);
+        ProfileScope scope(PROFILE_GRADE);
+        applyColorGrade(frame, grade);
     }
 
+    preview_indexed = false;
+    preview_filter_ctx_t ctx = {NULL, 0, recipe.dithering, recipe.pixelSize, current_palette_matching};
+    // Filter settings the cached tiles depend on (auto-adjust and grade changes show in the input)
+    uint32_t recipe_key = (uint32_t)current_filter | (recipe.dithering << 4) | (recipe.pixelSize << 8) |
+                          (current_palette_index << 16) | (current_palette_matching << 24);
+
     switch (current_filter)
     {
     case CAMERA_FILTER_PIXELATE:
-        applyPixelate(frame, current_pixel_size, false);
-        break;
+    {
+        ProfileScope scope(PROFILE_PIXELATE);
+        tileCacheRun(preview_tiles, frame, recipe_key, recipe.pixelSize, recipe.pixelSize, 0, preview_pixelate, &ctx);
+    }
+    break;
     case CAMERA_FILTER_DITHER:
     {
-        int palette_size = 0;
-        const uint32_t *palette = get_current_palette(palette_size);
-        applyColorPalette((uint16_t *)frame->buf, frame->width, frame->height, palette, palette_size, current_dithering, current_pixel_size, 2);
+        ProfileScope scope(PROFILE_DITHER);
+        ctx.palette = get_current_palette(ctx.palette_size);
+        // Diffusion carries error across the frame and blue noise tiles too coarsely to cache
+        if (recipe.dithering == 0 || recipe.dithering == 2)
+        {
+            int align = colorPaletteBandAlign(recipe.dithering, recipe.pixelSize, 2);
+            tileCacheRun(preview_tiles, frame, recipe_key, align, align, 0, preview_palette, &ctx);
+        }
+        else
+        {
+            // Nothing to cache, so the canvas takes the palette indices (one byte per pixel)
+            tileCacheInvalidate(preview_tiles);
+            preview_indexed = preview_palette_indexed(frame, &ctx);
+            if (!preview_indexed)
+            {
+                preview_palette(frame, &ctx);
+            }
+        }
     }
     break;
     case CAMERA_FILTER_EDGE:
-        applyEdgeDetection(frame, 1);
-        break;
+    {
+        ProfileScope scope(PROFILE_EDGE);
+        tileCacheRun(preview_tiles, frame, recipe_key, 1, 1, EDGE_DETECTION_HALO, preview_edge, &ctx);
+    }
+    break;
     case CAMERA_FILTER_CRT:
-        applyCRT(frame, current_pixel_size);
-        break;
+    {
+        ProfileScope scope(PROFILE_CRT);
+        // Channels rotate every 3 block columns; rows repeat every crtBandAlign
+        tileCacheRun(preview_tiles, frame, recipe_key, 3 * recipe.pixelSize, crtBandAlign(recipe.pixelSize), 0,
+                     preview_crt, &ctx);
+    }
+    break;
+    case CAMERA_FILTER_BLUR:
+    case CAMERA_FILTER_SHARPEN:
+    case CAMERA_FILTER_EMBOSS:
+    case CAMERA_FILTER_UNSHARP:
+    {
+        ProfileScope scope(PROFILE_CONVOLVE);
+        tileCacheRun(preview_tiles, frame, recipe_key, 1, 1, CONVOLUTION_HALO, preview_convolution, &ctx);
+    }
+    break;
     case CAMERA_FILTER_NONE:
     default:
+        tileCacheInvalidate(preview_tiles);
         break;
     }
+
+    preview_frame_index++;
+    preview_quality_level = governorUpdate(preview_governor, requested, micros() - start);
+}
+
+void ui_log_preview_stats(void)
+{
+    tileCacheLogStats(preview_tiles);
 }
 
 void ui_set_filter_mode(int mode)
 {
-    if (mode < CAMERA_FILTER_NONE || mode > CAMERA_FILTER_CRT)
+    if (mode < CAMERA_FILTER_NONE || mode > CAMERA_FILTER_UNSHARP)
     {
         mode = CAMERA_FILTER_NONE;
     }
@@ -476,6 +777,7 @@ void ui_set_filter_mode(int mode)
     {
         ui_prefs.putInt(UI_PREF_FILTER_KEY, current_filter);
     }
+    prepare_palette();
 }
 
 int ui_get_filter_mode(void)
@@ -509,7 +811,31 @@ void ui_set_palette_index(int idx)
     if (ui_prefs_ready)
     {
         ui_prefs.putInt(UI_PREF_PALETTE_KEY, current_palette_index);
+        // User palettes are remembered by name, as the files on SD can change
+        bool user = current_palette_index >= kPaletteOptionCount;
+        ui_prefs.putString(UI_PREF_PALETTE_FILE_KEY, user ? user_palettes[current_palette_index - kPaletteOptionCount].name : "");
+    }
+    prepare_palette();
+}
+
+int ui_get_palette_matching(void)
+{
+    return current_palette_matching;
+}
+
+bool ui_get_perceptual_palette_enabled(void)
+{
+    return current_palette_matching == PALETTE_MATCH_OKLAB;
+}
+
+void ui_set_perceptual_palette_enabled(bool enabled)
+{
+    current_palette_matching = enabled ? PALETTE_MATCH_OKLAB : PALETTE_MATCH_RGB;
+    if (ui_prefs_ready)
+    {
+        ui_prefs.putInt(UI_PREF_PALETTE_MATCH_KEY, current_palette_matching);
     }
+    prepare_palette();
 }
 
 void ui_set_flash_enabled(bool enabled)
@@ -638,6 +964,25 @@ int ui_get_zoom_level(void)
     return current_zoom_level;
 }
 
+int ui_get_software_zoom_factor(void)
+{
+    int factor = zoomLevelFactor(current_zoom_level) / sensorQueueZoomFactor();
+    return factor > 1 ? factor : 1;
+}
+
+// Move the zoom into the sensor readout window at the next frame boundary; software crop
+// covers whatever it cannot (and the frames still exposed with the old window)
+static void apply_sensor_zoom(void)
+{
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s || s->id.PID != OV3660_PID)
+    {
+        return;
+    }
+
+    sensorQueuePost(SENSOR_CMD_ZOOM, zoomLevelFactor(current_zoom_level));
+}
+
 void ui_set_zoom_level(int level)
 {
     if (level < 0 || level > 2)
@@ -646,6 +991,7 @@ void ui_set_zoom_level(int level)
     }
 
     current_zoom_level = level;
+    apply_sensor_zoom();
 
     if (ui_zoom_label)
     {
@@ -687,14 +1033,154 @@ void ui_set_screenshot_mode_enabled(bool enabled)
     }
 }
 
+bool ui_get_still_mode_enabled(void)
+{
+    Preferences prefs;
+    if (prefs.begin(UI_PREF_NAMESPACE, true))
+    {
+        bool enabled = prefs.getBool(UI_PREF_STILL_MODE_KEY, false);
+        prefs.end();
+        return enabled;
+    }
+    return false;
+}
+
+void ui_set_still_mode_enabled(bool enabled)
+{
+    if (ui_prefs_ready)
+    {
+        ui_prefs.putBool(UI_PREF_STILL_MODE_KEY, enabled);
+    }
+}
+
+static bool load_color_grade(const char *path)
+{
+    color_grade_active = false;
+    color_grade_path[0] = '\0';
+    if (!path || !path[0] || strlen(path) >= sizeof(color_grade_path))
+    {
+        return false;
+    }
+
+    if (!color_grade_table)
+    {
+        color_grade_table = (uint16_t *)ps_malloc(COLOR_GRADE_TABLE_ENTRIES * sizeof(uint16_t));
+        if (!color_grade_table)
+        {
+            return false;
+        }
+    }
+    if (!color_grade_load(path, color_grade_table))
+    {
+        return false;
+    }
+
+    strcpy(color_grade_path, path);
+    color_grade_active = true;
+    return true;
+}
+
+bool ui_set_color_grade(const char *path)
+{
+    bool ok = load_color_grade(path);
+    if (ui_prefs_ready)
+    {
+        ui_prefs.putString(UI_PREF_COLOR_GRADE_KEY, color_grade_path);
+    }
+    return ok || !path || !path[0];
+}
+
+const uint16_t *ui_get_color_grade(void)
+{
+    return color_grade_active ? color_grade_table : NULL;
+}
+
+const char *ui_get_color_grade_path(void)
+{
+    return color_grade_path;
+}
+
+// Median and 95th percentile of every stage that ran in the recent frames, in ms
+static void update_profiler_hud(void)
+{
+    if (!ui_profiler_hud || lv_obj_has_flag(ui_profiler_hud, LV_OBJ_FLAG_HIDDEN))
+    {
+        return;
+    }
+
+    char text[PROFILE_STAGE_COUNT * 32 + 32];
+    int len = snprintf(text, sizeof(text), "stage  p50  p95");
+    for (int i = 0; i < PROFILE_STAGE_COUNT && len < (int)sizeof(text); i++)
+    {
+        ProfileStage stage = (ProfileStage)i;
+        uint32_t p95 = profileStagePercentile(stage, 95);
+        if (p95 == 0)
+        {
+            continue;
+        }
+        uint32_t p50 = profileStagePercentile(stage, 50);
+        len += snprintf(text + len, sizeof(text) - len, "\n%s %lu.%lu %lu.%lu", profileStageName(stage),
+                        (unsigned long)(p50 / 1000), (unsigned long)(p50 % 1000 / 100),
+                        (unsigned long)(p95 / 1000), (unsigned long)(p95 % 1000 / 100));
+    }
+    if (preview_tiles.stats.frames && len < (int)sizeof(text))
+    {
+        snprintf(text + len, sizeof(text) - len, "\ntiles hit %d%%", tileCacheHitPercent(preview_tiles.stats));
+    }
+    lv_label_set_text(ui_profiler_hud, text);
+}
+
+static void ui_event_FpsLabelTap(lv_event_t *e)
+{
+    if (lv_event_get_code(e) != LV_EVENT_CLICKED || !ui_profiler_hud)
+    {
+        return;
+    }
+
+    if (lv_obj_has_flag(ui_profiler_hud, LV_OBJ_FLAG_HIDDEN))
+    {
+        lv_obj_clear_flag(ui_profiler_hud, LV_OBJ_FLAG_HIDDEN);
+        update_profiler_hud();
+    }
+    else
+    {
+        lv_obj_add_flag(ui_profiler_hud, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
 static void camera_video_play(lv_timer_t *t)
 {
     static uint32_t last_fps_tick = 0;
     static uint16_t frame_counter = 0;
 
-    camera_fb_t *frame = esp_camera_fb_get();
+    // Everything since the previous fetch (its render and flush included) is one frame
+    profileFrameBegin();
+
+    camera_fb_t *frame;
+    {
+        ProfileScope scope(PROFILE_FETCH);
+        frame = esp_camera_fb_get();
+    }
+    if (frame && !sensorQueueFrameFetched())
+    {
+        // Read out while the zoom window was rewritten; the canvas keeps the last frame
+        esp_camera_fb_return(frame);
+        return;
+    }
     if (frame)
     {
+        // Raw, as delivered, when a recording is running
+        ui_record_preview_frame(frame);
+
+        // This frame was read out with the current window; queued settings apply to the
+        // next one. Holding the only frame buffer keeps DMA idle while they are written.
+        int zoom_factor = ui_get_software_zoom_factor();
+        if (sensorQueuePending())
+        {
+            i2cBusLock();
+            sensorQueueApply(esp_camera_sensor_get());
+            i2cBusUnlock();
+        }
 
         apply_selected_filter(frame);
 
@@ -710,47 +1196,38 @@ static void camera_video_play(lv_timer_t *t)
         int target_width = 240;
         int target_height = 176;
 
-        if (current_zoom_level == 0)
+        profileStageBegin(PROFILE_ZOOM);
+        if (zoom_factor == 1)
         {
             size_t pixel_count = frame->len / 2;
-            copy_frame(dst_pixels, src_pixels, pixel_count);
-        }
-        else
-        {
-            int crop_width, crop_height;
-
-            if (current_zoom_level == 1)
+            if (preview_indexed)
             {
-                crop_width = target_width / 2;
-                crop_height = target_height / 2;
+                expandPaletteIndices(preview_indices, dst_pixels, pixel_count, preview_index_lut);
             }
             else
             {
-                crop_width = target_width / 4;
-                crop_height = target_height / 4;
+                copy_frame(dst_pixels, src_pixels, pixel_count);
             }
+        }
+        else
+        {
+            ZoomCrop crop = softwareZoomCrop(frame->width, frame->height, zoom_factor);
+            ResampleWindow window = {crop.x, crop.y, crop.width, crop.height};
 
-            int start_x = (frame->width - crop_width) / 2;
-            int start_y = (frame->height - crop_height) / 2;
-
-            for (int y = 0; y < target_height; y++)
+            // The preview is already filtered, so keep its pixels crisp
+            if (resamplerPrepare(zoom_resampler, frame->width, frame->height, window, target_width, target_height, RESAMPLE_NEAREST))
             {
-                for (int x = 0; x < target_width; x++)
+                if (preview_indexed)
                 {
-                    int src_x = start_x + (x * crop_width / target_width);
-                    int src_y = start_y + (y * crop_height / target_height);
-
-                    if (src_x >= frame->width)
-                        src_x = frame->width - 1;
-                    if (src_y >= frame->height)
-                        src_y = frame->height - 1;
-
-                    int src_idx = src_y * frame->width + src_x;
-                    int dst_idx = y * target_width + x;
-                    dst_pixels[dst_idx] = swap_rgb565_bytes(src_pixels[src_idx]);
+                    resampleIndexedFrame(zoom_resampler, preview_indices, dst_pixels, target_width, preview_index_lut);
+                }
+                else
+                {
+                    resampleFrame(zoom_resampler, src_pixels, dst_pixels, target_width, true);
                 }
             }
         }
+        profileStageEnd();
 
         lv_canvas_set_buffer(ui_camera_canvas, camera_canvas_buf, target_width, target_height, LV_IMG_CF_TRUE_COLOR);
 
@@ -765,9 +1242,18 @@ static void camera_video_play(lv_timer_t *t)
         {
             uint32_t elapsed = now - last_fps_tick;
             uint32_t fps = (frame_counter * 1000) / (elapsed ? elapsed : 1);
-            lv_label_set_text_fmt(ui_fps_label, "%lu FPS", static_cast<unsigned long>(fps));
+            if (preview_quality_level > 0)
+            {
+                // Preview is running below the selected quality to keep up
+                lv_label_set_text_fmt(ui_fps_label, "%lu FPS Q-%d", static_cast<unsigned long>(fps), preview_quality_level);
+            }
+            else
+            {
+                lv_label_set_text_fmt(ui_fps_label, "%lu FPS", static_cast<unsigned long>(fps));
+            }
             last_fps_tick = now;
             frame_counter = 0;
+            update_profiler_hud();
         }
 
         esp_camera_fb_return(frame);
@@ -828,16 +1314,6 @@ static void ui_event_CameraSettingsButton(lv_event_t *e)
                                     EYE_COLOR_INACTIVE, 0);
     }
 }
-static bool aec2_pending_value = false;
-
-static void set_aec2_callback(sensor_t *s)
-{
-    if (s)
-    {
-        s->set_aec2(s, aec2_pending_value ? 1 : 0);
-    }
-}
-
 static void ui_event_AEC2Switch(lv_event_t *e)
 {
     if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED)
@@ -856,7 +1332,7 @@ static void ui_event_AEC2Switch(lv_event_t *e)
     {
         ui_prefs.putBool(UI_PREF_AEC2_KEY, enabled);
     }
-    ESP.restart();
+    sensorQueuePost(SENSOR_CMD_AEC2, enabled ? 1 : 0);
 }
 
 static void ui_event_GainCtrlSwitch(lv_event_t *e)
@@ -878,25 +1354,34 @@ static void ui_event_GainCtrlSwitch(lv_event_t *e)
         else
             lv_obj_clear_state(ui_agc_gain_slider, LV_STATE_DISABLED);
     }
-    ESP.restart();
+    sensorQueuePost(SENSOR_CMD_GAIN_CTRL, enabled ? 1 : 0);
+    if (!enabled && ui_agc_gain_slider)
+    {
+        sensorQueuePost(SENSOR_CMD_AGC_GAIN, lv_slider_get_value(ui_agc_gain_slider));
+    }
 }
 
 static void ui_event_AgcGainSlider(lv_event_t *e)
 {
-    if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED)
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code != LV_EVENT_VALUE_CHANGED && code != LV_EVENT_RELEASED)
         return;
-    // Don't restart if AGC is enabled (slider is just for display)
+    // Manual gain only matters while AGC is off (slider is just for display otherwise)
     if (ui_prefs_ready && ui_prefs.getBool(UI_PREF_GAIN_CTRL_KEY, true))
         return;
     lv_obj_t *target = lv_event_get_target(e);
     if (!target)
         return;
     int value = lv_slider_get_value(target);
-    if (ui_prefs_ready)
+    if (code == LV_EVENT_VALUE_CHANGED)
+    {
+        // Live while dragging; the queue keeps only the latest value per frame
+        sensorQueuePost(SENSOR_CMD_AGC_GAIN, value);
+    }
+    else if (ui_prefs_ready)
     {
         ui_prefs.putInt(UI_PREF_AGC_GAIN_KEY, value);
     }
-    ESP.restart();
 }
 
 static void ui_event_ExposureCtrlSwitch(lv_event_t *e)
@@ -918,25 +1403,34 @@ static void ui_event_ExposureCtrlSwitch(lv_event_t *e)
         else
             lv_obj_clear_state(ui_aec_value_slider, LV_STATE_DISABLED);
     }
-    ESP.restart();
+    sensorQueuePost(SENSOR_CMD_EXPOSURE_CTRL, enabled ? 1 : 0);
+    if (!enabled && ui_aec_value_slider)
+    {
+        sensorQueuePost(SENSOR_CMD_AEC_VALUE, lv_slider_get_value(ui_aec_value_slider));
+    }
 }
 
 static void ui_event_AecValueSlider(lv_event_t *e)
 {
-    if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED)
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code != LV_EVENT_VALUE_CHANGED && code != LV_EVENT_RELEASED)
         return;
-    // Don't restart if AEC is enabled (slider is just for display)
+    // Manual exposure only matters while AEC is off (slider is just for display otherwise)
     if (ui_prefs_ready && ui_prefs.getBool(UI_PREF_EXPOSURE_CTRL_KEY, true))
         return;
     lv_obj_t *target = lv_event_get_target(e);
     if (!target)
         return;
     int value = lv_slider_get_value(target);
-    if (ui_prefs_ready)
+    if (code == LV_EVENT_VALUE_CHANGED)
+    {
+        // Live while dragging; the queue keeps only the latest value per frame
+        sensorQueuePost(SENSOR_CMD_AEC_VALUE, value);
+    }
+    else if (ui_prefs_ready)
     {
         ui_prefs.putInt(UI_PREF_AEC_VALUE_KEY, value);
     }
-    ESP.restart();
 }
 
 static bool gallery_long_press_triggered = false;
@@ -1099,6 +1593,7 @@ void ui_HomeScreen_screen_init(void)
     ui_HomeScreen = lv_obj_create(NULL);
     lv_obj_clear_flag(ui_HomeScreen, LV_OBJ_FLAG_SCROLLABLE); /// Flags
 
+    load_user_palettes();
     if (!ui_prefs_ready)
     {
         ui_prefs_ready = ui_prefs.begin(UI_PREF_NAMESPACE, false);
@@ -1106,13 +1601,40 @@ void ui_HomeScreen_screen_init(void)
         {
             int stored_filter = ui_prefs.getInt(UI_PREF_FILTER_KEY, current_filter);
             current_filter = (camera_filter_t)stored_filter;
-            current_palette_index = clamp_palette_index(ui_prefs.getInt(UI_PREF_PALETTE_KEY, current_palette_index));
+            current_palette_index = ui_prefs.getInt(UI_PREF_PALETTE_KEY, current_palette_index);
+            char palette_name[sizeof(user_palettes[0].name)];
+            if (ui_prefs.getString(UI_PREF_PALETTE_FILE_KEY, palette_name, sizeof(palette_name)) > 1)
+            {
+                current_palette_index = 0;
+                for (int i = 0; i < user_palette_count; i++)
+                {
+                    if (strcmp(user_palettes[i].name, palette_name) == 0)
+                    {
+                        current_palette_index = kPaletteOptionCount + i;
+                    }
+                }
+            }
+            else if (current_palette_index >= kPaletteOptionCount)
+            {
+                current_palette_index = 0;
+            }
+            current_palette_index = clamp_palette_index(current_palette_index);
             current_dithering = clamp_dither_type(ui_prefs.getInt(UI_PREF_DITHER_KEY, current_dithering));
+            current_palette_matching = ui_prefs.getInt(UI_PREF_PALETTE_MATCH_KEY, PALETTE_MATCH_RGB) == PALETTE_MATCH_OKLAB
+                                           ? PALETTE_MATCH_OKLAB
+                                           : PALETTE_MATCH_RGB;
             current_pixel_size = clamp_pixel_size(ui_prefs.getInt(UI_PREF_PIXEL_SIZE_KEY, current_pixel_size));
             camera_led_open_flag = ui_prefs.getBool(UI_PREF_FLASH_KEY, camera_led_open_flag);
             current_zoom_level = ui_prefs.getInt(UI_PREF_ZOOM_LEVEL_KEY, 0); // Default to 1x zoom
+
+            char grade_path[sizeof(color_grade_path)];
+            if (ui_prefs.getString(UI_PREF_COLOR_GRADE_KEY, grade_path, sizeof(grade_path)) > 1)
+            {
+                load_color_grade(grade_path);
+            }
         }
     }
+    prepare_palette();
 
     // Status bar row (SD card + battery)
     lv_obj_t *ui_status_row = lv_obj_create(ui_HomeScreen);
@@ -1154,6 +1676,20 @@ void ui_HomeScreen_screen_init(void)
     lv_obj_set_style_pad_all(ui_fps_label, 4, 0);
     lv_obj_set_style_radius(ui_fps_label, 4, 0);
     lv_obj_align(ui_fps_label, LV_ALIGN_BOTTOM_LEFT, 6, -4);
+    lv_obj_add_flag(ui_fps_label, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(ui_fps_label, ui_event_FpsLabelTap, LV_EVENT_CLICKED, NULL);
+
+    // Per-stage frame timings, toggled by tapping the FPS counter
+    ui_profiler_hud = lv_label_create(ui_camera_canvas);
+    lv_label_set_text(ui_profiler_hud, "");
+    lv_obj_set_style_bg_color(ui_profiler_hud, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(ui_profiler_hud, LV_OPA_50, 0);
+    lv_obj_set_style_text_color(ui_profiler_hud, lv_color_white(), 0);
+    lv_obj_set_style_text_font(ui_profiler_hud, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_pad_all(ui_profiler_hud, 4, 0);
+    lv_obj_set_style_radius(ui_profiler_hud, 4, 0);
+    lv_obj_align(ui_profiler_hud, LV_ALIGN_TOP_LEFT, 6, 4);
+    lv_obj_add_flag(ui_profiler_hud, LV_OBJ_FLAG_HIDDEN);
 
     // Zoom level indicator
     ui_zoom_label = lv_label_create(ui_camera_canvas);
@@ -1176,8 +1712,11 @@ void ui_HomeScreen_screen_init(void)
         lv_label_set_text(ui_zoom_label, zoom_text);
     }
 
+    governorInit(preview_governor, PREVIEW_PROCESS_BUDGET_US, PREVIEW_GOVERNOR_HOLD_FRAMES);
+    preview_quality_level = 0;
     camera_timer = lv_timer_create(camera_video_play, 50, NULL);
     lv_timer_ready(camera_timer);
+    apply_sensor_zoom();
 
     lv_obj_t *ui_bottom_panel = lv_obj_create(ui_HomeScreen);
     lv_obj_set_size(ui_bottom_panel, 222, 480 - 176 - 14);
@@ -1231,7 +1770,7 @@ void ui_HomeScreen_screen_init(void)
 
     lv_dropdown_set_options_static(
         ui_FilterDropdown,
-        "No filter\nPixelate\nDithering\nEdge detect\nCRT");
+        "No filter\nPixelate\nDithering\nEdge detect\nCRT\nBlur\nSharpen\nEmboss\nUnsharp mask");
     lv_dropdown_set_selected(ui_FilterDropdown, current_filter);
 
     /* Palette dropdown */
@@ -1242,26 +1781,7 @@ void ui_HomeScreen_screen_init(void)
     lv_obj_add_event_cb(ui_PaletteDropdown, ui_event_PaletteDropdown, LV_EVENT_ALL, NULL);
     lv_obj_set_style_pad_ver(ui_PaletteDropdown, 10, LV_PART_MAIN);
 
-    lv_dropdown_set_options_static(
-        ui_PaletteDropdown,
-        "Sunset\n"
-        "Yellow/Brown\n"
-        "Grayscale\n"
-        "Game Boy\n"
-        "Cyberpunk\n"
-        "Autumn\n"
-        "Ocean\n"
-        "Desert\n"
-        "Sakura\n"
-        "Mint\n"
-        "Fire\n"
-        "Arctic\n"
-        "Sepia\n"
-        "Neon\n"
-        "Black & White\n"
-        "CGA 4-color\n"
-        "VGA 16-color\n"
-        "Fresta");
+    set_palette_dropdown_options(ui_PaletteDropdown);
     lv_dropdown_set_selected(ui_PaletteDropdown, current_palette_index);
 
     /* Dithering dropdown */
@@ -1275,7 +1795,12 @@ void ui_HomeScreen_screen_init(void)
         ui_DitherDropdown,
         "Off\n"
         "Floyd-Steinberg\n"
-        "Bayer");
+        "Bayer\n"
+        "Blue noise\n"
+        "Atkinson\n"
+        "Sierra Lite\n"
+        "Stucki\n"
+        "Jarvis-Judice-Ninke");
     lv_dropdown_set_selected(ui_DitherDropdown, current_dithering);
 
     /* Pixel size dropdown */
@@ -1527,6 +2052,7 @@ void ui_HomeScreen_screen_destroy(void)
     ui_Image1 = NULL;
     ui_status_sd_label = NULL;
     ui_status_batt_label = NULL;
+    ui_profiler_hud = NULL;
 }
 
 lv_obj_t *ui_get_gallery_button(void)
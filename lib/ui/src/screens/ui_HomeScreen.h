@@ -18,6 +18,9 @@ extern lv_obj_t *ui_Image1;
 void ui_set_filter_mode(int mode);
 void ui_set_palette_index(int idx);
 void ui_get_palette(const uint32_t **palette, int *size);
+int ui_get_palette_matching(void); // PALETTE_MATCH_* for applyColorPalette
+bool ui_get_perceptual_palette_enabled(void);
+void ui_set_perceptual_palette_enabled(bool enabled);
 void ui_set_flash_enabled(bool enabled);
 bool ui_is_flash_enabled(void);
 lv_obj_t *ui_get_gallery_button(void);
@@ -25,6 +28,7 @@ int ui_get_filter_mode(void);
 int ui_get_dither_type(void);
 int ui_get_pixel_size(void);
 void ui_show_photo_overlay(const char *text);
+void ui_log_preview_stats(void);
 
 void ui_pause_camera_timer(void);
 void ui_resume_camera_timer(void);
@@ -40,8 +44,14 @@ bool ui_get_auto_adjust_enabled(void);
 void ui_set_auto_adjust_enabled(bool enabled);
 int ui_get_zoom_level(void);
 void ui_set_zoom_level(int level);
+int ui_get_software_zoom_factor(void);
 bool ui_get_screenshot_mode_enabled(void);
 void ui_set_screenshot_mode_enabled(bool enabled);
+bool ui_get_still_mode_enabled(void);
+void ui_set_still_mode_enabled(bool enabled);
+bool ui_set_color_grade(const char *path); // .cube on SD, NULL or "" for none; false if it failed to load
+const uint16_t *ui_get_color_grade(void);  // Grading table for applyColorGrade, NULL when off
+const char *ui_get_color_grade_path(void);
 
 #ifdef __cplusplus
 } /*extern "C"*/
@@ -3,18 +3,28 @@
 #include "../ui.h"
 #include "lvgl.h"
 #include "../../../include/utilities.h"
+#include <FS.h>
+#include <SD.h>
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 static lv_obj_t *ui_settings_screen = NULL;
 static lv_obj_t *ui_settings_flash_switch = NULL;
 static lv_obj_t *ui_settings_storage_switch = NULL;
 static lv_obj_t *ui_settings_auto_adjust_switch = NULL;
 static lv_obj_t *ui_settings_screenshot_switch = NULL;
+static lv_obj_t *ui_settings_still_mode_switch = NULL;
+static lv_obj_t *ui_settings_perceptual_switch = NULL;
+static lv_obj_t *ui_settings_grade_dropdown = NULL;
+static std::vector<String> ui_settings_grade_paths; // Dropdown entry i + 1
 static lv_obj_t *ui_settings_back_btn = NULL;
 
+static const char *COLOR_GRADE_DIR = "/luts";
+
 // Forward declaration
 extern void ui_event_FlashSwitch(lv_event_t *e);
+extern bool gallery_ensure_sd_initialized();
 extern bool camera_led_open_flag;
 
 static void ui_settings_auto_adjust_event(lv_event_t *e)
@@ -51,6 +61,104 @@ static void ui_settings_screenshot_event(lv_event_t *e)
     ui_set_screenshot_mode_enabled(enabled);
 }
 
+static void ui_settings_still_mode_event(lv_event_t *e)
+{
+    if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED)
+    {
+        return;
+    }
+
+    lv_obj_t *target = lv_event_get_target(e);
+    if (!target)
+    {
+        return;
+    }
+
+    bool enabled = lv_obj_has_state(target, LV_STATE_CHECKED);
+    ui_set_still_mode_enabled(enabled);
+}
+
+static void ui_settings_perceptual_event(lv_event_t *e)
+{
+    if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED)
+    {
+        return;
+    }
+
+    lv_obj_t *target = lv_event_get_target(e);
+    if (!target)
+    {
+        return;
+    }
+
+    bool enabled = lv_obj_has_state(target, LV_STATE_CHECKED);
+    ui_set_perceptual_palette_enabled(enabled);
+}
+
+static bool is_cube_file(const char *name)
+{
+    size_t len = strlen(name);
+    return len > 5 && strcasecmp(name + len - 5, ".cube") == 0 && name[0] != '.';
+}
+
+// List the .cube files in COLOR_GRADE_DIR as dropdown options after "None"
+static void refresh_color_grade_options()
+{
+    if (!ui_settings_grade_dropdown)
+    {
+        return;
+    }
+
+    ui_settings_grade_paths.clear();
+    String options = "None";
+    int selected = 0;
+    const char *current = ui_get_color_grade_path();
+    if (gallery_ensure_sd_initialized())
+    {
+        File dir = SD.open(COLOR_GRADE_DIR);
+        if (dir && dir.isDirectory())
+        {
+            File entry;
+            while ((entry = dir.openNextFile()))
+            {
+                if (!entry.isDirectory() && is_cube_file(entry.name()))
+                {
+                    String path = String(COLOR_GRADE_DIR) + "/" + entry.name();
+                    ui_settings_grade_paths.push_back(path);
+                    options += "\n";
+                    options += entry.name();
+                    if (strcmp(path.c_str(), current) == 0)
+                    {
+                        selected = ui_settings_grade_paths.size();
+                    }
+                }
+                entry.close();
+            }
+        }
+    }
+
+    lv_dropdown_set_options(ui_settings_grade_dropdown, options.c_str());
+    lv_dropdown_set_selected(ui_settings_grade_dropdown, selected);
+}
+
+static void ui_settings_grade_event(lv_event_t *e)
+{
+    if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED)
+    {
+        return;
+    }
+
+    int selected = lv_dropdown_get_selected(ui_settings_grade_dropdown);
+    const char *path = (selected > 0 && selected <= (int)ui_settings_grade_paths.size())
+                           ? ui_settings_grade_paths[selected - 1].c_str()
+                           : NULL;
+    if (!ui_set_color_grade(path))
+    {
+        // Not a usable .cube; the grade is off now
+        lv_dropdown_set_selected(ui_settings_grade_dropdown, 0);
+    }
+}
+
 static void ui_settings_back_event(lv_event_t *e)
 {
     if (lv_event_get_code(e) != LV_EVENT_CLICKED)
@@ -190,6 +298,72 @@ static void build_settings_screen()
     }
     lv_obj_add_event_cb(ui_settings_screenshot_switch, ui_settings_screenshot_event, LV_EVENT_ALL, NULL);
 
+    // high-resolution still toggle
+    lv_obj_t *still_mode_row = lv_obj_create(ui_settings_screen);
+    lv_obj_set_width(still_mode_row, LV_PCT(100));
+    lv_obj_set_height(still_mode_row, LV_SIZE_CONTENT);
+    lv_obj_clear_flag(still_mode_row, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_opa(still_mode_row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(still_mode_row, 0, 0);
+    lv_obj_set_style_pad_all(still_mode_row, 0, 0);
+    lv_obj_set_style_pad_row(still_mode_row, 8, 0);
+    lv_obj_set_style_pad_column(still_mode_row, 8, 0);
+    lv_obj_set_flex_flow(still_mode_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(still_mode_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t *still_mode_label = lv_label_create(still_mode_row);
+    lv_label_set_text(still_mode_label, "Hi-res stills");
+
+    ui_settings_still_mode_switch = lv_switch_create(still_mode_row);
+    if (ui_get_still_mode_enabled())
+    {
+        lv_obj_add_state(ui_settings_still_mode_switch, LV_STATE_CHECKED);
+    }
+    lv_obj_add_event_cb(ui_settings_still_mode_switch, ui_settings_still_mode_event, LV_EVENT_ALL, NULL);
+
+    // perceptual (Oklab) palette matching toggle
+    lv_obj_t *perceptual_row = lv_obj_create(ui_settings_screen);
+    lv_obj_set_width(perceptual_row, LV_PCT(100));
+    lv_obj_set_height(perceptual_row, LV_SIZE_CONTENT);
+    lv_obj_clear_flag(perceptual_row, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_opa(perceptual_row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(perceptual_row, 0, 0);
+    lv_obj_set_style_pad_all(perceptual_row, 0, 0);
+    lv_obj_set_style_pad_row(perceptual_row, 8, 0);
+    lv_obj_set_style_pad_column(perceptual_row, 8, 0);
+    lv_obj_set_flex_flow(perceptual_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(perceptual_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t *perceptual_label = lv_label_create(perceptual_row);
+    lv_label_set_text(perceptual_label, "Perceptual colors");
+
+    ui_settings_perceptual_switch = lv_switch_create(perceptual_row);
+    if (ui_get_perceptual_palette_enabled())
+    {
+        lv_obj_add_state(ui_settings_perceptual_switch, LV_STATE_CHECKED);
+    }
+    lv_obj_add_event_cb(ui_settings_perceptual_switch, ui_settings_perceptual_event, LV_EVENT_ALL, NULL);
+
+    // color grade (.cube files on SD)
+    lv_obj_t *grade_row = lv_obj_create(ui_settings_screen);
+    lv_obj_set_width(grade_row, LV_PCT(100));
+    lv_obj_set_height(grade_row, LV_SIZE_CONTENT);
+    lv_obj_clear_flag(grade_row, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_opa(grade_row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(grade_row, 0, 0);
+    lv_obj_set_style_pad_all(grade_row, 0, 0);
+    lv_obj_set_style_pad_row(grade_row, 8, 0);
+    lv_obj_set_style_pad_column(grade_row, 8, 0);
+    lv_obj_set_flex_flow(grade_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(grade_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t *grade_label = lv_label_create(grade_row);
+    lv_label_set_text(grade_label, "Color grade");
+
+    ui_settings_grade_dropdown = lv_dropdown_create(grade_row);
+    lv_obj_set_width(ui_settings_grade_dropdown, 100);
+    lv_obj_add_event_cb(ui_settings_grade_dropdown, ui_settings_grade_event, LV_EVENT_ALL, NULL);
+
     // Add flexible spacer to push version label to bottom
     lv_obj_t *spacer = lv_obj_create(ui_settings_screen);
     lv_obj_set_size(spacer, LV_PCT(100), LV_SIZE_CONTENT);
@@ -242,6 +416,7 @@ lv_obj_t *ui_get_settings_screen(void)
 void ui_settings_show(void)
 {
     build_settings_screen();
+    refresh_color_grade_options();
     show_version_label();
     ui_pause_camera_timer();
     lv_scr_load_anim(ui_settings_screen, LV_SCR_LOAD_ANIM_MOVE_LEFT, 200, 0, false);
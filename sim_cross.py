@@ -0,0 +1,13 @@
+Import("env")
+
+# Build the host simulator with a cross toolchain (custom_cross_prefix in platformio.ini),
+# e.g. aarch64-linux-gnu- so the NEON pixel kernels get compiled and checked on an x86 host
+prefix = env.GetProjectOption("custom_cross_prefix", "")
+if prefix:
+    env.Replace(
+        CC=prefix + "gcc",
+        CXX=prefix + "g++",
+        AR=prefix + "ar",
+        RANLIB=prefix + "ranlib",
+        LINK=prefix + "g++",
+    )
@@ -4,12 +4,16 @@
 #include <lvgl.h>
 #include <TFT_eSPI.h>
 #include <ui.h>
+#include "i2c_bus.h"
+#include "button_events.h"
+#include "profiler.h"
 #include "touch.h"
 #include "utilities.h"
 #include "esp_camera.h"
 #include "esp_heap_caps.h"
 #include <FS.h>
 #include <SD.h>
+#include <ff.h>
 #include <cstring>
 #include <vector>
 #include <string>
@@ -30,6 +34,13 @@ extern "C"
 #include <extra/others/snapshot/lv_snapshot.h>
 }
 #include "filter.h"
+#include "color_grade.h"
+#include "palette_file.h"
+#include "parallel.h"
+#include "resample.h"
+#include "camera_zoom.h"
+#include "frame_sequence.h"
+#include "sensor_queue.h"
 #include "palettes.h"
 
 extern "C" void *lodepng_malloc(size_t size)
@@ -68,13 +79,38 @@ PowersSY6970 PMU;
 camera_config_t config;
 
 static const int user_button_pins[BOARD_USER_BTN_NUM] = BOARD_USER_BUTTON;
-static bool user_button_last_pressed[BOARD_USER_BTN_NUM] = {false};
+static constexpr uint32_t USER_BUTTON_DEBOUNCE_US = 20000;
+
+// Shutter press to captured frame, over every photo since boot
+struct ShutterLatency
+{
+    uint32_t count;
+    uint64_t total_us;
+    uint32_t max_us;
+};
+static ShutterLatency shutter_latency = {};
 static bool led_flash_active = false;
 static uint32_t led_flash_until = 0;
 static constexpr uint8_t LED_FLASH_DUTY = 255;
 static constexpr uint32_t LED_FLASH_DURATION_MS = 200;
 static bool sd_initialized = false;
 static bool pmu_ready = false;
+
+// PMU readings served to the status bar; refreshed on the I2C bus task once stale
+struct PmuCache
+{
+    uint16_t batt_mv;
+    bool charging;
+    bool usb;
+    bool batt_valid;
+    bool status_valid;
+    uint32_t batt_ms; // When each group was last read
+    uint32_t status_ms;
+    volatile bool refresh_queued;
+};
+static PmuCache pmu_cache = {};
+static constexpr uint32_t PMU_BATT_TTL_MS = 10000;  // Voltage moves slowly and each read starts an ADC conversion
+static constexpr uint32_t PMU_STATUS_TTL_MS = 2000; // Charger and USB state change on plug events
 static Preferences photo_prefs;
 static const char *PHOTO_PREF_NAMESPACE = "gallery";
 static const char *PHOTO_PREF_KEY = "last_photo";
@@ -83,7 +119,36 @@ static PNGENC png_encoder;
 static File png_file_handle;
 static bool sd_fs_registered = false;
 
+// SD free space for the status bar. Counting free clusters walks the whole FAT (hundreds
+// of ms on large cards), so it only runs in a background scan after mounting and, rate
+// limited, once enough changes piled up; in between, our own saves and deletes adjust
+// the count. The scan task and the loop task both update it, under sd_space_lock.
+struct SdSpace
+{
+    uint64_t total_bytes;
+    int64_t free_bytes;
+    uint32_t cluster_bytes;    // Allocation unit of the mounted volume, read by the scan
+    bool valid;
+    bool scanning;
+    bool changed_during_scan;  // The scan result may miss a change, so it scans again
+    uint32_t changes_since_scan;
+    uint32_t last_scan_ms;
+};
+static SdSpace sd_space = {};
+static portMUX_TYPE sd_space_lock = portMUX_INITIALIZER_UNLOCKED;
+static const char *const SD_FATFS_DRIVE = "0:";                 // FatFs drive of the card (the only FAT volume)
+static constexpr uint32_t SD_DEFAULT_CLUSTER_BYTES = 32 * 1024; // Until a scan reads it: SDA unit for FAT32 cards
+static constexpr uint32_t SD_RESCAN_MIN_MS = 5 * 60 * 1000;     // Rescans are at most this frequent
+static constexpr uint32_t SD_RESCAN_CHANGES = 50;               // Changes tracked before a rescan is worth it
+static const framesize_t PREVIEW_FRAME_SIZE = FRAMESIZE_HQVGA; // 240x176 for best FPS
+static const framesize_t STILL_FRAME_SIZE = FRAMESIZE_VGA;     // Frame buffers are sized for this
+static const int STILL_BAND_ROWS = 32;                         // Rows per processing band of a still
+static const int CAPTURE_PIXELATE_BLOCK = 8;
+static const int CAPTURE_BAYER_SIZE = 2;
+static const uint32_t FRAME_RECORDING_DEFAULT_FRAMES = 100;    // "rec" without a count
+
 static bool ensure_sd_initialized();
+static void sd_space_request_scan(bool force);
 static void register_sd_fs_driver();
 static void *sd_fs_open_cb(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode);
 static lv_fs_res_t sd_fs_close_cb(lv_fs_drv_t *drv, void *file_p);
@@ -163,6 +228,7 @@ static bool ensure_sd_initialized()
 
     sd_initialized = true;
     register_sd_fs_driver();
+    sd_space_request_scan(true);
     return true;
 }
 
@@ -172,6 +238,338 @@ bool gallery_ensure_sd_initialized()
     return ensure_sd_initialized();
 }
 
+// Free clusters and cluster size straight from FatFs; SD.usedBytes() would do the same
+// walk but hides the cluster size
+static bool sd_space_count(uint64_t &total, uint64_t &free_bytes, uint32_t &cluster)
+{
+    FATFS *fs = nullptr;
+    DWORD free_clusters = 0;
+    if (f_getfree(SD_FATFS_DRIVE, &free_clusters, &fs) != FR_OK || !fs)
+    {
+        return false;
+    }
+
+#if FF_MAX_SS != FF_MIN_SS
+    cluster = (uint32_t)fs->csize * fs->ssize;
+#else
+    cluster = (uint32_t)fs->csize * FF_MAX_SS;
+#endif
+    total = (uint64_t)(fs->n_fatent - 2) * cluster;
+    free_bytes = (uint64_t)free_clusters * cluster;
+    return true;
+}
+
+static void sd_space_scan_task(void *param)
+{
+    LV_UNUSED(param);
+
+    // Saves and deletes during a pass may or may not be in its count, so a pass that saw
+    // any is repeated until one ran undisturbed
+    bool again = true;
+    while (again)
+    {
+        uint32_t start = millis();
+        uint64_t total = 0;
+        uint64_t free_bytes = 0;
+        uint32_t cluster = SD_DEFAULT_CLUSTER_BYTES;
+        bool counted = sd_space_count(total, free_bytes, cluster);
+        if (!counted)
+        {
+            total = SD.totalBytes();
+            uint64_t used = SD.usedBytes();
+            free_bytes = total > used ? total - used : 0;
+        }
+        uint32_t now = millis();
+
+        portENTER_CRITICAL(&sd_space_lock);
+        again = sd_space.changed_during_scan;
+        sd_space.changed_during_scan = false;
+        sd_space.total_bytes = total;
+        sd_space.free_bytes = (int64_t)free_bytes;
+        sd_space.cluster_bytes = counted ? cluster : sd_space.cluster_bytes;
+        sd_space.valid = true;
+        sd_space.last_scan_ms = now;
+        sd_space.scanning = again;
+        portEXIT_CRITICAL(&sd_space_lock);
+
+        Serial.printf("[sd] free space scan: %lluMB free, %luKB clusters, %lums%s\n",
+                      (unsigned long long)(free_bytes / (1024 * 1024)), (unsigned long)(cluster / 1024),
+                      (unsigned long)(now - start), again ? ", changed meanwhile, rescanning" : "");
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * Start a background free space scan
+ *
+ * @param force Scan even if the last one was less than SD_RESCAN_MIN_MS ago
+ */
+static void sd_space_request_scan(bool force)
+{
+    portENTER_CRITICAL(&sd_space_lock);
+    bool start = !sd_space.scanning &&
+                 (force || !sd_space.valid || millis() - sd_space.last_scan_ms >= SD_RESCAN_MIN_MS);
+    if (start)
+    {
+        sd_space.scanning = true;
+        sd_space.changed_during_scan = false;
+        sd_space.changes_since_scan = 0;
+    }
+    portEXIT_CRITICAL(&sd_space_lock);
+    if (!start)
+    {
+        return;
+    }
+
+    // FatFs locks the volume and the SPI driver the bus, so this may overlap saves and redraws
+    if (xTaskCreatePinnedToCore(sd_space_scan_task, "sd_space", 4096, nullptr, 1, nullptr, 0) != pdPASS)
+    {
+        portENTER_CRITICAL(&sd_space_lock);
+        sd_space.scanning = false;
+        portEXIT_CRITICAL(&sd_space_lock);
+    }
+}
+
+// Account for a file of the given size appearing (bytes > 0) or going away (bytes < 0)
+static void sd_space_note_change(int64_t bytes)
+{
+    portENTER_CRITICAL(&sd_space_lock);
+    // Files take whole clusters
+    int64_t cluster = sd_space.cluster_bytes ? sd_space.cluster_bytes : SD_DEFAULT_CLUSTER_BYTES;
+    int64_t clusters = ((bytes < 0 ? -bytes : bytes) + cluster - 1) / cluster;
+    int64_t allocated = clusters * cluster;
+    sd_space.free_bytes += bytes < 0 ? allocated : -allocated;
+    if (sd_space.free_bytes < 0)
+    {
+        sd_space.free_bytes = 0;
+    }
+
+    bool rescan = false;
+    if (sd_space.scanning)
+    {
+        sd_space.changed_during_scan = true;
+    }
+    else
+    {
+        rescan = ++sd_space.changes_since_scan >= SD_RESCAN_CHANGES;
+    }
+    portEXIT_CRITICAL(&sd_space_lock);
+
+    if (rescan)
+    {
+        sd_space_request_scan(false);
+    }
+}
+
+// Exported for gallery screen module - delete a file, keeping the free space count
+bool sd_remove_file(const char *path)
+{
+    size_t size = 0;
+    File file = SD.open(path, FILE_READ);
+    if (file)
+    {
+        size = file.size();
+        file.close();
+    }
+
+    if (!SD.remove(path))
+    {
+        return false;
+    }
+    sd_space_note_change(-(int64_t)size);
+    return true;
+}
+
+// Compiled grade kept next to its .cube: /luts/warm.cube -> /luts/warm.g565
+static String color_grade_cache_path(const String &cube_path)
+{
+    int dot = cube_path.lastIndexOf('.');
+    return (dot > 0 ? cube_path.substring(0, dot) : cube_path) + ".g565";
+}
+
+static bool color_grade_read_cache(const String &cache_path, const ColorGradeCacheHeader &expected, uint16_t *table)
+{
+    File file = SD.open(cache_path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    ColorGradeCacheHeader header;
+    const size_t table_bytes = COLOR_GRADE_TABLE_ENTRIES * sizeof(uint16_t);
+    bool ok = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header) &&
+              header.magic == expected.magic && header.version == expected.version &&
+              header.sourceBytes == expected.sourceBytes && header.sourceTime == expected.sourceTime &&
+              file.read(reinterpret_cast<uint8_t *>(table), table_bytes) == table_bytes;
+    file.close();
+    return ok;
+}
+
+static void color_grade_write_cache(const String &cache_path, const ColorGradeCacheHeader &header, const uint16_t *table)
+{
+    if (SD.exists(cache_path))
+    {
+        sd_remove_file(cache_path.c_str());
+    }
+
+    File file = SD.open(cache_path, FILE_WRITE);
+    if (!file)
+    {
+        return;
+    }
+    const size_t table_bytes = COLOR_GRADE_TABLE_ENTRIES * sizeof(uint16_t);
+    bool ok = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) == sizeof(header) &&
+              file.write(reinterpret_cast<const uint8_t *>(table), table_bytes) == table_bytes;
+    file.close();
+    if (ok)
+    {
+        sd_space_note_change(sizeof(header) + table_bytes);
+    }
+    else
+    {
+        // A short cache would only be rejected on every load
+        SD.remove(cache_path);
+    }
+}
+
+/**
+ * Feed a text file to a line parser through a small stack buffer
+ *
+ * Longer lines are cut short; in the formats read this way they are comments or titles.
+ *
+ * @param parse_line Called with each line (no terminator); false stops the read
+ * @return false if parse_line did
+ */
+template <typename LineParser>
+static bool sd_read_lines(File &file, LineParser parse_line)
+{
+    uint8_t chunk[512];
+    char line[128];
+    size_t line_len = 0;
+    size_t n;
+    while ((n = file.read(chunk, sizeof(chunk))) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            char c = static_cast<char>(chunk[i]);
+            if (c == '\n' || c == '\r')
+            {
+                line[line_len] = '\0';
+                line_len = 0;
+                if (!parse_line(line))
+                {
+                    return false;
+                }
+            }
+            else if (line_len < sizeof(line) - 1)
+            {
+                line[line_len++] = c;
+            }
+        }
+    }
+    line[line_len] = '\0';
+    return line_len == 0 || parse_line(line);
+}
+
+// Exported for the UI - compile the .cube at path into table, from the SD cache if current
+bool color_grade_load(const char *path, uint16_t *table)
+{
+    if (!ensure_sd_initialized())
+    {
+        return false;
+    }
+
+    uint32_t start = millis();
+    File cube_file = SD.open(path, FILE_READ);
+    if (!cube_file)
+    {
+        Serial.printf("[grade] %s not found\n", path);
+        return false;
+    }
+
+    ColorGradeCacheHeader header = {};
+    header.magic = COLOR_GRADE_CACHE_MAGIC;
+    header.version = COLOR_GRADE_CACHE_VERSION;
+    header.sourceBytes = static_cast<uint32_t>(cube_file.size());
+    header.sourceTime = static_cast<uint32_t>(cube_file.getLastWrite());
+
+    String cache_path = color_grade_cache_path(path);
+    if (color_grade_read_cache(cache_path, header, table))
+    {
+        cube_file.close();
+        Serial.printf("[grade] %s: cached table, %lums\n", path, (unsigned long)(millis() - start));
+        return true;
+    }
+
+    CubeLut cube;
+    cubeLutBegin(cube);
+    bool ok = sd_read_lines(cube_file, [&cube](const char *line) { return cubeLutParseLine(cube, line); }) &&
+              cubeLutFinish(cube);
+    cube_file.close();
+    uint32_t parsed = millis();
+    if (ok)
+    {
+        ok = colorGradeCompile(cube, table);
+    }
+    if (!ok)
+    {
+        Serial.printf("[grade] %s: line %d: %s\n", path, cube.line, cube.error ? cube.error : "compile failed");
+        cubeLutRelease(cube);
+        return false;
+    }
+
+    header.cubeSize = static_cast<uint16_t>(cube.size);
+    cubeLutRelease(cube);
+    uint32_t compiled = millis();
+    color_grade_write_cache(cache_path, header, table);
+    Serial.printf("[grade] %s: %d^3 cube, parse=%lums compile=%lums cache=%lums\n", path, header.cubeSize,
+                  (unsigned long)(parsed - start), (unsigned long)(compiled - parsed), (unsigned long)(millis() - compiled));
+    return true;
+}
+
+/**
+ * Exported for the UI - read a Lospec .hex or GIMP .gpl palette from SD
+ *
+ * @param colors PALETTE_INDEX_MAX entries to fill with 0xRRGGBB colors
+ * @return Colors read, 0 if the file is missing or invalid
+ */
+int palette_file_load(const char *path, uint32_t *colors)
+{
+    File file = SD.open(path, FILE_READ);
+    if (!file)
+    {
+        return 0;
+    }
+
+    // 1 KB of colors; keep it off the loop task's stack
+    PaletteFile *palette = (PaletteFile *)malloc(sizeof(PaletteFile));
+    if (!palette)
+    {
+        file.close();
+        return 0;
+    }
+
+    size_t len = strlen(path);
+    paletteFileBegin(*palette, len > 4 && strcasecmp(path + len - 4, ".gpl") == 0);
+    bool ok = sd_read_lines(file, [palette](const char *line) { return paletteFileParseLine(*palette, line); }) &&
+              paletteFileFinish(*palette);
+    file.close();
+
+    int size = 0;
+    if (ok)
+    {
+        size = palette->size;
+        memcpy(colors, palette->colors, size * sizeof(uint32_t));
+        Serial.printf("[palette] %s: %d colors\n", path, size);
+    }
+    else
+    {
+        Serial.printf("[palette] %s: line %d: %s\n", path, palette->line, palette->error);
+    }
+    free(palette);
+    return size;
+}
+
 // Exported for UI status bar - get SD card free space in MB
 uint32_t ui_get_sd_free_mb()
 {
@@ -179,44 +577,78 @@ uint32_t ui_get_sd_free_mb()
     {
         return 0;
     }
-    uint64_t total = SD.totalBytes();
-    uint64_t used = SD.usedBytes();
-    uint64_t free = (total > used) ? (total - used) : 0;
-    return static_cast<uint32_t>(free / (1024 * 1024));
+
+    portENTER_CRITICAL(&sd_space_lock);
+    int64_t free_bytes = sd_space.valid ? sd_space.free_bytes : 0;
+    portEXIT_CRITICAL(&sd_space_lock);
+    return static_cast<uint32_t>(free_bytes / (1024 * 1024));
 }
 
-// Exported for UI status bar - get battery voltage in mV
-uint16_t ui_get_battery_voltage()
+// Runs on the I2C bus task: re-read whichever PMU readings have expired
+static void pmu_refresh_job(void *ctx)
 {
-    if (!ensure_pmu_ready())
+    LV_UNUSED(ctx);
+
+    if (ensure_pmu_ready())
     {
-        return 0;
+        uint32_t now = millis();
+        if (!pmu_cache.batt_valid || now - pmu_cache.batt_ms >= PMU_BATT_TTL_MS)
+        {
+            PMU.enableMeasure();
+            pmu_cache.batt_mv = PMU.getBattVoltage();
+            pmu_cache.batt_ms = now;
+            pmu_cache.batt_valid = true;
+        }
+        if (!pmu_cache.status_valid || now - pmu_cache.status_ms >= PMU_STATUS_TTL_MS)
+        {
+            auto status = PMU.chargeStatus();
+            auto bus = PMU.getBusStatus();
+            pmu_cache.charging = (status == PowersSY6970::CHARGE_STATE_PRE_CHARGE ||
+                                  status == PowersSY6970::CHARGE_STATE_FAST_CHARGE);
+            pmu_cache.usb = (bus != PowersSY6970::BUS_STATE_NOINPUT && bus != PowersSY6970::BUS_STATE_OTG);
+            pmu_cache.status_ms = now;
+            pmu_cache.status_valid = true;
+        }
     }
-    PMU.enableMeasure();
-    return PMU.getBattVoltage();
+    pmu_cache.refresh_queued = false;
+}
+
+// Never waits on the bus: a stale cache is served while a refresh is queued
+static void pmu_refresh_if_stale()
+{
+    uint32_t now = millis();
+    bool stale = !pmu_cache.batt_valid || !pmu_cache.status_valid ||
+                 now - pmu_cache.batt_ms >= PMU_BATT_TTL_MS ||
+                 now - pmu_cache.status_ms >= PMU_STATUS_TTL_MS;
+    if (stale && !pmu_cache.refresh_queued)
+    {
+        pmu_cache.refresh_queued = true;
+        if (!i2cBusSubmit(pmu_refresh_job, nullptr, I2C_PRIORITY_LOW))
+        {
+            pmu_cache.refresh_queued = false;
+        }
+    }
+}
+
+// Exported for UI status bar - get battery voltage in mV
+uint16_t ui_get_battery_voltage()
+{
+    pmu_refresh_if_stale();
+    return pmu_cache.batt_valid ? pmu_cache.batt_mv : 0;
 }
 
 // Exported for UI status bar - check if charging
 bool ui_is_charging()
 {
-    if (!ensure_pmu_ready())
-    {
-        return false;
-    }
-    auto status = PMU.chargeStatus();
-    return (status == PowersSY6970::CHARGE_STATE_PRE_CHARGE ||
-            status == PowersSY6970::CHARGE_STATE_FAST_CHARGE);
+    pmu_refresh_if_stale();
+    return pmu_cache.status_valid && pmu_cache.charging;
 }
 
 // Exported for UI status bar - check if USB is connected
 bool ui_is_usb_connected()
 {
-    if (!ensure_pmu_ready())
-    {
-        return false;
-    }
-    auto bus = PMU.getBusStatus();
-    return (bus != PowersSY6970::BUS_STATE_NOINPUT && bus != PowersSY6970::BUS_STATE_OTG);
+    pmu_refresh_if_stale();
+    return pmu_cache.status_valid && pmu_cache.usb;
 }
 
 static void register_sd_fs_driver()
@@ -346,8 +778,9 @@ static void update_led_flash()
     }
 }
 
-static void ensure_flash_power(bool enable)
+static void flash_power_job(void *ctx)
 {
+    bool enable = *static_cast<bool *>(ctx);
     if (enable)
     {
         if (!ensure_pmu_ready())
@@ -362,16 +795,112 @@ static void ensure_flash_power(bool enable)
     }
 }
 
+static void ensure_flash_power(bool enable)
+{
+    // The flash cannot fire before its supply is up, so this one skips the bus queues
+    if (!i2cBusCall(flash_power_job, &enable, 100))
+    {
+        Serial.println("Flash power: I2C bus busy");
+    }
+}
+
 static void init_user_buttons()
 {
-    for (size_t i = 0; i < BOARD_USER_BTN_NUM; ++i)
+    if (!buttonEventsBegin(user_button_pins, BOARD_USER_BTN_NUM, USER_BUTTON_DEBOUNCE_US))
+    {
+        Serial.println("Button event queue allocation failed");
+    }
+}
+
+/**
+ * Record the time from a shutter press to its frame leaving the camera
+ *
+ * @param pressed_us Timestamp of the press event
+ * @param dispatched_us When the loop task took the event off the queue
+ */
+static void log_shutter_latency(uint32_t pressed_us, uint32_t dispatched_us)
+{
+    uint32_t latency = micros() - pressed_us;
+    shutter_latency.count++;
+    shutter_latency.total_us += latency;
+    if (latency > shutter_latency.max_us)
+    {
+        shutter_latency.max_us = latency;
+    }
+
+    Serial.printf("[shutter] press to frame: %luus (queued %luus) avg=%luus max=%luus over %lu\n",
+                  (unsigned long)latency, (unsigned long)(dispatched_us - pressed_us),
+                  (unsigned long)(shutter_latency.total_us / shutter_latency.count),
+                  (unsigned long)shutter_latency.max_us, (unsigned long)shutter_latency.count);
+}
+
+// Palette the capture filter maps to
+static const uint32_t *capture_palette(int &palette_size)
+{
+    const uint32_t *palette = nullptr;
+    palette_size = 0;
+    ui_get_palette(&palette, &palette_size);
+    if (!palette || palette_size <= 0)
+    {
+        palette = PALETTE_CYBERPUNK;
+        palette_size = PALETTE_CYBERPUNK_SIZE;
+    }
+    return palette;
+}
+
+// Selected filter (without auto adjust) on a frame or on one band of a still
+static void apply_capture_filter(camera_fb_t *frame)
+{
+    switch (ui_get_filter_mode())
+    {
+    case 1:
+        applyPixelate(frame, CAPTURE_PIXELATE_BLOCK, false);
+        break;
+    case 2:
     {
-        pinMode(user_button_pins[i], INPUT_PULLUP);
-        user_button_last_pressed[i] = digitalRead(user_button_pins[i]) == LOW;
+        int palette_size = 0;
+        const uint32_t *palette = capture_palette(palette_size);
+        applyColorPalette(reinterpret_cast<uint16_t *>(frame->buf), frame->width, frame->height, palette, palette_size, ui_get_dither_type(), ui_get_pixel_size(), CAPTURE_BAYER_SIZE, ui_get_palette_matching());
+    }
+    break;
+    case 3:
+        applyEdgeDetection(frame, 1);
+        break;
+    case 4:
+        applyCRT(frame, ui_get_pixel_size());
+        break;
+    case 5:
+        applyBoxBlur(frame);
+        break;
+    case 6:
+        applySharpen(frame);
+        break;
+    case 7:
+        applyEmboss(frame);
+        break;
+    case 8:
+        applyUnsharpMask(frame);
+        break;
+    default:
+        break;
     }
 }
 
-static bool rotate_and_filter_frame(camera_fb_t *frame, std::vector<uint16_t> &rgb565_out, uint16_t &out_w, uint16_t &out_h)
+// The palette filter's result as palette indices (frame untouched), for an indexed PNG
+static bool apply_capture_palette_indexed(const camera_fb_t *frame, uint8_t *indices)
+{
+    int palette_size = 0;
+    const uint32_t *palette = capture_palette(palette_size);
+    return applyColorPaletteIndexed(reinterpret_cast<const uint16_t *>(frame->buf), frame->width, frame->height, palette, palette_size, indices, ui_get_dither_type(), ui_get_pixel_size(), CAPTURE_BAYER_SIZE, ui_get_palette_matching());
+}
+
+/**
+ * Zoom and filter a preview-size frame for saving
+ *
+ * With the palette filter the result is returned as palette indices in indices_out and
+ * rgb565_out holds the unfiltered pixels; otherwise indices_out is left empty.
+ */
+static bool rotate_and_filter_frame(camera_fb_t *frame, int zoom_factor, std::vector<uint16_t> &rgb565_out, std::vector<uint8_t> &indices_out, uint16_t &out_w, uint16_t &out_h)
 {
     const uint16_t width = frame->width;
     const uint16_t height = frame->height;
@@ -380,40 +909,19 @@ static bool rotate_and_filter_frame(camera_fb_t *frame, std::vector<uint16_t> &r
     std::vector<uint16_t> working(pixel_count);
     uint16_t *src = reinterpret_cast<uint16_t *>(frame->buf);
 
-    int zoom_level = ui_get_zoom_level();
-    if (zoom_level > 0)
+    if (zoom_factor > 1)
     {
-        int crop_width, crop_height;
-
-        if (zoom_level == 1)
-        {
-            crop_width = width / 2;
-            crop_height = height / 2;
-        }
-        else
-        {
-            crop_width = width / 4;
-            crop_height = height / 4;
-        }
-
-        int start_x = (width - crop_width) / 2;
-        int start_y = (height - crop_height) / 2;
+        ZoomCrop crop = softwareZoomCrop(width, height, zoom_factor);
+        ResampleWindow window = {crop.x, crop.y, crop.width, crop.height};
 
-        for (int y = 0; y < height; y++)
+        // Filters run after the zoom here, so interpolate instead of repeating pixels
+        Resampler resampler = {};
+        if (!resamplerPrepare(resampler, width, height, window, width, height, RESAMPLE_BILINEAR))
         {
-            for (int x = 0; x < width; x++)
-            {
-                int src_x = start_x + (x * crop_width / width);
-                int src_y = start_y + (y * crop_height / height);
-
-                if (src_x >= width)
-                    src_x = width - 1;
-                if (src_y >= height)
-                    src_y = height - 1;
-
-                working[y * width + x] = src[src_y * width + src_x];
-            }
+            return false;
         }
+        resampleFrame(resampler, src, working.data(), width, false);
+        resamplerRelease(resampler);
     }
     else
     {
@@ -432,44 +940,49 @@ static bool rotate_and_filter_frame(camera_fb_t *frame, std::vector<uint16_t> &r
     {
         applyAutoAdjust(&temp_frame);
     }
-
-    switch (ui_get_filter_mode())
+    const uint16_t *grade = ui_get_color_grade();
+    if (grade)
     {
-    case 1:
-        applyPixelate(&temp_frame, 8, false);
-        break;
-    case 2:
+        applyColorGrade(&temp_frame, grade);
+    }
+
+    indices_out.clear();
+    if (ui_get_filter_mode() == 2)
     {
-        int palette_size = 0;
-        const uint32_t *palette = nullptr;
-        ui_get_palette(&palette, &palette_size);
-        if (!palette || palette_size <= 0)
+        indices_out.resize(pixel_count);
+        if (!apply_capture_palette_indexed(&temp_frame, indices_out.data()))
         {
-            palette = PALETTE_CYBERPUNK;
-            palette_size = PALETTE_CYBERPUNK_SIZE;
+            indices_out.clear();
+            apply_capture_filter(&temp_frame);
         }
-        applyColorPalette(working.data(), out_w, out_h, palette, palette_size, ui_get_dither_type(), ui_get_pixel_size(), 2);
     }
-    break;
-    case 3:
-        applyEdgeDetection(&temp_frame, 1);
-        break;
-    case 4:
-        applyCRT(&temp_frame, ui_get_pixel_size());
-        break;
-    default:
-        break;
+    else
+    {
+        apply_capture_filter(&temp_frame);
     }
 
     rgb565_out = std::move(working);
     return true;
 }
 
-static bool encode_rgb565_png(const char *path, const uint16_t *pixels, uint16_t width, uint16_t height)
+// Row-by-row PNG output, so an image can be written as its bands are finished. Rows are
+// frame-order RGB565 (24-bit PNG) or, with a palette, palette indices (indexed PNG)
+struct PngRowWriter
+{
+    uint16_t width;                    // Source row width
+    uint8_t scale;                     // Each source pixel becomes scale x scale output pixels
+    uint8_t index_bits;                // Bits per indexed pixel, 0 for RGB565 rows
+    uint32_t row;                      // Next output row
+    std::vector<uint16_t> scaled_line;
+    std::vector<uint8_t> temp_line;    // Converted or packed output line
+};
+
+static bool png_rows_begin(PngRowWriter &writer, const char *path, uint16_t width, uint16_t height, uint8_t scale,
+                           const uint32_t *palette = nullptr, int palette_size = 0)
 {
     if (SD.exists(path))
     {
-        SD.remove(path);
+        sd_remove_file(path);
     }
 
     int rc = png_encoder.open(path, png_file_open_cb, png_file_close_cb, png_file_read_cb, png_file_write_cb, png_file_seek_cb);
@@ -479,11 +992,28 @@ static bool encode_rgb565_png(const char *path, const uint16_t *pixels, uint16_t
         return false;
     }
 
-    // Scale up the image by 2x (each pixel becomes 2x2)
-    uint16_t scaled_width = width * 2;
-    uint16_t scaled_height = height * 2;
+    uint16_t scaled_width = width * scale;
+    uint16_t scaled_height = height * scale;
 
-    rc = png_encoder.encodeBegin(scaled_width, scaled_height, PNG_PIXEL_TRUECOLOR, 24, nullptr, 3);
+    writer.index_bits = 0;
+    if (palette)
+    {
+        // Smallest bit depth that holds the palette; the encoder takes a 256-entry RGB table
+        palette_size = min(palette_size, 256);
+        writer.index_bits = (palette_size <= 2) ? 1 : (palette_size <= 4) ? 2 : (palette_size <= 16) ? 4 : 8;
+        uint8_t plte[256 * 3] = {};
+        for (int i = 0; i < palette_size; ++i)
+        {
+            plte[i * 3] = (palette[i] >> 16) & 0xFF;
+            plte[i * 3 + 1] = (palette[i] >> 8) & 0xFF;
+            plte[i * 3 + 2] = palette[i] & 0xFF;
+        }
+        rc = png_encoder.encodeBegin(scaled_width, scaled_height, PNG_PIXEL_INDEXED, writer.index_bits, plte, 3);
+    }
+    else
+    {
+        rc = png_encoder.encodeBegin(scaled_width, scaled_height, PNG_PIXEL_TRUECOLOR, 24, nullptr, 3);
+    }
     if (rc != PNG_SUCCESS)
     {
         Serial.printf("encodeBegin failed: %d\n", rc);
@@ -491,49 +1021,335 @@ static bool encode_rgb565_png(const char *path, const uint16_t *pixels, uint16_t
         return false;
     }
 
-    std::vector<uint16_t> scaled_line(scaled_width);
-    std::vector<uint8_t> temp_line(scaled_width * 3);
+    writer.width = width;
+    writer.scale = scale;
+    writer.row = 0;
+    if (writer.index_bits)
+    {
+        writer.temp_line.resize((scaled_width * writer.index_bits + 7) / 8);
+    }
+    else
+    {
+        writer.scaled_line.resize(scaled_width);
+        writer.temp_line.resize(scaled_width * 3);
+    }
+    return true;
+}
 
-    for (uint16_t y = 0; y < height; ++y)
+// Add rows of frame-order pixels; on failure the file is closed and the writer is done
+static bool png_rows_add(PngRowWriter &writer, const uint16_t *pixels, uint16_t rows)
+{
+    for (uint16_t y = 0; y < rows; ++y)
     {
-        const uint16_t *row = pixels + y * width;
+        const uint16_t *row = pixels + y * writer.width;
+        uint16_t *line = const_cast<uint16_t *>(row);
 
-        // Create a scaled line: each pixel becomes 2 pixels horizontally
-        for (uint16_t x = 0; x < width; ++x)
+        if (writer.scale > 1)
         {
-            scaled_line[x * 2] = row[x];
-            scaled_line[x * 2 + 1] = row[x];
+            // Each pixel becomes scale pixels horizontally
+            for (uint16_t x = 0; x < writer.width; ++x)
+            {
+                for (uint8_t s = 0; s < writer.scale; ++s)
+                {
+                    writer.scaled_line[x * writer.scale + s] = row[x];
+                }
+            }
+            line = writer.scaled_line.data();
         }
 
-        // Write the same line twice (for vertical scaling)
-        rc = png_encoder.addRGB565Line(scaled_line.data(), temp_line.data(), true);
-        if (rc != PNG_SUCCESS)
+        // And the line is written scale times for vertical scaling
+        for (uint8_t s = 0; s < writer.scale; ++s)
         {
-            Serial.printf("addLine failed at row %u: %d\n", y * 2, rc);
-            png_encoder.close();
-            return false;
+            int rc = png_encoder.addRGB565Line(line, writer.temp_line.data(), true);
+            if (rc != PNG_SUCCESS)
+            {
+                Serial.printf("addLine failed at row %lu: %d\n", static_cast<unsigned long>(writer.row), rc);
+                png_encoder.close();
+                return false;
+            }
+            writer.row++;
+        }
+    }
+
+    return true;
+}
+
+// Add rows of palette indices to an indexed writer; on failure the file is closed
+static bool png_rows_add_indexed(PngRowWriter &writer, const uint8_t *indices, uint16_t rows)
+{
+    const uint8_t bits = writer.index_bits;
+    for (uint16_t y = 0; y < rows; ++y)
+    {
+        const uint8_t *row = indices + y * writer.width;
+
+        // Pack the scaled line, leftmost pixel in the high bits
+        memset(writer.temp_line.data(), 0, writer.temp_line.size());
+        uint32_t bit = 0;
+        for (uint16_t x = 0; x < writer.width; ++x)
+        {
+            for (uint8_t s = 0; s < writer.scale; ++s, bit += bits)
+            {
+                writer.temp_line[bit >> 3] |= row[x] << (8 - bits - (bit & 7));
+            }
         }
 
-        rc = png_encoder.addRGB565Line(scaled_line.data(), temp_line.data(), true);
-        if (rc != PNG_SUCCESS)
+        for (uint8_t s = 0; s < writer.scale; ++s)
         {
-            Serial.printf("addLine failed at row %u: %d\n", y * 2 + 1, rc);
-            png_encoder.close();
-            return false;
+            int rc = png_encoder.addLine(writer.temp_line.data());
+            if (rc != PNG_SUCCESS)
+            {
+                Serial.printf("addLine failed at row %lu: %d\n", static_cast<unsigned long>(writer.row), rc);
+                png_encoder.close();
+                return false;
+            }
+            writer.row++;
         }
     }
 
+    return true;
+}
+
+static bool png_rows_finish(PngRowWriter &writer)
+{
+    (void)writer;
+
     int32_t written = png_encoder.close();
     if (written <= 0)
     {
         Serial.println("PNG close failed");
         return false;
     }
+    sd_space_note_change(written);
 
     return true;
 }
 
-static bool save_frame_as_png(camera_fb_t *frame)
+static bool encode_rgb565_png(const char *path, const uint16_t *pixels, uint16_t width, uint16_t height)
+{
+    // Scale up the image by 2x (each pixel becomes 2x2)
+    PngRowWriter writer;
+    if (!png_rows_begin(writer, path, width, height, 2))
+    {
+        return false;
+    }
+
+    if (!png_rows_add(writer, pixels, height))
+    {
+        return false;
+    }
+
+    return png_rows_finish(writer);
+}
+
+static bool encode_indexed_png(const char *path, const uint8_t *indices, const uint32_t *palette, int palette_size, uint16_t width, uint16_t height)
+{
+    // Scaled up 2x like encode_rgb565_png
+    PngRowWriter writer;
+    if (!png_rows_begin(writer, path, width, height, 2, palette, palette_size))
+    {
+        return false;
+    }
+
+    if (!png_rows_add_indexed(writer, indices, height))
+    {
+        return false;
+    }
+
+    return png_rows_finish(writer);
+}
+
+// Band layout for processing a still with the selected filter
+struct StillBandPlan
+{
+    int rows; // Output rows per band (the whole frame if the filter cannot be split)
+    int halo; // Extra source rows the filter reads above and below a band
+};
+
+static StillBandPlan plan_still_bands(int height)
+{
+    int align = 1;
+    int halo = 0;
+
+    switch (ui_get_filter_mode())
+    {
+    case 1:
+        align = CAPTURE_PIXELATE_BLOCK;
+        break;
+    case 2:
+        align = colorPaletteBandAlign(ui_get_dither_type(), ui_get_pixel_size(), CAPTURE_BAYER_SIZE);
+        break;
+    case 3:
+        halo = EDGE_DETECTION_HALO;
+        break;
+    case 4:
+        align = crtBandAlign(ui_get_pixel_size());
+        break;
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+        halo = CONVOLUTION_HALO;
+        break;
+    default:
+        break;
+    }
+
+    StillBandPlan plan;
+    plan.rows = (align > 0) ? ((STILL_BAND_ROWS + align - 1) / align) * align : height;
+    plan.rows = min(plan.rows, height);
+    plan.halo = halo;
+    return plan;
+}
+
+/**
+ * Zoom, filter and encode a still one horizontal band at a time
+ *
+ * Each band (plus halo rows) is rebuilt from the untouched camera frame, run through
+ * auto adjust and the selected filter as a small frame of its own, and its rows are
+ * handed to the PNG encoder straight away, so scratch memory is a few bands, not a frame.
+ * The palette filter's bands are encoded as palette indices (an indexed PNG).
+ */
+static bool save_still_as_png(camera_fb_t *frame, int zoom_factor, const char *path)
+{
+    const int width = frame->width;
+    const int height = frame->height;
+    const uint16_t *src = reinterpret_cast<const uint16_t *>(frame->buf);
+
+    StillBandPlan plan = plan_still_bands(height);
+    ZoomCrop crop = softwareZoomCrop(width, height, zoom_factor);
+
+    Resampler resampler = {};
+    if (zoom_factor > 1)
+    {
+        ResampleWindow window = {crop.x, crop.y, crop.width, crop.height};
+        if (!resamplerPrepare(resampler, width, height, window, width, height, RESAMPLE_BILINEAR))
+        {
+            return false;
+        }
+    }
+
+    // Auto adjust needs the histogram of the whole picture, taken from the source crop
+    bool auto_adjust = ui_get_auto_adjust_enabled();
+    Lut565 auto_lut;
+    if (auto_adjust)
+    {
+        buildAutoAdjustLut(src + crop.y * width + crop.x, crop.width, crop.height, width, auto_lut);
+    }
+    const uint16_t *grade = ui_get_color_grade();
+
+    size_t band_bytes = static_cast<size_t>(width) * min(height, plan.rows + 2 * plan.halo) * sizeof(uint16_t);
+    uint16_t *band = (uint16_t *)ps_malloc(band_bytes);
+    if (!band)
+    {
+        resamplerRelease(resampler);
+        return false;
+    }
+
+    // Palette bands go to the encoder as indices, one byte per pixel
+    int palette_size = 0;
+    const uint32_t *palette = nullptr;
+    size_t index_bytes = 0;
+    uint8_t *band_indices = nullptr;
+    if (ui_get_filter_mode() == 2)
+    {
+        palette = capture_palette(palette_size);
+        index_bytes = band_bytes / sizeof(uint16_t);
+        band_indices = (uint8_t *)ps_malloc(index_bytes);
+        if (!band_indices)
+        {
+            palette = nullptr;
+            index_bytes = 0;
+        }
+    }
+
+    PngRowWriter writer;
+    bool ok = png_rows_begin(writer, path, width, height, 1, palette, palette_size);
+
+    uint32_t start = millis();
+    int band_count = 0;
+    for (int y0 = 0; ok && y0 < height; y0 += plan.rows, band_count++)
+    {
+        int y1 = min(y0 + plan.rows, height);
+        int read_y0 = max(0, y0 - plan.halo);
+        int read_y1 = min(height, y1 + plan.halo);
+        int read_rows = read_y1 - read_y0;
+
+        uint32_t t0 = micros();
+        if (zoom_factor > 1)
+        {
+            resampleRows(resampler, src, band, width, read_y0, read_y1, false);
+        }
+        else
+        {
+            memcpy(band, src + read_y0 * width, static_cast<size_t>(read_rows) * width * sizeof(uint16_t));
+        }
+        if (auto_adjust)
+        {
+            applyLut565(band, read_rows * width, auto_lut);
+        }
+        if (grade)
+        {
+            applyColorGradeRun(band, static_cast<size_t>(read_rows) * width, grade);
+        }
+
+        uint32_t t1 = micros();
+        camera_fb_t band_frame = *frame;
+        band_frame.buf = reinterpret_cast<uint8_t *>(band);
+        band_frame.width = width;
+        band_frame.height = read_rows;
+        band_frame.len = static_cast<size_t>(read_rows) * width * sizeof(uint16_t);
+        if (band_indices)
+        {
+            ok = apply_capture_palette_indexed(&band_frame, band_indices);
+        }
+        else
+        {
+            apply_capture_filter(&band_frame);
+        }
+
+        uint32_t t2 = micros();
+        if (!ok)
+        {
+            png_encoder.close();
+        }
+        else if (band_indices)
+        {
+            ok = png_rows_add_indexed(writer, band_indices + (y0 - read_y0) * width, y1 - y0);
+        }
+        else
+        {
+            ok = png_rows_add(writer, band + (y0 - read_y0) * width, y1 - y0);
+        }
+
+        uint32_t t3 = micros();
+        Serial.printf("[still] band %d rows %d-%d: fetch=%luus filter=%luus encode=%luus\n",
+                      band_count, y0, y1 - 1,
+                      (unsigned long)(t1 - t0), (unsigned long)(t2 - t1), (unsigned long)(t3 - t2));
+    }
+
+    if (ok)
+    {
+        ok = png_rows_finish(writer);
+    }
+
+    Serial.printf("[still] %dx%d in %d band(s) of %d rows (halo %d), scratch %u bytes, %lums\n",
+                  width, height, band_count, plan.rows, plan.halo,
+                  (unsigned)(band_bytes + index_bytes), (unsigned long)(millis() - start));
+
+    free(band_indices);
+    free(band);
+    resamplerRelease(resampler);
+    return ok;
+}
+
+/**
+ * Process and save a captured frame
+ *
+ * @param frame Captured frame
+ * @param zoom_factor Zoom still to apply in software
+ * @param still Frame is a high-resolution still (band processed, saved at 1:1)
+ */
+static bool save_frame_as_png(camera_fb_t *frame, int zoom_factor, bool still)
 {
     if (!ensure_sd_initialized())
     {
@@ -544,24 +1360,42 @@ static bool save_frame_as_png(camera_fb_t *frame)
     uint32_t current_index = photo_counter;
     snprintf(path, sizeof(path), "/photo_%lu.png", static_cast<unsigned long>(current_index));
 
-    std::vector<uint16_t> processed_pixels;
     uint16_t out_w = frame->width;
     uint16_t out_h = frame->height;
-    if (!rotate_and_filter_frame(frame, processed_pixels, out_w, out_h))
+    bool ok;
+    if (still)
     {
-        Serial.println("Failed to process frame before saving");
-        return false;
+        ok = save_still_as_png(frame, zoom_factor, path);
     }
-
-    if (SD.exists(path))
+    else
     {
-        SD.remove(path);
+        std::vector<uint16_t> processed_pixels;
+        std::vector<uint8_t> palette_indices;
+        if (!rotate_and_filter_frame(frame, zoom_factor, processed_pixels, palette_indices, out_w, out_h))
+        {
+            Serial.println("Failed to process frame before saving");
+            return false;
+        }
+
+        if (!palette_indices.empty())
+        {
+            int palette_size = 0;
+            const uint32_t *palette = capture_palette(palette_size);
+            ok = encode_indexed_png(path, palette_indices.data(), palette, palette_size, out_w, out_h);
+        }
+        else
+        {
+            ok = encode_rgb565_png(path, processed_pixels.data(), out_w, out_h);
+        }
     }
 
-    bool ok = encode_rgb565_png(path, processed_pixels.data(), out_w, out_h);
     if (ok)
     {
         Serial.printf("Saved photo to %s (%u x %u)\n", path, out_w, out_h);
+        parallelLogStats();
+        sensorQueueLogStats();
+        i2cBusLogStats();
+        ui_log_preview_stats();
         photo_prefs.putUInt(PHOTO_PREF_KEY, current_index);
         photo_counter = current_index + 1;
         ui_show_photo_overlay("Photo saved");
@@ -636,6 +1470,7 @@ static bool save_screenshot_as_bmp(const char *filename, lv_img_dsc_t *img_dsc,
 
     free(row);
     file.close();
+    sd_space_note_change(file_size);
     Serial.printf("Screenshot saved: %s\n", filename);
     return true;
 }
@@ -707,8 +1542,90 @@ static void capture_screenshot()
     }
 }
 
-static void capture_photo_with_flash()
+// Drop frames until one arrives at the given frame size (the first one after a switch
+// was exposed with the old mode)
+static void wait_for_frame_size(framesize_t size)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (!fb)
+        {
+            continue;
+        }
+        bool ready = fb->width == resolution[size].width && fb->height == resolution[size].height;
+        esp_camera_fb_return(fb);
+        if (ready)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Switch the sensor to the still frame size for one capture
+ *
+ * @param sensor Camera sensor
+ * @param sensor_zoom Set to the zoom the sensor window applies at the still size
+ * @return false if the sensor stayed in (or was put back into) preview mode
+ */
+static bool enter_still_mode(sensor_t *sensor, int &sensor_zoom)
+{
+    uint32_t start = millis();
+
+    i2cBusLock();
+    bool switched = sensor->set_framesize(sensor, STILL_FRAME_SIZE) == 0;
+    if (switched)
+    {
+        sensor_zoom = applySensorZoom(sensor, zoomLevelFactor(ui_get_zoom_level()));
+    }
+    i2cBusUnlock();
+
+    if (!switched)
+    {
+        Serial.println("[still] frame size switch failed");
+        return false;
+    }
+    wait_for_frame_size(STILL_FRAME_SIZE);
+
+    Serial.printf("[still] switch to %ux%u (sensor zoom %dx): %lums\n",
+                  resolution[STILL_FRAME_SIZE].width, resolution[STILL_FRAME_SIZE].height,
+                  sensor_zoom, (unsigned long)(millis() - start));
+    return true;
+}
+
+static void leave_still_mode(sensor_t *sensor)
+{
+    uint32_t start = millis();
+
+    i2cBusLock();
+    sensor->set_framesize(sensor, PREVIEW_FRAME_SIZE);
+    i2cBusUnlock();
+    sensorQueueFrameSizeChanged(); // The preview restores its zoom window at its next frame
+    wait_for_frame_size(PREVIEW_FRAME_SIZE);
+
+    Serial.printf("[still] switch back to preview: %lums\n", (unsigned long)(millis() - start));
+}
+
+/**
+ * Take and save a photo
+ *
+ * @param pressed_us When the shutter button was pressed
+ */
+static void capture_photo_with_flash(uint32_t pressed_us)
 {
+    uint32_t dispatched_us = micros();
+
+    // High-resolution stills: the sensor switches up for this one frame
+    sensor_t *sensor = esp_camera_sensor_get();
+    bool still_mode = ui_get_still_mode_enabled() && sensor && sensor->id.PID == OV3660_PID;
+    int still_sensor_zoom = 1;
+    if (still_mode && !enter_still_mode(sensor, still_sensor_zoom))
+    {
+        leave_still_mode(sensor);
+        still_mode = false;
+    }
+
     bool flash_active = trigger_led_flash();
 
     if (flash_active)
@@ -720,6 +1637,7 @@ static void capture_photo_with_flash()
             camera_fb_t *temp = esp_camera_fb_get();
             if (temp)
             {
+                sensorQueueFrameFetched();
                 esp_camera_fb_return(temp);
             }
             delay(50);
@@ -727,6 +1645,12 @@ static void capture_photo_with_flash()
     }
 
     camera_fb_t *frame = esp_camera_fb_get();
+    if (frame && !sensorQueueFrameFetched())
+    {
+        // Read out while the preview's zoom window was rewritten
+        esp_camera_fb_return(frame);
+        frame = esp_camera_fb_get();
+    }
     if (!frame)
     {
         Serial.println("Failed to capture frame");
@@ -736,16 +1660,29 @@ static void capture_photo_with_flash()
             led_flash_active = false;
             ensure_flash_power(false);
         }
+        if (still_mode)
+        {
+            leave_still_mode(sensor);
+        }
         return;
     }
+    log_shutter_latency(pressed_us, dispatched_us);
 
-    if (!save_frame_as_png(frame))
+    // Zoom the sensor window did not already apply is done in software
+    int zoom_factor = still_mode ? zoomLevelFactor(ui_get_zoom_level()) / still_sensor_zoom
+                                 : ui_get_software_zoom_factor();
+    if (!save_frame_as_png(frame, zoom_factor, still_mode))
     {
         Serial.println("Failed to save captured frame");
     }
 
     esp_camera_fb_return(frame);
 
+    if (still_mode)
+    {
+        leave_still_mode(sensor);
+    }
+
     if (led_flash_active)
     {
         ledcWrite(LEDC_WHITE_CH, 0);
@@ -756,21 +1693,23 @@ static void capture_photo_with_flash()
 
 static void handle_user_buttons()
 {
-    for (size_t i = 0; i < BOARD_USER_BTN_NUM; ++i)
+    // Presses made while the loop was busy are still queued, in order
+    ButtonEvent event;
+    while (buttonEventsNext(event))
     {
-        bool pressed = digitalRead(user_button_pins[i]) == LOW;
-        if (pressed && !user_button_last_pressed[i])
+        if (!event.pressed)
         {
-            if (i == 1 && ui_get_screenshot_mode_enabled())
-            {
-                capture_screenshot();
-            }
-            else
-            {
-                capture_photo_with_flash();
-            }
+            continue;
+        }
+
+        if (event.button == 1 && ui_get_screenshot_mode_enabled())
+        {
+            capture_screenshot();
+        }
+        else
+        {
+            capture_photo_with_flash(event.micros);
         }
-        user_button_last_pressed[i] = pressed;
     }
 }
 
@@ -797,7 +1736,7 @@ void camera_init(void)
     config.xclk_freq_hz = XCLK_FREQ_HZ;
 
     config.pixel_format = PIXFORMAT_RGB565;
-    config.frame_size = FRAMESIZE_HQVGA; // HQVGA (240x176) for best FPS
+    config.frame_size = STILL_FRAME_SIZE; // Largest size used, so stills fit the frame buffer
     config.jpeg_quality = 0;
     config.fb_count = 1;
 
@@ -813,6 +1752,9 @@ void camera_init(void)
 
     if (s)
     {
+        // Preview runs at the small frame size; stills switch up temporarily
+        s->set_framesize(s, PREVIEW_FRAME_SIZE);
+
         if (s->id.PID == GC0308_PID)
         {
             s->set_vflip(s, 0); // This can't flip the picture vertically. Watch out!
@@ -869,6 +1811,7 @@ void camera_init(void)
 /* Display flushing */
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
+    ProfileScope scope(PROFILE_FLUSH);
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
@@ -883,11 +1826,15 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
 // Touchpad reading function
 void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
 {
-    if (touch_touched())
+    // With the touch interrupt running, the bus task keeps the last point up to date
+    bool pressed = touch_has_signal() ? touch_cached_pressed : touch_touched();
+    if (pressed)
     {
+        int16_t x, y;
+        touch_last_xy(x, y);
         data->state = LV_INDEV_STATE_PR;
-        data->point.x = touch_last_x;
-        data->point.y = touch_last_y;
+        data->point.x = x;
+        data->point.y = y;
     }
     else
     {
@@ -961,6 +1908,18 @@ void setup()
 
     touch_init(screenWidth, screenHeight, tft.getRotation());
 
+    // Every device on the shared bus is initialized; from here on Wire traffic goes
+    // through the bus task
+    if (i2cBusBegin())
+    {
+        touch_begin_irq();
+        i2cBusCall(pmu_refresh_job, nullptr, 200);
+    }
+    else
+    {
+        Serial.println("I2C bus task failed to start, polling touch");
+    }
+
     ui_init();
 
     ensure_sd_initialized();
@@ -974,9 +1933,140 @@ void setup()
     Serial.println("Setup done");
 }
 
+// Raw preview recording: consecutive frames as the driver delivered them, before any
+// filter, written to /seq_<n>.fseq for replay on the host (see frame_sequence.h)
+struct FrameRecording
+{
+    File file;
+    char path[24];
+    FrameSequenceHeader header;
+    uint32_t remaining; // Frames still to record
+    uint64_t bytes;
+    uint32_t start_ms;
+    bool active;
+};
+static FrameRecording frame_recording;
+
+static bool frame_recording_start(uint32_t frames)
+{
+    if (frame_recording.active || frames == 0 || !ensure_sd_initialized())
+    {
+        return false;
+    }
+
+    for (uint32_t n = 1; n < 10000; n++)
+    {
+        snprintf(frame_recording.path, sizeof(frame_recording.path), "/seq_%lu.fseq", static_cast<unsigned long>(n));
+        if (!SD.exists(frame_recording.path))
+        {
+            break;
+        }
+    }
+
+    frame_recording.file = SD.open(frame_recording.path, FILE_WRITE);
+    if (!frame_recording.file)
+    {
+        Serial.printf("[rec] cannot create %s\n", frame_recording.path);
+        return false;
+    }
+
+    sensor_t *sensor = esp_camera_sensor_get();
+    frameSequenceInitHeader(frame_recording.header, sensor ? sensor->id.PID : 0);
+    frame_recording.bytes = frame_recording.file.write(reinterpret_cast<const uint8_t *>(&frame_recording.header),
+                                                       sizeof(frame_recording.header));
+    frame_recording.remaining = frames;
+    frame_recording.start_ms = millis();
+    frame_recording.active = true;
+    Serial.printf("[rec] recording %lu frames to %s\n", static_cast<unsigned long>(frames), frame_recording.path);
+    return true;
+}
+
+static void frame_recording_finish()
+{
+    // The frame count goes into the header last, so a cut-short file still says so
+    frame_recording.file.seek(0);
+    frame_recording.file.write(reinterpret_cast<const uint8_t *>(&frame_recording.header),
+                               sizeof(frame_recording.header));
+    frame_recording.file.close();
+    frame_recording.active = false;
+    sd_space_note_change(frame_recording.bytes);
+
+    Serial.printf("[rec] %s frames=%lu bytes=%llu ms=%lu\n", frame_recording.path,
+                  static_cast<unsigned long>(frame_recording.header.frameCount),
+                  static_cast<unsigned long long>(frame_recording.bytes),
+                  static_cast<unsigned long>(millis() - frame_recording.start_ms));
+}
+
+// Exported for the preview: called with each frame as fetched, before it is filtered
+void ui_record_preview_frame(const camera_fb_t *frame)
+{
+    if (!frame_recording.active)
+    {
+        return;
+    }
+
+    FrameSequenceRecord record;
+    frameSequenceFillRecord(record, frame, esp_camera_sensor_get(), ui_get_zoom_level(), sensorQueueZoomFactor());
+    bool ok = frame_recording.file.write(reinterpret_cast<const uint8_t *>(&record), sizeof(record)) == sizeof(record) &&
+              frame_recording.file.write(frame->buf, frame->len) == frame->len;
+    if (!ok)
+    {
+        Serial.println("[rec] write failed, recording stopped");
+        frame_recording_finish();
+        return;
+    }
+
+    frame_recording.bytes += sizeof(record) + frame->len;
+    frame_recording.header.frameCount++;
+    if (--frame_recording.remaining == 0)
+    {
+        frame_recording_finish();
+    }
+}
+
+// Line commands on the serial console ("prof": dump the frame stage ring as CSV; "rec N":
+// record the next N preview frames raw to SD)
+static void handle_serial_commands()
+{
+    static char line[32];
+    static size_t line_len = 0;
+
+    while (Serial.available() > 0)
+    {
+        char c = (char)Serial.read();
+        if (c != '\n' && c != '\r')
+        {
+            if (line_len < sizeof(line) - 1)
+            {
+                line[line_len++] = c;
+            }
+            continue;
+        }
+
+        line[line_len] = '\0';
+        if (strcmp(line, "prof") == 0)
+        {
+            profileDumpCsv();
+        }
+        else if (strcmp(line, "rec") == 0 || strncmp(line, "rec ", 4) == 0)
+        {
+            long frames = line[3] ? strtol(line + 3, nullptr, 10) : FRAME_RECORDING_DEFAULT_FRAMES;
+            if (!frame_recording_start(frames > 0 ? frames : 0))
+            {
+                Serial.println("[rec] not started (already recording, bad count or no SD card)");
+            }
+        }
+        line_len = 0;
+    }
+}
+
 void loop()
 {
     handle_user_buttons();
+    handle_serial_commands();
     update_led_flash();
+
+    // Scopes opened inside (camera timer, flush) are not counted as render time
+    ProfileScope scope(PROFILE_RENDER);
     lv_task_handler();
 }